@@ -42,6 +42,20 @@ Context::Context(Emulator *emulator) :
 }
 
 
+void Context::setId(int id)
+{
+	// Update ID and name
+	this->id = id;
+	name = misc::fmt("%s context %d",
+			emulator->getName().c_str(),
+			id);
+
+	// Identifiers of future contexts must not collide
+	if (id_counter <= id)
+		id_counter = id + 1;
+}
+
+
 void Context::Suspend()
 {
 	throw misc::Panic("Not implemented");
@@ -57,6 +57,12 @@ public:
 	/// architectures.
 	int getId() const { return id; }
 
+	/// Change the identifier of the context, updating its name. This
+	/// function is used when restoring a context from a checkpoint. The
+	/// identifiers assigned to contexts created later will be higher
+	/// than \a id.
+	void setId(int id);
+
 	/// Return the name of the context, formed of the name of the
 	/// architecture, the word 'context', and its identifier.
 	const std::string &getName() const { return name; }
@@ -17,8 +17,13 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */ 
  
+#include <cstdlib>
+#include <fcntl.h>
+#include <map>
 #include <unistd.h>
 
+#include <lib/cpp/Error.h>
+
 #include "FileTable.h"
 
 namespace comm
@@ -174,5 +179,149 @@ void FileTable::freeFileDescriptor(int index)
 }
 
 
+void FileTable::SaveCheckpoint(std::ostream &os) const
+{
+	// Number of entries
+	misc::WriteBinary(os, (unsigned) descriptors.size());
+
+	// Entries
+	for (auto &desc : descriptors)
+	{
+		// Empty entry
+		misc::WriteBinary(os, (bool) desc);
+		if (!desc)
+			continue;
+
+		// Only files with a host path, or the host standard input and
+		// output, can be restored.
+		FileDescriptor::Type type = desc->getType();
+		if (type != FileDescriptor::TypeRegular &&
+				type != FileDescriptor::TypeStandard &&
+				type != FileDescriptor::TypeVirtual)
+			throw misc::Error(misc::fmt("File descriptor %d of type "
+					"'%s' cannot be saved in a checkpoint",
+					desc->getGuestIndex(),
+					FileDescriptor::TypeTypeMap[type]));
+
+		// Current offset in host file
+		long long offset = 0;
+		if (!desc->getPath().empty())
+			offset = lseek(desc->getHostIndex(), 0, SEEK_CUR);
+
+		// Save
+		misc::WriteBinary(os, type);
+		misc::WriteBinary(os, desc->getGuestIndex());
+		misc::WriteBinary(os, desc->getHostIndex());
+		misc::WriteBinary(os, desc->getFlags());
+		misc::WriteBinary(os, offset);
+		misc::WriteBinaryString(os, desc->getPath());
+
+		// The temporary host file of a virtual file is deleted when
+		// the file is closed, so its content is saved as well.
+		if (type == FileDescriptor::TypeVirtual)
+		{
+			std::string content;
+			char buffer[4096];
+			long long size;
+			long long position = 0;
+			while ((size = pread(desc->getHostIndex(), buffer,
+					sizeof buffer, position)) > 0)
+			{
+				content.append(buffer, size);
+				position += size;
+			}
+			if (size < 0)
+				throw misc::Error(misc::fmt("%s: cannot read "
+						"virtual file",
+						desc->getPath().c_str()));
+			misc::WriteBinaryString(os, content);
+		}
+	}
+}
+
+
+void FileTable::LoadCheckpoint(std::istream &is)
+{
+	// Number of entries
+	unsigned size;
+	misc::ReadBinary(is, size);
+	descriptors.clear();
+	descriptors.resize(size);
+
+	// Host files open in the checkpoint can be shared by several guest
+	// descriptors (e.g., redirected standard output and error). Map old
+	// host descriptors to the new ones.
+	std::map<int, int> host_index_map;
+
+	// Entries
+	for (unsigned i = 0; i < size; i++)
+	{
+		// Empty entry
+		bool present;
+		misc::ReadBinary(is, present);
+		if (!present)
+			continue;
+
+		// Read fields
+		FileDescriptor::Type type;
+		int guest_index;
+		int host_index;
+		int flags;
+		long long offset;
+		misc::ReadBinary(is, type);
+		misc::ReadBinary(is, guest_index);
+		misc::ReadBinary(is, host_index);
+		misc::ReadBinary(is, flags);
+		misc::ReadBinary(is, offset);
+		std::string path = misc::ReadBinaryString(is);
+
+		// Virtual files are created again in a new temporary host
+		// file with the saved content
+		if (type == FileDescriptor::TypeVirtual)
+		{
+			std::string content = misc::ReadBinaryString(is);
+			char temp_path[] = "/tmp/m2s.XXXXXX";
+			int fd = mkstemp(temp_path);
+			if (fd < 0)
+				throw misc::Error("Cannot create temporary file");
+			bool error = write(fd, content.data(), content.size()) !=
+					(ssize_t) content.size();
+			close(fd);
+			if (error)
+				throw misc::Error(misc::fmt("%s: cannot write "
+						"virtual file", temp_path));
+			path = temp_path;
+		}
+
+		// Open host file again, if any. Standard input and output
+		// without a path are inherited from the host.
+		if (!path.empty())
+		{
+			auto it = host_index_map.find(host_index);
+			if (it != host_index_map.end())
+			{
+				host_index = it->second;
+			}
+			else
+			{
+				int new_host_index = open(path.c_str(), flags &
+						~(O_CREAT | O_TRUNC | O_EXCL));
+				if (new_host_index < 0)
+					throw misc::Error(misc::fmt("%s: cannot "
+							"open file",
+							path.c_str()));
+				lseek(new_host_index, offset, SEEK_SET);
+				host_index_map[host_index] = new_host_index;
+				host_index = new_host_index;
+			}
+		}
+
+		// Create entry
+		descriptors[i].reset(new FileDescriptor(type, guest_index,
+				host_index, flags, path));
+	}
+}
+
+
 }  // namespace comm
 
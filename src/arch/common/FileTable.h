@@ -200,6 +200,26 @@ public:
 	/// Return the guest file descriptor associated with a host file
 	/// descriptor given in \a host_index, or -1 if invalid.
 	int getGuestIndex(int host_index) const;
+
+	/// Save the file descriptor table into a binary checkpoint stream. For
+	/// files opened in the host, the path and current file offset are
+	/// saved, so that they can be opened again when the checkpoint is
+	/// loaded. The content of virtual files is saved too, since their
+	/// temporary host files are deleted when they are closed.
+	///
+	/// \throw
+	///	A misc::Error is thrown if the table contains pipes, sockets,
+	///	or virtual devices, which cannot be restored.
+	void SaveCheckpoint(std::ostream &os) const;
+
+	/// Replace the content of the table with the file descriptors saved in
+	/// a checkpoint stream, opening the associated host files again.
+	/// Virtual files are recreated in new temporary host files.
+	///
+	/// \throw
+	///	A misc::Error is thrown if the stream is truncated or a file
+	///	cannot be opened.
+	void LoadCheckpoint(std::istream &is);
 };
 
 
@@ -39,6 +39,13 @@ std::string Emulator::isa_debug_file;
 
 long long Emulator::max_instructions;
 
+int Emulator::num_threads = 1;
+
+const int Emulator::WorkGroupsPerThread;
+
+thread_local Emulator::Statistics *Emulator::thread_statistics;
+thread_local Emulator::Statistics Emulator::ThreadPool::statistics;
+
 std::string Emulator::scheduler_debug_file;
  
 misc::Debug Emulator::scheduler_debug;
@@ -87,6 +94,85 @@ void Emulator::DumpSummary(std::ostream &os) const
 }
 
 
+void Emulator::ExecuteWorkGroup(WorkGroup *work_group)
+{
+	while (!work_group->getFinished())
+	{
+		// Execute an instruction for each wavefront
+		for (auto wf_i = work_group->getWavefrontsBegin(), 
+				wf_e = work_group->getWavefrontsEnd();
+				wf_i != wf_e;
+				++wf_i)
+		{
+			// Get current wavefront
+			Wavefront *wavefront = (*wf_i).get();
+
+			// Check if the wavefront is finished or not
+			if (wavefront->getFinished() || wavefront->at_barrier)
+				continue;
+			
+			// Execute the wavefront
+			wavefront->Execute();
+		}
+	}
+}
+
+
+void Emulator::ThreadPool::BeginBatch()
+{
+	// Count instructions locally while executing the batch
+	statistics = Statistics();
+	thread_statistics = &statistics;
+}
+
+
+void Emulator::ThreadPool::ExecuteTask(int index)
+{
+	emulator->ExecuteWorkGroup(work_groups[index]);
+}
+
+
+void Emulator::ThreadPool::EndBatch()
+{
+	// Merge statistics
+	thread_statistics = nullptr;
+	emulator->num_instructions += statistics.num_instructions;
+	emulator->num_scalar_alu_instructions +=
+			statistics.num_scalar_alu_instructions;
+	emulator->num_scalar_memory_instructions +=
+			statistics.num_scalar_memory_instructions;
+	emulator->num_branch_instructions +=
+			statistics.num_branch_instructions;
+	emulator->num_vector_alu_instructions +=
+			statistics.num_vector_alu_instructions;
+	emulator->num_lds_instructions +=
+			statistics.num_lds_instructions;
+	emulator->num_vector_memory_instructions +=
+			statistics.num_vector_memory_instructions;
+	emulator->num_export_instructions +=
+			statistics.num_export_instructions;
+}
+
+
+void Emulator::ExecuteWorkGroups(const std::vector<WorkGroup *> &work_groups)
+{
+	// Accesses to global memory are serialized while the batch runs
+	thread_pool.work_groups = work_groups;
+	threads_running = true;
+	try
+	{
+		thread_pool.Run(work_groups.size(), num_threads);
+	}
+	catch (...)
+	{
+		threads_running = false;
+		throw;
+	}
+	threads_running = false;
+	thread_pool.work_groups.clear();
+}
+
+
 bool Emulator::Run()
 {
 	// For efficiency when no Southern Islands emulation is selected, 
@@ -94,54 +180,45 @@ bool Emulator::Run()
 	if (!getNumNDRanges())
 		return false;
 
+	// Work-groups run on multiple host threads, unless ISA traces are
+	// dumped, whose order would not be deterministic.
+	bool parallel = num_threads > 1 && !isa_debug;
+
 	// NDRange list is shared by CL/GL driver
 	for (auto it = getNDRangesBegin(), e = getNDRangesEnd(); it !=e; ++it)
 	{
 		// Get NDRange
 		NDRange *ndrange = it->get();
 
-		// Setup WorkGroup pointer
-		WorkGroup *work_group = nullptr;
-		
-		// Move a single waiting work group to the running work groups 
-		// list
-		if (!ndrange->isWaitingWorkGroupsEmpty())
+		// Move waiting work groups to the running work groups list. A
+		// single work group is executed at a time, unless work groups
+		// are distributed among host threads.
+		std::vector<WorkGroup *> work_groups;
+		int max_work_groups = parallel ?
+				num_threads * WorkGroupsPerThread : 1;
+		while (!ndrange->isWaitingWorkGroupsEmpty() &&
+				(int) work_groups.size() < max_work_groups)
 		{
 			long work_group_id = ndrange->GetWaitingWorkGroup();
-			work_group = ndrange->ScheduleWorkGroup(
-					work_group_id);
+			work_groups.push_back(ndrange->ScheduleWorkGroup(
+					work_group_id));
 		}
 
 		// If there's no work groups to run, go to next nd-range 
-		if (ndrange->isRunningWorkGroupsEmpty())
+		if (work_groups.empty())
 			continue;
-	
-		// Normally, we would iterate over the running work group list
-		// but in this case there is only a single work group being
-		// executed at a time so no loop is needed
-		while (!work_group->getFinished())
-		{
-			// Execute an instruction for each wavefront
-			for (auto wf_i = work_group->getWavefrontsBegin(), 
-					wf_e = work_group->getWavefrontsEnd();
-					wf_i != wf_e;
-					++wf_i)
-			{
-				// Get current wavefront
-				Wavefront *wavefront = (*wf_i).get();
-
-				// Check if the wavefront is finished or not
-				if (wavefront->getFinished() || wavefront->at_barrier)
-					continue;
-				
-				// Execute the wavefront
-				wavefront->Execute();
-			}
-		}
-	
-		// Now that the work group is finished, remove it from the
+
+		// Execute work groups. Independent work groups only share
+		// global memory, whose accesses are serialized.
+		if (work_groups.size() > 1)
+			ExecuteWorkGroups(work_groups);
+		else
+			ExecuteWorkGroup(work_groups[0]);
+
+		// Now that the work groups are finished, remove them from the
 		// running work group list
-		ndrange->RemoveWorkGroup(work_group);
+		for (WorkGroup *work_group : work_groups)
+			ndrange->RemoveWorkGroup(work_group);
 		
 		// If a context has been suspended while waiting for the ndrange
 		// check if it can be woken up.
@@ -372,11 +449,25 @@ void Emulator::RegisterOptions()
 			scheduler_debug_file,
 			"File to dump how the work groups, and wavefronts are "
 			"scheduled on the Gpu's compute units.");
+
+	// Option --si-emu-threads <num>
+	command_line->RegisterInt32("--si-emu-threads <num> (default = 1)",
+			num_threads,
+			"Number of host threads executing independent work-groups "
+			"of an ND-range in parallel during functional emulation. "
+			"Accesses to global memory are serialized. This option "
+			"is ignored when Southern Islands ISA traces are dumped "
+			"with '--si-debug-isa'.");
 }
 
 
 void Emulator::ProcessOptions()
 {
+	// Host threads
+	if (num_threads < 1)
+		throw Error(misc::fmt("Invalid value for --si-emu-threads: %d",
+				num_threads));
+
 	isa_debug.setPath(isa_debug_file);
 	scheduler_debug.setPath(scheduler_debug_file);
 }
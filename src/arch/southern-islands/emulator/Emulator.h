@@ -23,11 +23,14 @@
 #include <iostream>
 #include <list>
 #include <memory>
+#include <pthread.h>
+#include <vector>
 
 #include <arch/common/Emulator.h>
 #include <arch/southern-islands/disassembler/Argument.h>
 #include <lib/cpp/Debug.h>
 #include <lib/cpp/Error.h>
+#include <lib/cpp/WorkerPool.h>
 #include <memory/Memory.h>
 
 #include "NDRange.h"
@@ -101,6 +104,14 @@ private:
 	// Maximum number of instructions
 	static long long max_instructions;
 
+	// Number of host threads executing work-groups in parallel in the
+	// functional emulation loop
+	static int num_threads;
+
+	// Maximum number of work-groups scheduled per host thread in one
+	// iteration of the functional emulation loop
+	static const int WorkGroupsPerThread = 4;
+
 
 
 
@@ -128,7 +139,74 @@ private:
 
 	// Number of ndranges currently running
 	int ndranges_running = 0;
-	
+
+
+
+
+	//
+	// Parallel execution of work-groups
+	//
+
+	// Instruction counters of one host thread, merged into the emulator
+	// statistics when the thread completes a batch of work-groups
+	struct Statistics
+	{
+		long long num_instructions = 0;
+		long long num_scalar_alu_instructions = 0;
+		long long num_scalar_memory_instructions = 0;
+		long long num_branch_instructions = 0;
+		long long num_vector_alu_instructions = 0;
+		long long num_lds_instructions = 0;
+		long long num_vector_memory_instructions = 0;
+		long long num_export_instructions = 0;
+	};
+
+	// Counters of the current host thread, or null when instructions are
+	// counted directly in the emulator statistics
+	static thread_local Statistics *thread_statistics;
+
+	// Pool of host threads running work-groups, one work-group per task
+	class ThreadPool : public misc::WorkerPool
+	{
+		// Emulator owning the pool
+		Emulator *emulator;
+
+		// Counters of the current host thread while it executes a
+		// batch
+		static thread_local Statistics statistics;
+
+		void ExecuteTask(int index) override;
+		void BeginBatch() override;
+		void EndBatch() override;
+
+	public:
+
+		/// Work-groups of the batch being executed
+		std::vector<WorkGroup *> work_groups;
+
+		/// Constructor
+		ThreadPool(Emulator *emulator) : emulator(emulator)
+		{
+		}
+	};
+
+	// Host threads executing work-groups in parallel
+	ThreadPool thread_pool{this};
+
+	// Set while a batch is executing. Accesses to global memory must be
+	// serialized in the meantime, since mem::Memory is not thread-safe.
+	bool threads_running = false;
+
+	// Mutex serializing accesses to global memory from host threads
+	pthread_mutex_t global_memory_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+	// Execute a batch of work-groups on the thread pool, returning when
+	// all of them finish
+	void ExecuteWorkGroups(const std::vector<WorkGroup *> &work_groups);
+
+	// Run all wavefronts of a work-group until it finishes
+	void ExecuteWorkGroup(WorkGroup *work_group);
+
 public:
 
 	//
@@ -216,6 +294,14 @@ public:
 	/// Simulator to determine if the max has been reached.
 	static long long getMaxInstructions () { return max_instructions; }
 
+	/// Return the number of host threads executing work-groups in the
+	/// functional emulation loop
+	static int getNumThreads() { return num_threads; }
+
+	/// Set the number of host threads executing work-groups in the
+	/// functional emulation loop, as done by option '--si-emu-threads'
+	static void setNumThreads(int value) { num_threads = value; }
+
 
 
 
@@ -312,26 +398,84 @@ public:
 	/// Increment work_group_count
 	void incWorkGroupCount() { num_work_groups++; }
 
+	/// Increment the number of emulated instructions. Host threads
+	/// executing work-groups count instructions locally.
+	void incNumInstructions()
+	{
+		++(thread_statistics ? thread_statistics->num_instructions :
+				num_instructions);
+	}
+
 	/// Increment scalar_alu_inst_count
-	void incScalarAluInstCount() { num_scalar_alu_instructions++; }
+	void incScalarAluInstCount()
+	{
+		++(thread_statistics ?
+				thread_statistics->num_scalar_alu_instructions :
+				num_scalar_alu_instructions);
+	}
 
 	/// Increment scalar_mem_inst_count
-	void incScalarMemInstCount() { num_scalar_memory_instructions++; }
+	void incScalarMemInstCount()
+	{
+		++(thread_statistics ?
+				thread_statistics->num_scalar_memory_instructions :
+				num_scalar_memory_instructions);
+	}
 
 	/// Increment branch_inst_count
-	void incBranchInstCount() { num_branch_instructions++; }
+	void incBranchInstCount()
+	{
+		++(thread_statistics ?
+				thread_statistics->num_branch_instructions :
+				num_branch_instructions);
+	}
 
 	/// Increment vector_alu_inst_count
-	void incVectorAluInstCount() { num_vector_alu_instructions++; }
+	void incVectorAluInstCount()
+	{
+		++(thread_statistics ?
+				thread_statistics->num_vector_alu_instructions :
+				num_vector_alu_instructions);
+	}
 
 	/// Increment lds_inst_count
-	void incLdsInstCount() { num_lds_instructions++; }
+	void incLdsInstCount()
+	{
+		++(thread_statistics ?
+				thread_statistics->num_lds_instructions :
+				num_lds_instructions);
+	}
 
 	/// Increment vector_mem_inst_count
-	void incVectorMemInstCount() { num_vector_memory_instructions++; }
+	void incVectorMemInstCount()
+	{
+		++(thread_statistics ?
+				thread_statistics->num_vector_memory_instructions :
+				num_vector_memory_instructions);
+	}
 
 	/// Increment export_inst_count
-	void incExportInstCount() { num_export_instructions++; }
+	void incExportInstCount()
+	{
+		++(thread_statistics ?
+				thread_statistics->num_export_instructions :
+				num_export_instructions);
+	}
+
+	/// Lock the global memory before accessing it from a work-item. The
+	/// lock is only taken while work-groups run on multiple host threads.
+	void LockGlobalMemory()
+	{
+		if (threads_running)
+			pthread_mutex_lock(&global_memory_mutex);
+	}
+
+	/// Unlock the global memory after a call to LockGlobalMemory()
+	void UnlockGlobalMemory()
+	{
+		if (threads_running)
+			pthread_mutex_unlock(&global_memory_mutex);
+	}
 
 	/// Dump the statistics summary
 	void DumpSummary(std::ostream &os) const;
@@ -176,19 +176,14 @@ void Wavefront::Execute()
 	unsigned total_inst_buffer_size = ndrange->getInstructionBufferSize();
 	assert(total_inst_buffer_size > pc);
 
-	// Find out the remaining size of the instruction memory
-	unsigned remaining_inst_buffer_size = total_inst_buffer_size - pc;
-
-	// Create a buffer based on the remaining instruction memory
-	auto inst_buffer = misc::new_unique_array<char>(
-			remaining_inst_buffer_size);
-	ndrange->getInstructionMemory()->Read(pc, remaining_inst_buffer_size, 
-			inst_buffer.get());
-
-	// Decode the next instruction in the instruction memory
-	// Note: We need to pass the whole buffer for a single instruction
-	// because we don't know the size of the next instruction yet
-	instruction->Decode(inst_buffer.get(), pc);
+	// Decode the next instruction from the copy of the instruction memory
+	// kept in the ND-range, which is never modified while the ND-range
+	// runs, and can be read by work-groups running on different host
+	// threads. Note: We need to pass the whole buffer for a single
+	// instruction because we don't know the size of the next instruction
+	// yet
+	instruction->Decode(ndrange->getInstructionBuffer() + pc -
+			ndrange->getInstructionAddress(), pc);
 
 	// Update the statistics
 	emulator->incNumInstructions();
@@ -376,13 +371,18 @@ void Wavefront::Execute()
 		emulator->incVectorAluInstCount();
 		vector_alu_instruction_count++;
 	
-		// Execute the instruction
-		for (auto it = work_items_begin, e = work_items_end;
-				it != e; ++it)
+		// Execute the instruction for all work-items at once if
+		// possible, or for each work-item otherwise
+		if (!ExecuteVectorAlu())
 		{
-			work_item = (*it).get();
-			if (isWorkItemActive(work_item->getIdInWavefront()))
-				work_item->Execute(opcode, instruction.get());
+			for (auto it = work_items_begin, e = work_items_end;
+					it != e; ++it)
+			{
+				work_item = (*it).get();
+				if (isWorkItemActive(work_item->getIdInWavefront()))
+					work_item->Execute(opcode,
+							instruction.get());
+			}
 		}
 
 		// Add newlines between each instruction
@@ -431,9 +431,10 @@ void Wavefront::Execute()
 				}
 			}
 		}
-		else
+		else if (!ExecuteVectorAlu())
 		{
-			// Execute the instruction
+			// Execute the instruction for each work-item, if it
+			// could not be executed for all at once
 			for (auto it = work_items_begin, e = work_items_end; 
 				it != e; ++it)
 			{
@@ -496,14 +497,17 @@ void Wavefront::Execute()
 		emulator->incVectorAluInstCount();
 		vector_alu_instruction_count++;
 	
-		// Execute the instruction
-		for (auto it = work_items_begin, e = work_items_end; 
-				it != e; ++it)
+		// Execute the instruction for all work-items at once if
+		// possible, or for each work-item otherwise
+		if (!ExecuteVectorAlu())
 		{
-			work_item = (*it).get();
-			if (isWorkItemActive(work_item->getIdInWavefront()))
+			for (auto it = work_items_begin, e = work_items_end; 
+					it != e; ++it)
 			{
-				work_item->Execute(opcode, instruction.get());
+				work_item = (*it).get();
+				if (isWorkItemActive(work_item->getIdInWavefront()))
+					work_item->Execute(opcode,
+							instruction.get());
 			}
 		}
 
@@ -48,6 +48,13 @@ public:
 /// execute it multiple times.
 class Wavefront
 {
+public:
+
+	/// Number of work-items in a wavefront
+	static const int Size = 64;
+
+private:
+
 	// Global wavefront identifier
 	int id;
 
@@ -89,6 +96,11 @@ class Wavefront
 	// Scalar registers
 	Instruction::Register sreg[256];
 
+	// Vector registers. The values of one register for all work-items in
+	// the wavefront are stored contiguously, so that vector ALU
+	// instructions can run as loops over the work-items.
+	Instruction::Register vreg[256][Size];
+
 	// Associated wavefront pool entry
 	WavefrontPoolEntry *wavefront_pool_entry = nullptr;
 
@@ -126,6 +138,28 @@ class Wavefront
 	// Number of export instructions executed
 	long long export_instruction_count = 0;
 
+
+
+
+	//
+	// Vector ALU instructions (WavefrontIsa.cc)
+	//
+
+	// Return the values of a source operand of a vector ALU instruction
+	// for all work-items. Values of scalar registers, inline constants,
+	// and literal constants are replicated in 'buffer'. Argument 'count'
+	// is the number of active work-items, used for statistics.
+	const Instruction::Register *getVectorAluOperand(int src,
+			unsigned literal, Instruction::Register *buffer,
+			int count);
+
+	// Execute the current vector ALU instruction for all active
+	// work-items at once, running one loop over the vector registers of
+	// the wavefront. The function returns false if the instruction is not
+	// supported in this mode, in which case it must be executed by each
+	// work-item separately.
+	bool ExecuteVectorAlu();
+
 public:
 
 	/// Constructor
@@ -205,6 +239,15 @@ public:
 	/// Return content in scalar register as unsigned integer
 	unsigned getSregUint(int sreg_id) const;
 
+	/// Return the content of a vector register of a work-item, given its
+	/// identifier relative to the first work-item in the wavefront
+	unsigned getVregUint(int vreg_id, int id_in_wavefront) const
+	{
+		assert(vreg_id >= 0 && vreg_id < 256);
+		assert(id_in_wavefront >= 0 && id_in_wavefront < Size);
+		return vreg[vreg_id][id_in_wavefront].as_uint;
+	}
+
 	/// Return pointer to a workitem inside this wavefront
 	WorkItem *getWorkItem(int id_in_wavefront)
 	{
@@ -305,6 +348,15 @@ public:
 	/// Set scalar register as an unsigned int
 	void setSregUint(int id, unsigned int value);
 
+	/// Set the content of a vector register of a work-item, given its
+	/// identifier relative to the first work-item in the wavefront
+	void setVregUint(int vreg_id, int id_in_wavefront, unsigned value)
+	{
+		assert(vreg_id >= 0 && vreg_id < 256);
+		assert(id_in_wavefront >= 0 && id_in_wavefront < Size);
+		vreg[vreg_id][id_in_wavefront].as_uint = value;
+	}
+
 	/// Set the wavefront pool entry associated with the wavefront
 	void setWavefrontPoolEntry(WavefrontPoolEntry *entry)
 	{
@@ -0,0 +1,648 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <lib/cpp/Misc.h>
+
+#include "Emulator.h"
+#include "Wavefront.h"
+#include "WorkGroup.h"
+
+
+namespace SI
+{
+
+// Shortcut for the register type used in all functions below
+typedef Instruction::Register Register;
+
+
+// Apply an operation to the sources of all work-items whose bit is set in the
+// execution mask, storing the results in the destination. When all
+// work-items are active, the loop does not check the mask, so that the
+// compiler can vectorize it.
+template<typename Operation>
+static void ExecuteWorkItems(unsigned long long exec,
+		Register *dst,
+		const Register *src0,
+		const Register *src1,
+		const Register *src2,
+		Operation operation)
+{
+	if (exec == ~0ULL)
+	{
+		for (int i = 0; i < Wavefront::Size; i++)
+			dst[i] = operation(src0[i], src1[i], src2[i]);
+	}
+	else
+	{
+		for (int i = 0; i < Wavefront::Size; i++)
+			if (exec & (1ULL << i))
+				dst[i] = operation(src0[i], src1[i], src2[i]);
+	}
+}
+
+
+// Return the bit mask of work-items for which the condition holds on their
+// sources
+template<typename Condition>
+static unsigned long long getMask(const Register *src0,
+		const Register *src1,
+		Condition condition)
+{
+	unsigned long long mask = 0;
+	for (int i = 0; i < Wavefront::Size; i++)
+		if (condition(src0[i], src1[i]))
+			mask |= 1ULL << i;
+	return mask;
+}
+
+
+const Register *Wavefront::getVectorAluOperand(int src,
+		unsigned literal,
+		Register *buffer,
+		int count)
+{
+	// Vector register
+	if (src >= 256)
+	{
+		work_group->incVregReadCount(count);
+		return vreg[src - 256];
+	}
+
+	// Literal constant, scalar register, or inline constant
+	Register value;
+	if (src == 0xff)
+	{
+		value.as_uint = literal;
+	}
+	else
+	{
+		value.as_uint = sreg[src].as_uint;
+		work_group->incSregReadCount(count);
+	}
+	for (int i = 0; i < Size; i++)
+		buffer[i] = value;
+	return buffer;
+}
+
+
+bool Wavefront::ExecuteVectorAlu()
+{
+	// ISA traces dump the result of each work-item
+	if (Emulator::isa_debug)
+		return false;
+
+	// Decode operands. Instructions with input or output modifiers are
+	// executed by each work-item.
+	Instruction::Opcode opcode = instruction->getOpcode();
+	Instruction::Bytes *bytes = instruction->getBytes();
+	int src[3] = { 0, 0, 0 };
+	unsigned literal = 0;
+	int dst = 0;
+	switch (instruction->getFormat())
+	{
+	case Instruction::FormatVOP1:
+
+		src[0] = bytes->vop1.src0;
+		literal = bytes->vop1.lit_cnst;
+		dst = bytes->vop1.vdst;
+		break;
+
+	case Instruction::FormatVOP2:
+
+		src[0] = bytes->vop2.src0;
+		src[1] = bytes->vop2.vsrc1 + 256;
+		literal = bytes->vop2.lit_cnst;
+		dst = bytes->vop2.vdst;
+		break;
+
+	case Instruction::FormatVOP3a:
+
+		if (bytes->vop3a.abs || bytes->vop3a.neg ||
+				bytes->vop3a.clamp || bytes->vop3a.omod)
+			return false;
+		src[0] = bytes->vop3a.src0;
+		src[1] = bytes->vop3a.src1;
+		src[2] = bytes->vop3a.src2;
+		dst = bytes->vop3a.vdst;
+		break;
+
+	default:
+		return false;
+	}
+
+	// Number of source operands read by the instruction
+	int num_sources;
+	switch (opcode)
+	{
+	case Instruction::Opcode_V_MOV_B32:
+	case Instruction::Opcode_V_CVT_F32_I32:
+	case Instruction::Opcode_V_CVT_F32_U32:
+	case Instruction::Opcode_V_NOT_B32:
+
+		num_sources = 1;
+		break;
+
+	case Instruction::Opcode_V_CNDMASK_B32:
+	case Instruction::Opcode_V_ADD_F32:
+	case Instruction::Opcode_V_SUB_F32:
+	case Instruction::Opcode_V_SUBREV_F32:
+	case Instruction::Opcode_V_MUL_F32:
+	case Instruction::Opcode_V_MUL_I32_I24:
+	case Instruction::Opcode_V_MIN_F32:
+	case Instruction::Opcode_V_MAX_F32:
+	case Instruction::Opcode_V_MIN_I32:
+	case Instruction::Opcode_V_MAX_I32:
+	case Instruction::Opcode_V_MIN_U32:
+	case Instruction::Opcode_V_MAX_U32:
+	case Instruction::Opcode_V_LSHRREV_B32:
+	case Instruction::Opcode_V_ASHRREV_I32:
+	case Instruction::Opcode_V_LSHLREV_B32:
+	case Instruction::Opcode_V_AND_B32:
+	case Instruction::Opcode_V_OR_B32:
+	case Instruction::Opcode_V_XOR_B32:
+	case Instruction::Opcode_V_MAC_F32:
+	case Instruction::Opcode_V_ADD_I32:
+	case Instruction::Opcode_V_SUB_I32:
+	case Instruction::Opcode_V_SUBREV_I32:
+	case Instruction::Opcode_V_ADD_F32_VOP3a:
+	case Instruction::Opcode_V_MUL_F32_VOP3a:
+	case Instruction::Opcode_V_MUL_LO_U32:
+	case Instruction::Opcode_V_MUL_HI_U32:
+	case Instruction::Opcode_V_MUL_LO_I32:
+
+		num_sources = 2;
+		break;
+
+	case Instruction::Opcode_V_MAD_F32:
+	case Instruction::Opcode_V_MAD_U32_U24:
+	case Instruction::Opcode_V_BFE_U32:
+
+		num_sources = 3;
+		break;
+
+	default:
+		return false;
+	}
+
+	// Active work-items, ignoring bits of the execution mask beyond the
+	// last work-item of a partial wavefront
+	unsigned long long exec = (unsigned long long)
+			sreg[Instruction::RegisterExec + 1].as_uint << 32 |
+			sreg[Instruction::RegisterExec].as_uint;
+	if (work_item_count < Size)
+		exec &= (1ULL << work_item_count) - 1;
+	int count = __builtin_popcountll(exec);
+
+	// Read sources, replicating scalar values for all work-items
+	Register buffers[3][Size];
+	const Register *s[3];
+	for (int i = 0; i < 3; i++)
+		s[i] = i < num_sources ? getVectorAluOperand(src[i], literal,
+				buffers[i], count) : buffers[i];
+	Register *d = vreg[dst];
+	work_group->incVregWriteCount(count);
+
+	// Instructions reading or writing VCC
+	unsigned long long vcc = (unsigned long long)
+			sreg[Instruction::RegisterVcc + 1].as_uint << 32 |
+			sreg[Instruction::RegisterVcc].as_uint;
+	unsigned long long carry = 0;
+	bool write_vcc = false;
+
+	// Execute
+	switch (opcode)
+	{
+
+	// D.u = S0.u
+	case Instruction::Opcode_V_MOV_B32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			return s0;
+		});
+		break;
+
+	// D.f = (float) S0.i
+	case Instruction::Opcode_V_CVT_F32_I32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_float = (float) s0.as_int;
+			return r;
+		});
+		break;
+
+	// D.f = (float) S0.u
+	case Instruction::Opcode_V_CVT_F32_U32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_float = (float) s0.as_uint;
+			return r;
+		});
+		break;
+
+	// D.u = ~S0.u
+	case Instruction::Opcode_V_NOT_B32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_uint = ~s0.as_uint;
+			return r;
+		});
+		break;
+
+	// D.u = VCC[i] ? S1.u : S0.u
+	case Instruction::Opcode_V_CNDMASK_B32:
+
+		for (int i = 0; i < Size; i++)
+			buffers[2][i].as_uint = (vcc >> i) & 1;
+		work_group->incSregReadCount(count);
+		ExecuteWorkItems(exec, d, s[0], s[1], buffers[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			return s2.as_uint ? s1 : s0;
+		});
+		break;
+
+	// D.f = S0.f + S1.f
+	case Instruction::Opcode_V_ADD_F32:
+	case Instruction::Opcode_V_ADD_F32_VOP3a:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_float = s0.as_float + s1.as_float;
+			return r;
+		});
+		break;
+
+	// D.f = S0.f - S1.f
+	case Instruction::Opcode_V_SUB_F32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_float = s0.as_float - s1.as_float;
+			return r;
+		});
+		break;
+
+	// D.f = S1.f - S0.f
+	case Instruction::Opcode_V_SUBREV_F32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_float = s1.as_float - s0.as_float;
+			return r;
+		});
+		break;
+
+	// D.f = S0.f * S1.f
+	case Instruction::Opcode_V_MUL_F32:
+	case Instruction::Opcode_V_MUL_F32_VOP3a:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_float = s0.as_float * s1.as_float;
+			return r;
+		});
+		break;
+
+	// D.i = S0.i[23:0] * S1.i[23:0]
+	case Instruction::Opcode_V_MUL_I32_I24:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			s0.as_uint = misc::SignExtend32(s0.as_uint, 24);
+			s1.as_uint = misc::SignExtend32(s1.as_uint, 24);
+			r.as_int = s0.as_int * s1.as_int;
+			return r;
+		});
+		break;
+
+	// D.f = min(S0.f, S1.f)
+	case Instruction::Opcode_V_MIN_F32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			return s0.as_float < s1.as_float ? s0 : s1;
+		});
+		break;
+
+	// D.f = max(S0.f, S1.f)
+	case Instruction::Opcode_V_MAX_F32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			return s0.as_float > s1.as_float ? s0 : s1;
+		});
+		break;
+
+	// D.i = min(S0.i, S1.i)
+	case Instruction::Opcode_V_MIN_I32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			return s0.as_int < s1.as_int ? s0 : s1;
+		});
+		break;
+
+	// D.i = max(S0.i, S1.i)
+	case Instruction::Opcode_V_MAX_I32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			return s0.as_int > s1.as_int ? s0 : s1;
+		});
+		break;
+
+	// D.u = min(S0.u, S1.u)
+	case Instruction::Opcode_V_MIN_U32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			return s0.as_uint < s1.as_uint ? s0 : s1;
+		});
+		break;
+
+	// D.u = max(S0.u, S1.u)
+	case Instruction::Opcode_V_MAX_U32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			return s0.as_uint > s1.as_uint ? s0 : s1;
+		});
+		break;
+
+	// D.u = S1.u >> S0.u[4:0]
+	case Instruction::Opcode_V_LSHRREV_B32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_uint = s1.as_uint >> (s0.as_uint & 0x1f);
+			return r;
+		});
+		break;
+
+	// D.i = S1.i >> S0.i[4:0]
+	case Instruction::Opcode_V_ASHRREV_I32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_int = s1.as_int >> (s0.as_uint & 0x1f);
+			return r;
+		});
+		break;
+
+	// D.u = S1.u << S0.u[4:0]
+	case Instruction::Opcode_V_LSHLREV_B32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_uint = s1.as_uint << (s0.as_uint & 0x1f);
+			return r;
+		});
+		break;
+
+	// D.u = S0.u & S1.u
+	case Instruction::Opcode_V_AND_B32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_uint = s0.as_uint & s1.as_uint;
+			return r;
+		});
+		break;
+
+	// D.u = S0.u | S1.u
+	case Instruction::Opcode_V_OR_B32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_uint = s0.as_uint | s1.as_uint;
+			return r;
+		});
+		break;
+
+	// D.u = S0.u ^ S1.u
+	case Instruction::Opcode_V_XOR_B32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_uint = s0.as_uint ^ s1.as_uint;
+			return r;
+		});
+		break;
+
+	// D.f = S0.f * S1.f + D.f
+	case Instruction::Opcode_V_MAC_F32:
+
+		work_group->incVregReadCount(count);
+		ExecuteWorkItems(exec, d, s[0], s[1], d,
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_float = s0.as_float * s1.as_float + s2.as_float;
+			return r;
+		});
+		break;
+
+	// D.u = S0.u + S1.u, VCC = carry-out
+	case Instruction::Opcode_V_ADD_I32:
+
+		carry = getMask(s[0], s[1], [](Register s0, Register s1)
+		{
+			return !!(((long long) s0.as_int +
+					(long long) s1.as_int) >> 32);
+		});
+		write_vcc = true;
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_int = s0.as_int + s1.as_int;
+			return r;
+		});
+		break;
+
+	// D.u = S0.u - S1.u, VCC = borrow-out
+	case Instruction::Opcode_V_SUB_I32:
+
+		carry = getMask(s[0], s[1], [](Register s0, Register s1)
+		{
+			return s1.as_int > s0.as_int;
+		});
+		write_vcc = true;
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_uint = s0.as_int - s1.as_int;
+			return r;
+		});
+		break;
+
+	// D.u = S1.u - S0.u, VCC = borrow-out
+	case Instruction::Opcode_V_SUBREV_I32:
+
+		carry = getMask(s[0], s[1], [](Register s0, Register s1)
+		{
+			return s0.as_int > s1.as_int;
+		});
+		write_vcc = true;
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_int = s1.as_int - s0.as_int;
+			return r;
+		});
+		break;
+
+	// D.u = S0.u * S1.u
+	case Instruction::Opcode_V_MUL_LO_U32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_uint = s0.as_uint * s1.as_uint;
+			return r;
+		});
+		break;
+
+	// D.u = (S0.u * S1.u) >> 32
+	case Instruction::Opcode_V_MUL_HI_U32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_uint = (unsigned) (((unsigned long long) s0.as_uint *
+					(unsigned long long) s1.as_uint) >> 32);
+			return r;
+		});
+		break;
+
+	// D.i = S0.i * S1.i
+	case Instruction::Opcode_V_MUL_LO_I32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_int = s0.as_int * s1.as_int;
+			return r;
+		});
+		break;
+
+	// D.f = S0.f * S1.f + S2.f
+	case Instruction::Opcode_V_MAD_F32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_float = s0.as_float * s1.as_float + s2.as_float;
+			return r;
+		});
+		break;
+
+	// D.u = S0.u[23:0] * S1.u[23:0] + S2.u
+	case Instruction::Opcode_V_MAD_U32_U24:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_uint = (s0.as_uint & 0xffffff) *
+					(s1.as_uint & 0xffffff) + s2.as_uint;
+			return r;
+		});
+		break;
+
+	// D.u = (S0.u >> S1.u[4:0]) & ((1 << S2.u[4:0]) - 1)
+	case Instruction::Opcode_V_BFE_U32:
+
+		ExecuteWorkItems(exec, d, s[0], s[1], s[2],
+				[](Register s0, Register s1, Register s2)
+		{
+			Register r;
+			r.as_uint = (s0.as_uint >> (s1.as_uint & 0x1f)) &
+					((1 << (s2.as_uint & 0x1f)) - 1);
+			return r;
+		});
+		break;
+
+	default:
+		throw misc::Panic("Unexpected opcode");
+	}
+
+	// Update the bits of VCC for active work-items
+	if (write_vcc)
+	{
+		vcc = (vcc & ~exec) | (carry & exec);
+		sreg[Instruction::RegisterVcc].as_uint = vcc;
+		sreg[Instruction::RegisterVcc + 1].as_uint = vcc >> 32;
+		sreg[Instruction::RegisterVccz].as_uint = !vcc;
+		work_group->incSregReadCount(count);
+		work_group->incSregWriteCount(count);
+	}
+
+	// Done
+	return true;
+}
+
+
+}  // namespace SI
+
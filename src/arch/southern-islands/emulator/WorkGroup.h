@@ -233,16 +233,16 @@ public:
 	void incWavefrontsCompletedTiming() { wavefronts_completed_timing++; }
 
 	/// Increase scalar register read counter
-	void incSregReadCount() { sreg_read_count++; }
+	void incSregReadCount(int count = 1) { sreg_read_count += count; }
 
 	/// Increase scalar register write counter
-	void incSregWriteCount() { sreg_write_count++; }
+	void incSregWriteCount(int count = 1) { sreg_write_count += count; }
 
 	/// Increase vector register read counter
-	void incVregReadCount() { vreg_read_count++; }
+	void incVregReadCount(int count = 1) { vreg_read_count += count; }
 
 	/// Increase vector register write counter
-	void incVregWriteCount() { vreg_write_count++; }
+	void incVregWriteCount(int count = 1) { vreg_write_count += count; }
 
 	/// Set wavefront_at_barrier counter
 	void setWavefrontsAtBarrier(unsigned counter)
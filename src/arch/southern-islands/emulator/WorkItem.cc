@@ -19,6 +19,7 @@
 
 #include <lib/cpp/Misc.h>
 
+#include "Emulator.h"
 #include "Wavefront.h"
 #include "WorkItem.h"
 #include "WorkGroup.h"
@@ -247,6 +248,42 @@ WorkItem::WorkItem(Wavefront *wavefront, int id)
 	ISAInstFuncTable[Instruction::OpcodeCount] = nullptr;
 }
 
+void WorkItem::ReadGlobalMemory(unsigned address, unsigned size,
+		char *buffer)
+{
+	Emulator *emulator = Emulator::getInstance();
+	emulator->LockGlobalMemory();
+	try
+	{
+		global_mem->Read(address, size, buffer);
+	}
+	catch (...)
+	{
+		emulator->UnlockGlobalMemory();
+		throw;
+	}
+	emulator->UnlockGlobalMemory();
+}
+
+
+void WorkItem::WriteGlobalMemory(unsigned address, unsigned size,
+		const char *buffer)
+{
+	Emulator *emulator = Emulator::getInstance();
+	emulator->LockGlobalMemory();
+	try
+	{
+		global_mem->Write(address, size, buffer);
+	}
+	catch (...)
+	{
+		emulator->UnlockGlobalMemory();
+		throw;
+	}
+	emulator->UnlockGlobalMemory();
+}
+
+
 void WorkItem::setWorkGroup(WorkGroup *wg)
 { 
 	work_group = wg; 
@@ -281,7 +318,7 @@ unsigned WorkItem::ReadVReg(int vreg)
 	// Statistics
 	work_group->incVregReadCount();
 
-	return this->vreg[vreg].as_uint;
+	return wavefront->getVregUint(vreg, id_in_wavefront);
 }
 
 
@@ -290,7 +327,7 @@ void WorkItem::WriteVReg(int vreg,
 {
 	assert(vreg >= 0);
 	assert(vreg < 256);
-	this->vreg[vreg].as_uint = value;
+	wavefront->setVregUint(vreg, id_in_wavefront, value);
 
 	// Statistics
 	work_group->incVregWriteCount();
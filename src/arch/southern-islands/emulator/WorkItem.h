@@ -193,8 +193,14 @@ private:
 	// Local memory
 	mem::Memory *lds = nullptr;
 
-	// Vector registers
-	Instruction::Register vreg[256];
+	// Read from global memory. Accesses are serialized while work-groups
+	// run on multiple host threads.
+	void ReadGlobalMemory(unsigned address, unsigned size, char *buffer);
+
+	// Write into global memory. Accesses are serialized while work-groups
+	// run on multiple host threads.
+	void WriteGlobalMemory(unsigned address, unsigned size,
+			const char *buffer);
 
 	// Emulation of ISA. This code expands to one function per ISA
 	// instruction. For example: ISA_s_mov_b32_Impl(Instruction *inst)
@@ -74,7 +74,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORD_Impl(Instruction *instruction)
 
 	// Read value from global memory
 	Instruction::Register value;
-	global_mem->Read(addr, 4, (char *)&value);
+	ReadGlobalMemory(addr, 4, (char *)&value);
 
 	// Store the data in the destination register
 	WriteSReg(INST.sdst, value.as_uint);
@@ -110,7 +110,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORDX2_Impl(Instruction *instruction)
 	for (int i = 0; i < 2; i++)
 	{
 		// Read value from global memory
-		global_mem->Read(addr + i * 4, 4, (char *)&value[i]);
+		ReadGlobalMemory(addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -153,7 +153,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORDX4_Impl(Instruction *instruction)
 	for (int i = 0; i < 4; i++)
 	{
 		// Read value from global memory
-		global_mem->Read(addr + i * 4, 4, (char *)&value[i]);
+		ReadGlobalMemory(addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -195,7 +195,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORDX8_Impl(Instruction *instruction)
 	for (int i = 0; i < 8; i++)
 	{
 		// Read value from global memory
-		global_mem->Read(addr + i * 4, 4, (char *)&value[i]);
+		ReadGlobalMemory(addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -237,7 +237,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORDX16_Impl(Instruction *instruction)
 	for (int i = 0; i < 16; i++)
 	{
 		// Read value from global memory
-		global_mem->Read(addr + i * 4, 4, (char *)&value[i]);
+		ReadGlobalMemory(addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -284,7 +284,7 @@ void WorkItem::ISA_S_LOAD_DWORDX2_Impl(Instruction *instruction)
 	for (int i = 0; i < 2; i++)
 	{
 		// Read value from global memory		
-		global_mem->Read(m_addr + i * 4, 4, (char *)&value[i]);
+		ReadGlobalMemory(m_addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -330,7 +330,7 @@ void WorkItem::ISA_S_LOAD_DWORDX4_Impl(Instruction *instruction)
 	for (int i = 0; i < 4; i++)
 	{
 		// Read value from global memory		
-		global_mem->Read(m_addr + i * 4, 4, (char *)&value[i]);
+		ReadGlobalMemory(m_addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -377,7 +377,7 @@ void WorkItem::ISA_S_LOAD_DWORDX8_Impl(Instruction *instruction)
 	for (int i = 0; i < 8; i++)
 	{
 		// Read value from global memory		
-		global_mem->Read(m_addr + i * 4, 4, (char *)&value[i]);
+		ReadGlobalMemory(m_addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -424,7 +424,7 @@ void WorkItem::ISA_S_LOAD_DWORDX16_Impl(Instruction *instruction)
 	for (int i = 0; i < 16; i++)
 	{
 		// Read value from global memory		
-		global_mem->Read(m_addr + i * 4, 4, (char *)&value[i]);
+		ReadGlobalMemory(m_addr + i * 4, 4, (char *)&value[i]);
 		// Store the data in the destination register
 		WriteSReg(INST.sdst + i, value[i].as_uint);
 	}
@@ -7102,7 +7102,7 @@ void WorkItem::ISA_BUFFER_LOAD_SBYTE_Impl(Instruction *instruction)
 		stride * (idx_vgpr + id_in_wavefront);
 
 	
-	global_mem->Read(addr, bytes_to_read, (char *)&value);
+	ReadGlobalMemory(addr, bytes_to_read, (char *)&value);
 	
 	// Sign extend
 	value.as_int = (int) value.as_byte[0];
@@ -7172,7 +7172,7 @@ void WorkItem::ISA_BUFFER_LOAD_DWORD_Impl(Instruction *instruction)
 		stride * (idx_vgpr + id_in_wavefront);
 
 	
-	global_mem->Read(addr, bytes_to_read, (char *)&value);
+	ReadGlobalMemory(addr, bytes_to_read, (char *)&value);
 	
 	// Sign extend
 	value.as_int = (int) value.as_byte[0];
@@ -7247,7 +7247,7 @@ void WorkItem::ISA_BUFFER_STORE_BYTE_Impl(Instruction *instruction)
 
 	value.as_int = ReadVReg(INST.vdata);
 
-	global_mem->Write(addr, bytes_to_write, (char *)&value);
+	WriteGlobalMemory(addr, bytes_to_write, (char *)&value);
 	
 	// Sign extend
 	//value.as_int = (int) value.as_byte[0];
@@ -7322,7 +7322,7 @@ void WorkItem::ISA_BUFFER_STORE_DWORD_Impl(Instruction *instruction)
 
 	value.as_int = ReadVReg(INST.vdata);
 
-	global_mem->Write(addr, bytes_to_write, (char *)&value);
+	WriteGlobalMemory(addr, bytes_to_write, (char *)&value);
 	
 	// Record last memory access for the detailed simulator.
 	global_memory_access_address = addr;
@@ -7399,16 +7399,27 @@ void WorkItem::ISA_BUFFER_ATOMIC_ADD_Impl(Instruction *instruction)
 	unsigned addr = base + mem_offset + inst_offset + off_vgpr + 
 		stride * (idx_vgpr + id_in_wavefront);
 
-	// Read existing value from global memory
-	
-	global_mem->Read(addr, bytes_to_read, prev_value.as_byte);
+	// Read existing value from global memory, holding the global memory
+	// lock until the updated value is stored.
+	Emulator *emulator = Emulator::getInstance();
+	emulator->LockGlobalMemory();
+	try
+	{
+		global_mem->Read(addr, bytes_to_read, prev_value.as_byte);
 
-	// Read value to add to existing value from a register
-	value.as_int = ReadVReg(INST.vdata);
+		// Read value to add to existing value from a register
+		value.as_int = ReadVReg(INST.vdata);
 
-	// Compute and store the updated value
-	value.as_int += prev_value.as_int;
-	global_mem->Write(addr, bytes_to_write, (char *)&value);
+		// Compute and store the updated value
+		value.as_int += prev_value.as_int;
+		global_mem->Write(addr, bytes_to_write, (char *)&value);
+	}
+	catch (...)
+	{
+		emulator->UnlockGlobalMemory();
+		throw;
+	}
+	emulator->UnlockGlobalMemory();
 	
 	// If glc bit set, return the previous value in a register
 	if (INST.glc)
@@ -7491,7 +7502,7 @@ void WorkItem::ISA_TBUFFER_LOAD_FORMAT_X_Impl(Instruction *instruction)
 		stride * (idx_vgpr + 0/*work_item->id_in_wavefront*/);
 
 	
-	global_mem->Read(addr, bytes_to_read, (char *)&value);
+	ReadGlobalMemory(addr, bytes_to_read, (char *)&value);
 
 	WriteVReg(INST.vdata, value.as_uint);
 
@@ -7573,7 +7584,7 @@ void WorkItem::ISA_TBUFFER_LOAD_FORMAT_XY_Impl(Instruction *instruction)
 	for (i = 0; i < 2; i++)
 	{
 		
-		global_mem->Read(addr+4*i, 4, (char *)&value);
+		ReadGlobalMemory(addr+4*i, 4, (char *)&value);
 
 		WriteVReg(INST.vdata + i, value.as_uint);
 
@@ -7661,7 +7672,7 @@ void WorkItem::ISA_TBUFFER_LOAD_FORMAT_XYZW_Impl(Instruction *instruction)
 	for (i = 0; i < 4; i++)
 	{
 		
-		global_mem->Read(addr+4*i, 4, (char *)&value);
+		ReadGlobalMemory(addr+4*i, 4, (char *)&value);
 
 		WriteVReg(INST.vdata + i, value.as_uint);
 
@@ -7733,7 +7744,7 @@ void WorkItem::ISA_TBUFFER_STORE_FORMAT_X_Impl(Instruction *instruction)
 
 	value.as_uint = ReadVReg(INST.vdata);
 
-	global_mem->Write(addr, bytes_to_write, (char *)&value);
+	WriteGlobalMemory(addr, bytes_to_write, (char *)&value);
 
 	// Record last memory access for the detailed simulator.
 	global_memory_access_address = addr;
@@ -7805,7 +7816,7 @@ void WorkItem::ISA_TBUFFER_STORE_FORMAT_XY_Impl(Instruction *instruction)
 	{
 		value.as_uint = ReadVReg(INST.vdata + i);
 
-		global_mem->Write(addr+4*i, 4, (char *)&value);
+		WriteGlobalMemory(addr+4*i, 4, (char *)&value);
 
 		// TODO Print value based on type
 		if (Emulator::isa_debug)
@@ -7878,7 +7889,7 @@ void WorkItem::ISA_TBUFFER_STORE_FORMAT_XYZW_Impl(Instruction *instruction)
 	{
 		value.as_uint = ReadVReg(INST.vdata + i);
 
-		global_mem->Write(addr+4*i, 4, (char *)&value);
+		WriteGlobalMemory(addr+4*i, 4, (char *)&value);
 
 		// TODO Print value based on type
 		if (Emulator::isa_debug)
@@ -189,6 +189,9 @@ public:
 	/// Remove a work group pointer from the work_groups list
 	void RemoveWorkGroup(WorkGroup *work_group);
 
+	/// Return the vector memory unit of the compute unit
+	VectorMemoryUnit *getVectorMemoryUnit() { return &vector_memory_unit; }
+
 	/// Return the associated LDS module
 	mem::Module *getLdsModule() const { return lds_module.get(); }
 
@@ -249,6 +252,13 @@ public:
 	// Number of issued vector memory instructions
 	long long num_vector_memory_instructions = 0;
 
+	// Number of work-item accesses of vector memory instructions
+	long long num_vector_memory_work_item_accesses = 0;
+
+	// Number of cache block transactions of vector memory instructions,
+	// after coalescing the work-item accesses
+	long long num_vector_memory_transactions = 0;
+
 	// Number of issued LDS instructions
 	long long num_lds_instructions = 0;
 
@@ -1096,6 +1096,11 @@ void Timing::DumpReport() const
 				compute_unit->num_vreg_reads);                          
 		report << misc::fmt("VectorRegWrites= %lld\n",                            
 				compute_unit->num_vreg_writes);                         
+		report << misc::fmt("\n");
+		report << misc::fmt("VectorMem.WorkItemAccesses = %lld\n",
+				compute_unit->num_vector_memory_work_item_accesses);
+		report << misc::fmt("VectorMem.Transactions = %lld\n",
+				compute_unit->num_vector_memory_transactions);
 		report << misc::fmt("\n");                                                
 		report << misc::fmt("LDS.Accesses = %lld\n",                              
 				compute_unit->getLdsModule()->num_reads 
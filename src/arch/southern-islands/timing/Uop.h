@@ -116,9 +116,6 @@ public:
 		// Active after instruction emulation
 		bool active = true;
 
-		// Mark a work item that has successfully made a cache access
-		bool accessed_cache = false;
-
 		// Number of lds_accesses
 		int lds_access_count;
 
@@ -194,6 +191,18 @@ public:
 
 	/// Witness memory access
 	int global_memory_witness = 0;
+
+	/// Set once the accesses of the active work-items of a vector memory
+	/// instruction have been coalesced into cache block transactions
+	bool vector_memory_coalesced = false;
+
+	/// Physical addresses of the cache blocks accessed by the vector
+	/// memory instruction, after coalescing
+	std::vector<unsigned> vector_memory_blocks;
+
+	/// Number of blocks in \c vector_memory_blocks already submitted to
+	/// the vector cache
+	int num_vector_memory_accessed_blocks = 0;
 	
 	/// Last scalar memory access address
 	unsigned int global_memory_access_address = 0;
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include <arch/southern-islands/emulator/Wavefront.h>
 #include <arch/southern-islands/emulator/WorkGroup.h>
 #include <arch/southern-islands/emulator/NDRange.h>
@@ -211,6 +213,91 @@ void VectorMemoryUnit::Write()
 	}
 }
 
+void VectorMemoryUnit::Coalesce(Uop *uop)
+{
+	// Get compute unit object
+	ComputeUnit *compute_unit = getComputeUnit();
+
+	// Collect the virtual addresses of the blocks touched by each active
+	// work-item. An access can span several blocks if it is not aligned
+	// or larger than a block.
+	Wavefront *wavefront = uop->getWavefront();
+	unsigned block_size = compute_unit->vector_cache->getBlockSize();
+	std::vector<unsigned> &blocks = uop->vector_memory_blocks;
+	assert(blocks.empty());
+	for (auto wi_it = wavefront->getWorkItemsBegin(),
+			wi_e = wavefront->getWorkItemsEnd();
+			wi_it != wi_e;
+			++wi_it)
+	{
+		// Ignore inactive work-items
+		WorkItem *work_item = wi_it->get();
+		if (!wavefront->isWorkItemActive(work_item->getIdInWavefront()))
+			continue;
+
+		// Blocks of the access
+		Uop::WorkItemInfo *work_item_info = &uop->work_item_info_list[
+				work_item->getIdInWavefront()];
+		unsigned address = work_item_info->global_memory_access_address;
+		unsigned size = std::max(1U,
+				work_item_info->global_memory_access_size);
+		unsigned first_block = address & ~(block_size - 1);
+		unsigned last_block = (address + size - 1) & ~(block_size - 1);
+		for (unsigned block = first_block; ; block += block_size)
+		{
+			blocks.push_back(block);
+			if (block == last_block)
+				break;
+		}
+		compute_unit->num_vector_memory_work_item_accesses++;
+	}
+
+	// Keep unique blocks
+	std::sort(blocks.begin(), blocks.end());
+	blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+
+	// Translate blocks to physical addresses. Blocks do not cross page
+	// boundaries, so only the block addresses need translation.
+	mem::Mmu *mmu = compute_unit->getGpu()->getMmu();
+	mem::Mmu::Space *address_space = uop->getWorkGroup()->getNDRange()->
+			address_space;
+	for (unsigned &block : blocks)
+		block = mmu->TranslateVirtualAddress(address_space, block);
+
+	// Statistics
+	compute_unit->num_vector_memory_transactions += blocks.size();
+	uop->vector_memory_coalesced = true;
+}
+
+
+bool VectorMemoryUnit::AccessBlocks(Uop *uop,
+		mem::Module::AccessType access_type)
+{
+	// Get compute unit object
+	ComputeUnit *compute_unit = getComputeUnit();
+
+	// Submit blocks in order, resuming after the last submitted one
+	assert(uop->vector_memory_coalesced);
+	int num_blocks = uop->vector_memory_blocks.size();
+	while (uop->num_vector_memory_accessed_blocks < num_blocks)
+	{
+		unsigned physical_address = uop->vector_memory_blocks[
+				uop->num_vector_memory_accessed_blocks];
+		if (!compute_unit->vector_cache->canAccess(physical_address))
+			return false;
+		compute_unit->vector_cache->Access(
+				access_type,
+				physical_address,
+				&uop->global_memory_witness);
+		uop->global_memory_witness--;
+		uop->num_vector_memory_accessed_blocks++;
+	}
+
+	// All blocks submitted
+	return true;
+}
+
+
 void VectorMemoryUnit::Memory()
 {
 	// Get compute unit object
@@ -300,12 +387,9 @@ void VectorMemoryUnit::Memory()
 					__FUNCTION__));
 		}
 
-		// This variable keeps track if any work items are unsuccessful
-		// in making an access to the vector cache.
-		bool all_work_items_accessed = true;
-
 		// Access global memory
-		assert(!uop->global_memory_witness);
+		assert(!uop->global_memory_witness ||
+				uop->vector_memory_coalesced);
 		Timing::pipeline_debug << misc::fmt(
 				"\t\t@%lld inst=%lld "
 				"id_in_wf=%lld wg=%d/wf=%d (VecMem)\n",
@@ -314,74 +398,19 @@ void VectorMemoryUnit::Memory()
 				uop->getIdInWavefront(),
 				uop->getWorkGroup()->getId(),
 				uop->getWavefront()->getId());
-		for (auto wi_it = uop->getWavefront()->getWorkItemsBegin(),
-				wi_e = uop->getWavefront()->getWorkItemsEnd();
-				wi_it != wi_e;
-				++wi_it)
-		{
-			// Get work item
-			WorkItem *work_item = wi_it->get();
-
-			// Access memory for each active work-item
-			if (uop->getWavefront()->isWorkItemActive(
-					work_item->getIdInWavefront()))
-			{
-				// Get the work item uop
-				Uop::WorkItemInfo *work_item_info = 
-						&uop->work_item_info_list[
-						work_item->getIdInWavefront()];
-
-				// Check if the work item info struct has
-				// already made a successful vector cache
-				// access. If so, move on to the next work item.
-				if (work_item_info->accessed_cache)	
-					continue;
-
-				// Translate virtual address to a physical 
-				// address
-				unsigned physical_address = compute_unit->
-						getGpu()->
-						getMmu()->
-						TranslateVirtualAddress(
-						uop->getWorkGroup()->
-						getNDRange()->
-						address_space,
-						work_item_info->
-						global_memory_access_address);
-		
 
-				// Make sure we can access the vector cache. If 
-				// so, submit the access. If we can access the
-				// cache, mark the accessed flag of the work 
-				// item info struct.
-				if (compute_unit->vector_cache->
-						canAccess(physical_address))
-				{
-					compute_unit->vector_cache->Access(
-							module_access_type,
-							physical_address, 
-							&uop->global_memory_witness);
-					work_item_info->accessed_cache = true;
-
-					// Access global memory
-					uop->global_memory_witness--;
-				}
-				else
-				{
-					all_work_items_accessed = false;
-				}
-			}
-		}
+		// Merge the accesses of all work-items into cache block
+		// transactions the first time that the uop is processed
+		if (!uop->vector_memory_coalesced)
+			Coalesce(uop);
 
-		// Make sure that all the work items in the wavefront have 
-		// successfully accessed the vector cache. If not, the uop
-		// is not moved to the write buffer. Instead, the uop will
-		// be re-processed next cycle. Once all work items access
-		// the vector cache, the uop will be moved to the write buffer.
-		if (!all_work_items_accessed)
+		// Submit one access to the vector cache per transaction. If
+		// the cache cannot accept all of them, the uop is not moved to
+		// the memory buffer, and the remaining transactions are
+		// submitted when it is re-processed in the next cycle.
+		if (!AccessBlocks(uop, module_access_type))
 			continue;
 
-
 		// Trace
 		Timing::trace << misc::fmt("si.inst "
 				"id=%lld "
@@ -20,6 +20,8 @@
 #ifndef ARCH_SOUTHERN_ISLANDS_TIMING_VECTOR_MEMORY_UNIT_H
 #define ARCH_SOUTHERN_ISLANDS_TIMING_VECTOR_MEMORY_UNIT_H
 
+#include <memory/Module.h>
+
 #include "ExecutionUnit.h"
 
 namespace SI
@@ -104,6 +106,18 @@ public:
 
 	/// Decode stage of the execution pipeline.
 	void Decode();
+
+	/// Merge the addresses accessed by the active work-items of a vector
+	/// memory instruction into a sorted list of unique cache blocks,
+	/// translated into physical addresses and stored in the uop.
+	void Coalesce(Uop *uop);
+
+	/// Submit the coalesced cache blocks of a uop to the vector cache in
+	/// order, starting at the first block not submitted yet. Return
+	/// \c true if all blocks have been submitted, or \c false if the
+	/// cache could not accept one of them, in which case the remaining
+	/// blocks are submitted in a later call.
+	bool AccessBlocks(Uop *uop, mem::Module::AccessType access_type);
 	
 	/// Run the actions occurring in one cycle
 	void Run();
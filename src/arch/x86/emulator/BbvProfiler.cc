@@ -0,0 +1,96 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include <lib/cpp/Misc.h>
+
+#include "BbvProfiler.h"
+#include "Emulator.h"
+
+
+namespace x86
+{
+
+BbvProfiler::BbvProfiler(const std::string &path, long long interval) :
+		f(path),
+		interval(interval)
+{
+	assert(interval > 0);
+	if (!f)
+		throw Error(misc::fmt("%s: Cannot create basic block vector "
+				"file", path.c_str()));
+}
+
+
+BbvProfiler::~BbvProfiler()
+{
+	if (num_interval_instructions)
+		DumpInterval();
+}
+
+
+void BbvProfiler::DumpInterval()
+{
+	// Basic blocks are dumped in order of identifier
+	std::sort(interval_blocks.begin(), interval_blocks.end());
+	f << 'T';
+	for (int id : interval_blocks)
+	{
+		f << ':' << id << ':' << counts[id - 1] << ' ';
+		counts[id - 1] = 0;
+	}
+	f << '\n';
+
+	// Start a new interval
+	interval_blocks.clear();
+	num_interval_instructions = 0;
+	num_intervals++;
+}
+
+
+void BbvProfiler::AddBlock(unsigned eip, int num_instructions)
+{
+	// Identifier of the basic block, assigning a new one the first time
+	// that the block is executed
+	int id = block_ids.emplace(eip, block_ids.size() + 1).first->second;
+	if (id > (int) counts.size())
+		counts.resize(id);
+
+	// Count instructions. A basic block crossing the end of the interval
+	// is split, so that every interval has exactly the same length.
+	while (num_instructions)
+	{
+		int count = std::min((long long) num_instructions,
+				interval - num_interval_instructions);
+		if (!counts[id - 1])
+			interval_blocks.push_back(id);
+		counts[id - 1] += count;
+		num_interval_instructions += count;
+		num_instructions -= count;
+
+		// End of interval
+		if (num_interval_instructions == interval)
+			DumpInterval();
+	}
+}
+
+
+}  // namespace x86
@@ -0,0 +1,104 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_EMU_BBV_PROFILER_H
+#define ARCH_X86_EMU_BBV_PROFILER_H
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace x86
+{
+
+/// Profiler of basic block vectors (BBV), in the format read by the SimPoint
+/// tool. Execution is split into intervals of a fixed number of
+/// instructions. For each interval, a line is dumped with the number of
+/// instructions executed in each basic block, as in
+///
+///	T:1:1024 :2:99343 :5:120
+///
+/// Basic blocks are sequences of instructions ending in a control transfer,
+/// identified by the address of their first instruction and numbered from 1
+/// in order of first execution. The instructions of a basic block crossing
+/// the end of an interval are split between both intervals, so that
+/// interval \a i starts exactly at instruction \a i times the interval
+/// length.
+class BbvProfiler
+{
+	// Output file
+	std::ofstream f;
+
+	// Number of instructions in an interval
+	long long interval;
+
+	// Identifiers of basic blocks, indexed by start address
+	std::unordered_map<unsigned, int> block_ids;
+
+	// Number of instructions executed in each basic block in the current
+	// interval, indexed by basic block identifier minus 1
+	std::vector<long long> counts;
+
+	// Basic blocks executed in the current interval
+	std::vector<int> interval_blocks;
+
+	// Number of instructions executed in the current interval
+	long long num_interval_instructions = 0;
+
+	// Number of intervals dumped
+	long long num_intervals = 0;
+
+	// Dump the vector of the current interval and start a new one
+	void DumpInterval();
+
+public:
+
+	/// Constructor
+	///
+	/// \param path
+	///	Output file
+	///
+	/// \param interval
+	///	Number of instructions in an interval
+	///
+	/// \throw
+	///	An x86::Error is thrown if the file cannot be created.
+	BbvProfiler(const std::string &path, long long interval);
+
+	/// Destructor, dumping the last interval if any instruction was
+	/// executed in it.
+	~BbvProfiler();
+
+	/// Record the execution of a basic block starting at address \a eip
+	/// with \a num_instructions instructions.
+	void AddBlock(unsigned eip, int num_instructions);
+
+	/// Return the number of intervals dumped so far
+	long long getNumIntervals() const { return num_intervals; }
+
+	/// Return the number of different basic blocks executed so far
+	int getNumBlocks() const { return block_ids.size(); }
+};
+
+
+}  // namespace x86
+
+#endif
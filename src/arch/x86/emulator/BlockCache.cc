@@ -0,0 +1,82 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cassert>
+
+#include <lib/cpp/Misc.h>
+
+#include "BlockCache.h"
+
+
+namespace x86
+{
+
+const unsigned BlockCache::LogNumEntries;
+const unsigned BlockCache::NumEntries;
+const unsigned BlockCache::MaxBlockSize;
+
+bool BlockCache::block_end[Instruction::OpcodeCount];
+
+
+void BlockCache::InitBlockEnd()
+{
+	// Unconditional control transfers. Conditional branches do not end a
+	// superblock, so that its fall-through path can be executed in a row.
+	block_end[Instruction::Opcode_call_rel32] = true;
+	block_end[Instruction::Opcode_call_rm32] = true;
+	block_end[Instruction::Opcode_jmp_rel8] = true;
+	block_end[Instruction::Opcode_jmp_rel32] = true;
+	block_end[Instruction::Opcode_jmp_rm32] = true;
+	block_end[Instruction::Opcode_ret] = true;
+	block_end[Instruction::Opcode_ret_imm16] = true;
+
+	// Software interrupts, including system calls, which can change the
+	// memory map or the context state.
+	block_end[Instruction::Opcode_int_3] = true;
+	block_end[Instruction::Opcode_int_imm8] = true;
+	block_end[Instruction::Opcode_into] = true;
+	block_end[Instruction::Opcode_hlt] = true;
+}
+
+
+BlockCache::BlockCache()
+{
+	// Initialize table of superblock terminators
+	InitBlockEnd();
+
+	// Allocate superblocks
+	blocks = misc::new_unique_array<Block>(NumEntries);
+}
+
+
+BlockCache::Block *BlockCache::newBlock(unsigned eip,
+		const mem::Memory::Page *page)
+{
+	assert(page);
+	assert(page->getVersion());
+	assert((eip & mem::Memory::PageMask) == page->getTag());
+	Block *block = getBlock(eip);
+	block->version = page->getVersion();
+	block->eip = eip;
+	block->insts.clear();
+	return block;
+}
+
+
+}  // namespace x86
@@ -0,0 +1,140 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_EMU_BLOCK_CACHE_H
+#define ARCH_X86_EMU_BLOCK_CACHE_H
+
+#include <memory>
+#include <vector>
+
+#include <arch/x86/disassembler/Instruction.h>
+#include <memory/Memory.h>
+
+
+namespace x86
+{
+
+// Forward declarations
+class Context;
+
+
+/// Cache of decoded superblocks, used by the functional emulator to run
+/// several instructions of a context in a row without decoding them again.
+/// A superblock is a sequence of consecutive instructions starting at a
+/// given address and following the fall-through path of conditional
+/// branches. It ends at the first unconditional control transfer (jumps,
+/// calls, returns, software interrupts), at an instruction that could not be
+/// decoded, or at the end of the memory page.
+///
+/// Since a superblock is always contained in a single page, it is validated
+/// with the page version, in the same way as entries of the DecodeCache.
+class BlockCache
+{
+public:
+
+	/// Instruction emulation function, as declared in class Context
+	typedef void (Context::*ExecuteInstFn)();
+
+	/// Log base 2 of the number of entries
+	static const unsigned LogNumEntries = 10;
+
+	/// Number of entries
+	static const unsigned NumEntries = 1u << LogNumEntries;
+
+	/// Maximum number of instructions in a superblock
+	static const unsigned MaxBlockSize = 64;
+
+	/// Decoded instruction in a superblock, with its pre-resolved
+	/// emulation function.
+	struct BlockInst
+	{
+		// Decoded instruction
+		Instruction inst;
+
+		// Instruction emulation function
+		ExecuteInstFn execute_inst_fn;
+	};
+
+	/// Superblock
+	struct Block
+	{
+		// Page version when the superblock was built, or 0 if the
+		// entry is empty. Page versions are never 0.
+		long long version = 0;
+
+		// Address of the first instruction
+		unsigned eip = 0;
+
+		// Instructions
+		std::vector<BlockInst> insts;
+	};
+
+private:
+
+	// Table of flags indexed by opcode, indicating whether an instruction
+	// ends a superblock.
+	static bool block_end[Instruction::OpcodeCount];
+
+	// Initialize table 'block_end'
+	static void InitBlockEnd();
+
+	// Superblocks
+	std::unique_ptr<Block[]> blocks;
+
+	// Return the entry where a superblock starting at \a eip maps
+	Block *getBlock(unsigned eip)
+	{
+		return &blocks[(eip ^ (eip >> LogNumEntries)) &
+				(NumEntries - 1)];
+	}
+
+public:
+
+	/// Constructor
+	BlockCache();
+
+	/// Return whether an instruction with opcode \a opcode ends a
+	/// superblock.
+	static bool isBlockEnd(Instruction::Opcode opcode)
+	{
+		return block_end[opcode];
+	}
+
+	/// Look up the superblock starting at \a eip, contained in memory page
+	/// \a page. The function returns the superblock, or `nullptr` if it is
+	/// not present or the page changed since it was built.
+	Block *Lookup(unsigned eip, const mem::Memory::Page *page)
+	{
+		Block *block = getBlock(eip);
+		if (block->eip == eip && page &&
+				block->version == page->getVersion())
+			return block;
+		return nullptr;
+	}
+
+	/// Return an empty superblock starting at address \a eip in page
+	/// \a page, replacing any other superblock that mapped into the same
+	/// entry. The caller is responsible for filling its instructions.
+	Block *newBlock(unsigned eip, const mem::Memory::Page *page);
+};
+
+
+}  // namespace x86
+
+#endif
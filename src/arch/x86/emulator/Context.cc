@@ -17,6 +17,7 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
 #include <cstring>
 #include <fcntl.h>
 #include <poll.h>
@@ -355,6 +356,8 @@ void Context::Initialize()
 	// Create new memory image
 	assert(!memory.get());
 	memory = misc::new_shared<mem::Memory>();
+	decode_cache = misc::new_shared<DecodeCache>();
+	block_cache = misc::new_shared<BlockCache>();
 
 	// Creating a new independent context forces the creation of a new
 	// virtual memory space within the context's associated MMU.
@@ -390,6 +393,8 @@ void Context::Load(const std::vector<std::string> &args,
 	// Create new memory image
 	assert(!memory.get());
 	memory = misc::new_shared<mem::Memory>();
+	decode_cache = misc::new_shared<DecodeCache>();
+	block_cache = misc::new_shared<BlockCache>();
 
 	// Loading a context from an executable file creates a new virtual
 	// address space within the context's associated MMU.
@@ -438,6 +443,8 @@ void Context::Clone(Context *parent)
 	// structure must be only freed by the parent when all its children have
 	// been killed. The set of signal handlers is the same, too.
 	memory = parent->memory;
+	decode_cache = parent->decode_cache;
+	block_cache = parent->block_cache;
 
 	// Cloning a context makes the new context share the same virtual memory
 	// address space as the parent in the parent's associated MMU.
@@ -471,6 +478,8 @@ void Context::Fork(Context *parent)
 	// Memory
 	memory = misc::new_shared<mem::Memory>();
 	memory->Clone(*parent->memory);
+	decode_cache = misc::new_shared<DecodeCache>();
+	block_cache = misc::new_shared<BlockCache>();
 	
 	// Forking a context creates a new virtual memory space in the parent
 	// context's associated MMU.
@@ -760,35 +769,77 @@ void Context::Execute()
 	else
 		memory->setSafeDefault();
 
-	// Read instruction from memory. Memory should be accessed here in unsafe mode
-	// (i.e., allowing segmentation faults) if executing speculatively.
-	char buffer[20];
-	unsigned char *buffer_ptr = (unsigned char *)memory->getBuffer(
-			regs.getEip(), 20, mem::Memory::AccessExec);
-	if (!buffer_ptr)
+	// Look for the instruction in the cache of decoded instructions. The
+	// page permissions are checked again, since the cached instruction
+	// could have been decoded in speculative mode. A hit does not record
+	// the last accessed address of the memory object. Instruction fetches
+	// going through Memory::getBuffer() below do not record it either,
+	// since it only tracks accesses made with Memory::Access().
+	unsigned eip = regs.getEip();
+	mem::Memory::Page *page = memory->getPage(eip);
+	DecodeCache::Entry *entry = decode_cache->Lookup(eip, page);
+	ExecuteInstFn fn;
+	if (entry && (page->getPerm() & mem::Memory::AccessExec))
 	{
-		// Disable safe mode. If a part of the 20 read bytes does not
-		// belong to the actual instruction, and they lie on a page with
-		// no permissions, this would generate an undesired protection
-		// fault.
-		memory->setSafe(false);
-		buffer_ptr = (unsigned char *)buffer;
-		memory->Access(regs.getEip(), 20, (char *)buffer_ptr,
-				mem::Memory::AccessExec);
+		inst = entry->inst;
+		fn = entry->execute_inst_fn;
+	}
+	else
+	{
+		// Read instruction from memory. Memory should be accessed here
+		// in unsafe mode (i.e., allowing segmentation faults) if
+		// executing speculatively.
+		char buffer[20];
+		unsigned char *buffer_ptr = (unsigned char *)memory->getBuffer(
+				eip, 20, mem::Memory::AccessExec);
+		if (!buffer_ptr)
+		{
+			// Disable safe mode. If a part of the 20 read bytes
+			// does not belong to the actual instruction, and they
+			// lie on a page with no permissions, this would
+			// generate an undesired protection fault.
+			memory->setSafe(false);
+			buffer_ptr = (unsigned char *)buffer;
+			memory->Access(eip, 20, (char *)buffer_ptr,
+					mem::Memory::AccessExec);
+		}
+
+		// Disassemble
+		inst.Decode((char *)buffer_ptr, eip);
+		if (inst.getOpcode() == Instruction::OpcodeInvalid && !spec_mode)
+		{
+			inst.Dump(std::cout);
+			throw Error(misc::fmt("Unsupported instruction "
+					"(%02x %02x %02x %02x...)\n",
+					buffer_ptr[0], buffer_ptr[1],
+					buffer_ptr[2], buffer_ptr[3]));
+		}
+
+		// Save in cache
+		fn = execute_inst_fn[inst.getOpcode()];
+		if (page)
+			decode_cache->Insert(inst, fn, page);
 	}
 
 	// Return to default safe mode
 	memory->setSafeDefault();
 
-	// Disassemble
-	inst.Decode((char *)buffer_ptr, regs.getEip());
-	if (inst.getOpcode() == Instruction::OpcodeInvalid && !spec_mode)
+	// Emulate
+	ExecuteInst(fn);
+}
+
+
+void Context::ExecuteInst(ExecuteInstFn fn)
+{
+	// On host threads of the parallel emulation loop, stop before system
+	// calls touching state shared with other contexts, leaving them for
+	// the main thread.
+	if (inst.getOpcode() == Instruction::Opcode_int_imm8)
 	{
-		inst.Dump(std::cout);
-		throw Error(misc::fmt("Unsupported instruction "
-				"(%02x %02x %02x %02x...)\n",
-				buffer_ptr[0], buffer_ptr[1],
-				buffer_ptr[2], buffer_ptr[3]));
+		shared_syscall_pending = Emulator::isHostThread() &&
+				!isLocalSyscall(regs.getEax());
+		if (shared_syscall_pending)
+			return;
 	}
 
 	// Clear existing list of microinstructions, though the architectural
@@ -820,7 +871,6 @@ void Context::Execute()
 	{
 		try
 		{
-			ExecuteInstFn fn = execute_inst_fn[inst.getOpcode()];
 			(this->*fn)();
 		}
 		catch (mem::Memory::Error &e)
@@ -837,7 +887,7 @@ void Context::Execute()
 		{
 			// Ignore in speculative mode. Otherwise, add context
 			// information to the error message
-			if (!spec_mode)
+			if (!getState(StateSpecMode))
 			{
 				e.AppendPrefix(misc::fmt("pid %d", getId()));
 				e.AppendPrefix(misc::fmt("eip 0x%x",
@@ -848,7 +898,7 @@ void Context::Execute()
 		catch (misc::Panic &e)
 		{
 			// Ignore in speculative mode
-			if (!spec_mode)
+			if (!getState(StateSpecMode))
 				throw e;
 		}
 	}
@@ -860,6 +910,141 @@ void Context::Execute()
 
 	// Stats
 	emulator->incNumInstructions();
+
+	// Basic block vector profile. A basic block ends with a branch, taken
+	// or not, or with any other instruction that does not continue at the
+	// next address.
+	BbvProfiler *bbv_profiler = emulator->getBbvProfiler();
+	if (bbv_profiler && !getState(StateSpecMode))
+	{
+		if (!bbv_block_size)
+			bbv_block_eip = current_eip;
+		bbv_block_size++;
+		if (target_eip || regs.getEip() != current_eip + inst.getSize())
+		{
+			bbv_profiler->AddBlock(bbv_block_eip, bbv_block_size);
+			bbv_block_size = 0;
+		}
+	}
+}
+
+
+BlockCache::Block *Context::BuildBlock(unsigned eip, mem::Memory::Page *page)
+{
+	// Make sure that the page has content, so that instruction bytes can
+	// be read directly from it. Pages backed by host memory are read
+	// without allocating their data.
+	const char *data = page->getReadData();
+	if (!data)
+	{
+		page->AllocateData();
+		data = page->getData();
+	}
+
+	// Decode instructions
+	BlockCache::Block *block = block_cache->newBlock(eip, page);
+	while (block->insts.size() < BlockCache::MaxBlockSize &&
+			(eip & mem::Memory::PageMask) == page->getTag())
+	{
+		// Reuse instruction from the cache of decoded instructions
+		BlockCache::BlockInst block_inst;
+		DecodeCache::Entry *entry = decode_cache->Lookup(eip, page);
+		if (entry)
+		{
+			block_inst.inst = entry->inst;
+			block_inst.execute_inst_fn = entry->execute_inst_fn;
+		}
+		else
+		{
+			// Bytes past the end of the page are read as zeros.
+			// If the instruction turns out to use any of them,
+			// it is discarded below.
+			char buffer[20] = { };
+			unsigned offset = eip & (mem::Memory::PageSize - 1);
+			memcpy(buffer, data + offset, std::min(20u,
+					mem::Memory::PageSize - offset));
+			block_inst.inst.Decode(buffer, eip);
+			block_inst.execute_inst_fn = execute_inst_fn[
+					block_inst.inst.getOpcode()];
+			decode_cache->Insert(block_inst.inst,
+					block_inst.execute_inst_fn, page);
+		}
+
+		// Stop at instructions that failed to decode, or that cross
+		// the page boundary. They are emulated one at a time.
+		const Instruction &inst = block_inst.inst;
+		if (inst.getOpcode() == Instruction::OpcodeInvalid ||
+				(eip & (mem::Memory::PageSize - 1)) +
+				inst.getSize() > mem::Memory::PageSize)
+			break;
+
+		// Add instruction
+		block->insts.push_back(block_inst);
+		eip += inst.getSize();
+		if (BlockCache::isBlockEnd(inst.getOpcode()))
+			break;
+	}
+
+	// Return superblock
+	return block;
+}
+
+
+int Context::ExecuteBlock(int max_instructions)
+{
+	// Speculative execution only happens in detailed simulation, which
+	// emulates one instruction at a time.
+	if (max_instructions <= 1 || getState(StateSpecMode))
+	{
+		Execute();
+		return shared_syscall_pending ? 0 : 1;
+	}
+
+	// Instructions in pages without execution permissions go through the
+	// regular path, which reports the permission violation.
+	memory->setSafeDefault();
+	unsigned eip = regs.getEip();
+	mem::Memory::Page *page = memory->getPage(eip);
+	if (!page || !(page->getPerm() & mem::Memory::AccessExec))
+	{
+		Execute();
+		return shared_syscall_pending ? 0 : 1;
+	}
+
+	// Find or build superblock
+	BlockCache::Block *block = block_cache->Lookup(eip, page);
+	if (!block)
+		block = BuildBlock(eip, page);
+	if (!block->insts.size())
+	{
+		Execute();
+		return shared_syscall_pending ? 0 : 1;
+	}
+
+	// Run the superblock. Execution stops when a conditional branch is
+	// taken (or a repeated string instruction iterates), when the context
+	// stops running, or when the page is modified by the superblock
+	// itself. The page cannot be unmapped in the middle of a superblock,
+	// since system calls always end it.
+	int count = 0;
+	for (auto &block_inst : block->insts)
+	{
+		if (count == max_instructions ||
+				regs.getEip() != block_inst.inst.getEip() ||
+				!getState(StateRunning) ||
+				page->getVersion() != block->version)
+			break;
+		inst = block_inst.inst;
+		ExecuteInst(block_inst.execute_inst_fn);
+		if (shared_syscall_pending)
+			break;
+		count++;
+	}
+
+	// Return number of emulated instructions, not counting a system call
+	// left for the main thread
+	assert(count > 0 || shared_syscall_pending);
+	return count;
 }
 
 
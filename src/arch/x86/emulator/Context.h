@@ -21,7 +21,11 @@
 #define ARCH_X86_EMULATOR_CONTEXT_H
 
 #include <deque>
+#include <iostream>
+#include <map>
 #include <memory>
+#include <unordered_set>
+#include <vector>
 
 #include <arch/common/CallStack.h>
 #include <arch/common/Context.h>
@@ -34,6 +38,8 @@
 #include <memory/Mmu.h>
 #include <memory/SpecMem.h>
 
+#include "BlockCache.h"
+#include "DecodeCache.h"
 #include "Regs.h"
 #include "Signal.h"
 #include "Uinst.h"
@@ -154,6 +160,14 @@ private:
 	// this memory object will be the one automatically freeing it.
 	std::shared_ptr<mem::Memory> memory;
 
+	// Cache of decoded instructions. It is associated with the memory
+	// object, so it is shared by all contexts sharing the same memory.
+	std::shared_ptr<DecodeCache> decode_cache;
+
+	// Cache of decoded superblocks, shared in the same way as the cache
+	// of decoded instructions.
+	std::shared_ptr<BlockCache> block_cache;
+
 	// Memory management unit, which can be shared by multiple contexts.
 	// NOTE: For now, the MMU of each context is taken directly from the
 	// associated emulator's MMU. This will change with fused memory.
@@ -189,6 +203,11 @@ private:
 	// Target address for branch, even if not taken
 	unsigned target_eip = 0;
 
+	// Start address and number of instructions of the basic block being
+	// executed, recorded for the basic block vector profile
+	unsigned bbv_block_eip = 0;
+	int bbv_block_size = 0;
+
 	// Parent context
 	Context *parent = nullptr;
 
@@ -378,6 +397,14 @@ private:
 	// Load environment variables in 'loader.env' into the stack
 	void LoadEnv();
 
+	// Back the pages of the sections in read-only loadable segments of an
+	// ELF binary with a host mapping of the binary file, so that they are
+	// only allocated when written. The sections whose pages were all
+	// mapped are added to 'shared_sections'. Return false if the file
+	// could not be mapped.
+	bool MapELFSegments(elf::File32 *binary,
+			std::unordered_set<elf::Section32 *> &shared_sections);
+
 	// Load ELF sections from binary
 	void LoadELFSections(elf::File32 *binary);
 
@@ -495,6 +522,14 @@ private:
 	// Table of functions
 	static ExecuteInstFn execute_inst_fn[Instruction::OpcodeCount];
 
+	// Emulate the instruction already decoded in 'inst', using emulation
+	// function \a fn.
+	void ExecuteInst(ExecuteInstFn fn);
+
+	// Build the superblock starting at address \a eip, contained in page
+	// \a page, and insert it in the superblock cache.
+	BlockCache::Block *BuildBlock(unsigned eip, mem::Memory::Page *page);
+
 	// Safe memory accesses, based on the current speculative mode
 	void MemoryRead(unsigned int address, int size, void *buffer);
 	void MemoryWrite(unsigned int address, int size, void *buffer);
@@ -682,6 +717,19 @@ private:
 	// Table of system call execution functions
 	static const ExecuteSyscallFn execute_syscall_fn[SyscallCodeCount + 1];
 
+	// Set when the context stopped on a host thread of the parallel
+	// emulation loop before a system call that touches state shared with
+	// other contexts. The system call runs next on the main thread.
+	bool shared_syscall_pending = false;
+
+	// Return whether the system call with the given code only touches
+	// the state of the calling context and of the contexts sharing its
+	// memory image, so that it can run on a host thread of the parallel
+	// emulation loop. Calls that may suspend the context, create or
+	// signal other contexts, or change the emulator context lists are
+	// not local.
+	static bool isLocalSyscall(int code);
+
 	// Auxiliary system call functions
 	int SyscallMmapAux(unsigned int addr, unsigned int len, int prot,
 			int flags, int guest_fd, int offset);
@@ -760,6 +808,45 @@ public:
 	/// Initialize the context by forking a parent context.
 	void Fork(Context *parent);
 
+
+
+
+	//
+	// Checkpoints (ContextCheckpoint.cc)
+	//
+
+	/// Objects that can be shared among contexts (memory image, file
+	/// table, signal handler table, and loader information), tracked
+	/// while saving or loading a checkpoint. Each shared object is saved
+	/// only once, and referred to by its index afterwards, so that the
+	/// same sharing is reproduced when the checkpoint is loaded.
+	struct CheckpointObjects
+	{
+		/// Indices assigned to the objects already saved
+		std::map<const void *, int> indices;
+
+		/// Contexts holding the objects already loaded, indexed by
+		/// their position in the checkpoint
+		std::vector<Context *> contexts;
+	};
+
+	/// Save the architectural state of the context into a binary
+	/// checkpoint stream. The context must not be in speculative mode.
+	/// Contexts waiting in a futex or in system call \c sigsuspend are
+	/// saved as suspended. Contexts suspended in other system calls are
+	/// saved right before the system call, which runs again once the
+	/// checkpoint is loaded.
+	void SaveCheckpoint(std::ostream &os, CheckpointObjects &objects) const;
+
+	/// Initialize a context newly created with Emulator::newContext()
+	/// with the state saved in a checkpoint with SaveCheckpoint(). The
+	/// parent of the context, if any, must have been loaded before.
+	///
+	/// \throw
+	///	A misc::Error is thrown if the checkpoint is truncated or
+	///	inconsistent.
+	void LoadCheckpoint(std::istream &is, CheckpointObjects &objects);
+
 	/// Return the MMU used by the context.
 	mem::Mmu *getMmu() const { return mmu; }
 
@@ -844,6 +931,20 @@ public:
 	/// register \c eip.
 	void Execute();
 
+	/// Run up to \a max_instructions instructions of the superblock
+	/// starting at the position pointed to by register \c eip, and return
+	/// the number of instructions actually emulated. This is at least 1,
+	/// unless the context stops before a system call that must run on the
+	/// main thread (see isSharedSyscallPending()), which is not counted.
+	/// This function is used by the functional emulator only.
+	int ExecuteBlock(int max_instructions);
+
+	/// Return whether the context stopped on a host thread of the parallel
+	/// functional emulation loop before a system call that touches state
+	/// shared with other contexts. The system call is emulated in the
+	/// next call to Execute() from the main thread.
+	bool isSharedSyscallPending() const { return shared_syscall_pending; }
+
 	/// Return a reference of the register file
 	Regs &getRegs() { return regs; }
 
@@ -855,6 +956,14 @@ public:
 		return memory.get();
 	}
 
+	/// Return the cache of decoded instructions, shared by all contexts
+	/// with the same memory image.
+	DecodeCache *getDecodeCache() const { return decode_cache.get(); }
+
+	/// Return the cache of decoded superblocks, shared by all contexts
+	/// with the same memory image.
+	BlockCache *getBlockCache() const { return block_cache.get(); }
+
 	/// Force a new 'eip' value for the context. The forced value should be
 	/// the same as the current 'eip' under normal circumstances. If it is
 	/// not, speculative execution starts, which will end on the next call
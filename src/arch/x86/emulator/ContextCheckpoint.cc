@@ -0,0 +1,340 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <lib/cpp/Misc.h>
+
+#include "Context.h"
+#include "Emulator.h"
+
+
+namespace x86
+{
+
+
+// Write the reference to a shared object in a checkpoint stream. The function
+// returns true if this is the first time the object is saved, in which case
+// the caller must save the object itself right after. A null object is saved
+// as index -1.
+static bool SaveSharedObject(std::ostream &os,
+		Context::CheckpointObjects &objects,
+		const void *object)
+{
+	// Null object
+	if (!object)
+	{
+		misc::WriteBinary(os, -1);
+		return false;
+	}
+
+	// Object already saved
+	auto it = objects.indices.find(object);
+	if (it != objects.indices.end())
+	{
+		misc::WriteBinary(os, it->second);
+		return false;
+	}
+
+	// New object
+	int index = objects.indices.size();
+	objects.indices[object] = index;
+	misc::WriteBinary(os, index);
+	return true;
+}
+
+
+// Read the reference to a shared object from a checkpoint stream. If the
+// object is saved for the first time, the function returns true, and the
+// caller must load it into \a context. Otherwise, \a owner is set to the
+// context already holding the object, or to null if the object is null.
+static bool LoadSharedObject(std::istream &is,
+		Context::CheckpointObjects &objects,
+		Context *context,
+		Context *&owner)
+{
+	int index;
+	misc::ReadBinary(is, index);
+	owner = nullptr;
+
+	// Null object
+	if (index == -1)
+		return false;
+
+	// New object
+	int num_objects = objects.contexts.size();
+	if (index == num_objects)
+	{
+		objects.contexts.push_back(context);
+		return true;
+	}
+
+	// Object already loaded
+	if (index < 0 || index > num_objects)
+		throw Error(misc::fmt("Invalid shared object index in "
+				"checkpoint (%d)", index));
+	owner = objects.contexts[index];
+	return false;
+}
+
+
+// Save a list of strings into a binary stream
+static void SaveStrings(std::ostream &os, const std::vector<std::string> &v)
+{
+	misc::WriteBinary(os, (unsigned) v.size());
+	for (auto &s : v)
+		misc::WriteBinaryString(os, s);
+}
+
+
+// Load a list of strings from a binary stream
+static void LoadStrings(std::istream &is, std::vector<std::string> &v)
+{
+	unsigned size;
+	misc::ReadBinary(is, size);
+	v.clear();
+	for (unsigned i = 0; i < size; i++)
+		v.push_back(misc::ReadBinaryString(is));
+}
+
+
+void Context::SaveCheckpoint(std::ostream &os, CheckpointObjects &objects) const
+{
+	// Contexts in speculative mode are only found in timing simulation
+	if (getState(StateSpecMode))
+		throw misc::Panic(misc::fmt("Context %d cannot be saved in "
+				"speculative mode", getId()));
+
+	// Allocation of the context to hardware threads is not part of the
+	// functional state.
+	unsigned saved_state = state & ~(StateAlloc | StateMapped);
+	Regs saved_regs = regs;
+
+	// Contexts waiting in a futex or in 'sigsuspend' only depend on guest
+	// state, and are saved as suspended. Other system calls suspended with
+	// a callback wait on host events (timers, file descriptors), so they
+	// are saved right before the 'int 0x80' instruction, and the system
+	// call is executed again when the checkpoint is loaded. The system
+	// call code is still in register 'eax' while suspended.
+	if (getState(StateCallback) && wakeup_state != StateSigsuspend)
+	{
+		saved_state &= ~(StateSuspended | StateCallback | wakeup_state);
+		saved_regs.decEip(2);
+	}
+
+	// Identifier and state
+	misc::WriteBinary(os, getId());
+	misc::WriteBinary(os, saved_state);
+	misc::WriteBinary(os, parent ? parent->getId() : 0);
+	misc::WriteBinary(os, group_parent ? group_parent->getId() : 0);
+
+	// Futex the context is waiting on
+	misc::WriteBinary(os, wakeup_futex);
+	misc::WriteBinary(os, wakeup_futex_bitset);
+	misc::WriteBinary(os, wakeup_futex_sleep);
+
+	// Register file
+	saved_regs.SaveCheckpoint(os);
+
+	// Memory image
+	if (SaveSharedObject(os, objects, memory.get()))
+		memory->SaveCheckpoint(os);
+
+	// File descriptor table
+	if (SaveSharedObject(os, objects, file_table.get()))
+		file_table->SaveCheckpoint(os);
+
+	// Signal handlers and masks
+	if (SaveSharedObject(os, objects, signal_handler_table.get()))
+		signal_handler_table->SaveCheckpoint(os);
+	signal_mask_table.SaveCheckpoint(os);
+
+	// Loader information
+	if (SaveSharedObject(os, objects, loader.get()))
+	{
+		SaveStrings(os, loader->args);
+		SaveStrings(os, loader->env);
+		misc::WriteBinaryString(os, loader->interp);
+		misc::WriteBinaryString(os, loader->exe);
+		misc::WriteBinaryString(os, loader->cwd);
+		misc::WriteBinaryString(os, loader->stdin_file_name);
+		misc::WriteBinaryString(os, loader->stdout_file_name);
+		misc::WriteBinary(os, loader->stack_base);
+		misc::WriteBinary(os, loader->stack_top);
+		misc::WriteBinary(os, loader->stack_size);
+		misc::WriteBinary(os, loader->environ_base);
+		misc::WriteBinary(os, loader->bottom);
+		misc::WriteBinary(os, loader->prog_entry);
+		misc::WriteBinary(os, loader->interp_prog_entry);
+		misc::WriteBinary(os, loader->phdt_base);
+		misc::WriteBinary(os, loader->phdr_count);
+		misc::WriteBinary(os, loader->at_random_addr);
+		misc::WriteBinary(os, loader->at_random_addr_holder);
+	}
+
+	// Other fields
+	misc::WriteBinary(os, exit_signal);
+	misc::WriteBinary(os, exit_code);
+	misc::WriteBinary(os, clear_child_tid);
+	misc::WriteBinary(os, robust_list_head);
+	misc::WriteBinary(os, glibc_segment_base);
+	misc::WriteBinary(os, glibc_segment_limit);
+	misc::WriteBinary(os, sched_policy);
+	misc::WriteBinary(os, sched_priority);
+}
+
+
+void Context::LoadCheckpoint(std::istream &is, CheckpointObjects &objects)
+{
+	// Context must have been just created
+	assert(!memory.get());
+	assert(!loader.get());
+
+	// Identifier
+	int id;
+	misc::ReadBinary(is, id);
+	setId(id);
+
+	// State, applied after the rest of the context is loaded
+	unsigned saved_state;
+	misc::ReadBinary(is, saved_state);
+
+	// Parent contexts
+	int parent_id;
+	int group_parent_id;
+	misc::ReadBinary(is, parent_id);
+	misc::ReadBinary(is, group_parent_id);
+	parent = parent_id ? emulator->getContext(parent_id) : nullptr;
+	group_parent = group_parent_id ?
+			emulator->getContext(group_parent_id) : nullptr;
+	if ((parent_id && !parent) || (group_parent_id && !group_parent))
+		throw Error(misc::fmt("Context %d: parent context not found "
+				"in checkpoint", id));
+
+	// Futex the context is waiting on
+	misc::ReadBinary(is, wakeup_futex);
+	misc::ReadBinary(is, wakeup_futex_bitset);
+	misc::ReadBinary(is, wakeup_futex_sleep);
+
+	// Register file
+	regs.LoadCheckpoint(is);
+
+	// Memory image. A new memory image gets a new virtual memory space
+	// in the MMU and new caches of decoded instructions.
+	Context *owner;
+	if (LoadSharedObject(is, objects, this, owner))
+	{
+		memory = misc::new_shared<mem::Memory>();
+		memory->LoadCheckpoint(is);
+		decode_cache = misc::new_shared<DecodeCache>();
+		block_cache = misc::new_shared<BlockCache>();
+		mmu_space = mmu->newSpace();
+	}
+	else if (owner)
+	{
+		memory = owner->memory;
+		decode_cache = owner->decode_cache;
+		block_cache = owner->block_cache;
+		mmu_space = owner->mmu_space;
+	}
+	if (memory.get())
+		spec_mem = misc::new_unique<mem::SpecMem>(memory.get());
+
+	// File descriptor table
+	if (LoadSharedObject(is, objects, this, owner))
+	{
+		file_table = misc::new_shared<comm::FileTable>();
+		file_table->LoadCheckpoint(is);
+	}
+	else if (owner)
+	{
+		file_table = owner->file_table;
+	}
+
+	// Signal handlers and masks
+	if (LoadSharedObject(is, objects, this, owner))
+	{
+		signal_handler_table = misc::new_shared<SignalHandlerTable>();
+		signal_handler_table->LoadCheckpoint(is);
+	}
+	else if (owner)
+	{
+		signal_handler_table = owner->signal_handler_table;
+	}
+	signal_mask_table.LoadCheckpoint(is);
+
+	// Loader information. The ELF binary is only needed while loading the
+	// program, so it is not opened again.
+	if (LoadSharedObject(is, objects, this, owner))
+	{
+		loader = misc::new_shared<Loader>();
+		LoadStrings(is, loader->args);
+		LoadStrings(is, loader->env);
+		loader->interp = misc::ReadBinaryString(is);
+		loader->exe = misc::ReadBinaryString(is);
+		loader->cwd = misc::ReadBinaryString(is);
+		loader->stdin_file_name = misc::ReadBinaryString(is);
+		loader->stdout_file_name = misc::ReadBinaryString(is);
+		misc::ReadBinary(is, loader->stack_base);
+		misc::ReadBinary(is, loader->stack_top);
+		misc::ReadBinary(is, loader->stack_size);
+		misc::ReadBinary(is, loader->environ_base);
+		misc::ReadBinary(is, loader->bottom);
+		misc::ReadBinary(is, loader->prog_entry);
+		misc::ReadBinary(is, loader->interp_prog_entry);
+		misc::ReadBinary(is, loader->phdt_base);
+		misc::ReadBinary(is, loader->phdr_count);
+		misc::ReadBinary(is, loader->at_random_addr);
+		misc::ReadBinary(is, loader->at_random_addr_holder);
+	}
+	else if (owner)
+	{
+		loader = owner->loader;
+	}
+
+	// Other fields
+	misc::ReadBinary(is, exit_signal);
+	misc::ReadBinary(is, exit_code);
+	misc::ReadBinary(is, clear_child_tid);
+	misc::ReadBinary(is, robust_list_head);
+	misc::ReadBinary(is, glibc_segment_base);
+	misc::ReadBinary(is, glibc_segment_limit);
+	misc::ReadBinary(is, sched_policy);
+	misc::ReadBinary(is, sched_priority);
+
+	// The only system call saved as suspended with a callback is
+	// 'sigsuspend', which wakes up when a signal is received.
+	if (saved_state & StateCallback)
+	{
+		if (!(saved_state & StateSigsuspend))
+			throw Error(misc::fmt("Context %d: invalid suspended "
+					"state in checkpoint", id));
+		can_wakeup_fn = &Context::SyscallSigsuspendCanWakeup;
+		wakeup_fn = &Context::SyscallSigsuspendWakeup;
+		wakeup_state = StateSigsuspend;
+	}
+
+	// Restore state, updating the emulator context lists
+	UpdateState(saved_state);
+
+	// Debug
+	Emulator::context_debug << misc::fmt("Context %d loaded from "
+			"checkpoint\n", id);
+}
+
+
+}  // namespace x86
@@ -18,6 +18,8 @@
  */
 
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <lib/cpp/String.h>
@@ -143,8 +145,162 @@ static misc::StringMap section_flags_map =
 	{ "SHF_EXECINSTR", 4 }
 };
 
+// Return whether a program header describes a segment that can be backed by
+// a host mapping of the ELF file: a loadable, read-only segment whose file
+// offset and virtual address have the same offset within a page.
+static bool isSharedSegment(elf::ProgramHeader32 *program_header)
+{
+	return program_header->getType() == PT_LOAD &&
+			!(program_header->getFlags() & PF_W) &&
+			program_header->getFilesz() &&
+			program_header->getOffset() % mem::Memory::PageSize ==
+			program_header->getVaddr() % mem::Memory::PageSize;
+}
+
+
+// Return whether the content of a section is contained in a segment, at the
+// same offset from the start of the segment in the file and in memory.
+static bool isSectionInSegment(elf::ProgramHeader32 *program_header,
+		elf::Section32 *section)
+{
+	unsigned vaddr = program_header->getVaddr();
+	unsigned offset = program_header->getOffset();
+	return section->getAddr() >= vaddr &&
+			section->getAddr() + section->getSize() <=
+			vaddr + program_header->getFilesz() &&
+			section->getAddr() - vaddr ==
+			section->getOffset() - offset;
+}
+
+
+bool Context::MapELFSegments(elf::File32 *binary,
+		std::unordered_set<elf::Section32 *> &shared_sections)
+{
+	// Map the ELF file in host memory
+	int fd = open(binary->getPath().c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	void *buffer = MAP_FAILED;
+	if (!fstat(fd, &st) && st.st_size)
+		buffer = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE,
+				fd, 0);
+	close(fd);
+	if (buffer == MAP_FAILED)
+		return false;
+
+	// The mapping is released when the last page using it is written or
+	// freed.
+	size_t size = st.st_size;
+	std::shared_ptr<const char> file((const char *) buffer,
+			[size](const char *buffer)
+			{
+				munmap((void *) buffer, size);
+			});
+
+	// Back read-only segments with the mapping
+	Emulator::loader_debug << "\nMapping ELF segments\n";
+	for (auto &program_header : binary->getProgramHeaders())
+	{
+		if (!isSharedSegment(program_header.get()))
+			continue;
+
+		// Segment boundaries, extended to whole pages
+		unsigned vaddr = program_header->getVaddr();
+		unsigned address = vaddr & mem::Memory::PageMask;
+		unsigned offset = program_header->getOffset() - (vaddr - address);
+		unsigned end = vaddr + program_header->getFilesz();
+		if (program_header->getOffset() + program_header->getFilesz() >
+				size)
+			continue;
+
+		// Sections with content in the segment
+		std::vector<elf::Section32 *> sections;
+		for (auto &section : binary->getSections())
+			if ((section->getFlags() & SHF_ALLOC) &&
+					section->getType() != 8 &&
+					section->getSize() &&
+					isSectionInSegment(program_header.get(),
+					section.get()))
+				sections.push_back(section.get());
+
+		// Page permissions are given by the sections in each page, as
+		// when sections are loaded one by one. Pages without sections
+		// are not mapped.
+		unsigned num_pages = (end - address + mem::Memory::PageSize - 1) /
+				mem::Memory::PageSize;
+		std::vector<unsigned> perms(num_pages, 0);
+		for (elf::Section32 *section : sections)
+		{
+			unsigned perm = mem::Memory::AccessInit |
+					mem::Memory::AccessRead;
+			if (section->getFlags() & SHF_EXECINSTR)
+				perm |= mem::Memory::AccessExec;
+			unsigned first = (section->getAddr() - address) /
+					mem::Memory::PageSize;
+			unsigned last = (section->getAddr() + section->getSize() -
+					1 - address) / mem::Memory::PageSize;
+			for (unsigned page = first; page <= last; page++)
+				perms[page] |= perm;
+		}
+
+		// Map runs of pages with the same permissions. Pages mapped
+		// before, such as a page shared with another segment, are left
+		// as they are. The host mapping covers whole pages, with zeros
+		// past the end of the file.
+		std::vector<bool> mapped(num_pages, false);
+		for (unsigned page = 0; page < num_pages;)
+		{
+			unsigned tag = address + page * mem::Memory::PageSize;
+			if (!perms[page] || memory->getPage(tag))
+			{
+				page++;
+				continue;
+			}
+			unsigned run = page + 1;
+			while (run < num_pages && perms[run] == perms[page] &&
+					!memory->getPage(address +
+					run * mem::Memory::PageSize))
+				run++;
+			unsigned run_size = (run - page) * mem::Memory::PageSize;
+			memory->MapShared(tag, run_size, perms[page],
+					std::shared_ptr<const char>(file,
+					file.get() + offset +
+					page * mem::Memory::PageSize));
+			Emulator::loader_debug << misc::fmt("  pages at 0x%x, "
+					"size=%u, offset=0x%x\n", tag, run_size,
+					offset + page * mem::Memory::PageSize);
+			for (; page < run; page++)
+				mapped[page] = true;
+		}
+
+		// Sections whose pages were all mapped are not loaded again
+		for (elf::Section32 *section : sections)
+		{
+			unsigned first = (section->getAddr() - address) /
+					mem::Memory::PageSize;
+			unsigned last = (section->getAddr() + section->getSize() -
+					1 - address) / mem::Memory::PageSize;
+			bool all_mapped = true;
+			for (unsigned page = first; page <= last; page++)
+				all_mapped = all_mapped && mapped[page];
+			if (all_mapped)
+				shared_sections.insert(section);
+		}
+	}
+
+	// Success
+	return true;
+}
+
+
 void Context::LoadELFSections(elf::File32 *binary)
 {
+	// Back sections of read-only segments with the ELF file
+	std::unordered_set<elf::Section32 *> shared_sections;
+	if (Emulator::getMmapElf())
+		MapELFSegments(binary, shared_sections);
+
 	Emulator::loader_debug << "\nLoading ELF sections\n";
 	loader->bottom = 0xffffffff;
 	for (auto &section : binary->getSections())
@@ -199,7 +355,7 @@ void Context::LoadELFSections(elf::File32 *binary)
 							zero_buffer.get());
 				}
 			}
-			else
+			else if (!shared_sections.count(section.get()))
 			{
 				memory->Init(section->getAddr(), section->getSize(),
 						section->getBuffer());
@@ -290,6 +290,62 @@ void Context::ExecuteSyscall()
 }
 
 
+bool Context::isLocalSyscall(int code)
+{
+	switch (code)
+	{
+
+	// Memory map
+	case SyscallCode_brk:
+	case SyscallCode_mmap:
+	case SyscallCode_mmap2:
+	case SyscallCode_munmap:
+	case SyscallCode_mremap:
+	case SyscallCode_mprotect:
+	case SyscallCode_madvise:
+
+	// Time
+	case SyscallCode_time:
+	case SyscallCode_times:
+	case SyscallCode_gettimeofday:
+	case SyscallCode_clock_gettime:
+	case SyscallCode_clock_getres:
+
+	// Identifiers
+	case SyscallCode_getpid:
+	case SyscallCode_gettid:
+	case SyscallCode_getuid:
+	case SyscallCode_getgid:
+	case SyscallCode_geteuid:
+	case SyscallCode_getegid:
+	case SyscallCode_getuid16:
+	case SyscallCode_getgid16:
+	case SyscallCode_geteuid16:
+	case SyscallCode_getegid16:
+	case SyscallCode_newuname:
+	case SyscallCode_getrlimit:
+	case SyscallCode_set_thread_area:
+	case SyscallCode_set_tid_address:
+
+	// File system queries and non-blocking file operations
+	case SyscallCode_access:
+	case SyscallCode_getcwd:
+	case SyscallCode_readlink:
+	case SyscallCode_stat64:
+	case SyscallCode_lstat64:
+	case SyscallCode_fstat64:
+	case SyscallCode_lseek:
+	case SyscallCode_llseek:
+
+		return true;
+
+	default:
+
+		return false;
+	}
+}
+
+
 
 
 //
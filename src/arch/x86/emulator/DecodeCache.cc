@@ -0,0 +1,72 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cassert>
+
+#include <lib/cpp/Misc.h>
+
+#include "DecodeCache.h"
+
+
+namespace x86
+{
+
+const unsigned DecodeCache::LogNumEntries;
+const unsigned DecodeCache::NumEntries;
+
+
+DecodeCache::DecodeCache()
+{
+	entries = misc::new_unique_array<Entry>(NumEntries);
+}
+
+
+void DecodeCache::Insert(const Instruction &inst, ExecuteInstFn execute_inst_fn,
+		const mem::Memory::Page *page)
+{
+	// Instructions that failed to decode are not cached, so that the
+	// emulator reports them every time they are found.
+	if (inst.getOpcode() == Instruction::OpcodeInvalid)
+		return;
+
+	// Instruction must be fully contained in the page
+	assert(page);
+	assert(page->getVersion());
+	assert((inst.getEip() & mem::Memory::PageMask) == page->getTag());
+	if ((inst.getEip() & (mem::Memory::PageSize - 1)) + inst.getSize() >
+			mem::Memory::PageSize)
+		return;
+
+	// Replace entry
+	Entry *entry = getEntry(inst.getEip());
+	entry->version = page->getVersion();
+	entry->eip = inst.getEip();
+	entry->inst = inst;
+	entry->execute_inst_fn = execute_inst_fn;
+}
+
+
+void DecodeCache::Flush()
+{
+	for (unsigned i = 0; i < NumEntries; i++)
+		entries[i].version = 0;
+}
+
+
+}  // namespace x86
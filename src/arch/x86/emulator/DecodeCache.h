@@ -0,0 +1,134 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_EMU_DECODE_CACHE_H
+#define ARCH_X86_EMU_DECODE_CACHE_H
+
+#include <memory>
+
+#include <arch/x86/disassembler/Instruction.h>
+#include <memory/Memory.h>
+
+
+namespace x86
+{
+
+// Forward declarations
+class Context;
+
+
+/// Cache of decoded x86 instructions associated with a virtual memory space.
+/// The cache is direct-mapped and indexed by the instruction address. Each
+/// entry keeps the decoded instruction together with its emulation function,
+/// and the version of the memory page containing the instruction bytes at the
+/// time the instruction was decoded. An entry is only valid as long as the
+/// page keeps the same version, which changes when the page is remapped,
+/// re-protected, or written while having execution permissions.
+///
+/// Instructions crossing a page boundary are never inserted in the cache,
+/// since their validity would depend on the version of two pages.
+class DecodeCache
+{
+public:
+
+	/// Instruction emulation function, as declared in class Context
+	typedef void (Context::*ExecuteInstFn)();
+
+	/// Log base 2 of the number of entries
+	static const unsigned LogNumEntries = 13;
+
+	/// Number of entries
+	static const unsigned NumEntries = 1u << LogNumEntries;
+
+	/// Cache entry
+	struct Entry
+	{
+		// Page version when the instruction was decoded, or 0 if the
+		// entry is empty. Page versions are never 0.
+		long long version = 0;
+
+		// Instruction address
+		unsigned eip = 0;
+
+		// Decoded instruction
+		Instruction inst;
+
+		// Instruction emulation function
+		ExecuteInstFn execute_inst_fn = nullptr;
+	};
+
+private:
+
+	// Cache entries
+	std::unique_ptr<Entry[]> entries;
+
+	// Statistics
+	long long num_hits = 0;
+	long long num_misses = 0;
+
+	// Return the entry where an instruction address maps
+	Entry *getEntry(unsigned eip)
+	{
+		return &entries[(eip ^ (eip >> LogNumEntries)) &
+				(NumEntries - 1)];
+	}
+
+public:
+
+	/// Constructor
+	DecodeCache();
+
+	/// Look up the instruction at address \a eip, contained in memory page
+	/// \a page. The function returns the valid cache entry for the
+	/// instruction, or `nullptr` if the instruction is not in the cache or
+	/// its page changed since it was decoded.
+	Entry *Lookup(unsigned eip, const mem::Memory::Page *page)
+	{
+		Entry *entry = getEntry(eip);
+		if (entry->eip == eip && page &&
+				entry->version == page->getVersion())
+		{
+			num_hits++;
+			return entry;
+		}
+		num_misses++;
+		return nullptr;
+	}
+
+	/// Insert a decoded instruction in the cache, replacing any previous
+	/// instruction mapped into the same entry. The instruction must be
+	/// fully contained in page \a page. Instructions that failed to decode
+	/// are not inserted.
+	void Insert(const Instruction &inst, ExecuteInstFn execute_inst_fn,
+			const mem::Memory::Page *page);
+
+	/// Invalidate all entries
+	void Flush();
+
+	/// Return the number of lookups that hit the cache
+	long long getNumHits() const { return num_hits; }
+
+	/// Return the number of lookups that missed the cache
+	long long getNumMisses() const { return num_misses; }
+};
+
+
+}  // namespace x86
+
+#endif
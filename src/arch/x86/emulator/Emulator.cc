@@ -17,6 +17,10 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
+
 #include <arch/x86/disassembler/Disassembler.h>
 #include <lib/esim/Engine.h>
 
@@ -35,6 +39,18 @@ std::string Emulator::syscall_debug_file;
 
 long long Emulator::max_instructions;
 
+int Emulator::quantum = 1;
+
+bool Emulator::mmap_elf = false;
+
+int Emulator::num_threads = 1;
+
+std::string Emulator::bbv_file;
+long long Emulator::bbv_interval = 100000000;
+
+const unsigned Emulator::CheckpointMagic;
+const unsigned Emulator::CheckpointVersion;
+
 std::unique_ptr<Emulator> Emulator::instance;
 
 misc::Debug Emulator::call_debug;
@@ -43,6 +59,9 @@ misc::Debug Emulator::isa_debug;
 misc::Debug Emulator::loader_debug;
 misc::Debug Emulator::syscall_debug;
 
+thread_local long long *Emulator::thread_num_instructions;
+thread_local long long Emulator::ThreadPool::num_instructions;
+
 
 void Emulator::RegisterOptions()
 {
@@ -91,11 +110,78 @@ void Emulator::RegisterOptions()
 			"instructions. On x86 detailed simulation, it is given as "
 			"the number of committed (non-speculative) instructions. "
 			"A value of 0 means no limit.");
+
+	// Option --x86-quantum <number>
+	command_line->RegisterInt32("--x86-quantum <number> (default = 1)",
+			quantum,
+			"Maximum number of x86 instructions emulated in a row for "
+			"each running context in every iteration of the "
+			"functional emulation loop. Values greater than 1 enable "
+			"a faster emulation mode, where sequences of instructions "
+			"are decoded once and run without intermediate "
+			"bookkeeping. Contexts are interleaved at a coarser "
+			"granularity, and signals are delivered with a delay of "
+			"up to this number of instructions. This option has no "
+			"effect on x86 detailed simulation.");
+
+	// Option --x86-mmap-elf
+	command_line->RegisterBool("--x86-mmap-elf",
+			mmap_elf,
+			"Back the read-only segments of program binaries (code "
+			"and constant data) with a memory mapping of the binary "
+			"file in the host, instead of copying them into the "
+			"guest memory. Pages are copied only when first written. "
+			"This reduces loading time and host memory usage when "
+			"running large binaries or many copies of a program.");
+
+	// Option --x86-emu-threads <num>
+	command_line->RegisterInt32("--x86-emu-threads <num> (default = 1)",
+			num_threads,
+			"Number of host threads running independent contexts in "
+			"parallel during x86 functional simulation. Contexts "
+			"sharing their memory image run on the same host thread, "
+			"and system calls touching state shared with other "
+			"contexts (e.g., futex, clone) are executed on the main "
+			"thread between quanta. This option is most effective "
+			"combined with a large '--x86-quantum', and is ignored "
+			"when x86 debug traces are dumped.");
+
+	// Option --x86-bbv <file>
+	command_line->RegisterString("--x86-bbv <file>", bbv_file,
+			"Dump the basic block vectors of the execution into the "
+			"given file, one line per interval of instructions, in "
+			"the format read by the SimPoint tool. The vectors "
+			"cover the instructions of all contexts. Use option "
+			"'--x86-bbv-interval' to set the interval length.");
+
+	// Option --x86-bbv-interval <num>
+	command_line->RegisterInt64("--x86-bbv-interval <num> "
+			"(default = 100000000)",
+			bbv_interval,
+			"Number of instructions in each interval of the basic "
+			"block vectors dumped with '--x86-bbv'. The same length "
+			"is used for the simulation points given with "
+			"'--x86-simpoints'.");
 }
 
 
 void Emulator::ProcessOptions()
 {
+	// Quantum
+	if (quantum < 1)
+		throw Error(misc::fmt("Invalid value for --x86-quantum: %d",
+				quantum));
+
+	// Host threads
+	if (num_threads < 1)
+		throw Error(misc::fmt("Invalid value for --x86-emu-threads: %d",
+				num_threads));
+
+	// Basic block vectors
+	if (bbv_interval < 1)
+		throw Error(misc::fmt("Invalid value for --x86-bbv-interval: "
+				"%lld", bbv_interval));
+
 	// Debuggers
 	call_debug.setPath(call_debug_file);
 	context_debug.setPath(context_debug_file);
@@ -233,6 +319,15 @@ Emulator *Emulator::getInstance()
 }
 
 
+Emulator::Emulator() : comm::Emulator("x86")
+{
+	// Basic block vector profiler
+	if (!bbv_file.empty())
+		bbv_profiler = misc::new_unique<BbvProfiler>(bbv_file,
+				bbv_interval);
+}
+
+
 Context *Emulator::newContext()
 {
 	// Create context and add to context list
@@ -421,6 +516,52 @@ void Emulator::ProcessEvents()
 }
 
 
+void Emulator::ExecuteGroup(const std::vector<Context *> &group)
+{
+	// Contexts sharing memory run one after another, as in the serial
+	// emulation loop. A context stops when it reaches a system call that
+	// must be executed on the main thread.
+	for (Context *context : group)
+	{
+		int count = 0;
+		while (count < quantum &&
+				context->getState(Context::StateRunning) &&
+				!context->isSharedSyscallPending())
+			count += context->ExecuteBlock(quantum - count);
+	}
+}
+
+
+void Emulator::ThreadPool::BeginBatch()
+{
+	// Count instructions locally while executing the batch
+	num_instructions = 0;
+	thread_num_instructions = &num_instructions;
+}
+
+
+void Emulator::ThreadPool::ExecuteTask(int index)
+{
+	emulator->ExecuteGroup(groups[index]);
+}
+
+
+void Emulator::ThreadPool::EndBatch()
+{
+	// Merge statistics
+	thread_num_instructions = nullptr;
+	emulator->num_instructions += num_instructions;
+}
+
+
+void Emulator::ExecuteGroups(const std::vector<std::vector<Context *>> &groups)
+{
+	thread_pool.groups = groups;
+	thread_pool.Run(groups.size(), num_threads);
+	thread_pool.groups.clear();
+}
+
+
 bool Emulator::Run()
 {
 	// Stop if there is no more contexts
@@ -435,18 +576,8 @@ bool Emulator::Run()
 	if (esim->hasFinished())
 		return true;
 
-	// Run an instruction from every running context. During execution, a
-	// context can remove itself from the running list, so traversing the
-	// running list is not an option.
-	for (auto &context : contexts)
-	{
-		// Skip if not running
-		if (!context->getState(Context::StateRunning))
-			continue;
-
-		// Run one iteration
-		context->Execute();
-	}
+	// Run a quantum of instructions of all running contexts
+	RunContexts();
 
 	// Free finished contexts
 	while (finished_contexts.size())
@@ -459,5 +590,165 @@ bool Emulator::Run()
 	return true;
 }
 
+
+void Emulator::RunContexts()
+{
+	// Pause at the instruction requested with setStopInstruction()
+	if (stop_instruction && num_instructions >= stop_instruction)
+		return;
+
+	// Number of instructions that cannot be exceeded in this iteration
+	long long limit = max_instructions;
+	if (stop_instruction && (!limit || stop_instruction < limit))
+		limit = stop_instruction;
+
+	// Group running contexts by memory image. Groups run on multiple host
+	// threads, unless debug traces or basic block vectors are dumped,
+	// whose order would not be deterministic, or unless the full quantum
+	// of every context could exceed the maximum number of instructions.
+	std::vector<std::vector<Context *>> groups;
+	if (num_threads > 1 && !isa_debug && !call_debug &&
+			!context_debug && !syscall_debug && !bbv_profiler)
+	{
+		std::unordered_map<mem::Memory *, int> group_index;
+		for (auto &context : contexts)
+		{
+			if (!context->getState(Context::StateRunning))
+				continue;
+			auto it = group_index.emplace(context->getMemory(),
+					groups.size()).first;
+			if (it->second == (int) groups.size())
+				groups.emplace_back();
+			groups[it->second].push_back(context.get());
+		}
+		if (limit && limit - num_instructions <
+				(long long) quantum * (long long) running_contexts.size())
+			groups.clear();
+	}
+
+	// Run groups in parallel. System calls touching state shared with
+	// other contexts are then executed here, in context order.
+	if (groups.size() > 1)
+	{
+		ExecuteGroups(groups);
+		for (auto &context : contexts)
+			if (context->getState(Context::StateRunning) &&
+					context->isSharedSyscallPending())
+				context->Execute();
+	}
+
+	// Otherwise, run a quantum of instructions from every running context.
+	// During execution, a context can remove itself from the running
+	// list, so traversing the running list is not an option.
+	else
+	{
+		for (auto &context : contexts)
+		{
+			// Skip if not running
+			if (!context->getState(Context::StateRunning))
+				continue;
+
+			// Stop point reached by a previous context
+			if (stop_instruction && num_instructions >=
+					stop_instruction)
+				break;
+
+			// Run one iteration. With a quantum larger than one, do
+			// not exceed the maximum number of instructions.
+			int max_quantum = quantum;
+			if (quantum > 1 && limit &&
+					limit - num_instructions < quantum)
+				max_quantum = std::max(1LL, limit -
+						num_instructions);
+			int count = 0;
+			while (count < max_quantum &&
+					context->getState(Context::StateRunning))
+				count += context->ExecuteBlock(max_quantum -
+						count);
+		}
+	}
+}
+
+
+void Emulator::SaveCheckpoint(const std::string &path)
+{
+	// Open file
+	std::ofstream f(path, std::ios::binary);
+	if (!f)
+		throw Error(misc::fmt("%s: Cannot create checkpoint file",
+				path.c_str()));
+
+	// Header
+	misc::WriteBinary(f, CheckpointMagic);
+	misc::WriteBinary(f, CheckpointVersion);
+
+	// Emulator state
+	misc::WriteBinary(f, num_instructions);
+	misc::WriteBinary(f, futex_sleep_count);
+
+	// Contexts, in order of creation, so that parent contexts are always
+	// loaded before their children.
+	Context::CheckpointObjects objects;
+	misc::WriteBinary(f, (unsigned) contexts.size());
+	for (auto &context : contexts)
+		context->SaveCheckpoint(f, objects);
+
+	// Check errors
+	f.close();
+	if (!f)
+		throw Error(misc::fmt("%s: Error writing checkpoint file",
+				path.c_str()));
+
+	// Debug
+	context_debug << misc::fmt("Checkpoint saved to %s at instruction "
+			"%lld\n", path.c_str(), num_instructions);
+}
+
+
+void Emulator::LoadCheckpoint(const std::string &path)
+{
+	// No context must exist
+	if (contexts.size())
+		throw misc::Panic("Checkpoint loaded with existing contexts");
+
+	// Open file
+	std::ifstream f(path, std::ios::binary);
+	if (!f)
+		throw Error(misc::fmt("%s: Cannot open checkpoint file",
+				path.c_str()));
+
+	// Header
+	unsigned magic;
+	unsigned version;
+	misc::ReadBinary(f, magic);
+	misc::ReadBinary(f, version);
+	if (magic != CheckpointMagic)
+		throw Error(misc::fmt("%s: Not a valid checkpoint file",
+				path.c_str()));
+	if (version != CheckpointVersion)
+		throw Error(misc::fmt("%s: Unsupported checkpoint version "
+				"(%u, expected %u)", path.c_str(), version,
+				CheckpointVersion));
+
+	// Emulator state
+	misc::ReadBinary(f, num_instructions);
+	misc::ReadBinary(f, futex_sleep_count);
+
+	// Contexts
+	Context::CheckpointObjects objects;
+	unsigned num_contexts;
+	misc::ReadBinary(f, num_contexts);
+	for (unsigned i = 0; i < num_contexts; i++)
+	{
+		Context *context = newContext();
+		context->LoadCheckpoint(f, objects);
+	}
+
+	// Debug
+	context_debug << misc::fmt("Checkpoint loaded from %s at instruction "
+			"%lld\n", path.c_str(), num_instructions);
+}
+
+
 } // namespace x86
 
@@ -22,12 +22,16 @@
 
 #include <pthread.h>
 
+#include <vector>
+
 #include <arch/common/Arch.h>
 #include <arch/common/Emulator.h>
 #include <lib/cpp/CommandLine.h>
 #include <lib/cpp/Debug.h>
 #include <lib/cpp/Error.h>
+#include <lib/cpp/WorkerPool.h>
 
+#include "BbvProfiler.h"
 #include "Context.h"
 
 
@@ -68,6 +72,26 @@ class Emulator : public comm::Emulator
 	// Maximum number of instructions
 	static long long max_instructions;
 
+	// Maximum number of instructions emulated for each context in one
+	// iteration of the functional emulation loop
+	static int quantum;
+
+	// Back read-only segments of program binaries with host mappings
+	static bool mmap_elf;
+
+	// Number of host threads executing independent contexts in parallel
+	// in the functional emulation loop
+	static int num_threads;
+
+	// Output file for basic block vectors, and number of instructions in
+	// each interval
+	static std::string bbv_file;
+	static long long bbv_interval;
+
+	// Identifier and version of checkpoint files
+	static const unsigned CheckpointMagic = 0x4b43324d;  // "M2CK"
+	static const unsigned CheckpointVersion = 2;
+
 	// Unique instance of singleton
 	static std::unique_ptr<Emulator> instance;
 
@@ -110,6 +134,61 @@ class Emulator : public comm::Emulator
 	// for FIFO wakeups.
 	long long futex_sleep_count = 0;
 
+	// Profiler of basic block vectors, or null if not active
+	std::unique_ptr<BbvProfiler> bbv_profiler;
+
+	// Instruction count at which the emulation loop pauses, or 0 if none
+	long long stop_instruction = 0;
+
+
+
+
+	//
+	// Parallel execution of contexts
+	//
+
+	// Instruction counter of the current host thread, or null when
+	// instructions are counted directly in the emulator statistics
+	static thread_local long long *thread_num_instructions;
+
+	// Pool of host threads running groups of contexts, one group per
+	// task. Contexts sharing a memory image are placed in the same group.
+	class ThreadPool : public misc::WorkerPool
+	{
+		// Emulator owning the pool
+		Emulator *emulator;
+
+		// Instruction counter of the current host thread while it
+		// executes a batch
+		static thread_local long long num_instructions;
+
+		void ExecuteTask(int index) override;
+		void BeginBatch() override;
+		void EndBatch() override;
+
+	public:
+
+		/// Groups of contexts of the batch being executed
+		std::vector<std::vector<Context *>> groups;
+
+		/// Constructor
+		ThreadPool(Emulator *emulator) : emulator(emulator)
+		{
+		}
+	};
+
+	// Host threads executing independent contexts in parallel
+	ThreadPool thread_pool{this};
+
+	// Execute a batch of context groups on the thread pool, returning
+	// when all of them finish their quantum
+	void ExecuteGroups(const std::vector<std::vector<Context *>> &groups);
+
+	// Run a quantum of instructions of all contexts in a group. Contexts
+	// stop early before system calls touching state shared with other
+	// contexts.
+	void ExecuteGroup(const std::vector<Context *> &group);
+
 
 public:
 
@@ -132,6 +211,39 @@ public:
 	/// Return the maximum number of instructions, as set up by the user
 	static long long getMaxInstructions() { return max_instructions; }
 
+	/// Return the maximum number of instructions emulated for each context
+	/// in one iteration of the functional emulation loop.
+	static int getQuantum() { return quantum; }
+
+	/// Set the maximum number of instructions emulated for each context
+	/// in one iteration of the functional emulation loop, as given by
+	/// option '--x86-quantum'.
+	static void setQuantum(int quantum) { Emulator::quantum = quantum; }
+
+	/// Return whether read-only segments of program binaries are backed
+	/// by host memory mappings of the binary files.
+	static bool getMmapElf() { return mmap_elf; }
+
+	/// Return the number of host threads executing independent contexts
+	/// in parallel in the functional emulation loop.
+	static int getNumThreads() { return num_threads; }
+
+	/// Set the number of host threads executing independent contexts in
+	/// parallel, as given by option '--x86-emu-threads'. It must be set
+	/// before the first iteration of the functional emulation loop.
+	static void setNumThreads(int num_threads)
+	{
+		Emulator::num_threads = num_threads;
+	}
+
+	/// Return whether the caller runs on a host thread of the parallel
+	/// functional emulation loop.
+	static bool isHostThread() { return thread_num_instructions; }
+
+	/// Return the number of instructions in each interval of the basic
+	/// block vector profile, also used as the length of simulation points.
+	static long long getBbvInterval() { return bbv_interval; }
+
 	/// Debugger for function calls
 	static misc::Debug call_debug;
 
@@ -155,7 +267,7 @@ public:
 	//
 
 	/// Constructor
-	Emulator() : comm::Emulator("x86") { }
+	Emulator();
 
 	/// Create a new context associated with the emulator. The context is
 	/// inserted in the main emulator context list. Its state is set to
@@ -178,6 +290,31 @@ public:
 			const std::string &stdin_file_name = "",
 			const std::string &stdout_file_name = "");
 
+	/// Return the profiler of basic block vectors, or `nullptr` if
+	/// option '--x86-bbv' was not given.
+	BbvProfiler *getBbvProfiler() const { return bbv_profiler.get(); }
+
+	/// Pause the functional emulation loop once exactly \a num_instructions
+	/// instructions have been emulated. The quantum of the last contexts
+	/// run is shortened to stop at that point, and Run() does not emulate
+	/// any further instruction until the stop point is changed or
+	/// cleared with a value of 0.
+	void setStopInstruction(long long num_instructions)
+	{
+		stop_instruction = num_instructions;
+	}
+
+	/// Return the instruction count set with setStopInstruction()
+	long long getStopInstruction() const { return stop_instruction; }
+
+	/// Increment the number of emulated instructions. Host threads
+	/// count them locally and merge them when their batch completes.
+	void incNumInstructions()
+	{
+		++(thread_num_instructions ? *thread_num_instructions :
+				num_instructions);
+	}
+
 	/// Return a unique process ID. Contexts can call this function when
 	/// created to obtain their unique identifier.
 	int getPid() { return pid++; }
@@ -212,6 +349,30 @@ public:
 	/// emulation, and \c false if all contexts finished execution.
 	bool Run();
 
+	/// Run a quantum of instructions of every running context, as done
+	/// in each iteration of the emulation loop by Run(), without going
+	/// past the instruction set with setStopInstruction(). Finished
+	/// contexts are not freed, and suspended contexts are not processed.
+	void RunContexts();
+
+	/// Save the state of the emulator and all its contexts into the
+	/// checkpoint file given in \a path. Suspended contexts are saved
+	/// as described in Context::SaveCheckpoint().
+	///
+	/// \throw
+	///	An x86::Error is thrown if the file cannot be created or if
+	///	any context holds state that cannot be saved.
+	void SaveCheckpoint(const std::string &path);
+
+	/// Create the contexts saved in the checkpoint file given in \a path
+	/// and restore the emulator state. This function is used instead of
+	/// LoadProgram(), and no context must exist when it is invoked.
+	///
+	/// \throw
+	///	An x86::Error is thrown if the file cannot be opened or is not
+	///	a valid checkpoint.
+	void LoadCheckpoint(const std::string &path);
+
 
 
 
@@ -76,6 +76,9 @@ public:
 
 	/// Return the extended value as a sequence of 10 bytes
 	unsigned char *getValue() { return x; }
+
+	/// Return the extended value as a sequence of 10 constant bytes
+	const unsigned char *getValue() const { return x; }
 };
 
 
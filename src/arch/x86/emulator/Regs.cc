@@ -20,6 +20,7 @@
 #include <cstring>
 
 #include <arch/x86/disassembler/Instruction.h>
+#include <lib/cpp/Error.h>
 #include <lib/cpp/Misc.h>
 #include <lib/cpp/String.h>
 
@@ -237,5 +238,70 @@ void Regs::Dump(std::ostream &os) const
 }
 
 
+void Regs::SaveCheckpoint(std::ostream &os) const
+{
+	// Main registers, with the size given in the register info table
+	for (int reg = Instruction::RegEax; reg <= Instruction::RegEdi; reg++)
+		misc::WriteBinary(os, Read(reg));
+	for (int reg = Instruction::RegEs; reg <= Instruction::RegGs; reg++)
+		misc::WriteBinary(os, (unsigned short) Read(reg));
+	misc::WriteBinary(os, eip);
+	misc::WriteBinary(os, eflags);
+
+	// Floating-point stack
+	for (int i = 0; i < 8; i++)
+	{
+		os.write((const char *) fpu_stack[i].value.getValue(), 10);
+		misc::WriteBinary(os, fpu_stack[i].valid);
+	}
+	misc::WriteBinary(os, fpu_top);
+	misc::WriteBinary(os, fpu_code);
+	misc::WriteBinary(os, fpu_ctrl);
+
+	// XMM registers
+	for (int i = 0; i < 8; i++)
+		for (int j = 0; j < 4; j++)
+			misc::WriteBinary(os, xmm[i].getAsUInt(j));
+}
+
+
+void Regs::LoadCheckpoint(std::istream &is)
+{
+	// Main registers
+	for (int reg = Instruction::RegEax; reg <= Instruction::RegEdi; reg++)
+	{
+		unsigned value;
+		misc::ReadBinary(is, value);
+		Write(reg, value);
+	}
+	for (int reg = Instruction::RegEs; reg <= Instruction::RegGs; reg++)
+	{
+		unsigned short value;
+		misc::ReadBinary(is, value);
+		Write(reg, value);
+	}
+	misc::ReadBinary(is, eip);
+	misc::ReadBinary(is, eflags);
+
+	// Floating-point stack
+	for (int i = 0; i < 8; i++)
+	{
+		misc::ReadBinary(is, (char *) fpu_stack[i].value.getValue(), 10);
+		misc::ReadBinary(is, fpu_stack[i].valid);
+	}
+	misc::ReadBinary(is, fpu_top);
+	misc::ReadBinary(is, fpu_code);
+	misc::ReadBinary(is, fpu_ctrl);
+	if (!misc::inRange(fpu_top, 0, 7))
+		throw misc::Error(misc::fmt("Invalid FPU stack top in "
+				"checkpoint (%d)", fpu_top));
+
+	// XMM registers
+	for (int i = 0; i < 8; i++)
+		for (int j = 0; j < 4; j++)
+			misc::ReadBinary(is, xmm[i].getAsUInt()[j]);
+}
+
+
 }  // namespace x86
 
@@ -441,6 +441,15 @@ public:
 	/// output stream (or standard output if argument \a os is omitted).
 	void DumpFpuStack(std::ostream &os = std::cout) const;
 
+	/// Save the register file into a binary checkpoint stream. Registers
+	/// are saved one by one, so that the format does not depend on the
+	/// layout of the class in memory.
+	void SaveCheckpoint(std::ostream &os) const;
+
+	/// Load the register file from a binary checkpoint stream, as saved
+	/// by SaveCheckpoint().
+	void LoadCheckpoint(std::istream &is);
+
 	/// Operator \c << overloaded, invoking function Dump()
 	friend std::ostream &operator<<(std::ostream &os, const Regs &regs) {
 		regs.Dump(os);
@@ -122,6 +122,57 @@ void SignalHandler::WriteToMemory(mem::Memory *memory, unsigned address)
 }
 
 
+void SignalHandler::SaveCheckpoint(std::ostream &os) const
+{
+	misc::WriteBinary(os, handler);
+	misc::WriteBinary(os, flags);
+	misc::WriteBinary(os, restorer);
+	mask.SaveCheckpoint(os);
+}
+
+
+void SignalHandler::LoadCheckpoint(std::istream &is)
+{
+	misc::ReadBinary(is, handler);
+	misc::ReadBinary(is, flags);
+	misc::ReadBinary(is, restorer);
+	mask.LoadCheckpoint(is);
+}
+
+
+void SignalMaskTable::SaveCheckpoint(std::ostream &os) const
+{
+	pending.SaveCheckpoint(os);
+	blocked.SaveCheckpoint(os);
+	backup.SaveCheckpoint(os);
+	misc::WriteBinary(os, ret_code_ptr);
+
+	// Backup of register file, present while running a signal handler
+	misc::WriteBinary(os, (bool) regs);
+	if (regs)
+		regs->SaveCheckpoint(os);
+}
+
+
+void SignalMaskTable::LoadCheckpoint(std::istream &is)
+{
+	pending.LoadCheckpoint(is);
+	blocked.LoadCheckpoint(is);
+	backup.LoadCheckpoint(is);
+	misc::ReadBinary(is, ret_code_ptr);
+
+	// Backup of register file
+	bool has_regs;
+	misc::ReadBinary(is, has_regs);
+	regs.reset();
+	if (has_regs)
+	{
+		regs.reset(new Regs());
+		regs->LoadCheckpoint(is);
+	}
+}
+
+
 void SignalHandler::Dump(std::ostream &os) const
 {
 	os << misc::fmt("handler = 0x%x, ", handler)
@@ -23,6 +23,7 @@
 #include <cassert>
 
 #include <lib/cpp/Bitmap.h>
+#include <lib/cpp/Misc.h>
 #include <lib/cpp/String.h>
 #include <memory/Memory.h>
 
@@ -201,6 +202,18 @@ public:
 		assert(bitmap.getSizeInBytes() == 8);
 		memory->Write(address, 8, bitmap.getBuffer());
 	}
+
+	/// Save signal set into a binary checkpoint stream
+	void SaveCheckpoint(std::ostream &os) const {
+		assert(bitmap.getSizeInBytes() == 8);
+		os.write(bitmap.getBuffer(), 8);
+	}
+
+	/// Load signal set from a binary checkpoint stream
+	void LoadCheckpoint(std::istream &is) {
+		assert(bitmap.getSizeInBytes() == 8);
+		misc::ReadBinary(is, bitmap.getBuffer(), 8);
+	}
 };
 
 
@@ -266,6 +279,12 @@ public:
 
 	/// Return address where the return code can be found.
 	unsigned getRetCodePtr() const { return ret_code_ptr; }
+
+	/// Save the table into a binary checkpoint stream
+	void SaveCheckpoint(std::ostream &os) const;
+
+	/// Load the table from a binary checkpoint stream
+	void LoadCheckpoint(std::istream &is);
 };
 
 
@@ -308,6 +327,12 @@ public:
 
 	/// Write the content of the signal handler to memory
 	void WriteToMemory(mem::Memory *memory, unsigned address);
+
+	/// Save the signal handler into a binary checkpoint stream
+	void SaveCheckpoint(std::ostream &os) const;
+
+	/// Load the signal handler from a binary checkpoint stream
+	void LoadCheckpoint(std::istream &is);
 };
 
 
@@ -326,6 +351,18 @@ public:
 		assert(misc::inRange(sig, 1, 64));
 		return &signal_handler[sig - 1];
 	}
+
+	/// Save the table into a binary checkpoint stream
+	void SaveCheckpoint(std::ostream &os) const {
+		for (auto &handler : signal_handler)
+			handler.SaveCheckpoint(os);
+	}
+
+	/// Load the table from a binary checkpoint stream
+	void LoadCheckpoint(std::istream &is) {
+		for (auto &handler : signal_handler)
+			handler.LoadCheckpoint(is);
+	}
 };
 
 
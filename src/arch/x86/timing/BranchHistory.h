@@ -0,0 +1,144 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_BRANCH_HISTORY_H
+#define ARCH_X86_TIMING_BRANCH_HISTORY_H
+
+#include <cassert>
+#include <vector>
+
+
+namespace x86
+{
+
+/// Global history of the last branches fetched by a hardware thread, shared
+/// by the TAGE, perceptron, and indirect target predictors. For each branch,
+/// the history records one outcome bit, and one address bit in a separate
+/// path history.
+class BranchHistory
+{
+	// Circular buffer of outcome bits. The number of entries is a power
+	// of 2.
+	std::vector<unsigned char> bits;
+
+	// Position of the most recent outcome in the buffer
+	int head = 0;
+
+	// Path history, with the address bit of the most recent branch in the
+	// least significant position
+	unsigned path = 0;
+
+public:
+
+	/// Constructor
+	///
+	/// \param length
+	///	Number of outcomes remembered by the history. Folded histories
+	///	of a given length require one more outcome than their length.
+	///
+	BranchHistory(int length)
+	{
+		int size = 1;
+		while (size < length)
+			size <<= 1;
+		bits.resize(size);
+	}
+
+	/// Return the outcome of the \a index-th most recent branch, where 0
+	/// is the most recent one.
+	unsigned operator[](int index) const
+	{
+		assert(index >= 0 && index < (int) bits.size());
+		return bits[(head + index) & (bits.size() - 1)];
+	}
+
+	/// Return the path history
+	unsigned getPath() const { return path; }
+
+	/// Record the outcome of a new branch
+	///
+	/// \param outcome
+	///	Outcome bit, usually the branch direction.
+	///
+	/// \param address
+	///	Address bit recorded in the path history.
+	///
+	void Push(bool outcome, bool address)
+	{
+		head = (head - 1) & (bits.size() - 1);
+		bits[head] = outcome;
+		path = (path << 1) | address;
+	}
+};
+
+
+/// The outcomes of the last branches in a history, folded with XOR into a
+/// smaller number of bits. The folded value is updated in constant time
+/// after every push to the history, and is used to hash long histories
+/// into table indices and tags.
+class FoldedHistory
+{
+	// Folded value
+	unsigned value = 0;
+
+	// Number of outcomes folded
+	int length;
+
+	// Number of bits of the folded value
+	int folded_length;
+
+	// Position in the folded value of the outcome leaving the history
+	int outpoint;
+
+public:
+
+	/// Constructor
+	///
+	/// \param length
+	///	Number of most recent outcomes folded.
+	///
+	/// \param folded_length
+	///	Number of bits of the folded value, between 1 and 31.
+	///
+	FoldedHistory(int length, int folded_length) :
+			length(length),
+			folded_length(folded_length),
+			outpoint(length % folded_length)
+	{
+		assert(folded_length > 0 && folded_length < 32);
+	}
+
+	/// Return the folded value
+	unsigned get() const { return value; }
+
+	/// Update the folded value after an outcome was pushed to the given
+	/// history, which must remember more outcomes than folded.
+	void Update(const BranchHistory &history)
+	{
+		value = (value << 1) | history[0];
+		value ^= history[length] << outpoint;
+		value ^= value >> folded_length;
+		value &= (1u << folded_length) - 1;
+	}
+};
+
+
+}  // namespace x86
+
+#endif
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include <lib/cpp/Misc.h>
 
 #include "BranchPredictor.h"
@@ -28,6 +30,7 @@ namespace x86
 BranchPredictor::Kind BranchPredictor::kind;
 int BranchPredictor::btb_num_sets;
 int BranchPredictor::btb_num_ways;
+bool BranchPredictor::btb_keep_taken_target;
 int BranchPredictor::ras_size;
 int BranchPredictor::bimod_size;
 int BranchPredictor::choice_size;
@@ -43,7 +46,9 @@ misc::StringMap BranchPredictor::KindMap =
 	{"NotTaken", KindNottaken},
 	{"Bimodal", KindBimod},
 	{"TwoLevel", KindTwoLevel},
-	{"Combined", KindCombined}
+	{"Combined", KindCombined},
+	{"TAGE", KindTage},
+	{"Perceptron", KindPerceptron}
 };
 
 BranchPredictor::BranchPredictor(const std::string &name)
@@ -78,6 +83,33 @@ BranchPredictor::BranchPredictor(const std::string &name)
 			choice[i] = 2;
 	}
 
+	// TAGE predictor
+	int history_length = 0;
+	if (kind == KindTage)
+	{
+		tage = misc::new_unique<TagePredictor>();
+		history_length = TagePredictor::getHistoryLength();
+	}
+
+	// Perceptron predictor
+	if (kind == KindPerceptron)
+	{
+		perceptron = misc::new_unique<PerceptronPredictor>();
+		history_length = PerceptronPredictor::getHistoryLength();
+	}
+
+	// Indirect target predictor
+	if (IndirectPredictor::isPresent() && kind != KindPerfect)
+	{
+		indirect_predictor = misc::new_unique<IndirectPredictor>();
+		history_length = std::max(history_length,
+				IndirectPredictor::getHistoryLength());
+	}
+
+	// Global history shared by all of the above
+	if (history_length)
+		history = misc::new_unique<BranchHistory>(history_length);
+
 	// Allocate BTB and assign LRU counters
 	btb = misc::new_unique_array<BtbEntry>(btb_num_sets * btb_num_ways);
 	for (int i = 0; i < btb_num_sets; i++)
@@ -98,6 +130,8 @@ void BranchPredictor::ParseConfiguration(misc::IniFile *ini_file)
 	// Load branch predictor parameter
 	btb_num_sets = ini_file->ReadInt(section, "BTB.Sets", 256);
 	btb_num_ways = ini_file->ReadInt(section, "BTB.Assoc", 4);
+	btb_keep_taken_target = ini_file->ReadBool(section,
+			"BTB.KeepTakenTarget", false);
 	bimod_size = ini_file->ReadInt(section, "Bimod.Size", 1024);
 	choice_size = ini_file->ReadInt(section, "Choice.Size", 1024);
 	ras_size = ini_file->ReadInt(section, "RAS.Size", 32);
@@ -108,6 +142,11 @@ void BranchPredictor::ParseConfiguration(misc::IniFile *ini_file)
 	// Two-level branch predictor parameter
 	two_level_l2_height = 1 << two_level_history_size;
 
+	// Predictors in their own classes
+	TagePredictor::ParseConfiguration(ini_file);
+	PerceptronPredictor::ParseConfiguration(ini_file);
+	IndirectPredictor::ParseConfiguration(ini_file);
+
 	// Integrity
 	if (bimod_size & (bimod_size - 1))
 		throw Error("number of entries in bimodal precitor must be a power of 2");
@@ -132,16 +171,82 @@ void BranchPredictor::DumpConfiguration(std::ostream &os)
 	os << misc::fmt("\n***** BranchPredictor *****\n");
 	os << misc::fmt("\tBTB.Sets: %d\n", btb_num_sets);
 	os << misc::fmt("\tBTB.Assoc: %d\n", btb_num_ways);
+	os << misc::fmt("\tBTB.KeepTakenTarget: %s\n",
+			btb_keep_taken_target ? "True" : "False");
 	os << misc::fmt("\tBimod.Size: %d\n", bimod_size);
 	os << misc::fmt("\tChoice.Size: %d\n", choice_size);
 	os << misc::fmt("\tRAS.Size: %d\n", ras_size);
 	os << misc::fmt("\tTwoLevel.L1Size: %d\n", two_level_l1_size);
 	os << misc::fmt("\tTwoLevel.L2Size: %d\n", two_level_l2_size);
 	os << misc::fmt("\tTwoLevel.HistorySize: %d\n", two_level_history_size);
+	TagePredictor::DumpConfiguration(os);
+	PerceptronPredictor::DumpConfiguration(os);
+	IndirectPredictor::DumpConfiguration(os);
+}
+
+
+bool BranchPredictor::isIndirect(Uop *uop)
+{
+	// Indirect jumps and calls read their target from a register or
+	// memory, while direct ones have no input dependences.
+	Uinst *uinst = uop->getUinst();
+	return (uinst->getOpcode() == Uinst::OpcodeJump ||
+			uinst->getOpcode() == Uinst::OpcodeCall) &&
+			uinst->getIDep(0) != Uinst::DepNone;
+}
+
+
+void BranchPredictor::UpdateHistory(Uop *uop)
+{
+	// Only branches on the correct path are recorded, with the outcome
+	// known from functional simulation. Internal branches of string
+	// operations are not part of the history.
+	if (!history || uop->speculative_mode ||
+			uop->getUinst()->getOpcode() == Uinst::OpcodeIbranch)
+		return;
+
+	// Conditional branches record their direction. Indirect jumps and
+	// calls record the parity of their target instead, which lets the
+	// indirect target predictor correlate consecutive targets.
+	bool outcome = true;
+	if (!(uop->getFlags() & Uinst::FlagUncond))
+	{
+		outcome = uop->neip != uop->eip + uop->mop_size;
+	}
+	else if (isIndirect(uop))
+	{
+		unsigned parity = uop->neip ^ (uop->neip >> 16);
+		parity ^= parity >> 8;
+		parity ^= parity >> 4;
+		parity ^= parity >> 2;
+		parity ^= parity >> 1;
+		outcome = parity & 1;
+	}
+	history->Push(outcome, uop->eip & 1);
+
+	// Advance the speculative state of the loop predictor
+	if (tage && uop->tage_lookup)
+		tage->RecordOutcome(outcome, uop->tage_info);
+
+	// Update folded histories
+	if (tage)
+		tage->UpdateHistory(*history);
+	if (perceptron)
+		perceptron->UpdateHistory(*history);
+	if (indirect_predictor)
+		indirect_predictor->UpdateHistory(*history);
 }
 
 
 BranchPredictor::Prediction BranchPredictor::Lookup(Uop *uop)
+{
+	Prediction prediction = Predict(uop);
+	UpdateHistory(uop);
+	return prediction;
+}
+
+
+BranchPredictor::Prediction BranchPredictor::Predict(Uop *uop)
 {
 	// Local variable
 	Prediction prediction;
@@ -222,6 +327,24 @@ BranchPredictor::Prediction BranchPredictor::Lookup(Uop *uop)
 		uop->prediction = choice_prediction;
 	}
 
+	// TAGE
+	if (kind == KindTage)
+	{
+		uop->tage_lookup = true;
+		uop->prediction = tage->Lookup(uop->eip, *history,
+				uop->tage_info) ?
+				PredictionTaken : PredictionNotTaken;
+	}
+
+	// Perceptron
+	if (kind == KindPerceptron)
+	{
+		uop->perceptron_lookup = true;
+		uop->prediction = perceptron->Lookup(uop->eip, *history,
+				uop->perceptron_info) ?
+				PredictionTaken : PredictionNotTaken;
+	}
+
 	// Return prediction
 	assert(uop->prediction == PredictionTaken || uop->prediction == PredictionNotTaken);
 	return uop->prediction;
@@ -330,6 +453,14 @@ void BranchPredictor::Update(Uop *uop)
 		else
 			*choice_ptr = *choice_ptr + 1 > 3 ? 3 : *choice_ptr + 1;
 	}
+
+	// TAGE predictor
+	if (kind == KindTage && uop->tage_lookup)
+		tage->Update(taken, uop->tage_info);
+
+	// Perceptron predictor
+	if (kind == KindPerceptron && uop->perceptron_lookup)
+		perceptron->Update(taken, uop->perceptron_info);
 }
 
 
@@ -363,6 +494,21 @@ unsigned int BranchPredictor::LookupBtb(Uop *uop)
 		break;
 	}
 
+	// The indirect target predictor may override the target of indirect
+	// jumps and calls found in the BTB. On a BTB miss, its target is used
+	// if it comes from a confident entry, which then counts as a hit.
+	if (indirect_predictor && isIndirect(uop))
+	{
+		uop->indirect_lookup = true;
+		unsigned indirect_target = indirect_predictor->Lookup(uop->eip,
+				target, *history, uop->indirect_info);
+		if (hit || uop->indirect_info.confident)
+		{
+			target = indirect_target;
+			hit = true;
+		}
+	}
+
 	// If there was a hit, we know whether branch is a call.
 	// In this case, push return address into RAS. To avoid
 	// updates at recovery, do it only for non-spec instructions.
@@ -398,6 +544,21 @@ void BranchPredictor::UpdateBtb(Uop *uop)
 	if (kind == KindPerfect)
 		return;
 
+	// Indirect target predictor
+	if (indirect_predictor && uop->indirect_lookup)
+		indirect_predictor->Update(uop->neip, uop->indirect_info);
+
+	// Optionally, the BTB records the taken target of conditional
+	// branches also when they were not taken, so that a later taken
+	// prediction does not redirect fetch to the fall-through address.
+	// Otherwise, it records the next address of every branch.
+	unsigned target = uop->neip;
+	if (btb_keep_taken_target &&
+			!(uop->getFlags() & Uinst::FlagUncond) &&
+			uop->neip == uop->eip + uop->mop_size &&
+			uop->target_neip)
+		target = uop->target_neip;
+
 	// Search address in BTB
 	int set = uop->eip & (btb_num_sets - 1);
 	for (int way = 0; way < btb_num_ways; way++)
@@ -421,7 +582,7 @@ void BranchPredictor::UpdateBtb(Uop *uop)
 			if (entry->counter < 0) {
 				entry->counter = btb_num_ways - 1;
 				entry->source = uop->eip;
-				entry->target = uop->neip;
+				entry->target = target;
 			}
 		}
 	}
@@ -436,7 +597,7 @@ void BranchPredictor::UpdateBtb(Uop *uop)
 				entry->counter--;
 		}
 		found_entry->counter = btb_num_ways - 1;
-		found_entry->target = uop->neip;
+		found_entry->target = target;
 	}
 }
 
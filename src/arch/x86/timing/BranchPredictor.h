@@ -20,12 +20,18 @@
 #ifndef ARCH_X86_TIMING_BRANCH_PREDICTOR_H
 #define ARCH_X86_TIMING_BRANCH_PREDICTOR_H
 
+#include <memory>
 #include <string>
 
 #include <arch/x86/emulator/Uinst.h>
 #include <lib/cpp/Error.h>
 #include <lib/cpp/IniFile.h>
 
+#include "BranchHistory.h"
+#include "IndirectPredictor.h"
+#include "PerceptronPredictor.h"
+#include "TagePredictor.h"
+
 
 namespace x86
 {
@@ -54,7 +60,9 @@ public:
 		KindNottaken,
 		KindBimod,
 		KindTwoLevel,
-		KindCombined
+		KindCombined,
+		KindTage,
+		KindPerceptron
 	};
 
 	/// string map of branch predictor kind
@@ -75,6 +83,10 @@ private:
 	// Associativity of the BTB
 	static int btb_num_ways;
 
+	// Keep the taken target of conditional branches in the BTB when they
+	// are not taken
+	static bool btb_keep_taken_target;
+
 	// Size of the return address stack
 	static int ras_size;
 
@@ -138,10 +150,34 @@ private:
 	//   2,3 - Use two-level adaptive predictor
 	std::unique_ptr<char[]> choice;
 
+	// Global history of the branches on the correct path, used by the
+	// TAGE, perceptron, and indirect target predictors
+	std::unique_ptr<BranchHistory> history;
+
+	// TAGE predictor
+	std::unique_ptr<TagePredictor> tage;
+
+	// Perceptron predictor
+	std::unique_ptr<PerceptronPredictor> perceptron;
+
+	// Indirect target predictor
+	std::unique_ptr<IndirectPredictor> indirect_predictor;
+
 	// Stats 
 	long long accesses = 0;
 	long long hits = 0;
 
+	// Return whether the uop is an indirect jump or call
+	static bool isIndirect(Uop *uop);
+
+	// Predict the direction of a branch, recording in the uop the
+	// information needed to update the predictor at commit.
+	Prediction Predict(Uop *uop);
+
+	// Push the actual outcome of a branch on the correct path into the
+	// global history
+	void UpdateHistory(Uop *uop);
+
 public:
 
 	//
@@ -171,6 +207,8 @@ public:
 
 	static int getBtbNumWays() { return btb_num_ways; }
 
+	static bool getBtbKeepTakenTarget() { return btb_keep_taken_target; }
+
 	static int getRasSize() { return ras_size; }
 
 	static int getBimodSize() { return bimod_size; }
@@ -212,7 +250,11 @@ public:
 
 	int getChoiceStatus(int index) const { return choice[index]; }
 
-	/// Return prediction for an address (0=not taken, 1=taken)
+	/// Return prediction for an address (0=not taken, 1=taken). The
+	/// global history used by the TAGE, perceptron, and indirect target
+	/// predictors is updated right after the prediction with the actual
+	/// outcome of branches on the correct path, which models a
+	/// speculative history repaired on mispredictions.
 	///
 	/// \param uop
 	/// 	Micro-instruction with information used to read the branch
@@ -250,7 +292,8 @@ public:
 	/// Lookup BTB. If it contains the uop address, return target. The BTB
 	/// also contains information about the type of branch, i.e., jump,
 	/// call, ret, or conditional. If instruction is call or ret, access RAS
-	/// instead of BTB.
+	/// instead of BTB. For indirect jumps and calls, the target of a BTB
+	/// hit may be overridden by the indirect target predictor.
 	///
 	/// \param uop
 	/// 	Micro-instruction capturing all the information related with the
@@ -0,0 +1,115 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "CircularQueue.h"
+#include "Uop.h"
+
+
+namespace x86
+{
+
+CircularQueue::CircularQueue(int capacity, int Uop::*index_field) :
+		index_field(index_field)
+{
+	// Number of slots is the power of 2 equal or greater than twice the
+	// capacity.
+	int num_slots = 1;
+	while (num_slots < capacity * 2)
+		num_slots <<= 1;
+	slots.resize(num_slots);
+}
+
+
+void CircularQueue::Relocate(int num_slots)
+{
+	// Move uops into the new buffer in order
+	std::vector<std::shared_ptr<Uop>> new_slots(num_slots);
+	int index = 0;
+	int slot = head;
+	for (int i = 0; i < span; i++)
+	{
+		if (slots[slot])
+		{
+			slots[slot].get()->*index_field = index;
+			new_slots[index] = std::move(slots[slot]);
+			index++;
+		}
+		slot = getNextSlot(slot);
+	}
+
+	// Replace buffer
+	assert(index == num_uops);
+	slots.swap(new_slots);
+	head = 0;
+	span = num_uops;
+}
+
+
+const std::shared_ptr<Uop> &CircularQueue::get(Uop *uop) const
+{
+	int slot = uop->*index_field;
+	assert(slot >= 0 && slot < (int) slots.size());
+	assert(slots[slot].get() == uop);
+	return slots[slot];
+}
+
+
+void CircularQueue::push_back(std::shared_ptr<Uop> uop)
+{
+	// If the buffer is full, compact it to remove holes, or grow it if
+	// there are no holes.
+	int num_slots = slots.size();
+	if (span == num_slots)
+		Relocate(num_uops == num_slots ? num_slots * 2 : num_slots);
+
+	// Insert at the tail
+	int slot = (head + span) & (slots.size() - 1);
+	assert(!slots[slot]);
+	uop.get()->*index_field = slot;
+	slots[slot] = std::move(uop);
+	span++;
+	num_uops++;
+}
+
+
+void CircularQueue::erase(Uop *uop)
+{
+	// Free the slot
+	int slot = uop->*index_field;
+	assert(slot >= 0 && slot < (int) slots.size());
+	assert(slots[slot].get() == uop);
+	uop->*index_field = -1;
+	num_uops--;
+
+	// Release the uop. This may free it, so it is not accessed anymore.
+	slots[slot] = nullptr;
+
+	// Reclaim holes at the head and at the tail of the queue
+	int num_slots = slots.size();
+	while (span && !slots[head])
+	{
+		head = getNextSlot(head);
+		span--;
+	}
+	while (span && !slots[(head + span - 1) & (num_slots - 1)])
+		span--;
+}
+
+
+}  // namespace x86
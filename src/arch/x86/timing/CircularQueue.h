@@ -0,0 +1,200 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_CIRCULAR_QUEUE_H
+#define ARCH_X86_TIMING_CIRCULAR_QUEUE_H
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+
+namespace x86
+{
+
+// Forward declarations
+class Uop;
+
+
+/// Queue of uops used to model the pipeline queues of a hardware thread,
+/// implemented as a circular buffer. Uops are inserted at the tail, and can
+/// be removed from any position. The slot occupied by a uop is recorded in
+/// one of its fields, given in the constructor, which serves as a handle
+/// to remove the uop in constant time. Removing a uop from the middle of
+/// the queue leaves a hole that is reclaimed once the head or tail of the
+/// queue reaches it, or when the buffer is compacted.
+class CircularQueue
+{
+	// Slots of the circular buffer. The number of slots is a power of 2.
+	std::vector<std::shared_ptr<Uop>> slots;
+
+	// Index of the slot at the head of the queue
+	int head = 0;
+
+	// Number of slots between the head and the tail, including holes
+	int span = 0;
+
+	// Number of uops in the queue
+	int num_uops = 0;
+
+	// Field of the uop where its slot index is stored
+	int Uop::*index_field;
+
+	// Return the slot index following the given one
+	int getNextSlot(int slot) const
+	{
+		return (slot + 1) & (slots.size() - 1);
+	}
+
+	// Move all uops to consecutive slots starting at slot 0 of a buffer
+	// with the given number of slots, updating the uops' slot indices.
+	void Relocate(int num_slots);
+
+public:
+
+	/// Iterator over the uops in the queue, from head to tail, skipping
+	/// holes. An iterator stays valid when other uops are removed from the
+	/// queue, but not when uops are inserted.
+	class Iterator
+	{
+		// Queue being traversed
+		const CircularQueue *queue;
+
+		// Current slot
+		int slot;
+
+		// Number of slots left until the tail of the queue
+		int remaining;
+
+		// Skip empty slots
+		void Skip()
+		{
+			while (remaining && !queue->slots[slot])
+			{
+				slot = queue->getNextSlot(slot);
+				remaining--;
+			}
+		}
+
+	public:
+
+		/// Constructor
+		Iterator(const CircularQueue *queue, int slot, int remaining) :
+				queue(queue),
+				slot(slot),
+				remaining(remaining)
+		{
+			Skip();
+		}
+
+		/// Return the uop in the current position
+		const std::shared_ptr<Uop> &operator*() const
+		{
+			return queue->slots[slot];
+		}
+
+		/// Access a field of the uop in the current position
+		const std::shared_ptr<Uop> *operator->() const
+		{
+			return &queue->slots[slot];
+		}
+
+		/// Move to the next uop in the queue
+		Iterator &operator++()
+		{
+			assert(remaining > 0);
+			slot = queue->getNextSlot(slot);
+			remaining--;
+			Skip();
+			return *this;
+		}
+
+		/// Compare two iterators. Iterators are equal if they have the
+		/// same number of slots left until the tail, which keeps the
+		/// past-the-end iterator valid while uops are removed.
+		bool operator==(const Iterator &other) const
+		{
+			return remaining == other.remaining;
+		}
+
+		/// Compare two iterators
+		bool operator!=(const Iterator &other) const
+		{
+			return remaining != other.remaining;
+		}
+	};
+
+	/// Constructor
+	///
+	/// \param capacity
+	///	Maximum number of uops expected in the queue, as given by the
+	///	configuration of the modeled structure. The buffer is allocated
+	///	with twice as many slots, so that holes left by uops removed
+	///	out of order are compacted only once in a while. If the
+	///	capacity is exceeded, the buffer grows.
+	///
+	/// \param index_field
+	///	Field of class Uop where the queue records the slot index of
+	///	each uop it contains.
+	///
+	CircularQueue(int capacity, int Uop::*index_field);
+
+	/// Return the number of uops in the queue
+	int size() const { return num_uops; }
+
+	/// Return whether the queue is empty
+	bool empty() const { return num_uops == 0; }
+
+	/// Return the uop at the head of the queue. The queue must not be
+	/// empty.
+	const std::shared_ptr<Uop> &front() const
+	{
+		assert(num_uops > 0);
+		return slots[head];
+	}
+
+	/// Return the uop at the tail of the queue. The queue must not be
+	/// empty.
+	const std::shared_ptr<Uop> &back() const
+	{
+		assert(num_uops > 0);
+		return slots[(head + span - 1) & (slots.size() - 1)];
+	}
+
+	/// Return the shared pointer to a uop present in the queue
+	const std::shared_ptr<Uop> &get(Uop *uop) const;
+
+	/// Insert a uop at the tail of the queue
+	void push_back(std::shared_ptr<Uop> uop);
+
+	/// Remove a uop from the queue. The uop must be present in it. The
+	/// uop may be freed as a result.
+	void erase(Uop *uop);
+
+	/// Return an iterator to the head of the queue
+	Iterator begin() const { return Iterator(this, head, span); }
+
+	/// Return a past-the-end iterator
+	Iterator end() const { return Iterator(this, head, 0); }
+};
+
+
+}  // namespace x86
+
+#endif
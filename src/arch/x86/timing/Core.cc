@@ -28,7 +28,8 @@ namespace x86
 Core::Core(Cpu *cpu,
 		int id) :
 		cpu(cpu),
-		id(id)
+		id(id),
+		uop_pool(new UopPool())
 {
 	// Assign name
 	name = misc::fmt("Core %d", id);
@@ -40,6 +41,13 @@ Core::Core(Cpu *cpu,
 }
 
 
+Core::~Core()
+{
+	// Uops still referenced elsewhere are freed after the core
+	uop_pool->Release();
+}
+
+
 void Core::Dump(std::ostream &os) const
 {
 	// Dump all threads
@@ -461,5 +469,46 @@ void Core::Run()
 	Fetch();
 }
 
+
+bool Core::isIdle()
+{
+	for (auto &thread : threads)
+		if (!thread->isIdle())
+			return false;
+	return true;
+}
+
+
+void Core::SkipCycles(long long num_cycles)
+{
+	// In every idle cycle, the dispatch stage visits all threads, leaving
+	// the round-robin thread pointers where they were. A shared dispatch
+	// records one stall slot for each thread, while a time-sliced dispatch
+	// charges the entire dispatch width to the current thread.
+	switch (Cpu::getDispatchKind())
+	{
+
+	case Cpu::DispatchKindShared:
+
+		for (auto &thread : threads)
+			incDispatchStall(thread->canDispatch(), num_cycles);
+		break;
+
+	case Cpu::DispatchKindTimeslice:
+
+		incDispatchStall(threads[current_dispatch_thread]->canDispatch(),
+				num_cycles * Cpu::getDispatchWidth());
+		break;
+
+	default:
+
+		throw misc::Panic("Invalid dispatch kind");
+	}
+
+	// Update threads
+	for (auto &thread : threads)
+		thread->SkipCycles(num_cycles);
+}
+
 }
 
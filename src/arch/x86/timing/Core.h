@@ -60,6 +60,9 @@ private:
 	// Event queue
 	std::list<std::shared_ptr<Uop>> event_queue;
 
+	// Pool used to allocate the uops of all threads in the core
+	UopPool *uop_pool;
+
 
 
 
@@ -195,6 +198,9 @@ public:
 	/// Constructor
 	Core(Cpu *cpu, int index);
 
+	/// Destructor
+	~Core();
+
 	/// Return the number of threads
 	int getNumThreads() const { return threads.size(); }
 
@@ -217,6 +223,9 @@ public:
 	/// Return a new unique identifier for a uop in this core
 	long long getUopId() { return ++uop_id_counter; }
 
+	/// Return the pool used to allocate uops in this core
+	UopPool *getUopPool() const { return uop_pool; }
+
 	/// Return the core's arithmetic-logic unit
 	Alu *getAlu() { return &alu; }
 
@@ -400,6 +409,22 @@ public:
 	/// Commit stage
 	void Commit();
 
+	/// Return true if all threads of the core are idle, as determined by
+	/// Thread::isIdle().
+	bool isIdle();
+
+	/// Return the cycle in which the uop at the head of the event queue
+	/// completes, or -1 if the event queue is empty.
+	long long getNextCompletionCycle() const
+	{
+		return event_queue.empty() ? -1 :
+				event_queue.front()->complete_when;
+	}
+
+	/// Account for the stalls of \a num_cycles idle cycles following the
+	/// current cycle, without simulating them. All threads must be idle.
+	void SkipCycles(long long num_cycles);
+
 
 
 
@@ -409,7 +434,7 @@ public:
 
 	/// Increment the counter for reasons of dispatch stalls by the given
 	/// quantum.
-	void incDispatchStall(Thread::DispatchStall stall, int quantum)
+	void incDispatchStall(Thread::DispatchStall stall, long long quantum)
 	{
 		assert(stall > Thread::DispatchStallInvalid && stall < Thread::DispatchStallMax);
 		dispatch_stall[stall] += quantum;
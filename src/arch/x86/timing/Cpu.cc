@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include "Cpu.h"
 #include "Timing.h"
 
@@ -77,6 +79,7 @@ int Cpu::num_threads = 1;
 int Cpu::context_quantum;
 int Cpu::thread_quantum;
 int Cpu::thread_switch_penalty;
+bool Cpu::skip_idle_cycles;
 long long Cpu::num_fast_forward_instructions;
 long long Cpu::max_cycles = 0;
 int Cpu::recover_penalty;
@@ -142,6 +145,7 @@ void Cpu::ParseConfiguration(misc::IniFile *ini_file)
 	recover_kind = (RecoverKind)ini_file->ReadEnum(section, "RecoverKind",
 			recover_kind_map, RecoverKindWriteback);
 	recover_penalty = ini_file->ReadInt(section, "RecoverPenalty", 0);
+	skip_idle_cycles = ini_file->ReadBool(section, "SkipIdleCycles", true);
 
 	// Section '[ Pipeline ]'
 	section = "Pipeline";
@@ -187,13 +191,83 @@ void Cpu::Run()
 }
 
 
+bool Cpu::isIdle()
+{
+	// The scheduler must run in the next cycle
+	if (emulator->schedule_signal)
+		return false;
+
+	// Uops in the trace list dump their last trace line in the next cycle
+	if (!trace_list.empty())
+		return false;
+
+	// All cores must be idle
+	for (auto &core : cores)
+		if (!core->isIdle())
+			return false;
+	return true;
+}
+
+
+bool Cpu::isPipelineEmpty() const
+{
+	for (auto &core : cores)
+	{
+		for (int i = 0; i < num_threads; i++)
+		{
+			Thread *thread = core->getThread(i);
+			if (!thread->isPipelineEmpty() || (thread->context &&
+					thread->context->getState(
+					Context::StateSpecMode)))
+				return false;
+		}
+	}
+	return true;
+}
+
+
+long long Cpu::getWakeupCycle() const
+{
+	// Expiration of a context quantum
+	long long wakeup_cycle = min_context_allocate_cycle + context_quantum;
+
+	// Maximum number of cycles
+	if (max_cycles && max_cycles < wakeup_cycle)
+		wakeup_cycle = max_cycles;
+
+	// Uop completions and commit stall checks
+	for (auto &core : cores)
+	{
+		long long cycle = core->getNextCompletionCycle();
+		if (cycle >= 0 && cycle < wakeup_cycle)
+			wakeup_cycle = cycle;
+		for (int i = 0; i < num_threads; i++)
+		{
+			cycle = core->getThread(i)->getCommitStallCycle();
+			if (cycle >= 0 && cycle < wakeup_cycle)
+				wakeup_cycle = cycle;
+		}
+	}
+
+	// A cycle in the past means that the CPU must be simulated now
+	return std::max(wakeup_cycle, getCycle() + 1);
+}
+
+
+void Cpu::SkipCycles(long long num_cycles)
+{
+	for (auto &core : cores)
+		core->SkipCycles(num_cycles);
+}
+
+
 void Cpu::MemoryAccess(mem::Module *module,
 			mem::Module::AccessType access_type,
 			unsigned address,
 			std::shared_ptr<Uop> uop)
 {
 	// New frame
-	auto frame = misc::new_shared<MemoryAccessFrame>();
+	auto frame = esim::new_frame<MemoryAccessFrame>();
 	frame->module = module;
 	frame->access_type = access_type;
 	frame->address = address;
@@ -219,7 +293,8 @@ void Cpu::MemoryAccessHandler(esim::Event *event, esim::Frame *esim_frame)
 				frame->access_type,
 				frame->address,
 				nullptr,
-				event_memory_access_end);
+				event_memory_access_end,
+				frame->uop->eip);
 	}
 	else if (event == event_memory_access_end)
 	{
@@ -246,7 +321,7 @@ void Cpu::InsertInTraceList(std::shared_ptr<Uop> uop)
 	assert(Timing::trace == true);
 	assert(!uop->in_trace_list);
 	uop->in_trace_list = true;
-	uop->trace_list_iterator = trace_list.insert(trace_list.end(), uop);
+	trace_list.push_back(uop);
 }
 
 
@@ -261,7 +336,6 @@ void Cpu::EmptyTraceList()
 		// Remove from trace list
 		trace_list.pop_front();
 		uop->in_trace_list = false;
-		uop->trace_list_iterator = trace_list.end();
 
 		// Trace
 		Timing::trace << misc::fmt("x86.end_inst "
@@ -158,6 +158,9 @@ private:
 	// Thread swtich penalty
 	static int thread_switch_penalty;
 
+	// Skip cycles in which all pipelines are idle
+	static bool skip_idle_cycles;
+
 	// Number of fast forward instructions
 	static long long num_fast_forward_instructions;
 
@@ -183,7 +186,11 @@ private:
 	std::string stage;
 
 	// List containing uops that need to report an 'end_inst' trace event 
-	std::list<std::shared_ptr<Uop>> trace_list;
+	std::deque<std::shared_ptr<Uop>> trace_list;
+
+	// Set while the pipelines are drained. No instructions are fetched
+	// in the meantime.
+	bool draining = false;
 
 
 
@@ -377,6 +384,9 @@ public:
 	/// Get thread switch penalty
 	static int getThreadSwitchPenalty() { return thread_switch_penalty; }
 
+	/// Return whether cycles in which all pipelines are idle are skipped
+	static bool getSkipIdleCycles() { return skip_idle_cycles; }
+
 	/// Get reorder buffer size
 	static int getReorderBufferSize() { return reorder_buffer_size; }
 
@@ -489,6 +499,34 @@ public:
 	/// Simulate one cycle of the CPU for all its cores and threads.
 	void Run();
 
+	/// Return true if simulating the cycles following the current one
+	/// would only account for stalls in all cores, until either an event
+	/// of the memory system occurs or the cycle returned by
+	/// getWakeupCycle() is reached.
+	bool isIdle();
+
+	/// Return the first cycle after the current one in which an idle CPU
+	/// needs to be simulated again regardless of the memory system. This
+	/// is the earliest of the completion of a uop in the event queue of a
+	/// core, the expiration of a context quantum, the commit stall check
+	/// of a thread, and the maximum number of cycles.
+	long long getWakeupCycle() const;
+
+	/// Account for \a num_cycles idle cycles following the current cycle
+	/// without simulating them. The CPU must be idle.
+	void SkipCycles(long long num_cycles);
+
+	/// Stop or resume fetching instructions in all hardware threads. While
+	/// fetch is stopped, the instructions in flight leave the pipelines.
+	void setDraining(bool draining) { this->draining = draining; }
+
+	/// Return whether fetch is stopped to drain the pipelines
+	bool isDraining() const { return draining; }
+
+	/// Return true if the pipelines of all hardware threads are empty,
+	/// and no context executes speculatively.
+	bool isPipelineEmpty() const;
+
 	/// Update structure occupancy statistics
 	void UpdateOccupancyStats();
 
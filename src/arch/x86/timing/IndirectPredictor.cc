@@ -0,0 +1,212 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <cstdlib>
+
+#include <lib/cpp/Misc.h>
+
+#include "BranchPredictor.h"
+#include "IndirectPredictor.h"
+
+
+namespace x86
+{
+
+bool IndirectPredictor::present;
+int IndirectPredictor::num_tables;
+int IndirectPredictor::table_size;
+int IndirectPredictor::tag_bits;
+int IndirectPredictor::min_history;
+int IndirectPredictor::max_history;
+
+
+void IndirectPredictor::ParseConfiguration(misc::IniFile *ini_file)
+{
+	// Section
+	std::string section = "BranchPredictor";
+
+	// Read parameters
+	present = ini_file->ReadBool(section, "ITTAGE", false);
+	num_tables = ini_file->ReadInt(section, "ITTAGE.NumTables", 4);
+	table_size = ini_file->ReadInt(section, "ITTAGE.TableSize", 256);
+	tag_bits = ini_file->ReadInt(section, "ITTAGE.TagBits", 9);
+	min_history = ini_file->ReadInt(section, "ITTAGE.MinHistory", 4);
+	max_history = ini_file->ReadInt(section, "ITTAGE.MaxHistory", 64);
+
+	// Integrity
+	if (num_tables < 1 || num_tables > max_num_tables)
+		throw BranchPredictor::Error(misc::fmt("number of ITTAGE "
+				"tables must be between 1 and %d",
+				max_num_tables));
+	if (table_size < 2 || (table_size & (table_size - 1)))
+		throw BranchPredictor::Error("size of ITTAGE tables must be a "
+				"power of 2");
+	if (tag_bits < 1 || tag_bits > 16)
+		throw BranchPredictor::Error("number of ITTAGE tag bits must "
+				"be between 1 and 16");
+	if (min_history < 1 || max_history < min_history)
+		throw BranchPredictor::Error("invalid ITTAGE history lengths");
+	if (max_history > 1024)
+		throw BranchPredictor::Error("ITTAGE history length must be "
+				"1024 or less");
+}
+
+
+void IndirectPredictor::DumpConfiguration(std::ostream &os)
+{
+	os << misc::fmt("\tITTAGE: %s\n", present ? "True" : "False");
+	os << misc::fmt("\tITTAGE.NumTables: %d\n", num_tables);
+	os << misc::fmt("\tITTAGE.TableSize: %d\n", table_size);
+	os << misc::fmt("\tITTAGE.TagBits: %d\n", tag_bits);
+	os << misc::fmt("\tITTAGE.MinHistory: %d\n", min_history);
+	os << misc::fmt("\tITTAGE.MaxHistory: %d\n", max_history);
+}
+
+
+IndirectPredictor::IndirectPredictor()
+{
+	// Tables with history lengths in a geometric series
+	log_table_size = misc::LogBase2(table_size);
+	tables.resize(num_tables);
+	for (int i = 0; i < num_tables; i++)
+	{
+		int length = min_history;
+		if (num_tables > 1)
+			length = (int) (min_history * std::pow((double)
+					max_history / min_history, (double) i /
+					(num_tables - 1)) + 0.5);
+		tables[i].resize(table_size);
+		index_histories.emplace_back(length, log_table_size);
+		tag_histories.emplace_back(length, tag_bits);
+	}
+}
+
+
+unsigned IndirectPredictor::Lookup(unsigned eip, unsigned btb_target,
+		const BranchHistory &history, Info &info) const
+{
+	// Find the two tables with the longest matching histories
+	unsigned path = history.getPath() & 0xffff;
+	info.provider = -1;
+	info.alt_provider = -1;
+	for (int i = num_tables - 1; i >= 0; i--)
+	{
+		unsigned index = eip ^ (eip >> (std::abs(log_table_size - i) + 1)) ^
+				index_histories[i].get() ^ path ^
+				(path >> log_table_size);
+		unsigned tag = eip ^ (tag_histories[i].get() << 1);
+		info.indices[i] = index & (table_size - 1);
+		info.tags[i] = tag & ((1u << tag_bits) - 1);
+		if (tables[i][info.indices[i]].tag != info.tags[i])
+			continue;
+		if (info.provider < 0)
+			info.provider = i;
+		else if (info.alt_provider < 0)
+			info.alt_provider = i;
+	}
+
+	// Alternate target
+	info.alt_target = btb_target;
+	if (info.alt_provider >= 0)
+		info.alt_target = tables[info.alt_provider]
+				[info.indices[info.alt_provider]].target;
+
+	// Use the provider unless it has no confidence and there is an
+	// alternate provider
+	info.target = info.alt_target;
+	info.confident = false;
+	if (info.provider >= 0)
+	{
+		const Entry &entry = tables[info.provider][info.indices[info.provider]];
+		if (entry.confidence || info.alt_provider < 0)
+			info.target = entry.target;
+		info.confident = entry.confidence > 0;
+	}
+	return info.target;
+}
+
+
+void IndirectPredictor::UpdateHistory(const BranchHistory &history)
+{
+	for (int i = 0; i < num_tables; i++)
+	{
+		index_histories[i].Update(history);
+		tag_histories[i].Update(history);
+	}
+}
+
+
+void IndirectPredictor::Update(unsigned target, const Info &info)
+{
+	// Update the provider, skipping entries replaced since the lookup
+	if (info.provider >= 0)
+	{
+		Entry &entry = tables[info.provider][info.indices[info.provider]];
+		if (entry.tag == info.tags[info.provider])
+		{
+			if (entry.target == target)
+			{
+				if (entry.confidence < 3)
+					entry.confidence++;
+				if (info.alt_target != target)
+					entry.useful = true;
+			}
+			else if (entry.confidence)
+			{
+				entry.confidence--;
+			}
+			else
+			{
+				entry.target = target;
+			}
+		}
+	}
+
+	// On a misprediction, allocate an entry in a table with a longer
+	// history. If all candidates are useful, clear their useful bits.
+	if (info.target != target && info.provider < num_tables - 1)
+	{
+		bool allocated = false;
+		for (int i = info.provider + 1; i < num_tables; i++)
+		{
+			Entry &entry = tables[i][info.indices[i]];
+			if (entry.useful)
+				continue;
+			entry.tag = info.tags[i];
+			entry.target = target;
+			entry.confidence = 0;
+			allocated = true;
+			break;
+		}
+		if (!allocated)
+			for (int i = info.provider + 1; i < num_tables; i++)
+				tables[i][info.indices[i]].useful = false;
+	}
+
+	// Periodically reset all useful bits
+	num_updates++;
+	if (!(num_updates & ((1 << 16) - 1)))
+		for (auto &table : tables)
+			for (Entry &entry : table)
+				entry.useful = false;
+}
+
+
+}  // namespace x86
@@ -0,0 +1,194 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_INDIRECT_PREDICTOR_H
+#define ARCH_X86_TIMING_INDIRECT_PREDICTOR_H
+
+#include <iostream>
+#include <vector>
+
+#include <lib/cpp/IniFile.h>
+
+#include "BranchHistory.h"
+
+
+namespace x86
+{
+
+/// ITTAGE-style target predictor for indirect jumps and calls. Tagged
+/// tables indexed with geometrically increasing lengths of the global
+/// history store branch targets. The matching table with the longest
+/// history provides the target, and the BTB acts as the base predictor
+/// when no table matches.
+class IndirectPredictor
+{
+public:
+
+	/// Maximum number of tagged tables
+	static const int max_num_tables = 16;
+
+	/// Information recorded by a lookup in the predictor, kept in the
+	/// branch uop until it commits to update the predictor.
+	struct Info
+	{
+		/// Index in each tagged table
+		int indices[max_num_tables];
+
+		/// Tag computed for each tagged table
+		unsigned tags[max_num_tables];
+
+		/// Table providing the target, or -1 if no table matched
+		int provider = -1;
+
+		/// Table providing the alternate target, or -1 if only one
+		/// table matched
+		int alt_provider = -1;
+
+		/// Alternate target, or the BTB target if there was no
+		/// alternate provider
+		unsigned alt_target = 0;
+
+		/// Predicted target
+		unsigned target = 0;
+
+		/// Whether the predicted target comes from a provider entry
+		/// with some confidence, in which case it can be used even if
+		/// the branch missed in the BTB
+		bool confident = false;
+	};
+
+private:
+
+	//
+	// Static fields
+	//
+
+	// Whether the predictor is present
+	static bool present;
+
+	// Number of tagged tables
+	static int num_tables;
+
+	// Number of entries in each tagged table
+	static int table_size;
+
+	// Number of tag bits
+	static int tag_bits;
+
+	// History length of the first tagged table
+	static int min_history;
+
+	// History length of the last tagged table
+	static int max_history;
+
+
+
+
+	//
+	// Class members
+	//
+
+	// Entry of a tagged table
+	struct Entry
+	{
+		// Partial tag
+		unsigned tag = 0;
+
+		// Branch target
+		unsigned target = 0;
+
+		// Confidence in the target, 2 bits
+		unsigned char confidence = 0;
+
+		// Useful bit
+		bool useful = false;
+	};
+
+	// Base-2 logarithm of the table size
+	int log_table_size = 0;
+
+	// Tagged tables
+	std::vector<std::vector<Entry>> tables;
+
+	// Folded histories used to compute the index in each table
+	std::vector<FoldedHistory> index_histories;
+
+	// Folded histories used to compute the tag in each table
+	std::vector<FoldedHistory> tag_histories;
+
+	// Number of updates, used to reset the useful bits periodically
+	long long num_updates = 0;
+
+public:
+
+	/// Read the configuration of the predictor from section
+	/// [ BranchPredictor ] of the x86 configuration file.
+	static void ParseConfiguration(misc::IniFile *ini_file);
+
+	/// Dump the configuration of the predictor
+	static void DumpConfiguration(std::ostream &os);
+
+	/// Return whether the predictor is present
+	static bool isPresent() { return present; }
+
+	/// Return the number of tagged tables
+	static int getNumTables() { return num_tables; }
+
+	/// Return the number of entries in each tagged table
+	static int getTableSize() { return table_size; }
+
+	/// Return the number of tag bits
+	static int getTagBits() { return tag_bits; }
+
+	/// Return the shortest history length of the tagged tables
+	static int getMinHistory() { return min_history; }
+
+	/// Return the longest history length of the tagged tables
+	static int getMaxHistory() { return max_history; }
+
+	/// Return the number of outcomes that the global history must
+	/// remember for this predictor.
+	static int getHistoryLength() { return max_history + 1; }
+
+	/// Constructor
+	IndirectPredictor();
+
+	/// Predict the target of the indirect branch at address \a eip,
+	/// recording in \a info the information needed to update the
+	/// predictor later.
+	///
+	/// \param btb_target
+	///	Target found in the BTB, used if no tagged table matches.
+	///
+	unsigned Lookup(unsigned eip, unsigned btb_target,
+			const BranchHistory &history, Info &info) const;
+
+	/// Update the folded histories after an outcome was pushed to the
+	/// global history.
+	void UpdateHistory(const BranchHistory &history);
+
+	/// Train the predictor with the actual target of a committed indirect
+	/// branch, given the information recorded when it was looked up.
+	void Update(unsigned target, const Info &info);
+};
+
+
+}  // namespace x86
+
+#endif
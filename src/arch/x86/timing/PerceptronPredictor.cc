@@ -0,0 +1,164 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <cstdlib>
+
+#include <lib/cpp/Misc.h>
+
+#include "BranchPredictor.h"
+#include "PerceptronPredictor.h"
+
+
+namespace x86
+{
+
+int PerceptronPredictor::num_tables;
+int PerceptronPredictor::table_size;
+int PerceptronPredictor::min_history;
+int PerceptronPredictor::max_history;
+
+
+void PerceptronPredictor::ParseConfiguration(misc::IniFile *ini_file)
+{
+	// Section
+	std::string section = "BranchPredictor";
+
+	// Read parameters
+	num_tables = ini_file->ReadInt(section, "Perceptron.NumTables", 8);
+	table_size = ini_file->ReadInt(section, "Perceptron.TableSize", 1024);
+	min_history = ini_file->ReadInt(section, "Perceptron.MinHistory", 3);
+	max_history = ini_file->ReadInt(section, "Perceptron.MaxHistory", 128);
+
+	// Integrity
+	if (num_tables < 2 || num_tables > max_num_tables)
+		throw BranchPredictor::Error(misc::fmt("number of perceptron "
+				"tables must be between 2 and %d",
+				max_num_tables));
+	if (table_size < 2 || (table_size & (table_size - 1)))
+		throw BranchPredictor::Error("size of perceptron tables must "
+				"be a power of 2");
+	if (min_history < 1 || max_history < min_history)
+		throw BranchPredictor::Error("invalid perceptron history "
+				"lengths");
+	if (max_history > 1024)
+		throw BranchPredictor::Error("perceptron history length must "
+				"be 1024 or less");
+}
+
+
+void PerceptronPredictor::DumpConfiguration(std::ostream &os)
+{
+	os << misc::fmt("\tPerceptron.NumTables: %d\n", num_tables);
+	os << misc::fmt("\tPerceptron.TableSize: %d\n", table_size);
+	os << misc::fmt("\tPerceptron.MinHistory: %d\n", min_history);
+	os << misc::fmt("\tPerceptron.MaxHistory: %d\n", max_history);
+}
+
+
+PerceptronPredictor::PerceptronPredictor()
+{
+	// Tables
+	log_table_size = misc::LogBase2(table_size);
+	tables.resize(num_tables);
+	for (auto &table : tables)
+		table.resize(table_size);
+
+	// Segment ends in a geometric series between the minimum and
+	// maximum history lengths. Table 0 is the bias table.
+	int num_segments = num_tables - 1;
+	for (int i = 0; i < num_segments; i++)
+	{
+		int length = min_history;
+		if (num_segments > 1)
+			length = (int) (min_history * std::pow((double)
+					max_history / min_history, (double) i /
+					(num_segments - 1)) + 0.5);
+		histories.emplace_back(length, log_table_size);
+	}
+
+	// Initial threshold for the number of tables
+	threshold = (int) (2.14 * (num_tables + 1) + 20.58);
+}
+
+
+bool PerceptronPredictor::Lookup(unsigned eip, const BranchHistory &history,
+		Info &info) const
+{
+	unsigned hash = eip ^ (eip >> log_table_size);
+	info.indices[0] = hash & (table_size - 1);
+	info.sum = tables[0][info.indices[0]];
+	unsigned previous = 0;
+	for (int i = 1; i < num_tables; i++)
+	{
+		unsigned folded = histories[i - 1].get();
+		info.indices[i] = (hash ^ folded ^ previous) & (table_size - 1);
+		info.sum += tables[i][info.indices[i]];
+		previous = folded;
+	}
+	info.prediction = info.sum >= 0;
+	return info.prediction;
+}
+
+
+void PerceptronPredictor::UpdateHistory(const BranchHistory &history)
+{
+	for (FoldedHistory &folded : histories)
+		folded.Update(history);
+}
+
+
+void PerceptronPredictor::Update(bool taken, const Info &info)
+{
+	// Adapt the threshold, raising it on mispredictions and lowering it
+	// on correct predictions with a low margin.
+	if (info.prediction != taken)
+	{
+		threshold_counter++;
+		if (threshold_counter >= 63)
+		{
+			threshold++;
+			threshold_counter = 0;
+		}
+	}
+	else if (std::abs(info.sum) <= threshold)
+	{
+		threshold_counter--;
+		if (threshold_counter <= -64)
+		{
+			threshold--;
+			threshold_counter = 0;
+		}
+	}
+
+	// Train on mispredictions and low-margin predictions
+	if (info.prediction == taken && std::abs(info.sum) > threshold)
+		return;
+	for (int i = 0; i < num_tables; i++)
+	{
+		signed char &weight = tables[i][info.indices[i]];
+		if (taken && weight < 127)
+			weight++;
+		else if (!taken && weight > -127)
+			weight--;
+	}
+}
+
+
+}  // namespace x86
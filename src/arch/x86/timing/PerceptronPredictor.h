@@ -0,0 +1,146 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_PERCEPTRON_PREDICTOR_H
+#define ARCH_X86_TIMING_PERCEPTRON_PREDICTOR_H
+
+#include <iostream>
+#include <vector>
+
+#include <lib/cpp/IniFile.h>
+
+#include "BranchHistory.h"
+
+
+namespace x86
+{
+
+/// Hashed perceptron conditional branch predictor. The global history is
+/// split into segments of geometrically increasing length, and each
+/// segment is hashed with the branch address to select a weight from its
+/// own table. A bias table is indexed by the address only. The branch is
+/// predicted taken if the sum of the selected weights is not negative.
+class PerceptronPredictor
+{
+public:
+
+	/// Maximum number of tables
+	static const int max_num_tables = 32;
+
+	/// Information recorded by a lookup in the predictor, kept in the
+	/// branch uop until it commits to update the predictor.
+	struct Info
+	{
+		/// Index in each table
+		int indices[max_num_tables];
+
+		/// Sum of the selected weights
+		int sum = 0;
+
+		/// Prediction
+		bool prediction = false;
+	};
+
+private:
+
+	//
+	// Static fields
+	//
+
+	// Number of tables, including the bias table
+	static int num_tables;
+
+	// Number of weights in each table
+	static int table_size;
+
+	// Length of the shortest history segment
+	static int min_history;
+
+	// Total history length covered by all segments
+	static int max_history;
+
+
+
+
+	//
+	// Class members
+	//
+
+	// Base-2 logarithm of the table size
+	int log_table_size = 0;
+
+	// Tables of signed 8-bit weights
+	std::vector<std::vector<signed char>> tables;
+
+	// History folded up to the end of each segment. The hash of a
+	// segment is the XOR of the folded histories at its two ends.
+	std::vector<FoldedHistory> histories;
+
+	// Training threshold
+	int threshold;
+
+	// Counter used to adapt the training threshold
+	int threshold_counter = 0;
+
+public:
+
+	/// Read the configuration of the predictor from section
+	/// [ BranchPredictor ] of the x86 configuration file.
+	static void ParseConfiguration(misc::IniFile *ini_file);
+
+	/// Dump the configuration of the predictor
+	static void DumpConfiguration(std::ostream &os);
+
+	/// Return the number of tables
+	static int getNumTables() { return num_tables; }
+
+	/// Return the number of weights in each table
+	static int getTableSize() { return table_size; }
+
+	/// Return the length of the shortest history segment
+	static int getMinHistory() { return min_history; }
+
+	/// Return the total history length
+	static int getMaxHistory() { return max_history; }
+
+	/// Return the number of outcomes that the global history must
+	/// remember for this predictor.
+	static int getHistoryLength() { return max_history + 1; }
+
+	/// Constructor
+	PerceptronPredictor();
+
+	/// Predict the direction of the conditional branch at address \a eip,
+	/// and record in \a info the information needed to update the
+	/// predictor later.
+	bool Lookup(unsigned eip, const BranchHistory &history, Info &info) const;
+
+	/// Update the folded histories after an outcome was pushed to the
+	/// global history.
+	void UpdateHistory(const BranchHistory &history);
+
+	/// Train the predictor with the direction of a committed conditional
+	/// branch, given the information recorded when it was looked up.
+	void Update(bool taken, const Info &info);
+};
+
+
+}  // namespace x86
+
+#endif
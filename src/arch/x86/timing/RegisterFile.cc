@@ -571,6 +571,21 @@ void RegisterFile::Rename(Uop *uop)
 }
 
 
+RegisterFile::PhysicalRegister *RegisterFile::getInputRegister(Uop *uop,
+		int dep)
+{
+	int logical_register = uop->getUinst()->getIDep(dep);
+	int physical_register = uop->getInput(dep);
+	if (Uinst::isIntegerDependency(logical_register))
+		return &integer_registers[physical_register];
+	if (Uinst::isFloatingPointDependency(logical_register))
+		return &floating_point_registers[physical_register];
+	if (Uinst::isXmmDependency(logical_register))
+		return &xmm_registers[physical_register];
+	return nullptr;
+}
+
+
 bool RegisterFile::isUopReady(Uop *uop)
 {
 	// If uop is marked as ready, it means that we verified that it is
@@ -610,19 +625,90 @@ bool RegisterFile::isUopReady(Uop *uop)
 }
 
 
-void RegisterFile::WriteUop(Uop *uop)
+bool RegisterFile::TrackUop(Uop *uop)
 {
+	// Already ready
+	if (uop->ready)
+		return true;
+
+	// Wait on pending input registers
+	assert(!uop->num_pending_inputs);
+	for (int dep = 0; dep < Uinst::MaxIDeps; dep++)
+	{
+		PhysicalRegister *input_register = getInputRegister(uop, dep);
+		if (input_register && input_register->pending)
+		{
+			input_register->waiting_uops.push_back(uop);
+			uop->num_pending_inputs++;
+		}
+	}
+
+	// Uop is ready if no input is pending
+	if (!uop->num_pending_inputs)
+		uop->ready = true;
+	return uop->ready;
+}
+
+
+void RegisterFile::UntrackUop(Uop *uop)
+{
+	// Nothing to do if uop is not waiting on any register
+	if (uop->ready)
+		return;
 
+	// Remove uop from the waiting lists of its pending input registers
+	for (int dep = 0; dep < Uinst::MaxIDeps; dep++)
+	{
+		PhysicalRegister *input_register = getInputRegister(uop, dep);
+		if (!input_register)
+			continue;
+		std::vector<Uop *> &waiting_uops = input_register->waiting_uops;
+		for (auto it = waiting_uops.begin(); it != waiting_uops.end(); ++it)
+		{
+			if (*it == uop)
+			{
+				*it = waiting_uops.back();
+				waiting_uops.pop_back();
+				uop->num_pending_inputs--;
+				break;
+			}
+		}
+	}
+	assert(!uop->num_pending_inputs);
+}
+
+
+void RegisterFile::WriteUop(Uop *uop)
+{
 	for (int dep = 0; dep < Uinst::MaxODeps; dep++)
 	{
+		// Get output register
 		int logical_register = uop->getUinst()->getODep(dep);
 		int physical_register = uop->getOutput(dep);
+		PhysicalRegister *output_register;
 		if (Uinst::isIntegerDependency(logical_register))
-			integer_registers[physical_register].pending = false;
+			output_register = &integer_registers[physical_register];
 		else if (Uinst::isFloatingPointDependency(logical_register))
-			floating_point_registers[physical_register].pending = false;
+			output_register = &floating_point_registers[physical_register];
 		else if (Uinst::isXmmDependency(logical_register))
-			xmm_registers[physical_register].pending = false;
+			output_register = &xmm_registers[physical_register];
+		else
+			continue;
+
+		// Result is available
+		output_register->pending = false;
+
+		// Wake up waiting uops, which become ready once their last
+		// pending input is available.
+		for (Uop *waiting_uop : output_register->waiting_uops)
+		{
+			assert(waiting_uop->num_pending_inputs > 0);
+			if (--waiting_uop->num_pending_inputs)
+				continue;
+			waiting_uop->ready = true;
+			thread->InsertInReadyList(waiting_uop);
+		}
+		output_register->waiting_uops.clear();
 	}
 }
 
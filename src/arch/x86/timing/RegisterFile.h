@@ -20,6 +20,8 @@
 #ifndef ARCH_X86_TIMING_REGISTER_FILE_H
 #define ARCH_X86_TIMING_REGISTER_FILE_H
 
+#include <vector>
+
 #include <lib/cpp/Debug.h>
 #include <lib/cpp/IniFile.h>
 #include <arch/x86/emulator/Uinst.h>
@@ -80,8 +82,16 @@ private:
 
 		// Number of logical registers mapped to this physical register
 		int busy = 0;
+
+		// Uops waiting for the result of this physical register. A uop
+		// appears once for each input dependence on the register.
+		std::vector<Uop *> waiting_uops;
 	};
 
+	// Return the physical register that an input dependence of a uop
+	// reads, or nullptr if the dependence is not a register.
+	PhysicalRegister *getInputRegister(Uop *uop, int dep);
+
 
 
 
@@ -286,8 +296,21 @@ public:
 	/// Check if input dependencies are resolved
 	bool isUopReady(Uop *uop);
 
+	/// Start tracking the input dependencies of a uop that was inserted in
+	/// the instruction queue or load-store queue. The uop is recorded as
+	/// waiting on each input register whose result is still pending. The
+	/// function returns true if the uop is ready. Otherwise, the uop is
+	/// woken up when its last pending input is written back.
+	bool TrackUop(Uop *uop);
+
+	/// Stop tracking the input dependencies of a uop that is removed from
+	/// the instruction queue or load-store queue before becoming ready.
+	void UntrackUop(Uop *uop);
+
 	/// Update the state of the register file when an uop completes, that
-	/// is, when its results are written back.
+	/// is, when its results are written back. Uops waiting on the output
+	/// registers are woken up, and inserted in the ready lists of the
+	/// thread once all their inputs are available.
 	void WriteUop(Uop *uop);
 
 	/// Update the state of the register file when an uop is recovered from
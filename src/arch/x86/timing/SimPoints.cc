@@ -0,0 +1,413 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <arch/x86/emulator/Emulator.h>
+#include <lib/cpp/Misc.h>
+#include <lib/esim/Engine.h>
+#include <memory/System.h>
+
+#include "Cpu.h"
+#include "SimPoints.h"
+#include "Timing.h"
+
+
+namespace x86
+{
+
+SimPoints::SimPoints(Cpu *cpu,
+		const std::string &simpoints_path,
+		const std::string &weights_path,
+		long long interval_length,
+		long long warmup_length) :
+		cpu(cpu),
+		interval_length(interval_length),
+		warmup_length(warmup_length)
+{
+	Load(simpoints_path, weights_path);
+}
+
+
+void SimPoints::Load(const std::string &simpoints_path,
+		const std::string &weights_path)
+{
+	// Read simulation points
+	std::ifstream f(simpoints_path);
+	if (!f)
+		throw Timing::Error(misc::fmt("%s: Cannot open simulation "
+				"points file", simpoints_path.c_str()));
+	std::string line;
+	for (int line_num = 1; std::getline(f, line); line_num++)
+	{
+		// Skip empty lines
+		std::istringstream is(line);
+		std::string token;
+		if (!(is >> token))
+			continue;
+
+		// Format '<interval> <cluster>'
+		SimPoint simpoint;
+		is.str(line);
+		is.clear();
+		if (!(is >> simpoint.interval >> simpoint.cluster) ||
+				simpoint.interval < 0 || (is >> token))
+			throw Timing::Error(misc::fmt("%s:%d: Invalid simulation "
+					"point, expected '<interval> <cluster>'",
+					simpoints_path.c_str(), line_num));
+		simpoints.push_back(simpoint);
+	}
+	if (simpoints.empty())
+		throw Timing::Error(misc::fmt("%s: No simulation points found",
+				simpoints_path.c_str()));
+
+	// Simulation points are visited in order of execution
+	std::sort(simpoints.begin(), simpoints.end(),
+			[](const SimPoint &a, const SimPoint &b)
+			{
+				return a.interval < b.interval;
+			});
+	for (unsigned i = 1; i < simpoints.size(); i++)
+		if (simpoints[i].interval == simpoints[i - 1].interval)
+			throw Timing::Error(misc::fmt("%s: Interval %lld "
+					"appears more than once",
+					simpoints_path.c_str(),
+					simpoints[i].interval));
+
+	// Same weight for all simulation points if no weights are given
+	if (weights_path.empty())
+	{
+		for (SimPoint &simpoint : simpoints)
+			simpoint.weight = 1.0 / simpoints.size();
+		return;
+	}
+
+	// Read weights, indexed by cluster
+	std::map<int, double> weights;
+	std::ifstream g(weights_path);
+	if (!g)
+		throw Timing::Error(misc::fmt("%s: Cannot open simulation "
+				"point weights file", weights_path.c_str()));
+	for (int line_num = 1; std::getline(g, line); line_num++)
+	{
+		// Skip empty lines
+		std::istringstream is(line);
+		std::string token;
+		if (!(is >> token))
+			continue;
+
+		// Format '<weight> <cluster>'
+		double weight;
+		int cluster;
+		is.str(line);
+		is.clear();
+		if (!(is >> weight >> cluster) || weight < 0.0 || (is >> token))
+			throw Timing::Error(misc::fmt("%s:%d: Invalid weight, "
+					"expected '<weight> <cluster>'",
+					weights_path.c_str(), line_num));
+		weights[cluster] = weight;
+	}
+
+	// Assign weights
+	for (SimPoint &simpoint : simpoints)
+	{
+		auto it = weights.find(simpoint.cluster);
+		if (it == weights.end())
+			throw Timing::Error(misc::fmt("%s: No weight for "
+					"cluster %d", weights_path.c_str(),
+					simpoint.cluster));
+		simpoint.weight = it->second;
+	}
+}
+
+
+long long SimPoints::getPosition() const
+{
+	return num_fast_forward_instructions +
+			cpu->getNumCommittedInstructions();
+}
+
+
+long long SimPoints::getWarmupPosition(int index) const
+{
+	return std::max(0LL, getStartPosition(index) - warmup_length);
+}
+
+
+void SimPoints::getStatistics(Statistics &statistics) const
+{
+	// Processor
+	statistics.cycles = cpu->getCycle();
+	statistics.instructions = getPosition();
+	statistics.branches = cpu->getNumBranches();
+	statistics.mispredicted_branches = cpu->getNumMispredictedBranches();
+
+	// Memory modules
+	mem::System *memory_system = mem::System::getInstance();
+	statistics.module_accesses.clear();
+	statistics.module_hits.clear();
+	for (auto it = memory_system->getModulesBegin(),
+			e = memory_system->getModulesEnd();
+			it != e;
+			++it)
+	{
+		mem::Module *module = it->get();
+		statistics.module_accesses.push_back(module->getNumAccesses());
+		statistics.module_hits.push_back(module->getNumHits());
+	}
+}
+
+
+void SimPoints::FastForward(long long position)
+{
+	// Contexts run with the same scheduling and quantum as the
+	// functional emulation loop where the basic block vectors were
+	// profiled, stopping exactly at the given position. Finished contexts
+	// are not freed here if they are mapped to a hardware thread, since
+	// the scheduler of the thread releases them.
+	Emulator *emulator = Emulator::getInstance();
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	emulator->setStopInstruction(emulator->getNumInstructions() +
+			position - getPosition());
+	while (getPosition() < position && !esim_engine->hasFinished() &&
+			(emulator->getNumRunningContexts() ||
+			emulator->getNumSuspendedContexts()))
+	{
+		// Run a quantum of each context
+		long long num_instructions = emulator->getNumInstructions();
+		emulator->RunContexts();
+		num_fast_forward_instructions += emulator->getNumInstructions() -
+				num_instructions;
+
+		// Process host threads generating events, and free contexts
+		// that finished without ever being mapped
+		emulator->ProcessEvents();
+		std::vector<Context *> finished_contexts(
+				emulator->getFinishedContextsBegin(),
+				emulator->getFinishedContextsEnd());
+		for (Context *context : finished_contexts)
+			if (!context->getState(Context::StateMapped))
+				emulator->FreeContext(context);
+	}
+	emulator->setStopInstruction(0);
+
+	// Hardware threads resume fetching where their contexts stopped
+	for (int i = 0; i < cpu->getNumCores(); i++)
+	{
+		Core *core = cpu->getCore(i);
+		for (int j = 0; j < core->getNumThreads(); j++)
+		{
+			Thread *thread = core->getThread(j);
+			if (thread->context)
+				thread->setFetchNeip(thread->context->getRegs().getEip());
+		}
+	}
+}
+
+
+void SimPoints::Run()
+{
+	// Wait for the pipelines to drain before fast-forwarding
+	if (phase == PhaseDrain)
+	{
+		if (!cpu->isPipelineEmpty())
+			return;
+		cpu->setDraining(false);
+		phase = PhaseFastForward;
+	}
+
+	// Functional execution up to the warmup of the next simulation point
+	if (phase == PhaseFastForward)
+	{
+		FastForward(getWarmupPosition(current));
+		phase = PhaseWarmup;
+	}
+
+	// Start of the interval
+	long long start = getStartPosition(current);
+	if (phase == PhaseWarmup && getPosition() >= start)
+	{
+		getStatistics(start_statistics);
+		phase = PhaseMeasure;
+	}
+
+	// Nothing else to do until the end of the interval
+	if (phase != PhaseMeasure || getPosition() < start + interval_length)
+		return;
+
+	// Record statistics of the interval
+	SimPoint &simpoint = simpoints[current];
+	Statistics &statistics = simpoint.statistics;
+	getStatistics(statistics);
+	statistics.cycles -= start_statistics.cycles;
+	statistics.instructions -= start_statistics.instructions;
+	statistics.branches -= start_statistics.branches;
+	statistics.mispredicted_branches -=
+			start_statistics.mispredicted_branches;
+	for (unsigned i = 0; i < statistics.module_accesses.size(); i++)
+	{
+		statistics.module_accesses[i] -=
+				start_statistics.module_accesses[i];
+		statistics.module_hits[i] -= start_statistics.module_hits[i];
+	}
+	simpoint.measured = true;
+
+	// Last simulation point
+	current++;
+	if (current == (int) simpoints.size())
+	{
+		phase = PhaseDone;
+		esim::Engine *esim_engine = esim::Engine::getInstance();
+		esim_engine->Finish("X86SimPoints");
+		return;
+	}
+
+	// Continue with a detailed simulation if the warmup of the next
+	// simulation point was already reached. Otherwise, stop fetching
+	// until the pipelines are empty, so that the functional execution of
+	// contexts can resume where their committed state is.
+	if (getPosition() >= getWarmupPosition(current))
+	{
+		phase = PhaseWarmup;
+	}
+	else
+	{
+		phase = PhaseDrain;
+		cpu->setDraining(true);
+	}
+}
+
+
+double SimPoints::getCpi() const
+{
+	double weight = 0.0;
+	double cpi = 0.0;
+	for (const SimPoint &simpoint : simpoints)
+	{
+		if (!simpoint.measured || !simpoint.statistics.instructions)
+			continue;
+		weight += simpoint.weight;
+		cpi += simpoint.weight * simpoint.statistics.cycles /
+				simpoint.statistics.instructions;
+	}
+	return weight > 0.0 ? cpi / weight : 0.0;
+}
+
+
+void SimPoints::DumpReport(std::ostream &os) const
+{
+	// Weights are normalized over the simulation points that were
+	// measured, in case the simulation finished before the last one.
+	double total_weight = 0.0;
+	int num_measured = 0;
+	for (const SimPoint &simpoint : simpoints)
+	{
+		if (!simpoint.measured || !simpoint.statistics.instructions)
+			continue;
+		total_weight += simpoint.weight;
+		num_measured++;
+	}
+
+	// Weighted processor statistics, with rates given per thousand
+	// instructions
+	double cpi = getCpi();
+	double branch_mpki = 0.0;
+	mem::System *memory_system = mem::System::getInstance();
+	int num_modules = std::distance(memory_system->getModulesBegin(),
+			memory_system->getModulesEnd());
+	std::vector<double> module_apki(num_modules);
+	std::vector<double> module_mpki(num_modules);
+	for (const SimPoint &simpoint : simpoints)
+	{
+		const Statistics &statistics = simpoint.statistics;
+		if (!simpoint.measured || !statistics.instructions)
+			continue;
+		double factor = simpoint.weight / total_weight * 1000.0 /
+				statistics.instructions;
+		branch_mpki += factor * statistics.mispredicted_branches;
+		for (int i = 0; i < num_modules &&
+				i < (int) statistics.module_accesses.size(); i++)
+		{
+			module_apki[i] += factor * statistics.module_accesses[i];
+			module_mpki[i] += factor *
+					(statistics.module_accesses[i] -
+					statistics.module_hits[i]);
+		}
+	}
+
+	// Aggregate statistics
+	os << "[ SimPoints ]\n";
+	os << misc::fmt("IntervalLength = %lld\n", interval_length);
+	os << misc::fmt("Warmup = %lld\n", warmup_length);
+	os << misc::fmt("SimPoints = %d\n", (int) simpoints.size());
+	os << misc::fmt("MeasuredSimPoints = %d\n", num_measured);
+	os << misc::fmt("FastForwardInstructions = %lld\n",
+			num_fast_forward_instructions);
+	os << misc::fmt("CPI = %.4g\n", cpi);
+	os << misc::fmt("IPC = %.4g\n", cpi > 0.0 ? 1.0 / cpi : 0.0);
+	os << misc::fmt("BranchMPKI = %.4g\n", branch_mpki);
+	int index = 0;
+	for (auto it = memory_system->getModulesBegin(),
+			e = memory_system->getModulesEnd();
+			it != e;
+			++it, ++index)
+	{
+		const std::string &name = (*it)->getName();
+		os << misc::fmt("%s.APKI = %.4g\n", name.c_str(),
+				module_apki[index]);
+		os << misc::fmt("%s.MPKI = %.4g\n", name.c_str(),
+				module_mpki[index]);
+		os << misc::fmt("%s.MissRatio = %.4g\n", name.c_str(),
+				module_apki[index] > 0.0 ? module_mpki[index] /
+				module_apki[index] : 0.0);
+	}
+	os << '\n';
+
+	// Statistics of each simulation point
+	for (const SimPoint &simpoint : simpoints)
+	{
+		const Statistics &statistics = simpoint.statistics;
+		os << misc::fmt("[ SimPoint %lld ]\n", simpoint.interval);
+		os << misc::fmt("Cluster = %d\n", simpoint.cluster);
+		os << misc::fmt("Weight = %.4g\n", simpoint.weight);
+		os << misc::fmt("Measured = %s\n", simpoint.measured ?
+				"True" : "False");
+		if (simpoint.measured)
+		{
+			os << misc::fmt("Instructions = %lld\n",
+					statistics.instructions);
+			os << misc::fmt("Cycles = %lld\n", statistics.cycles);
+			os << misc::fmt("IPC = %.4g\n", statistics.cycles ?
+					(double) statistics.instructions /
+					statistics.cycles : 0.0);
+			os << misc::fmt("Branches = %lld\n",
+					statistics.branches);
+			os << misc::fmt("MispredictedBranches = %lld\n",
+					statistics.mispredicted_branches);
+		}
+		os << '\n';
+	}
+}
+
+
+}  // namespace x86
+
@@ -0,0 +1,218 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_SIM_POINTS_H
+#define ARCH_X86_TIMING_SIM_POINTS_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace x86
+{
+
+// Forward declarations
+class Cpu;
+
+/// Sampled simulation of the intervals selected by the SimPoint tool from
+/// the basic block vectors dumped with option '--x86-bbv'. The execution is
+/// fast-forwarded functionally up to each simulation point, the pipelines
+/// and caches are warmed up with a detailed simulation of the instructions
+/// preceding it, and statistics are collected during the detailed
+/// simulation of the interval. The statistics of all simulation points are
+/// combined using the weights of their clusters.
+class SimPoints
+{
+public:
+
+	/// Statistics collected at a given point of the simulation
+	struct Statistics
+	{
+		// Cycle
+		long long cycles = 0;
+
+		// Instructions executed, including fast-forwarded ones
+		long long instructions = 0;
+
+		// Committed branches
+		long long branches = 0;
+
+		// Mispredicted branches
+		long long mispredicted_branches = 0;
+
+		// Accesses to each memory module, in the order of the memory
+		// system's module list
+		std::vector<long long> module_accesses;
+
+		// Hits in each memory module
+		std::vector<long long> module_hits;
+	};
+
+	/// Simulation point
+	struct SimPoint
+	{
+		// Index of the interval in the basic block vector file
+		long long interval = 0;
+
+		// Cluster that the interval represents
+		int cluster = 0;
+
+		// Weight of the cluster
+		double weight = 0.0;
+
+		// Whether the interval was simulated entirely
+		bool measured = false;
+
+		// Statistics collected during the interval
+		Statistics statistics;
+	};
+
+private:
+
+	// Simulation phases
+	enum Phase
+	{
+		PhaseFastForward = 0,
+		PhaseWarmup,
+		PhaseMeasure,
+		PhaseDrain,
+		PhaseDone
+	};
+
+	// CPU running the detailed simulation
+	Cpu *cpu;
+
+	// Number of instructions in an interval
+	long long interval_length;
+
+	// Number of instructions simulated in detail before each interval
+	long long warmup_length;
+
+	// Simulation points, sorted by interval
+	std::vector<SimPoint> simpoints;
+
+	// Current simulation point
+	int current = 0;
+
+	// Current phase
+	Phase phase = PhaseFastForward;
+
+	// Number of instructions executed functionally
+	long long num_fast_forward_instructions = 0;
+
+	// Statistics at the beginning of the current interval
+	Statistics start_statistics;
+
+	// Read the simulation points and weights from the files produced by
+	// the SimPoint tool.
+	void Load(const std::string &simpoints_path,
+			const std::string &weights_path);
+
+	// Return the number of instructions executed so far, adding the
+	// fast-forwarded and committed ones.
+	long long getPosition() const;
+
+	// Take a snapshot of the current statistics
+	void getStatistics(Statistics &statistics) const;
+
+	// Execute contexts functionally until the given position is reached
+	void FastForward(long long position);
+
+public:
+
+	/// Constructor
+	///
+	/// \param cpu
+	///	CPU of the timing simulator
+	///
+	/// \param simpoints_path
+	///	File with one line per simulation point in the format
+	///	'<interval> <cluster>', as produced with SimPoint's option
+	///	'-saveSimpoints'.
+	///
+	/// \param weights_path
+	///	File with one line per cluster in the format '<weight>
+	///	<cluster>', as produced with SimPoint's option '-saveWeights'.
+	///	If empty, all simulation points have the same weight.
+	///
+	/// \param interval_length
+	///	Number of instructions in an interval
+	///
+	/// \param warmup_length
+	///	Number of instructions simulated in detail before each interval
+	///
+	/// \throw
+	///	A Timing::Error is thrown if any file cannot be read or has an
+	///	invalid format.
+	SimPoints(Cpu *cpu,
+			const std::string &simpoints_path,
+			const std::string &weights_path,
+			long long interval_length,
+			long long warmup_length);
+
+	/// Advance the sampled simulation before a cycle of detailed
+	/// simulation, fast-forwarding, draining the pipelines, or collecting
+	/// statistics as needed. The simulation is finished when the last
+	/// simulation point has been measured.
+	void Run();
+
+	/// Return the number of simulation points
+	int getNumSimPoints() const { return simpoints.size(); }
+
+	/// Return the simulation point with the given index
+	const SimPoint &getSimPoint(int index) const
+	{
+		return simpoints[index];
+	}
+
+	/// Return the position, in number of instructions executed since the
+	/// beginning of the program, where the interval of the simulation
+	/// point with the given index starts.
+	long long getStartPosition(int index) const
+	{
+		return simpoints[index].interval * interval_length;
+	}
+
+	/// Return the position where the detailed simulation warming up the
+	/// simulation point with the given index starts. Execution is
+	/// fast-forwarded functionally up to this position, unless the
+	/// detailed simulation already went past it.
+	long long getWarmupPosition(int index) const;
+
+	/// Return the number of instructions executed functionally
+	long long getNumFastForwardInstructions() const
+	{
+		return num_fast_forward_instructions;
+	}
+
+	/// Return the weighted cycles per instruction of the simulation points
+	/// measured so far, or 0 if none was measured.
+	double getCpi() const;
+
+	/// Dump the aggregate statistics of the simulation points, followed
+	/// by the statistics of each one.
+	void DumpReport(std::ostream &os = std::cout) const;
+};
+
+
+}  // namespace x86
+
+#endif
+
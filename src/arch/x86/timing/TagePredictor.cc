@@ -0,0 +1,578 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <lib/cpp/Misc.h>
+
+#include "BranchPredictor.h"
+#include "TagePredictor.h"
+
+
+namespace x86
+{
+
+int TagePredictor::num_tables;
+int TagePredictor::table_size;
+int TagePredictor::base_size;
+int TagePredictor::tag_bits;
+int TagePredictor::min_history;
+int TagePredictor::max_history;
+bool TagePredictor::loop_predictor;
+int TagePredictor::loop_size;
+bool TagePredictor::statistical_corrector;
+int TagePredictor::sc_size;
+
+const int TagePredictor::sc_history_lengths[num_sc_tables] =
+{
+	0, 4, 8, 13, 21
+};
+
+
+// Saturating update of a signed counter
+static void UpdateCounter(signed char &counter, bool taken, int min, int max)
+{
+	if (taken && counter < max)
+		counter++;
+	else if (!taken && counter > min)
+		counter--;
+}
+
+
+void TagePredictor::ParseConfiguration(misc::IniFile *ini_file)
+{
+	// Section
+	std::string section = "BranchPredictor";
+
+	// Read parameters
+	num_tables = ini_file->ReadInt(section, "TAGE.NumTables", 7);
+	table_size = ini_file->ReadInt(section, "TAGE.TableSize", 1024);
+	base_size = ini_file->ReadInt(section, "TAGE.BaseSize", 4096);
+	tag_bits = ini_file->ReadInt(section, "TAGE.TagBits", 11);
+	min_history = ini_file->ReadInt(section, "TAGE.MinHistory", 5);
+	max_history = ini_file->ReadInt(section, "TAGE.MaxHistory", 130);
+	loop_predictor = ini_file->ReadBool(section, "TAGE.LoopPredictor", true);
+	loop_size = ini_file->ReadInt(section, "TAGE.LoopSize", 64);
+	statistical_corrector = ini_file->ReadBool(section,
+			"TAGE.StatisticalCorrector", true);
+	sc_size = ini_file->ReadInt(section, "TAGE.SCSize", 1024);
+
+	// Integrity
+	if (num_tables < 1 || num_tables > max_num_tables)
+		throw BranchPredictor::Error(misc::fmt("number of TAGE tables "
+				"must be between 1 and %d", max_num_tables));
+	if (table_size < 2 || (table_size & (table_size - 1)))
+		throw BranchPredictor::Error("size of TAGE tables must be a "
+				"power of 2");
+	if (base_size < 1 || (base_size & (base_size - 1)))
+		throw BranchPredictor::Error("size of TAGE base table must be "
+				"a power of 2");
+	if (tag_bits < 2 || tag_bits > 16)
+		throw BranchPredictor::Error("number of TAGE tag bits must be "
+				"between 2 and 16");
+	if (min_history < 1 || max_history < min_history)
+		throw BranchPredictor::Error("invalid TAGE history lengths");
+	if (max_history > 1024)
+		throw BranchPredictor::Error("TAGE history length must be "
+				"1024 or less");
+	if (loop_size < 1 || (loop_size & (loop_size - 1)))
+		throw BranchPredictor::Error("size of TAGE loop predictor must "
+				"be a power of 2");
+	if (sc_size < 16 || (sc_size & (sc_size - 1)))
+		throw BranchPredictor::Error("size of TAGE statistical "
+				"corrector must be a power of 2 of at least 16");
+}
+
+
+void TagePredictor::DumpConfiguration(std::ostream &os)
+{
+	os << misc::fmt("\tTAGE.NumTables: %d\n", num_tables);
+	os << misc::fmt("\tTAGE.TableSize: %d\n", table_size);
+	os << misc::fmt("\tTAGE.BaseSize: %d\n", base_size);
+	os << misc::fmt("\tTAGE.TagBits: %d\n", tag_bits);
+	os << misc::fmt("\tTAGE.MinHistory: %d\n", min_history);
+	os << misc::fmt("\tTAGE.MaxHistory: %d\n", max_history);
+	os << misc::fmt("\tTAGE.LoopPredictor: %s\n",
+			loop_predictor ? "True" : "False");
+	os << misc::fmt("\tTAGE.LoopSize: %d\n", loop_size);
+	os << misc::fmt("\tTAGE.StatisticalCorrector: %s\n",
+			statistical_corrector ? "True" : "False");
+	os << misc::fmt("\tTAGE.SCSize: %d\n", sc_size);
+}
+
+
+int TagePredictor::getHistoryLength()
+{
+	int length = max_history;
+	if (statistical_corrector)
+		length = std::max(length,
+				sc_history_lengths[num_sc_tables - 1]);
+	return length + 1;
+}
+
+
+TagePredictor::TagePredictor()
+{
+	// Base table
+	base.resize(base_size);
+
+	// Tagged tables, with history lengths in a geometric series between
+	// the minimum and maximum history lengths
+	log_table_size = misc::LogBase2(table_size);
+	tables.resize(num_tables);
+	for (int i = 0; i < num_tables; i++)
+	{
+		int length = min_history;
+		if (num_tables > 1)
+			length = (int) (min_history * std::pow((double)
+					max_history / min_history, (double) i /
+					(num_tables - 1)) + 0.5);
+		tables[i].resize(table_size);
+		history_lengths.push_back(length);
+		index_histories.emplace_back(length, log_table_size);
+		tag_histories[0].emplace_back(length, tag_bits);
+		tag_histories[1].emplace_back(length, tag_bits - 1);
+	}
+
+	// Loop predictor. Tags are limited to 14 bits, so entries start with
+	// a tag that never matches.
+	if (loop_predictor)
+	{
+		log_loop_size = misc::LogBase2(loop_size);
+		loop_table.resize(loop_size);
+		for (LoopEntry &entry : loop_table)
+			entry.tag = ~0u;
+	}
+
+	// Statistical corrector
+	if (statistical_corrector)
+	{
+		log_sc_size = misc::LogBase2(sc_size);
+		sc_tables.resize(num_sc_tables);
+		for (int i = 0; i < num_sc_tables; i++)
+		{
+			sc_tables[i].resize(sc_size);
+			if (i > 0)
+				sc_histories.emplace_back(sc_history_lengths[i],
+						log_sc_size);
+		}
+	}
+}
+
+
+unsigned TagePredictor::getRandom()
+{
+	// Xorshift generator, deterministic across runs
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 17;
+	random_state ^= random_state << 5;
+	return random_state;
+}
+
+
+void TagePredictor::ComputeIndices(unsigned eip,
+		const BranchHistory &history,
+		Info &info) const
+{
+	int log_size = log_table_size;
+	for (int i = 0; i < num_tables; i++)
+	{
+		// Hash of the path history, limited to 16 branches
+		int path_length = std::min(history_lengths[i], 16);
+		unsigned path = history.getPath() & ((1u << path_length) - 1);
+		path ^= path >> log_size;
+
+		// Index and tag
+		unsigned index = eip ^ (eip >> (std::abs(log_size - i) + 1)) ^
+				index_histories[i].get() ^ path;
+		unsigned tag = eip ^ tag_histories[0][i].get() ^
+				(tag_histories[1][i].get() << 1);
+		info.indices[i] = index & (table_size - 1);
+		info.tags[i] = tag & ((1u << tag_bits) - 1);
+	}
+	info.base_index = eip & (base_size - 1);
+}
+
+
+void TagePredictor::LookupLoop(unsigned eip, Info &info) const
+{
+	int log_size = log_loop_size;
+	info.loop_index = (eip ^ (eip >> log_size)) & (loop_size - 1);
+	info.loop_tag = (eip >> log_size) & 0x3fff;
+
+	const LoopEntry &entry = loop_table[info.loop_index];
+	info.loop_hit = entry.tag == info.loop_tag;
+	info.loop_valid = info.loop_hit && entry.confidence == 3;
+	info.loop_prediction = entry.speculative_iterations + 1 ==
+			entry.past_iterations ? !entry.direction :
+			entry.direction;
+}
+
+
+void TagePredictor::LookupStatisticalCorrector(unsigned eip, Info &info) const
+{
+	// The bias table is indexed by the address and the TAGE prediction,
+	// the rest of the tables by the address and the global history.
+	int log_size = log_sc_size;
+	unsigned hash = eip ^ (eip >> log_size);
+	info.sc_indices[0] = ((hash << 1) | info.tage_prediction) &
+			(sc_size - 1);
+	for (int i = 1; i < num_sc_tables; i++)
+		info.sc_indices[i] = (hash ^ sc_histories[i - 1].get() ^
+				(i << (log_size - 3))) & (sc_size - 1);
+
+	// Sum of the centered counters
+	info.sc_sum = 0;
+	for (int i = 0; i < num_sc_tables; i++)
+		info.sc_sum += 2 * sc_tables[i][info.sc_indices[i]] + 1;
+	info.sc_prediction = info.sc_sum >= 0;
+}
+
+
+bool TagePredictor::Lookup(unsigned eip, const BranchHistory &history,
+		Info &info) const
+{
+	// Find the two tables with the longest matching histories
+	ComputeIndices(eip, history, info);
+	info.provider = -1;
+	info.alt_provider = -1;
+	for (int i = num_tables - 1; i >= 0; i--)
+	{
+		if (tables[i][info.indices[i]].tag != info.tags[i])
+			continue;
+		if (info.provider < 0)
+		{
+			info.provider = i;
+		}
+		else
+		{
+			info.alt_provider = i;
+			break;
+		}
+	}
+
+	// Alternate prediction
+	signed char base_counter = base[info.base_index];
+	info.alt_prediction = info.alt_provider >= 0 ?
+			tables[info.alt_provider][info.indices[info.alt_provider]]
+					.counter >= 0 :
+			base_counter >= 0;
+
+	// TAGE prediction
+	if (info.provider >= 0)
+	{
+		const Entry &entry = tables[info.provider][info.indices[info.provider]];
+		info.provider_prediction = entry.counter >= 0;
+		info.weak_new = entry.useful == 0 &&
+				(entry.counter == 0 || entry.counter == -1);
+		info.high_confidence = std::abs(2 * entry.counter + 1) == 7;
+		info.tage_prediction = info.weak_new && use_alt_on_weak_new >= 0 ?
+				info.alt_prediction :
+				info.provider_prediction;
+	}
+	else
+	{
+		info.provider_prediction = info.alt_prediction;
+		info.weak_new = false;
+		info.high_confidence = std::abs(2 * base_counter + 1) == 3;
+		info.tage_prediction = info.alt_prediction;
+	}
+	info.prediction = info.tage_prediction;
+
+	// The statistical corrector reverts predictions of low confidence
+	if (statistical_corrector)
+	{
+		LookupStatisticalCorrector(eip, info);
+		if (!info.high_confidence &&
+				info.sc_prediction != info.tage_prediction &&
+				std::abs(info.sc_sum) >= sc_threshold)
+			info.prediction = info.sc_prediction;
+	}
+
+	// The loop predictor overrides the rest when confident
+	if (loop_predictor)
+	{
+		LookupLoop(eip, info);
+		if (info.loop_valid && use_loop >= 0)
+			info.prediction = info.loop_prediction;
+	}
+
+	// Done
+	return info.prediction;
+}
+
+
+void TagePredictor::RecordOutcome(bool taken, const Info &info)
+{
+	// Only the loop predictor keeps speculative state
+	if (!loop_predictor || !info.loop_hit)
+		return;
+
+	// The entry may have been replaced since the lookup
+	LoopEntry &entry = loop_table[info.loop_index];
+	if (entry.tag != info.loop_tag)
+		return;
+
+	// Count iterations, restarting when the loop exits
+	if (taken == entry.direction)
+		entry.speculative_iterations++;
+	else
+		entry.speculative_iterations = 0;
+}
+
+
+void TagePredictor::UpdateHistory(const BranchHistory &history)
+{
+	for (int i = 0; i < num_tables; i++)
+	{
+		index_histories[i].Update(history);
+		tag_histories[0][i].Update(history);
+		tag_histories[1][i].Update(history);
+	}
+	for (FoldedHistory &sc_history : sc_histories)
+		sc_history.Update(history);
+}
+
+
+void TagePredictor::UpdateLoop(bool taken, const Info &info)
+{
+	// Maximum number of iterations tracked
+	const int max_iterations = 1023;
+
+	LoopEntry &entry = loop_table[info.loop_index];
+	if (info.loop_hit && entry.tag == info.loop_tag)
+	{
+		// Trust the loop predictor if it was right when it disagreed
+		// with TAGE
+		if (info.loop_valid && info.loop_prediction != info.tage_prediction)
+		{
+			use_loop += info.loop_prediction == taken ? 1 : -1;
+			use_loop = std::max(-8, std::min(7, use_loop));
+		}
+
+		// A confident entry that mispredicts is freed
+		if (info.loop_valid && info.loop_prediction != taken)
+		{
+			entry = LoopEntry();
+			entry.tag = ~0u;
+			return;
+		}
+
+		// Keep entries that predict better than TAGE
+		if (info.loop_valid && info.tage_prediction != taken &&
+				entry.age < 7)
+			entry.age++;
+
+		// Iteration within the loop
+		if (taken == entry.direction)
+		{
+			entry.current_iterations++;
+			if (entry.current_iterations > max_iterations)
+			{
+				entry = LoopEntry();
+				entry.tag = ~0u;
+			}
+			return;
+		}
+
+		// Loop exit. Gain confidence when the trip count repeats, learn
+		// it the first time, and free the entry otherwise.
+		if (entry.past_iterations == 0)
+		{
+			entry.past_iterations = entry.current_iterations + 1;
+		}
+		else if (entry.current_iterations + 1 == entry.past_iterations)
+		{
+			if (entry.confidence < 3)
+				entry.confidence++;
+		}
+		else
+		{
+			entry = LoopEntry();
+			entry.tag = ~0u;
+			return;
+		}
+		entry.current_iterations = 0;
+		return;
+	}
+
+	// Allocate an entry when TAGE mispredicts, assuming that the branch
+	// just exited a loop.
+	if (info.tage_prediction == taken)
+		return;
+	if (entry.age > 0)
+	{
+		entry.age--;
+		return;
+	}
+	entry = LoopEntry();
+	entry.tag = info.loop_tag;
+	entry.direction = !taken;
+	entry.age = 7;
+}
+
+
+void TagePredictor::UpdateStatisticalCorrector(bool taken, const Info &info)
+{
+	// Adapt the threshold when the corrector disagrees with TAGE
+	if (info.sc_prediction != info.tage_prediction)
+	{
+		if (info.sc_prediction != taken)
+		{
+			sc_threshold_counter++;
+			if (sc_threshold_counter >= 31)
+			{
+				sc_threshold++;
+				sc_threshold_counter = 0;
+			}
+		}
+		else if (std::abs(info.sc_sum) < sc_threshold)
+		{
+			sc_threshold_counter--;
+			if (sc_threshold_counter <= -32)
+			{
+				sc_threshold = std::max(1, sc_threshold - 1);
+				sc_threshold_counter = 0;
+			}
+		}
+	}
+
+	// Train the counters on mispredictions and low-margin predictions
+	if (info.sc_prediction != taken || std::abs(info.sc_sum) < sc_threshold)
+		for (int i = 0; i < num_sc_tables; i++)
+			UpdateCounter(sc_tables[i][info.sc_indices[i]], taken,
+					-32, 31);
+}
+
+
+void TagePredictor::UpdateTables(bool taken, const Info &info)
+{
+	// Allocate new entries when TAGE mispredicts, unless the provider
+	// already uses the longest history
+	bool allocate = info.tage_prediction != taken &&
+			info.provider < num_tables - 1;
+	if (info.provider >= 0 && info.weak_new)
+	{
+		// A new entry that was right needs no longer history
+		if (info.provider_prediction == taken)
+			allocate = false;
+
+		// Learn whether new entries are worse than the alternate
+		// prediction
+		if (info.provider_prediction != info.alt_prediction)
+		{
+			use_alt_on_weak_new += info.alt_prediction == taken ? 1 : -1;
+			use_alt_on_weak_new = std::max(-8,
+					std::min(7, use_alt_on_weak_new));
+		}
+	}
+
+	// Allocate one entry in a table with a longer history, skipping the
+	// first candidate at random to spread allocations.
+	if (allocate)
+	{
+		int start = info.provider + 1;
+		if (start < num_tables - 1 && (getRandom() & 1))
+			start++;
+		bool allocated = false;
+		for (int i = start; i < num_tables; i++)
+		{
+			Entry &entry = tables[i][info.indices[i]];
+			if (entry.useful)
+				continue;
+			entry.tag = info.tags[i];
+			entry.counter = taken ? 0 : -1;
+			allocated = true;
+			break;
+		}
+
+		// No entry could be allocated, age candidates
+		if (!allocated)
+			for (int i = info.provider + 1; i < num_tables; i++)
+			{
+				Entry &entry = tables[i][info.indices[i]];
+				if (entry.useful)
+					entry.useful--;
+			}
+	}
+
+	// Update the provider, skipping entries replaced since the lookup
+	Entry *provider = nullptr;
+	if (info.provider >= 0)
+	{
+		provider = &tables[info.provider][info.indices[info.provider]];
+		if (provider->tag != info.tags[info.provider])
+			provider = nullptr;
+	}
+	if (provider)
+	{
+		// Entries not proven useful also train the alternate provider
+		if (!provider->useful)
+		{
+			if (info.alt_provider >= 0)
+				UpdateCounter(tables[info.alt_provider]
+						[info.indices[info.alt_provider]]
+						.counter, taken, -4, 3);
+			else
+				UpdateCounter(base[info.base_index], taken,
+						-2, 1);
+		}
+		UpdateCounter(provider->counter, taken, -4, 3);
+
+		// The provider is useful if it was right where the alternate
+		// prediction was wrong
+		if (info.provider_prediction != info.alt_prediction)
+		{
+			if (info.provider_prediction == taken)
+			{
+				if (provider->useful < 3)
+					provider->useful++;
+			}
+			else if (provider->useful)
+			{
+				provider->useful--;
+			}
+		}
+	}
+	else if (info.provider < 0)
+	{
+		UpdateCounter(base[info.base_index], taken, -2, 1);
+	}
+
+	// Periodically age all useful counters
+	num_updates++;
+	if (!(num_updates & ((1 << 18) - 1)))
+		for (auto &table : tables)
+			for (Entry &entry : table)
+				entry.useful >>= 1;
+}
+
+
+void TagePredictor::Update(bool taken, const Info &info)
+{
+	if (loop_predictor)
+		UpdateLoop(taken, info);
+	if (statistical_corrector)
+		UpdateStatisticalCorrector(taken, info);
+	UpdateTables(taken, info);
+}
+
+
+}  // namespace x86
@@ -0,0 +1,342 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_TAGE_PREDICTOR_H
+#define ARCH_X86_TIMING_TAGE_PREDICTOR_H
+
+#include <iostream>
+#include <vector>
+
+#include <lib/cpp/IniFile.h>
+
+#include "BranchHistory.h"
+
+
+namespace x86
+{
+
+/// TAGE conditional branch predictor. A bimodal base table is backed by a
+/// set of partially tagged tables indexed with geometrically increasing
+/// lengths of the global history. The prediction is provided by the
+/// matching table with the longest history. Optionally, a loop predictor
+/// overrides the prediction for loops with a constant trip count, and a
+/// statistical corrector reverts low-confidence predictions that behave
+/// against a statistical bias.
+class TagePredictor
+{
+public:
+
+	/// Maximum number of tagged tables
+	static const int max_num_tables = 16;
+
+	/// Number of tables of the statistical corrector, including the bias
+	/// table indexed by address and TAGE prediction.
+	static const int num_sc_tables = 5;
+
+	/// Information recorded by a lookup in the predictor, kept in the
+	/// branch uop until it commits to update the predictor.
+	struct Info
+	{
+		/// Index in each tagged table
+		int indices[max_num_tables];
+
+		/// Tag computed for each tagged table
+		unsigned tags[max_num_tables];
+
+		/// Index in the base table
+		int base_index = 0;
+
+		/// Tagged table providing the prediction, or -1 if the base
+		/// table provided it.
+		int provider = -1;
+
+		/// Tagged table providing the alternate prediction, or -1 if
+		/// the base table provided it.
+		int alt_provider = -1;
+
+		/// Prediction of the provider table
+		bool provider_prediction = false;
+
+		/// Alternate prediction
+		bool alt_prediction = false;
+
+		/// Whether the provider entry is newly allocated and weak, in
+		/// which case the alternate prediction may be used instead.
+		bool weak_new = false;
+
+		/// Whether the provider counter is saturated
+		bool high_confidence = false;
+
+		/// Prediction of the TAGE tables
+		bool tage_prediction = false;
+
+		/// Index in the loop predictor
+		int loop_index = 0;
+
+		/// Tag of the branch in the loop predictor
+		unsigned loop_tag = 0;
+
+		/// Whether the branch was found in the loop predictor
+		bool loop_hit = false;
+
+		/// Whether the loop predictor entry was confident
+		bool loop_valid = false;
+
+		/// Prediction of the loop predictor
+		bool loop_prediction = false;
+
+		/// Index in each table of the statistical corrector
+		int sc_indices[num_sc_tables];
+
+		/// Sum of the statistical corrector counters
+		int sc_sum = 0;
+
+		/// Prediction of the statistical corrector
+		bool sc_prediction = false;
+
+		/// Final prediction
+		bool prediction = false;
+	};
+
+private:
+
+	//
+	// Static fields
+	//
+
+	// Number of tagged tables
+	static int num_tables;
+
+	// Number of entries in each tagged table
+	static int table_size;
+
+	// Number of entries in the base table
+	static int base_size;
+
+	// Number of tag bits in the tagged tables
+	static int tag_bits;
+
+	// History length of the first tagged table
+	static int min_history;
+
+	// History length of the last tagged table
+	static int max_history;
+
+	// Whether the loop predictor is present
+	static bool loop_predictor;
+
+	// Number of entries in the loop predictor
+	static int loop_size;
+
+	// Whether the statistical corrector is present
+	static bool statistical_corrector;
+
+	// Number of entries in each table of the statistical corrector
+	static int sc_size;
+
+	// History lengths of the tables of the statistical corrector
+	static const int sc_history_lengths[num_sc_tables];
+
+
+
+
+	//
+	// Class members
+	//
+
+	// Entry of a tagged table
+	struct Entry
+	{
+		// Signed 3-bit prediction counter
+		signed char counter = 0;
+
+		// Useful counter, 2 bits
+		unsigned char useful = 0;
+
+		// Partial tag
+		unsigned tag = 0;
+	};
+
+	// Entry of the loop predictor
+	struct LoopEntry
+	{
+		// Partial tag
+		unsigned tag = 0;
+
+		// Trip count observed in the last complete execution of the
+		// loop
+		int past_iterations = 0;
+
+		// Iteration count of the current execution, updated at commit
+		int current_iterations = 0;
+
+		// Iteration count of the current execution, updated at fetch
+		int speculative_iterations = 0;
+
+		// Number of consecutive executions with the same trip count
+		int confidence = 0;
+
+		// Replacement age
+		int age = 0;
+
+		// Direction of the branch while the loop iterates
+		bool direction = false;
+	};
+
+	// Base-2 logarithms of the sizes of the tagged tables, loop
+	// predictor, and statistical corrector tables
+	int log_table_size = 0;
+	int log_loop_size = 0;
+	int log_sc_size = 0;
+
+	// Signed 2-bit counters of the base table
+	std::vector<signed char> base;
+
+	// Tagged tables
+	std::vector<std::vector<Entry>> tables;
+
+	// History length of each tagged table
+	std::vector<int> history_lengths;
+
+	// Folded histories used to compute the index in each tagged table
+	std::vector<FoldedHistory> index_histories;
+
+	// Folded histories used to compute the tag in each tagged table,
+	// folded in two different lengths.
+	std::vector<FoldedHistory> tag_histories[2];
+
+	// Counter deciding whether to use the alternate prediction when the
+	// provider entry is newly allocated
+	int use_alt_on_weak_new = 0;
+
+	// Number of updates, used to age the useful counters periodically
+	long long num_updates = 0;
+
+	// State of the pseudo-random number generator used for allocation
+	unsigned random_state = 1;
+
+	// Loop predictor
+	std::vector<LoopEntry> loop_table;
+
+	// Counter deciding whether to trust the loop predictor
+	int use_loop = 0;
+
+	// Signed 6-bit counters of the statistical corrector
+	std::vector<std::vector<signed char>> sc_tables;
+
+	// Folded histories used to index the statistical corrector
+	std::vector<FoldedHistory> sc_histories;
+
+	// Threshold of the statistical corrector
+	int sc_threshold = 12;
+
+	// Counter used to adapt the threshold of the statistical corrector
+	int sc_threshold_counter = 0;
+
+	// Return the next pseudo-random number
+	unsigned getRandom();
+
+	// Compute the indices and tags for the tagged tables
+	void ComputeIndices(unsigned eip, const BranchHistory &history,
+			Info &info) const;
+
+	// Look up the loop predictor
+	void LookupLoop(unsigned eip, Info &info) const;
+
+	// Look up the statistical corrector
+	void LookupStatisticalCorrector(unsigned eip, Info &info) const;
+
+	// Update the loop predictor
+	void UpdateLoop(bool taken, const Info &info);
+
+	// Update the statistical corrector
+	void UpdateStatisticalCorrector(bool taken, const Info &info);
+
+	// Update the tagged and base tables
+	void UpdateTables(bool taken, const Info &info);
+
+public:
+
+	/// Read the configuration of the predictor from section
+	/// [ BranchPredictor ] of the x86 configuration file.
+	static void ParseConfiguration(misc::IniFile *ini_file);
+
+	/// Dump the configuration of the predictor
+	static void DumpConfiguration(std::ostream &os);
+
+	/// Return the number of tagged tables
+	static int getNumTables() { return num_tables; }
+
+	/// Return the number of entries in each tagged table
+	static int getTableSize() { return table_size; }
+
+	/// Return the number of entries in the base table
+	static int getBaseSize() { return base_size; }
+
+	/// Return the number of tag bits of the tagged tables
+	static int getTagBits() { return tag_bits; }
+
+	/// Return the shortest history length of the tagged tables
+	static int getMinHistory() { return min_history; }
+
+	/// Return the longest history length of the tagged tables
+	static int getMaxHistory() { return max_history; }
+
+	/// Return whether the loop predictor is present
+	static bool hasLoopPredictor() { return loop_predictor; }
+
+	/// Return the number of entries in the loop predictor
+	static int getLoopSize() { return loop_size; }
+
+	/// Return whether the statistical corrector is present
+	static bool hasStatisticalCorrector() { return statistical_corrector; }
+
+	/// Return the number of entries in each statistical corrector table
+	static int getSCSize() { return sc_size; }
+
+	/// Return the number of outcomes that the global history must
+	/// remember for this predictor.
+	static int getHistoryLength();
+
+	/// Constructor
+	TagePredictor();
+
+	/// Predict the direction of the conditional branch at address \a eip,
+	/// and record in \a info the information needed to update the
+	/// predictor later.
+	bool Lookup(unsigned eip, const BranchHistory &history, Info &info) const;
+
+	/// Advance the speculative state of the predictor with the actual
+	/// direction of a conditional branch on the correct path, right after
+	/// it was looked up.
+	void RecordOutcome(bool taken, const Info &info);
+
+	/// Update the folded histories after an outcome was pushed to the
+	/// global history.
+	void UpdateHistory(const BranchHistory &history);
+
+	/// Train the predictor with the direction of a committed conditional
+	/// branch, given the information recorded when it was looked up.
+	void Update(bool taken, const Info &info);
+};
+
+
+}  // namespace x86
+
+#endif
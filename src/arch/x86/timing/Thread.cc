@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include "Cpu.h"
 #include "Timing.h"
 #include "Thread.h"
@@ -54,7 +56,17 @@ const misc::StringMap Thread::dispatch_stall_map =
 Thread::Thread(Core *core,
 		int id_in_core) :
 		core(core),
-		id_in_core(id_in_core)
+		id_in_core(id_in_core),
+		fetch_queue(Cpu::getFetchQueueSize(), &Uop::fetch_queue_index),
+		uop_queue(Cpu::getUopQueueSize(), &Uop::uop_queue_index),
+		reorder_buffer(Cpu::getReorderBufferSize(),
+				&Uop::reorder_buffer_index),
+		instruction_queue(Cpu::getInstructionQueueSize(),
+				&Uop::instruction_queue_index),
+		load_queue(Cpu::getLoadStoreQueueSize(),
+				&Uop::load_queue_index),
+		store_queue(Cpu::getLoadStoreQueueSize(),
+				&Uop::store_queue_index)
 {
 	// Assign name
 	name = misc::fmt("Core %d Thread %d", core->getId(), id_in_core);
@@ -110,7 +122,7 @@ void Thread::InsertInFetchQueue(std::shared_ptr<Uop> uop)
 
 	// Insert in queue
 	uop->in_fetch_queue = true;
-	uop->fetch_queue_iterator = fetch_queue.insert(fetch_queue.end(), uop);
+	fetch_queue.push_back(uop);
 
 	// Increase occupancy of fetch queue or trace queue
 	if (uop->from_trace_cache)
@@ -135,17 +147,12 @@ void Thread::ExtractFromFetchQueue(Uop *uop)
 	// Sanity: uop must be in the fetch queue, and must be either the first
 	// or the last element in it.
 	assert(uop->in_fetch_queue);
-	assert(uop->fetch_queue_iterator != fetch_queue.end());
 	assert(fetch_queue.size() > 0);
 	assert(uop == fetch_queue.front().get() ||
 			uop == fetch_queue.back().get());
-	
-	// Save iterator
-	auto it = uop->fetch_queue_iterator;
 
 	// Mark uop as extracted
 	uop->in_fetch_queue = false;
-	uop->fetch_queue_iterator = fetch_queue.end();
 
 	// Decrease occupancy of fetch queue or trace queue
 	if (uop->from_trace_cache)
@@ -168,7 +175,7 @@ void Thread::ExtractFromFetchQueue(Uop *uop)
 	}
 
 	// Extract uop as last step, since uop may be freed here
-	fetch_queue.erase(it);
+	fetch_queue.erase(uop);
 }
 
 
@@ -201,7 +208,7 @@ void Thread::InsertInUopQueue(std::shared_ptr<Uop> uop)
 {
 	assert(!uop->in_uop_queue);
 	uop->in_uop_queue = true;
-	uop->uop_queue_iterator = uop_queue.insert(uop_queue.end(), uop);
+	uop_queue.push_back(uop);
 }
 
 
@@ -211,17 +218,14 @@ void Thread::ExtractFromUopQueue(Uop *uop)
 	// or the last element in it.
 	assert(uop->in_uop_queue);
 	assert(uop_queue.size() > 0);
-	assert(uop == uop_queue.front().get() || uop_queue.back().get());
-
-	// Save iterator
-	auto it = uop->uop_queue_iterator;
+	assert(uop == uop_queue.front().get() ||
+			uop == uop_queue.back().get());
 
 	// Mark uop as extracted
 	uop->in_uop_queue = false;
-	uop->uop_queue_iterator = uop_queue.end();
 
 	// Extract uop as last step, since this may free it
-	uop_queue.erase(it);
+	uop_queue.erase(uop);
 }
 
 
@@ -285,7 +289,7 @@ void Thread::InsertInReorderBuffer(std::shared_ptr<Uop> uop)
 
 	// Insert into reorder buffer
 	uop->in_reorder_buffer = true;
-	uop->reorder_buffer_iterator = reorder_buffer.insert(reorder_buffer.end(), uop);
+	reorder_buffer.push_back(uop);
 
 	// Increase per-core counter
 	core->incReorderBufferOccupancy();
@@ -298,17 +302,14 @@ void Thread::ExtractFromReorderBuffer(Uop *uop)
 	// first or the last instruction in that queue.
 	assert(uop->in_reorder_buffer);
 	assert(reorder_buffer.size() > 0);
-	assert(uop == reorder_buffer.front().get() || reorder_buffer.back().get());
-
-	// Save iterator
-	auto it = uop->reorder_buffer_iterator;
+	assert(uop == reorder_buffer.front().get() ||
+			uop == reorder_buffer.back().get());
 
 	// Mark uop as extracted
 	uop->in_reorder_buffer = false;
-	uop->reorder_buffer_iterator = reorder_buffer.end();
 
 	// Extract uop as last step, since this may free it
-	reorder_buffer.erase(it);
+	reorder_buffer.erase(uop);
 
 	// Decrease per-core counter
 	core->decReorderBufferOccupancy();
@@ -405,8 +406,11 @@ void Thread::InsertInInstructionQueue(std::shared_ptr<Uop> uop)
 
 	// Insert into instruction queue
 	uop->in_instruction_queue = true;
-	uop->instruction_queue_iterator = instruction_queue.insert(
-			instruction_queue.end(), uop);
+	instruction_queue.push_back(uop);
+
+	// Wait for input registers, or insert in ready list
+	if (register_file->TrackUop(uop.get()))
+		InsertInReadyList(instruction_ready_list, uop.get());
 
 	// Increase per-core counter
 	core->incInstructionQueueOccupancy();
@@ -420,15 +424,17 @@ void Thread::ExtractFromInstructionQueue(Uop *uop)
 	assert(!uop->in_store_queue);
 	assert(uop->in_instruction_queue);
 
-	// Save iterator
-	auto it = uop->instruction_queue_iterator;
+	// Remove from ready list, or stop waiting for input registers
+	if (uop->ready)
+		ExtractFromReadyList(instruction_ready_list, uop);
+	else
+		register_file->UntrackUop(uop);
 
 	// Mark uop as not present
 	uop->in_instruction_queue = false;
-	uop->instruction_queue_iterator = instruction_queue.end();
 	
 	// Remove from queue as the last step, as this may free the uop
-	instruction_queue.erase(it);
+	instruction_queue.erase(uop);
 
 	// Decrease per-core counter
 	core->decInstructionQueueOccupancy();
@@ -500,13 +506,13 @@ void Thread::InsertInLoadStoreQueue(std::shared_ptr<Uop> uop)
 
 	case Uinst::OpcodeLoad:
 
-		uop->load_queue_iterator = load_queue.insert(load_queue.end(), uop);
+		load_queue.push_back(uop);
 		uop->in_load_queue = true;
 		break;
 
 	case Uinst::OpcodeStore:
 
-		uop->store_queue_iterator = store_queue.insert(store_queue.end(), uop);
+		store_queue.push_back(uop);
 		uop->in_store_queue = true;
 		break;
 	
@@ -515,6 +521,11 @@ void Thread::InsertInLoadStoreQueue(std::shared_ptr<Uop> uop)
 		throw misc::Panic("Invalid micro-instruction opcode");
 	}
 
+	// Wait for input registers. Ready loads are inserted in the ready
+	// list, while stores only issue after they commit.
+	if (register_file->TrackUop(uop.get()) && uop->in_load_queue)
+		InsertInReadyList(load_ready_list, uop.get());
+
 	// Increase per-core counter
 	core->incLoadStoreQueueOccupancy();
 }
@@ -527,15 +538,17 @@ void Thread::ExtractFromLoadQueue(Uop *uop)
 	assert(!uop->in_store_queue);
 	assert(!uop->in_instruction_queue);
 
-	// Save iterator
-	auto it = uop->load_queue_iterator;
+	// Remove from ready list, or stop waiting for input registers
+	if (uop->ready)
+		ExtractFromReadyList(load_ready_list, uop);
+	else
+		register_file->UntrackUop(uop);
 
 	// Mark as not present in the queue
 	uop->in_load_queue = false;
-	uop->load_queue_iterator = load_queue.end();
 	
 	// Remove from queue as last step, as this may free uop
-	load_queue.erase(it);
+	load_queue.erase(uop);
 
 	// Decrease per-core counter
 	core->decLoadStoreQueueOccupancy();
@@ -549,21 +562,50 @@ void Thread::ExtractFromStoreQueue(Uop *uop)
 	assert(!uop->in_load_queue);
 	assert(uop->in_store_queue);
 
-	// Save iterator
-	auto it = uop->store_queue_iterator;
+	// Stop waiting for input registers
+	register_file->UntrackUop(uop);
 
 	// Mark as not present in the queue
 	uop->in_store_queue = false;
-	uop->store_queue_iterator = store_queue.end();
 
 	// Remove from queue as last step, as this may free uop
-	store_queue.erase(it);
+	store_queue.erase(uop);
 
 	// Decrease per-core counter
 	core->decLoadStoreQueueOccupancy();
 }
 
 
+void Thread::InsertInReadyList(std::vector<Uop *> &ready_list, Uop *uop)
+{
+	// Uops usually become ready in order, so look for the insertion point
+	// starting at the back.
+	auto it = ready_list.end();
+	while (it != ready_list.begin() && (*(it - 1))->getId() > uop->getId())
+		--it;
+	ready_list.insert(it, uop);
+}
+
+
+void Thread::ExtractFromReadyList(std::vector<Uop *> &ready_list, Uop *uop)
+{
+	auto it = std::lower_bound(ready_list.begin(), ready_list.end(), uop,
+			[](Uop *a, Uop *b) { return a->getId() < b->getId(); });
+	assert(it != ready_list.end() && *it == uop);
+	ready_list.erase(it);
+}
+
+
+void Thread::InsertInReadyList(Uop *uop)
+{
+	assert(uop->ready);
+	if (uop->in_instruction_queue)
+		InsertInReadyList(instruction_ready_list, uop);
+	else if (uop->in_load_queue)
+		InsertInReadyList(load_ready_list, uop);
+}
+
+
 void Thread::DumpLoadStoreQueue(std::ostream &os) const
 {
 	// Load queue
@@ -610,5 +652,77 @@ void Thread::DumpLoadStoreQueue(std::ostream &os) const
 }
 
 
+bool Thread::isIdle()
+{
+	// A context being evicted is handled by the scheduler
+	if (context && context->evict_signal)
+		return false;
+
+	// Fetch stage
+	if (canFetch() == FetchStallUsed)
+		return false;
+
+	// Decode stage, which can make progress unless the uop at the head of
+	// the fetch queue still waits for the instruction cache
+	if (!fetch_queue.empty() && (int) uop_queue.size() <
+			Cpu::getUopQueueSize())
+	{
+		Uop *uop = fetch_queue.front().get();
+		if (uop->from_trace_cache || !instruction_module->
+				isInFlightAccess(uop->fetch_access))
+			return false;
+	}
+
+	// Dispatch stage
+	if (canDispatch() == DispatchStallUsed)
+		return false;
+
+	// Issue stage. Ready uops in the instruction queue may be waiting for
+	// a functional unit, which becomes available in a later cycle.
+	if (!instruction_ready_list.empty())
+		return false;
+	for (Uop *uop : load_ready_list)
+		if (data_module->canAccess(uop->physical_address))
+			return false;
+	if (!store_queue.empty())
+	{
+		Uop *uop = store_queue.front().get();
+		if (!uop->in_reorder_buffer &&
+				data_module->canAccess(uop->physical_address))
+			return false;
+	}
+
+	// Commit stage
+	if (!reorder_buffer.empty())
+	{
+		Uop *uop = reorder_buffer.front().get();
+		if (uop->getOpcode() == Uinst::OpcodeStore ?
+				register_file->isUopReady(uop) :
+				uop->completed)
+			return false;
+	}
+
+	// Idle
+	return true;
+}
+
+
+long long Thread::getCommitStallCycle() const
+{
+	if (!context || !context->getState(Context::StateRunning))
+		return -1;
+	return last_commit_cycle + max_commit_stall_cycles + 1;
+}
+
+
+void Thread::SkipCycles(long long num_cycles)
+{
+	// The commit stage keeps updating the last commit cycle of a thread
+	// with no running context
+	if (!context || !context->getState(Context::StateRunning))
+		last_commit_cycle = cpu->getCycle() + num_cycles;
+}
+
+
 }
 
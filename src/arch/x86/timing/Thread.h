@@ -22,11 +22,13 @@
 
 #include <deque>
 #include <string>
+#include <vector>
 
 #include <memory/Module.h>
 #include <arch/x86/emulator/Uinst.h>
 #include <arch/x86/emulator/Context.h>
 
+#include "CircularQueue.h"
 #include "Uop.h"
 #include "BranchPredictor.h"
 #include "RegisterFile.h"
@@ -82,7 +84,7 @@ private:
 	//
 
 	// Fetch queue
-	std::list<std::shared_ptr<Uop>> fetch_queue;
+	CircularQueue fetch_queue;
 
 	// Insert a uop into the tail of the fetch queue
 	void InsertInFetchQueue(std::shared_ptr<Uop> uop);
@@ -102,7 +104,7 @@ private:
 	//
 
 	// Uop queue
-	std::list<std::shared_ptr<Uop>> uop_queue;
+	CircularQueue uop_queue;
 
 	// Insert a uop into the tail of the uop queue
 	void InsertInUopQueue(std::shared_ptr<Uop> uop);
@@ -122,7 +124,7 @@ private:
 	//
 
 	// Reorder buffer
-	std::list<std::shared_ptr<Uop>> reorder_buffer;
+	CircularQueue reorder_buffer;
 
 	// Insert a uop into the tail of the reorder buffer
 	void InsertInReorderBuffer(std::shared_ptr<Uop> uop);
@@ -148,7 +150,7 @@ private:
 	//
 
 	// Instruction queue
-	std::list<std::shared_ptr<Uop>> instruction_queue;
+	CircularQueue instruction_queue;
 
 	// Insert a uop into the tail of the instruction queue
 	void InsertInInstructionQueue(std::shared_ptr<Uop> uop);
@@ -165,6 +167,10 @@ private:
 	// Dump content of instruction queue
 	void DumpInstructionQueue(std::ostream &os = std::cout) const;
 
+	// Uops in the instruction queue whose inputs are available, sorted
+	// from the oldest to the youngest
+	std::vector<Uop *> instruction_ready_list;
+
 
 
 
@@ -173,10 +179,10 @@ private:
 	//
 	
 	// Load queue
-	std::list<std::shared_ptr<Uop>> load_queue;
+	CircularQueue load_queue;
 
 	// Store queue
-	std::list<std::shared_ptr<Uop>> store_queue;
+	CircularQueue store_queue;
 
 	// Determine whether a new uop can be inserted into this thread's
 	// load-store queue, based on whether the queue was configured as
@@ -199,6 +205,17 @@ private:
 	// Dump content of load_store queue
 	void DumpLoadStoreQueue(std::ostream &os = std::cout) const;
 
+	// Uops in the load queue whose inputs are available, sorted from the
+	// oldest to the youngest
+	std::vector<Uop *> load_ready_list;
+
+	// Insert a uop in a ready list, keeping it sorted by age
+	static void InsertInReadyList(std::vector<Uop *> &ready_list, Uop *uop);
+
+	// Remove a uop from a ready list
+	static void ExtractFromReadyList(std::vector<Uop *> &ready_list,
+			Uop *uop);
+
 
 
 
@@ -528,6 +545,13 @@ public:
 	/// The function returns the remaining quantum.
 	int IssueInstructionQueue(int quantum);
 
+	/// Insert a uop that just became ready into the ready list of the
+	/// instruction queue or the load queue, whichever contains it. Ready
+	/// stores are not inserted in any list, since they issue after
+	/// committing. This function is invoked by the register file when
+	/// the last pending input of the uop is written back.
+	void InsertInReadyList(Uop *uop);
+
 
 
 
@@ -538,6 +562,10 @@ public:
 	/// Error message for stalls
 	static const char *commit_stall_error;
 
+	/// Number of cycles without committing any uop after which a thread
+	/// with a running context is considered to be in a deadlock
+	static const long long max_commit_stall_cycles = 1000000;
+
 	/// Return true if at least one uop can be committed for the thread
 	bool canCommit();
 
@@ -575,6 +603,27 @@ public:
 
 
 
+	//
+	// Idle cycles
+	//
+
+	/// Return true if no pipeline stage of the thread can make progress
+	/// until a memory access completes or a uop in the core's event queue
+	/// finishes executing. Simulating a cycle for an idle thread only
+	/// accounts for its stalls.
+	bool isIdle();
+
+	/// Return the first cycle in which the commit stall check fails,
+	/// ending the simulation, or -1 if the thread has no running context.
+	long long getCommitStallCycle() const;
+
+	/// Update the state of the thread as if \a num_cycles idle cycles had
+	/// been simulated after the current cycle.
+	void SkipCycles(long long num_cycles);
+
+
+
+
 	//
 	// Scheduler (ThreadScheduler.cc)
 	//
@@ -41,7 +41,7 @@ bool Thread::canCommit()
 	// going wrong if more than 1M cycles go by without committing a uop.
 	if (!context || !context->getState(Context::StateRunning))
 		last_commit_cycle = cycle;
-	if (cycle - last_commit_cycle > 1000000)
+	if (cycle - last_commit_cycle > max_commit_stall_cycles)
 	{
 		// Show warning
 		misc::Warning("[x86] %s: simulation ended due to a commit "
@@ -40,6 +40,10 @@ Thread::FetchStall Thread::canFetch()
 	if (context->evict_signal)
 		return FetchStallContext;
 
+	// Fetch must not be stopped to drain the pipelines
+	if (cpu->isDraining())
+		return FetchStallContext;
+
 	// Fetch queue must have not exceeded the limit of stored bytes to be
 	// able to store new macro-instructions.
 	if (fetch_queue_occupancy >= Cpu::getFetchQueueSize())
@@ -105,7 +109,9 @@ Uop *Thread::FetchInstruction(bool fetch_from_trace_cache)
 		std::shared_ptr<Uinst> uinst = context->ExtractUinst();
 
 		// Create uop
-		auto uop = misc::new_shared<Uop>(this,
+		auto uop = std::allocate_shared<Uop>(
+				UopAllocator<Uop>(core->getUopPool()),
+				this,
 				context,
 				uinst);
 
@@ -29,26 +29,22 @@ namespace x86
 
 int Thread::IssueLoadQueue(int quantum)
 {
-	// List iterators
-	auto it = load_queue.begin();
-	auto e = load_queue.end();
-
-	// Traverse list
-	while (it != e && quantum > 0)
+	// Traverse ready loads from the oldest to the youngest
+	int index = 0;
+	while (index < (int) load_ready_list.size() && quantum > 0)
 	{
-		// Get the uop and forward iterator
-		std::shared_ptr<Uop> uop = *it;
-		++it;
-
-		// If the uop is not ready, skip it
-		if (!register_file->isUopReady(uop.get()))
-			continue;
+		// Get the uop
+		std::shared_ptr<Uop> uop = load_queue.get(load_ready_list[index]);
+		assert(uop->ready);
 
 		// Check that memory system is accessible
 		if (!data_module->canAccess(uop->physical_address))
+		{
+			index++;
 			continue;
+		}
 
-		// Remove uop from load queue
+		// Remove uop from load queue and from the ready list
 		ExtractFromLoadQueue(uop.get());
 
 		// Access memory system
@@ -185,23 +181,18 @@ int Thread::IssueLoadStoreQueue(int quantum)
 
 int Thread::IssueInstructionQueue(int quantum)
 {
-	// List iterators
-	auto it = instruction_queue.begin();
-	auto e = instruction_queue.end();
-
-	// Traverse list
-	while (it != e && quantum > 0)
+	// Traverse ready uops from the oldest to the youngest. Uops still
+	// waiting for their inputs are not in the ready list.
+	int index = 0;
+	while (index < (int) instruction_ready_list.size() && quantum > 0)
 	{
-		// Get the uop and forward iterator
-		std::shared_ptr<Uop> uop = *it;
-		++it;
+		// Get the uop
+		std::shared_ptr<Uop> uop = instruction_queue.get(
+				instruction_ready_list[index]);
 
 		// Sanity
 		assert(!(uop->getFlags() & Uinst::FlagMem));
-
-		// If the uop is not ready, skip it
-		if (!register_file->isUopReady(uop.get()))
-			continue;
+		assert(uop->ready);
 
 		// Run the instruction in its corresponding functional unit in
 		// the ALU. If the instruction does not require a functional
@@ -210,10 +201,13 @@ int Thread::IssueInstructionQueue(int quantum)
 		Alu *alu = core->getAlu();
 		int latency = alu->Reserve(uop.get());
 		if (!latency)
+		{
+			index++;
 			continue;
+		}
 
 		// Instruction was successfully issued, remove from instruction
-		// queue.
+		// queue and from the ready list.
 		ExtractFromInstructionQueue(uop.get());
 
 		// Instruction has been issued
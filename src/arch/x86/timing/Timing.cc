@@ -78,6 +78,10 @@ const std::string Timing::help_message =
 		"  RecoverPenalty = <cycles> (Default = 0)\n"
 		"      Number of cycles that the fetch stage gets stalled after a branch\n"
 		"      misprediction.\n"
+		"  SkipIdleCycles = {t|f} (Default = True)\n"
+		"      When all pipelines are waiting for the memory system or for executing\n"
+		"      instructions, jump directly to the next cycle where any of them can make\n"
+		"      progress. Results are the same as simulating every cycle.\n"
 		"  PageSize = <size> (Default = 4kB)\n"
 		"      Memory page size in bytes.\n"
 		"  DataCachePerfect = {t|f} (Default = False)\n"
@@ -213,12 +217,17 @@ const std::string Timing::help_message =
 		"\n"
 		"Section '[ BranchPredictor ]':\n"
 		"\n"
-		"  Kind = {Perfect|Taken|NotTaken|Bimodal|TwoLevel|Combined} (Default = TwoLevel)\n"
+		"  Kind = {Perfect|Taken|NotTaken|Bimodal|TwoLevel|Combined|TAGE|Perceptron}\n"
+		"          (Default = TwoLevel)\n"
 		"      Branch predictor type.\n"
 		"  BTB.Sets = <num_sets> (Default = 256)\n"
 		"      Number of sets in the BTB.\n"
 		"  BTB.Assoc = <num_ways) (Default = 4)\n"
 		"      BTB associativity.\n"
+		"  BTB.KeepTakenTarget = {t|f} (Default = f)\n"
+		"      Keep the taken target of a conditional branch in the BTB when the\n"
+		"      branch is not taken, instead of its fall-through address. This\n"
+		"      applies to all kinds of branch predictors.\n"
 		"  Bimod.Size = <entries> (Default = 1024)\n"
 		"      Number of entries of the bimodal branch predictor.\n"
 		"  Choice.Size = <entries> (Default = 1024)\n"
@@ -231,6 +240,47 @@ const std::string Timing::help_message =
 		"      For the two-level adaptive predictor, level 2 size.\n"
 		"  TwoLevel.HistorySize = <size> (Default = 8)\n"
 		"      For the two-level adaptive predictor, level 2 history size.\n"
+		"  TAGE.NumTables = <num> (Default = 7)\n"
+		"      For the TAGE predictor, number of tagged tables.\n"
+		"  TAGE.TableSize = <entries> (Default = 1024)\n"
+		"      For the TAGE predictor, number of entries in each tagged table.\n"
+		"  TAGE.BaseSize = <entries> (Default = 4096)\n"
+		"      For the TAGE predictor, number of entries in the bimodal base table.\n"
+		"  TAGE.TagBits = <bits> (Default = 11)\n"
+		"      For the TAGE predictor, number of tag bits in the tagged tables.\n"
+		"  TAGE.MinHistory = <length> (Default = 5)\n"
+		"  TAGE.MaxHistory = <length> (Default = 130)\n"
+		"      For the TAGE predictor, global history lengths of the first and last\n"
+		"      tagged tables. Lengths of intermediate tables form a geometric series.\n"
+		"  TAGE.LoopPredictor = {t|f} (Default = t)\n"
+		"      For the TAGE predictor, use a loop predictor for loops with a constant\n"
+		"      trip count.\n"
+		"  TAGE.LoopSize = <entries> (Default = 64)\n"
+		"      Number of entries of the loop predictor.\n"
+		"  TAGE.StatisticalCorrector = {t|f} (Default = t)\n"
+		"      For the TAGE predictor, use a statistical corrector to revert\n"
+		"      predictions of low confidence.\n"
+		"  TAGE.SCSize = <entries> (Default = 1024)\n"
+		"      Number of entries of each table of the statistical corrector.\n"
+		"  Perceptron.NumTables = <num> (Default = 8)\n"
+		"      For the hashed perceptron predictor, number of weight tables, including\n"
+		"      a bias table indexed only by the branch address.\n"
+		"  Perceptron.TableSize = <entries> (Default = 1024)\n"
+		"      For the hashed perceptron predictor, number of weights per table.\n"
+		"  Perceptron.MinHistory = <length> (Default = 3)\n"
+		"  Perceptron.MaxHistory = <length> (Default = 128)\n"
+		"      For the hashed perceptron predictor, length of the shortest history\n"
+		"      segment and total history length covered by all segments.\n"
+		"  ITTAGE = {t|f} (Default = f)\n"
+		"      Use an ITTAGE indirect target predictor for indirect jumps and calls,\n"
+		"      overriding the target found in the BTB.\n"
+		"  ITTAGE.NumTables = <num> (Default = 4)\n"
+		"  ITTAGE.TableSize = <entries> (Default = 256)\n"
+		"  ITTAGE.TagBits = <bits> (Default = 9)\n"
+		"  ITTAGE.MinHistory = <length> (Default = 4)\n"
+		"  ITTAGE.MaxHistory = <length> (Default = 64)\n"
+		"      Number of tagged tables, entries per table, tag bits, and history\n"
+		"      lengths of the first and last tables of the indirect target predictor.\n"
 		"\n";
 
 const char *Timing::error_fast_forward =
@@ -243,6 +293,12 @@ bool Timing::help = false;
 
 int Timing::frequency = 1000;
 
+std::string Timing::simpoints_file;
+
+std::string Timing::simpoint_weights_file;
+
+long long Timing::simpoint_warmup = 0;
+
 
 Timing::Timing() : comm::Timing("x86")
 {
@@ -252,6 +308,14 @@ Timing::Timing() : comm::Timing("x86")
 	// Create CPU
 	cpu = misc::new_unique<Cpu>(this);
 
+	// Sampled simulation
+	if (!simpoints_file.empty())
+		simpoints = misc::new_unique<SimPoints>(cpu.get(),
+				simpoints_file,
+				simpoint_weights_file,
+				Emulator::getBbvInterval(),
+				simpoint_warmup);
+
 	// Create the trace header related to CPU
 	trace.Header(misc::fmt("x86.init version=\"%d.%d\" "
 			"num_cores=%d num_threads=%d\n",
@@ -280,8 +344,10 @@ bool Timing::Run()
 	if (emulator->getNumContexts() == 0)
 		return false;
 
-	// Fast-forward simulation
-	if (Cpu::getNumFastForwardInstructions()
+	// Fast-forward simulation, or sampled simulation
+	if (simpoints)
+		simpoints->Run();
+	else if (Cpu::getNumFastForwardInstructions()
 			&& emulator->getNumInstructions()
 			< Cpu::getNumFastForwardInstructions())
 		FastForward();
@@ -312,11 +378,64 @@ bool Timing::Run()
 	// Process host threads generating events
 	emulator->ProcessEvents();
 
+	// Skip the following cycles if nothing happens in them
+	if (Cpu::getSkipIdleCycles())
+		SkipIdleCycles();
+
 	// Still simulating
 	return true;
 }
 
 
+void Timing::SkipIdleCycles()
+{
+	// Other timing simulators need to run in every cycle
+	if (comm::ArchPool::getInstance()->getNumTiming() != 1)
+		return;
+
+	// Suspended contexts are checked for wakeup in every cycle
+	Emulator *emulator = Emulator::getInstance();
+	if (emulator->getNumSuspendedContexts())
+		return;
+
+	// Nothing to skip if the simulation is ending
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	if (esim_engine->hasFinished())
+		return;
+
+	// Pipelines are checked for being drained in every cycle
+	if (cpu->isDraining())
+		return;
+
+	// Events scheduled for the current time are processed after this
+	// cycle, so no time can be skipped if there are any.
+	long long time = esim_engine->getTime();
+	long long next_event_time = esim_engine->getNextEventTime();
+	if (next_event_time == time)
+		return;
+
+	// Find the latest time that can be skipped to. The next event is
+	// processed at that time, and the CPU runs again in the cycle where
+	// it would have woken up.
+	long long cycle = getCycle();
+	long long cycle_time = getFrequencyDomain()->getCycleTime();
+	long long wakeup_cycle = cpu->getWakeupCycle();
+	long long skip_time = (wakeup_cycle - 1) * cycle_time - 1;
+	if (next_event_time >= 0 && next_event_time < skip_time)
+		skip_time = next_event_time;
+	skip_time -= skip_time % esim_engine->getCycleTime();
+
+	// Skip cycles only if the pipelines are idle
+	long long num_cycles = skip_time / cycle_time + 1 - cycle;
+	if (num_cycles <= 0 || !cpu->isIdle())
+		return;
+
+	// Skip
+	cpu->SkipCycles(num_cycles);
+	esim_engine->SkipTo(skip_time);
+}
+
+
 void Timing::FastForward()
 {
 	// Fast-forward simulation
@@ -610,6 +729,33 @@ void Timing::RegisterOptions()
 			"to run.  If this maximum is reached, the simulation "
 			"will finish with the X86MaxCycles string.");
 
+	// Option --x86-simpoints <file>
+	command_line->RegisterString("--x86-simpoints <file>", simpoints_file,
+			"Run a sampled detailed simulation of the intervals listed "
+			"in the given file, with one '<interval> <cluster>' line "
+			"per simulation point, as selected by the SimPoint tool "
+			"from the basic block vectors dumped with option "
+			"'--x86-bbv'. The execution is fast-forwarded functionally "
+			"between simulation points, scheduling contexts as the "
+			"profiling run did, so options '--x86-bbv-interval' and "
+			"'--x86-quantum' must have the same values. The weighted "
+			"statistics are dumped in the x86 report. This option is "
+			"only valid for detailed x86 simulation.");
+
+	// Option --x86-simpoint-weights <file>
+	command_line->RegisterString("--x86-simpoint-weights <file>",
+			simpoint_weights_file,
+			"Weights of the clusters of option '--x86-simpoints', with "
+			"one '<weight> <cluster>' line per cluster. If not given, "
+			"all simulation points have the same weight.");
+
+	// Option --x86-simpoint-warmup <num>
+	command_line->RegisterInt64("--x86-simpoint-warmup <num> "
+			"(default = 0)",
+			simpoint_warmup,
+			"Number of instructions simulated in detail before each "
+			"simulation point to warm up caches and predictors, "
+			"without collecting statistics.");
 }
 
 
@@ -620,11 +766,28 @@ void Timing::ProcessOptions()
 	if (!config_file.empty())
 		ini_file.Load(config_file);
 
+	// Options for sampled simulation
+	if (simpoints_file.empty() && !simpoint_weights_file.empty())
+		throw Error("Option '--x86-simpoint-weights' requires option "
+				"'--x86-simpoints'");
+	if (!simpoints_file.empty() && sim_kind != comm::Arch::SimDetailed)
+		throw Error("Option '--x86-simpoints' requires detailed "
+				"simulation (option '--x86-sim detailed')");
+	if (simpoint_warmup < 0)
+		throw Error(misc::fmt("Invalid value for "
+				"--x86-simpoint-warmup: %lld",
+				simpoint_warmup));
+
 	// Instantiate timing simulator if '--x86-sim detailed' is present
 	if (sim_kind == comm::Arch::SimDetailed)
 	{
 		// First: parse configuration
 		ParseConfiguration(&ini_file);
+		if (!simpoints_file.empty() &&
+				Cpu::getNumFastForwardInstructions())
+			throw Error("Option '--x86-simpoints' cannot be combined "
+					"with variable 'FastForward' in the x86 "
+					"configuration file");
 
 		// Second: generate instance
 		getInstance();
@@ -703,7 +866,9 @@ void Timing::DumpSummary(std::ostream &os) const
 	os << misc::fmt("CyclesPerSecond = %.0f\n", cycles_per_second);
 	
 	// Fast-forward instructions
-	os << misc::fmt("FastForwardInstructions = %lld\n", Cpu::getNumFastForwardInstructions());
+	os << misc::fmt("FastForwardInstructions = %lld\n", simpoints ?
+			simpoints->getNumFastForwardInstructions() :
+			Cpu::getNumFastForwardInstructions());
 
 	// Number of committed instructions
 	os << misc::fmt("CommittedInstructions = %lld\n", cpu->getNumCommittedInstructions());
@@ -730,6 +895,14 @@ void Timing::DumpSummary(std::ostream &os) const
 			/ cpu->getNumBranches()
 			: 0.0;
 	os << misc::fmt("BranchPredictionAccuracy = %.4g\n", branch_accuracy);
+
+	// Weighted instructions per cycle of sampled simulation
+	if (simpoints)
+	{
+		double cpi = simpoints->getCpi();
+		os << misc::fmt("SimPointsIPC = %.4g\n",
+				cpi > 0.0 ? 1.0 / cpi : 0.0);
+	}
 }
 
 
@@ -850,6 +1023,15 @@ void Timing::DumpReport() const
 			/ cpu->getNumBranches() : 0.0);
 	os << '\n';
 
+	// Sampled simulation
+	if (simpoints)
+	{
+		os << "; Sampled simulation, with statistics of the simulation "
+				"points\n";
+		os << "; weighted by their clusters\n";
+		simpoints->DumpReport(os);
+	}
+
 	// Report for each core
 	for (int i = 0; i < Cpu::getNumCores(); i++)
 	{
@@ -1082,6 +1264,7 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 	os << misc::fmt("ThreadSwitchPenalty = %d\n", cpu->getThreadSwitchPenalty());
 	os << misc::fmt("RecoverKind = %s\n", cpu->recover_kind_map[cpu->getRecoverKind()]);
 	os << misc::fmt("RecoverPenalty = %d\n", cpu->getRecoverPenalty());
+	os << misc::fmt("SkipIdleCycles = %s\n", cpu->getSkipIdleCycles() ? "True" : "False");
 	os << std::endl;
 
 	// Pipeline
@@ -1131,6 +1314,7 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 	os << misc::fmt("Kind = %s\n", BranchPredictor::KindMap[BranchPredictor::getKind()]);
 	os << misc::fmt("BTB.Sets = %d\n", BranchPredictor::getBtbNumSets());
 	os << misc::fmt("BTB.Assoc = %d\n", BranchPredictor::getBtbNumWays());
+	os << misc::fmt("BTB.KeepTakenTarget = %s\n", BranchPredictor::getBtbKeepTakenTarget() ? "True" : "False");
 	os << misc::fmt("Bimod.Size = %d\n", BranchPredictor::getBimodSize());
 	os << misc::fmt("Choice.Size = %d\n", BranchPredictor::getChoiceSize());
 	os << misc::fmt("RAS.Size = %d\n", BranchPredictor::getRasSize());
@@ -1138,6 +1322,35 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 	os << misc::fmt("TwoLevel.L2Size = %d\n", BranchPredictor::getTwoLevelL2Size());
 	os << misc::fmt("TwoLevel.L2Height = %d\n", BranchPredictor::getTwoLevelL2Height());
 	os << misc::fmt("TwoLevel.HistorySize = %d\n", BranchPredictor::getTwoLevelHistorySize());
+	if (BranchPredictor::getKind() == BranchPredictor::KindTage)
+	{
+		os << misc::fmt("TAGE.NumTables = %d\n", TagePredictor::getNumTables());
+		os << misc::fmt("TAGE.TableSize = %d\n", TagePredictor::getTableSize());
+		os << misc::fmt("TAGE.BaseSize = %d\n", TagePredictor::getBaseSize());
+		os << misc::fmt("TAGE.TagBits = %d\n", TagePredictor::getTagBits());
+		os << misc::fmt("TAGE.MinHistory = %d\n", TagePredictor::getMinHistory());
+		os << misc::fmt("TAGE.MaxHistory = %d\n", TagePredictor::getMaxHistory());
+		os << misc::fmt("TAGE.LoopPredictor = %s\n", TagePredictor::hasLoopPredictor() ? "True" : "False");
+		os << misc::fmt("TAGE.LoopSize = %d\n", TagePredictor::getLoopSize());
+		os << misc::fmt("TAGE.StatisticalCorrector = %s\n", TagePredictor::hasStatisticalCorrector() ? "True" : "False");
+		os << misc::fmt("TAGE.SCSize = %d\n", TagePredictor::getSCSize());
+	}
+	if (BranchPredictor::getKind() == BranchPredictor::KindPerceptron)
+	{
+		os << misc::fmt("Perceptron.NumTables = %d\n", PerceptronPredictor::getNumTables());
+		os << misc::fmt("Perceptron.TableSize = %d\n", PerceptronPredictor::getTableSize());
+		os << misc::fmt("Perceptron.MinHistory = %d\n", PerceptronPredictor::getMinHistory());
+		os << misc::fmt("Perceptron.MaxHistory = %d\n", PerceptronPredictor::getMaxHistory());
+	}
+	os << misc::fmt("ITTAGE = %s\n", IndirectPredictor::isPresent() ? "True" : "False");
+	if (IndirectPredictor::isPresent())
+	{
+		os << misc::fmt("ITTAGE.NumTables = %d\n", IndirectPredictor::getNumTables());
+		os << misc::fmt("ITTAGE.TableSize = %d\n", IndirectPredictor::getTableSize());
+		os << misc::fmt("ITTAGE.TagBits = %d\n", IndirectPredictor::getTagBits());
+		os << misc::fmt("ITTAGE.MinHistory = %d\n", IndirectPredictor::getMinHistory());
+		os << misc::fmt("ITTAGE.MaxHistory = %d\n", IndirectPredictor::getMaxHistory());
+	}
 	os << misc::fmt("\n");
 
 	// End of configuration
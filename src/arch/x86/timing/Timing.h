@@ -30,6 +30,7 @@
 
 #include "BranchPredictor.h"
 #include "Cpu.h"
+#include "SimPoints.h"
 #include "TraceCache.h"
 
 
@@ -71,6 +72,17 @@ class Timing : public comm::Timing
 	// Frequency of memory system in MHz
 	static int frequency;
 
+	// Simulation points file given with option '--x86-simpoints'
+	static std::string simpoints_file;
+
+	// Simulation point weights file given with option
+	// '--x86-simpoint-weights'
+	static std::string simpoint_weights_file;
+
+	// Number of instructions simulated in detail before each simulation
+	// point, given with option '--x86-simpoint-warmup'
+	static long long simpoint_warmup;
+
 	
 	
 	//
@@ -83,6 +95,9 @@ class Timing : public comm::Timing
 	// List of entry modules to the memory hierarchy
 	std::vector<mem::Module *> entry_modules;
 
+	// Sampled simulation, if option '--x86-simpoints' was given
+	std::unique_ptr<SimPoints> simpoints;
+
 	// Dump a specific part of a statistics report related with uops.
 	void DumpUopReport(std::ostream &os, const long long *uop_stats,
 			const std::string &prefix, int peak_ipc) const;
@@ -143,6 +158,11 @@ public:
 	/// Fast forward instructions set up by the user
 	void FastForward();
 
+	/// Advance the simulation time over the cycles following the current
+	/// one if the CPU is idle until the next event of the memory system or
+	/// its next wakeup cycle, accounting for the stalls of those cycles.
+	void SkipIdleCycles();
+
 	/// Run one iteration of the cpu timing simuation.
 	/// \return This function \c true if the iteration had a useful
 	/// timing simulation, and \c false if all timing simulation finished
@@ -114,4 +114,54 @@ void Uop::Dump(std::ostream &os) const
 }
 
 
+UopPool::~UopPool()
+{
+	for (void *block : free_blocks)
+		::operator delete(block);
+}
+
+
+void *UopPool::Allocate(size_t size)
+{
+	// Assign block size on first allocation
+	if (!block_size)
+		block_size = size;
+
+	// Blocks of other sizes are not pooled
+	num_blocks_in_use++;
+	if (size != block_size || free_blocks.empty())
+		return ::operator new(size);
+
+	// Reuse a free block
+	void *block = free_blocks.back();
+	free_blocks.pop_back();
+	return block;
+}
+
+
+void UopPool::Free(void *block, size_t size)
+{
+	// Return block to the pool, unless the pool was released
+	assert(num_blocks_in_use > 0);
+	num_blocks_in_use--;
+	if (size == block_size && !released)
+		free_blocks.push_back(block);
+	else
+		::operator delete(block);
+
+	// Destroy a released pool with its last block
+	if (released && !num_blocks_in_use)
+		delete this;
+}
+
+
+void UopPool::Release()
+{
+	assert(!released);
+	released = true;
+	if (!num_blocks_in_use)
+		delete this;
+}
+
+
 }
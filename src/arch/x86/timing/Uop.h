@@ -21,6 +21,9 @@
 #define ARCH_X86_TIMING_UOP_H
 
 #include <deque>
+#include <list>
+#include <memory>
+#include <vector>
 
 #include <arch/x86/emulator/Uinst.h>
 #include <arch/x86/emulator/Context.h>
@@ -259,20 +262,20 @@ public:
 
 
 	//
-	// Queues and iterators
+	// Queues
 	//
 
 	/// True if the instruction is currently in the fetch queue
 	bool in_fetch_queue = false;
 
-	/// Position of the uop in the thread's fetch queue
-	std::list<std::shared_ptr<Uop>>::iterator fetch_queue_iterator;
+	/// Slot of the uop in the thread's fetch queue, or -1 if not present
+	int fetch_queue_index = -1;
 
 	/// True if the instruction is currently in the uop queue
 	bool in_uop_queue = false;
 
-	/// Position of the uop in the thread's uop queue
-	std::list<std::shared_ptr<Uop>>::iterator uop_queue_iterator;
+	/// Slot of the uop in the thread's uop queue, or -1 if not present
+	int uop_queue_index = -1;
 
 	/// True if the instruction is currently in the core's event queue
 	bool in_event_queue = false;
@@ -285,40 +288,35 @@ public:
 	/// reorder buffer
 	bool in_reorder_buffer = false;
 
-	/// Position of the uop in the reorder buffer, if present
-	std::list<std::shared_ptr<Uop>>::iterator reorder_buffer_iterator;
+	/// Slot of the uop in the reorder buffer, or -1 if not present
+	int reorder_buffer_index = -1;
 
 	/// True if the instruction is currently present in the thread's
 	/// instruction queue
 	bool in_instruction_queue = false;
 
-	/// Position of the uop in the thread's instruction queue, or past-the-
-	/// end iterator to this queue if not present.
-	std::list<std::shared_ptr<Uop>>::iterator instruction_queue_iterator;
+	/// Slot of the uop in the thread's instruction queue, or -1 if not
+	/// present
+	int instruction_queue_index = -1;
 
 	/// True if the instruction is currently present in the thread's
 	/// load queue
 	bool in_load_queue = false;
 
-	/// Position of the uop in the thread's load queue, or past-the-end
-	/// iterator to this queue if not present.
-	std::list<std::shared_ptr<Uop>>::iterator load_queue_iterator;
+	/// Slot of the uop in the thread's load queue, or -1 if not present
+	int load_queue_index = -1;
 
 	/// True if the instruction is currently present in the thread's
 	/// store queue
 	bool in_store_queue = false;
 
-	/// Position of the uop in the thread's store queue, or past-the-end
-	/// iterator to this queue if not present.
-	std::list<std::shared_ptr<Uop>>::iterator store_queue_iterator;
+	/// Slot of the uop in the thread's store queue, or -1 if not present
+	int store_queue_index = -1;
 
 	/// True if the instruction is currently present in the uop trace list
 	/// of the CPU
 	bool in_trace_list = false;
 
-	/// Position of the uop in the CPU's trace list, if present
-	std::list<std::shared_ptr<Uop>>::iterator trace_list_iterator;
-
 
 
 	
@@ -413,6 +411,30 @@ public:
 
 	/// Prediction in the combined branch predictor
 	BranchPredictor::Prediction choice_prediction = BranchPredictor::PredictionNotTaken;
+
+	/// Whether the TAGE predictor was looked up, which only happens for
+	/// conditional branches when this predictor is used
+	bool tage_lookup = false;
+
+	/// Information recorded by the TAGE predictor, valid if 'tage_lookup'
+	/// is set
+	TagePredictor::Info tage_info;
+
+	/// Whether the perceptron predictor was looked up, which only happens
+	/// for conditional branches when this predictor is used
+	bool perceptron_lookup = false;
+
+	/// Information recorded by the perceptron predictor, valid if
+	/// 'perceptron_lookup' is set
+	PerceptronPredictor::Info perceptron_info;
+
+	/// Whether the indirect target predictor was looked up, which only
+	/// happens for indirect jumps and calls when this predictor is present
+	bool indirect_lookup = false;
+
+	/// Information recorded by the indirect target predictor, valid if
+	/// 'indirect_lookup' is set
+	IndirectPredictor::Info indirect_info;
 	
 	
 	
@@ -433,6 +455,11 @@ public:
 	/// Cycle when uop was made ready, or 0 if not ready yet
 	long long ready_when = 0;
 
+	/// Number of input dependencies on registers whose result is still
+	/// pending, while the uop waits in the instruction queue or
+	/// load-store queue
+	int num_pending_inputs = 0;
+
 	/// True if uop was already issued
 	bool issued = false;
 
@@ -449,6 +476,94 @@ public:
 	long long first_alu_cycle = 0;
 };
 
+
+/// Pool of memory blocks used to allocate the uops of a core. Uops are
+/// created with std::allocate_shared(), which allocates each uop together
+/// with its reference counter in a single block, so all blocks in the pool
+/// have the same size. Freed blocks are kept in the pool for later uops.
+class UopPool
+{
+	// Size of the blocks in the pool, assigned on the first allocation
+	size_t block_size = 0;
+
+	// Free blocks
+	std::vector<void *> free_blocks;
+
+	// Number of blocks currently allocated from the pool
+	int num_blocks_in_use = 0;
+
+	// Set when the owner of the pool released it while some blocks are
+	// still in use. Uops can outlive their core, for example when a memory
+	// access in flight still references them at the end of the simulation.
+	bool released = false;
+
+	// Destructor, only invoked once no block is in use
+	~UopPool();
+
+public:
+
+	/// Allocate a block of \a size bytes
+	void *Allocate(size_t size);
+
+	/// Free a block of \a size bytes previously returned by Allocate()
+	void Free(void *block, size_t size);
+
+	/// Release the pool by its owner. The pool is destroyed when the last
+	/// block in use is freed, or immediately if no block is in use.
+	void Release();
+};
+
+
+/// Allocator passed to std::allocate_shared() to create uops from a pool
+template<typename T> class UopAllocator
+{
+	// Pool that memory is obtained from
+	UopPool *pool;
+
+public:
+
+	/// Type of the allocated objects
+	typedef T value_type;
+
+	/// Constructor
+	UopAllocator(UopPool *pool) : pool(pool)
+	{
+	}
+
+	/// Conversion from an allocator of a different type
+	template<typename U> UopAllocator(const UopAllocator<U> &other) :
+			pool(other.getPool())
+	{
+	}
+
+	/// Return the pool that memory is obtained from
+	UopPool *getPool() const { return pool; }
+
+	/// Allocate memory for \a n objects
+	T *allocate(size_t n)
+	{
+		return static_cast<T *>(pool->Allocate(n * sizeof(T)));
+	}
+
+	/// Free memory for \a n objects
+	void deallocate(T *p, size_t n)
+	{
+		pool->Free(p, n * sizeof(T));
+	}
+
+	/// Allocators are equal if they use the same pool
+	template<typename U> bool operator==(const UopAllocator<U> &other) const
+	{
+		return pool == other.getPool();
+	}
+
+	/// Allocators are different if they use different pools
+	template<typename U> bool operator!=(const UopAllocator<U> &other) const
+	{
+		return pool != other.getPool();
+	}
+};
+
 }
 
 #endif
@@ -22,6 +22,7 @@
 #include <lib/cpp/String.h>
 
 #include "Address.h"
+#include "Controller.h"
 #include "System.h"
 
 namespace dram
@@ -32,25 +33,39 @@ Address::Address(long long encoded)
 		:
 		encoded(encoded)
 {
-	// Decode the address.
-	DecodeAddress();
+	// Decode the address with the component sizes of the system.
+	System *dram = System::getInstance();
+	long long decoding = DecodeAddress(dram->getLogicalSize(),
+			dram->getRankSize(),
+			dram->getBankSize(),
+			dram->getRowSize(),
+			dram->getColumnSize());
+
+	// The remaining bits select the physical channel.
+	int physical_size = dram->getPhysicalSize();
+	physical = decoding & int(pow(2, physical_size) - 1);
 }
 
 
-void Address::DecodeAddress()
+Address::Address(long long encoded, const Controller *controller)
+		:
+		encoded(encoded)
 {
-	// Get the DRAM system.
-	System *dram = System::getInstance();
+	// Decode the address with the component sizes of the controller.
+	// The remaining bits are ignored, wrapping around the capacity of the
+	// controller.
+	DecodeAddress(System::Log2(controller->getNumChannels()),
+			System::Log2(controller->getNumRanks()),
+			System::Log2(controller->getNumBanks()),
+			System::Log2(controller->getNumRows()),
+			System::Log2(controller->getNumColumns()));
+	physical = controller->getId();
+}
 
-	// Get the sizes of each address component in number of bits required
-	// to represent it.
-	int physical_size = dram->getPhysicalSize();
-	int logical_size = dram->getLogicalSize();
-	int rank_size = dram->getRankSize();
-	int bank_size = dram->getBankSize();
-	int row_size = dram->getRowSize();
-	int column_size = dram->getColumnSize();
 
+long long Address::DecodeAddress(int logical_size, int rank_size,
+		int bank_size, int row_size, int column_size)
+{
 	// Make a local copy of the address.  Don't use the one in the address
 	// struct because it will be altered during decoding.
 	long long decoding = encoded;
@@ -73,13 +88,7 @@ void Address::DecodeAddress()
 	logical = decoding & int(pow(2, logical_size) - 1);
 	// Step to physical.
 	decoding >>= logical_size;
-	physical = decoding & int(pow(2, physical_size) - 1);
-
-	// Debug
-	// System::debug << misc::fmt("Sizes: %d, %d, %d, %d, %d, %d\n",
-	// 		physical_size, logical_size, rank_size, bank_size,
-	// 		row_size, column_size);
-	// dump(System::debug);
+	return decoding;
 }
 
 
@@ -26,6 +26,10 @@
 namespace dram
 {
 
+// Forward declarations
+class Controller;
+
+
 class Address
 {
 	// Encoded address
@@ -40,23 +44,38 @@ class Address
 	int column;
 
 	/// Decodes an encoded address into its components locations and stores
-	/// them in the class.  The encoded address is taken from the class's
-	/// encoded member
+	/// them in the class, given the sizes in bits of each component. The
+	/// encoded address is taken from the class's encoded member. Return
+	/// the bits of the address left after the logical channel component.
 	///
 	/// For now, this decodes in the order:
 	/// 	physical:logical:rank:bank:row:column.
 	/// This will eventually be configurable.
-	void DecodeAddress();
+	long long DecodeAddress(int logical_size, int rank_size,
+			int bank_size, int row_size, int column_size);
 
 public:
 
 	/// Creates an address object with all location information derived
-	/// from the encoded address.
+	/// from the encoded address, using the address format of the whole
+	/// DRAM system.
 	///
 	/// \param encoded
 	/// The encoded memory address.
 	Address(long long encoded);
 
+	/// Creates an address object for a location in the given controller.
+	/// The encoded address is decoded with the geometry of the controller,
+	/// wrapping around its capacity, and the physical component is the
+	/// controller id.
+	///
+	/// \param encoded
+	/// The encoded memory address.
+	///
+	/// \param controller
+	/// The controller that the address refers to.
+	Address(long long encoded, const Controller *controller);
+
 	/// Returns the encoded address.
 	long long getEncoded() const { return encoded; }
 
@@ -59,11 +59,41 @@ void Bank::setLastScheduledCommand(CommandType type)
 
 void Bank::ProcessRequest(std::shared_ptr<Request> request)
 {
-	// Get the current cycle.
+	// Add the request to the queue.
+	request_queue.push_back(request);
+
+	// Break it down into commands right away, unless the scheduler
+	// reorders requests and there are still commands to run, in which
+	// case the request waits to be selected by the scheduler.
+	Channel *channel = getRank()->getChannel();
+	Scheduler *scheduler = channel->getScheduler();
+	if (!scheduler->isReordering() || command_queue.empty())
+		ScheduleRequest(scheduler->SelectRequest(this));
+
+	// Ensure the scheduler is running.
+	channel->CallScheduler();
+
+	// Debug
 	long long cycle = System::frequency_domain->getCycle();
+	System::debug << misc::fmt("[%lld] Processed request for 0x%llx in "
+			"bank %d\n", cycle,
+			request->getAddress()->getEncoded(), id);
+}
+
+
+void Bank::ScheduleRequest(int position)
+{
+	// Remove the request from the queue.
+	std::shared_ptr<Request> request = request_queue[position];
+	request_queue.erase(request_queue.begin() + position);
+
+	// Commands take the cycle when the request arrived to the controller
+	// as their creation cycle, so that schedulers can compare their age.
+	long long cycle = request->getCycleCreated();
 
 	// Pull the address out of the request.
 	Address *address = request->getAddress();
+	Controller *controller = getRank()->getChannel()->getController();
 
 	// Break the request down into its commands and add them to the queue.
 	// For all checks to the active row, the checks are made to what the
@@ -84,6 +114,9 @@ void Bank::ProcessRequest(std::shared_ptr<Request> request)
 
 		// Set the future active row.
 		future_active_row = address->getRow();
+
+		// Statistics
+		controller->incRowMisses();
 	}
 
 	// Create the precharge and activate commands if the wrong row will
@@ -102,6 +135,16 @@ void Bank::ProcessRequest(std::shared_ptr<Request> request)
 
 		// Set the future active row.
 		future_active_row = address->getRow();
+
+		// Statistics
+		controller->incRowConflicts();
+	}
+
+	// The desired row will be open. (Row hit)
+	else
+	{
+		// Statistics
+		controller->incRowHits();
 	}
 
 	// Check that the desired row will actually be open.
@@ -127,8 +170,7 @@ void Bank::ProcessRequest(std::shared_ptr<Request> request)
 
 	// If the the page policy is set to closed page, then also add a
 	// precharge command to the end of the queue.
-	if (getRank()->getChannel()->getController()->getPagePolicy() ==
-			PagePolicyClosed)
+	if (controller->getPagePolicy() == PagePolicyClosed)
 	{
 		// Create the command.
 		auto precharge_command = std::make_shared<Command>(
@@ -141,12 +183,9 @@ void Bank::ProcessRequest(std::shared_ptr<Request> request)
 		future_active_row = -1;
 	}
 
-	// Ensure the scheduler is running.
-	getRank()->getChannel()->CallScheduler();
-
 	// Debug
-	System::debug << misc::fmt("[%lld] Processed request for 0x%llx in "
-			"bank %d\n", cycle,
+	System::debug << misc::fmt("[%lld] Scheduled request for 0x%llx in "
+			"bank %d\n", System::frequency_domain->getCycle(),
 			address->getEncoded(), id);
 }
 
@@ -172,7 +211,7 @@ void Bank::RunFrontCommand()
 	esim::Engine *esim = esim::Engine::getInstance();
 
 	// Create return event
-	auto frame = std::make_shared<CommandReturnFrame>(command);
+	auto frame = esim::new_frame<CommandReturnFrame>(command);
 	esim->Call(System::event_command_return, frame, nullptr,
 			command->getDuration());
 
@@ -196,6 +235,10 @@ void Bank::dump(std::ostream &os) const
 	os << misc::fmt("\t\t\t%d Rows, %d Columns, %d Bits per Column\n",
 			num_rows, num_columns, num_bits);
 
+	// Print the requests currently in queue
+	os << misc::fmt("\t\t\t%d Requests in queue\n",
+			(int) request_queue.size());
+
 	// Print the commands currently in queue
 	os << misc::fmt("\t\t\t%d Commands in queue\n", (int)command_queue.size());
 	for (int i = 0; i < (int)command_queue.size(); i++)
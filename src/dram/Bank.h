@@ -47,6 +47,9 @@ class Bank
 	int num_columns;
 	int num_bits;
 
+	// Queue of requests that have not been broken down into commands yet
+	std::deque<std::shared_ptr<Request>> request_queue;
+
 	// Queue of commands to be sent to the Bank
 	std::deque<std::shared_ptr<Command>> command_queue;
 
@@ -106,6 +109,20 @@ public:
 	/// Returns how many commands are in the queue.
 	int getNumCommandsInQueue() const { return (int) command_queue.size(); }
 
+	/// Returns how many requests are waiting to be broken down into
+	/// commands.
+	int getNumRequestsInQueue() const { return (int) request_queue.size(); }
+
+	/// Returns the request waiting in the request queue at a certain
+	/// position, where position 0 is the oldest.
+	Request *getRequestInQueue(int position) const
+	{
+		return request_queue[position].get();
+	}
+
+	/// Returns the command at the front of the queue.
+	Command *getFrontCommand() const { return command_queue.front().get(); }
+
 	/// Returns the command in the queue at a certain position.
 	std::string getCommandInQueueType(int position = 0)
 	{
@@ -126,10 +143,15 @@ public:
 	/// Pops off the top command in the queue.
 	void RunFrontCommand();
 
-	/// Breaks a request down into it's component commands and adds them to the
-	/// bank's command queue.
+	/// Adds a request to the bank's request queue, where it waits until
+	/// the scheduler selects it.
 	void ProcessRequest(std::shared_ptr<Request> request);
 
+	/// Removes the request at a certain position of the request queue,
+	/// breaks it down into its component commands, and adds them to the
+	/// bank's command queue.
+	void ScheduleRequest(int position);
+
 	/// Dump the object to an output stream.
 	void dump(std::ostream &os = std::cout) const;
 
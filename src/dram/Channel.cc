@@ -65,6 +65,24 @@ Channel::Channel(int id,
 		scheduler = std::unique_ptr<Scheduler>(
 				new OldestFirst(this));
 		break;
+
+	// Create a First-Ready First-Come First-Served scheduler.
+	case SchedulerFrFcfs:
+		scheduler = std::unique_ptr<Scheduler>(
+				new FrFcfs(this));
+		break;
+
+	// Create an FR-FCFS scheduler with a starvation cap.
+	case SchedulerFrFcfsCap:
+		scheduler = std::unique_ptr<Scheduler>(
+				new FrFcfsCap(this));
+		break;
+
+	// Create a Blacklisting scheduler.
+	case SchedulerBliss:
+		scheduler = std::unique_ptr<Scheduler>(
+				new Bliss(this));
+		break;
 	}
 }
 
@@ -85,7 +103,7 @@ void Channel::CallScheduler(int after)
 	}
 
 	// Create the frame to pass containing a reference to this controller.
-	auto frame = std::make_shared<SchedulerFrame>();
+	auto frame = esim::new_frame<SchedulerFrame>();
 	frame->channel = this;
 
 	// Call the event for the request processor.
@@ -113,6 +131,16 @@ void Channel::RunScheduler()
 	System::debug << misc::fmt("[%lld] Controller %d Channel %d running "
 			"scheduler\n", cycle, getController()->getId(), id);
 
+	// Break down the request selected by the scheduler in every bank that
+	// has run all its commands.
+	for (int i = 0; i < getNumBanksTotal(); i++)
+	{
+		Bank *bank = getRank(i / num_banks)->getBank(i % num_banks);
+		if (bank->getNumCommandsInQueue() == 0 &&
+				bank->getNumRequestsInQueue() > 0)
+			bank->ScheduleRequest(scheduler->SelectRequest(bank));
+	}
+
 	// Get a pointer to the bank whose front command should be run next.
 	// This is either the result of the scheduling algorithm from a previous
 	// cycle (if timing constraints prevented it from being run then), or
@@ -136,6 +164,7 @@ void Channel::RunScheduler()
 	if (cycle >= cycle_ready)
 	{
 		// Run the command.
+		scheduler->CommandRun(bank->getFrontCommand());
 		bank->RunFrontCommand();
 		next_scheduled_bank = nullptr;
 
@@ -79,6 +79,9 @@ public:
 	/// Returns a rank belonging to this channel with the specified id.
 	Rank *getRank(int id) const { return ranks[id].get(); }
 
+	/// Returns the scheduler that determines what commands are run.
+	Scheduler *getScheduler() const { return scheduler.get(); }
+
 	/// Returns the controller that this channel belongs to.
 	Controller *getController() const { return controller; }
 
@@ -91,6 +91,9 @@ public:
 	/// scheduled.
 	int getDuration() const;
 
+	/// Returns the request associated with this command.
+	Request *getRequest() const { return request.get(); }
+
 	/// Returns the cycle when the command was created.
 	long long getCycleCreated() { return cycle_created; }
 
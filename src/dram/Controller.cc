@@ -86,10 +86,30 @@ void Controller::ParseConfiguration(misc::IniFile *config,
 			PagePolicyTypeMap, PagePolicyOpen);
 
 	// Load the scheduling algorithm, defaulting to SchedulerOldestFirst.
-	SchedulerType scheduler_type = (SchedulerType) config->ReadEnum(section,
+	scheduler_type = (SchedulerType) config->ReadEnum(section,
 			"SchedulingPolicy", SchedulerTypeMap,
 			SchedulerOldestFirst);
 
+	// Read scheduling algorithm parameters
+	starvation_cap = config->ReadInt(section, "StarvationCap", 4);
+	if (starvation_cap < 0)
+		throw Error(misc::fmt("%s: StarvationCap must be at least 0.\n%s",
+				config->getPath().c_str(),
+				System::err_config_note));
+	blacklist_threshold = config->ReadInt(section, "BlacklistThreshold", 4);
+	if (blacklist_threshold <= 0)
+		throw Error(misc::fmt("%s: BlacklistThreshold must be at least "
+				"1.\n%s",
+				config->getPath().c_str(),
+				System::err_config_note));
+	blacklist_clearing_interval = config->ReadInt(section,
+			"BlacklistClearingInterval", 10000);
+	if (blacklist_clearing_interval <= 0)
+		throw Error(misc::fmt("%s: BlacklistClearingInterval must be at "
+				"least 1.\n%s",
+				config->getPath().c_str(),
+				System::err_config_note));
+
 	// Read DRAM size settings
 	num_channels = config->ReadInt(section, "NumChannels", 1);
 	if (num_channels <= 0)
@@ -211,6 +231,26 @@ void Controller::ParseConfigurationTiming(misc::IniFile *ini_file,
 
 void Controller::AddRequest(std::shared_ptr<Request> request)
 {
+	// The request must be addressed to this controller.
+	if (request->getAddress()->getPhysical() != id)
+		throw misc::Panic(misc::fmt("%s: request for 0x%llx addressed "
+				"to controller %d", name.c_str(),
+				request->getAddress()->getEncoded(),
+				request->getAddress()->getPhysical()));
+
+	// Record the arrival of the request.
+	request->setCycleCreated(System::frequency_domain->getCycle());
+
+	// Statistics
+	if (request->getType() == RequestWrite)
+		num_writes++;
+	else
+		num_reads++;
+	int source = request->getSource();
+	if (source >= (int) sources.size())
+		sources.resize(source + 1);
+	sources[source].num_requests++;
+
 	// Add the request to the controller incoming request queue.
 	incoming_requests.push(request);
 
@@ -219,6 +259,48 @@ void Controller::AddRequest(std::shared_ptr<Request> request)
 }
 
 
+int Controller::AddSource(const std::string &name)
+{
+	// Existing source
+	auto it = source_ids.find(name);
+	if (it != source_ids.end())
+		return it->second;
+
+	// New source
+	int id = sources.size();
+	sources.emplace_back();
+	sources.back().name = name;
+	source_ids[name] = id;
+	return id;
+}
+
+
+int Controller::getSourceId(const std::string &name) const
+{
+	auto it = source_ids.find(name);
+	if (it == source_ids.end())
+		throw misc::Panic(misc::fmt("%s: source '%s' not registered",
+				this->name.c_str(), name.c_str()));
+	return it->second;
+}
+
+
+void Controller::RecordRequestLatency(Request *request)
+{
+	long long latency = System::frequency_domain->getCycle() -
+			request->getCycleCreated();
+
+	// Global statistics
+	num_completed_requests++;
+	total_latency += latency;
+
+	// Per-source statistics
+	Source &source = sources[request->getSource()];
+	source.num_completed_requests++;
+	source.total_latency += latency;
+}
+
+
 void Controller::CreateRequestProcessor(int controller)
 {
 	esim::Engine *esim = esim::Engine::getInstance();
@@ -261,7 +343,7 @@ void Controller::CallRequestProcessor()
 	}
 
 	// Create the frame to pass containing a reference to this controller.
-	auto frame = std::make_shared<RequestProcessorFrame>();
+	auto frame = esim::new_frame<RequestProcessorFrame>();
 	frame->controller = this;
 
 	// Call the event for the request processor.
@@ -320,6 +402,16 @@ void Controller::CommandReturnHandler(esim::Event *type, esim::Frame *frame)
 	// its request.
 	command->setFinished();
 
+	// Statistics for the request, which completes with its read or
+	// write command.
+	if (command->getType() == CommandRead ||
+			command->getType() == CommandWrite)
+	{
+		Controller *controller = command->getRank()->getChannel()->
+				getController();
+		controller->RecordRequestLatency(command->getRequest());
+	}
+
 	// Debug
 	long long cycle = System::frequency_domain->getCycle();
 	System::activity << misc::fmt("[%lld] [%d : %d] Finished command #%d "
@@ -348,4 +440,59 @@ void Controller::dump(std::ostream &os) const
 }
 
 
+void Controller::DumpReport(std::ostream &os) const
+{
+	// Header
+	os << misc::fmt("[ DramController.%s ]\n", name.c_str());
+	os << misc::fmt("SchedulingPolicy = %s\n",
+			SchedulerTypeMap[scheduler_type]);
+	os << misc::fmt("PagePolicy = %s\n",
+			PagePolicyTypeMap[page_policy]);
+	os << "\n";
+
+	// Requests
+	os << misc::fmt("Requests = %lld\n", num_reads + num_writes);
+	os << misc::fmt("Reads = %lld\n", num_reads);
+	os << misc::fmt("Writes = %lld\n", num_writes);
+	os << "\n";
+
+	// Row buffer
+	long long num_row_accesses = num_row_hits + num_row_misses +
+			num_row_conflicts;
+	os << misc::fmt("RowHits = %lld\n", num_row_hits);
+	os << misc::fmt("RowMisses = %lld\n", num_row_misses);
+	os << misc::fmt("RowConflicts = %lld\n", num_row_conflicts);
+	os << misc::fmt("RowHitRate = %.4g\n", num_row_accesses ?
+			(double) num_row_hits / num_row_accesses : 0.0);
+	os << "\n";
+
+	// Latency
+	os << misc::fmt("CompletedRequests = %lld\n", num_completed_requests);
+	os << misc::fmt("AverageLatency = %.4g\n", num_completed_requests ?
+			(double) total_latency / num_completed_requests : 0.0);
+	os << "\n";
+
+	// Sources
+	for (int i = 0; i < (int) sources.size(); i++)
+	{
+		const Source &source = sources[i];
+		if (!source.num_requests)
+			continue;
+		os << misc::fmt("[ DramController.%s.Source.%s ]\n",
+				name.c_str(), source.name.empty() ?
+				misc::fmt("%d", i).c_str() :
+				source.name.c_str());
+		os << misc::fmt("Requests = %lld\n", source.num_requests);
+		os << misc::fmt("CompletedRequests = %lld\n",
+				source.num_completed_requests);
+		os << misc::fmt("AverageLatency = %.4g\n",
+				source.num_completed_requests ?
+				(double) source.total_latency /
+				source.num_completed_requests : 0.0);
+		os << "\n";
+	}
+	os << "\n";
+}
+
+
 }  // namespace dram
@@ -25,6 +25,7 @@
 #include <memory>
 #include <vector>
 #include <queue>
+#include <unordered_map>
 
 #include <lib/cpp/IniFile.h>
 #include <lib/cpp/String.h>
@@ -32,6 +33,7 @@
 #include <lib/esim/Event.h>
 
 #include "Command.h"
+#include "Scheduler.h"
 
 namespace dram
 {
@@ -90,6 +92,12 @@ class Controller
 	// The page policy that command processors in this controller follow
 	PagePolicyType page_policy;
 
+	// Scheduling algorithm of the channels and its parameters
+	SchedulerType scheduler_type;
+	int starvation_cap;
+	int blacklist_threshold;
+	int blacklist_clearing_interval;
+
 	// Timing matrix
 	int timings[4][4][2][2] = {};
 
@@ -102,6 +110,35 @@ class Controller
 	// Incoming request queue
 	std::queue<std::shared_ptr<Request>> incoming_requests;
 
+	// Statistics of the requests issued by a source
+	struct Source
+	{
+		// Name of the source
+		std::string name;
+
+		// Number of requests
+		long long num_requests = 0;
+
+		// Number of completed requests and the sum of their latencies
+		long long num_completed_requests = 0;
+		long long total_latency = 0;
+	};
+
+	// Sources of requests, indexed by source id
+	std::vector<Source> sources;
+
+	// Map of source names to source ids
+	std::unordered_map<std::string, int> source_ids;
+
+	// Statistics
+	long long num_reads = 0;
+	long long num_writes = 0;
+	long long num_row_hits = 0;
+	long long num_row_misses = 0;
+	long long num_row_conflicts = 0;
+	long long num_completed_requests = 0;
+	long long total_latency = 0;
+
 	// Map of ids to EventTypes for each controller's request processor
 	static std::map<int, esim::Event *> REQUEST_PROCESSORS;
 
@@ -118,6 +155,10 @@ public:
 	/// controllers.
 	int getId() const { return id; }
 
+	/// Returns the name of this controller, as given in its section of
+	/// the DRAM configuration file.
+	const std::string &getName() const { return name; }
+
 	/// Returns a channel that belongs to this controller with the
 	/// specified id.
 	Channel *getChannel(int id) { return channels[id].get(); }
@@ -132,6 +173,76 @@ public:
 	/// controller follow.
 	PagePolicyType getPagePolicy() { return page_policy; }
 
+	/// Returns the maximum number of younger row hits that can be served
+	/// before the oldest request of a bank, used by the FR-FCFS
+	/// scheduler with a starvation cap.
+	int getStarvationCap() const { return starvation_cap; }
+
+	/// Returns the number of consecutive requests served from the same
+	/// source after which the BLISS scheduler blacklists it.
+	int getBlacklistThreshold() const { return blacklist_threshold; }
+
+	/// Returns the number of cycles after which the BLISS scheduler
+	/// clears its blacklist.
+	int getBlacklistClearingInterval() const
+	{
+		return blacklist_clearing_interval;
+	}
+
+	/// Register a source of requests with the given name, and return its
+	/// id. If the source is already registered, its existing id is
+	/// returned. Sources should be registered while the configuration is
+	/// loaded, so that the controller state is not modified during the
+	/// simulation.
+	int AddSource(const std::string &name);
+
+	/// Returns the id of the source with the given name, previously
+	/// registered with AddSource(). The id should be set in the requests
+	/// issued by that source.
+	int getSourceId(const std::string &name) const;
+
+	/// Returns the number of read requests received.
+	long long getNumReads() const { return num_reads; }
+
+	/// Returns the number of write requests received.
+	long long getNumWrites() const { return num_writes; }
+
+	/// Returns the number of requests that have completed.
+	long long getNumCompletedRequests() const
+	{
+		return num_completed_requests;
+	}
+
+	/// Returns the number of requests received from the given source.
+	long long getNumRequests(int source) const
+	{
+		return source < (int) sources.size() ?
+				sources[source].num_requests : 0;
+	}
+
+	/// Record a request that hit in the open row of its bank.
+	void incRowHits() { num_row_hits++; }
+
+	/// Record a request that found its bank precharged.
+	void incRowMisses() { num_row_misses++; }
+
+	/// Record a request that found a different row open in its bank.
+	void incRowConflicts() { num_row_conflicts++; }
+
+	/// Returns the number of requests that hit in the open row of their
+	/// bank.
+	long long getNumRowHits() const { return num_row_hits; }
+
+	/// Returns the number of requests that found their bank precharged.
+	long long getNumRowMisses() const { return num_row_misses; }
+
+	/// Returns the number of requests that found a different row open
+	/// in their bank.
+	long long getNumRowConflicts() const { return num_row_conflicts; }
+
+	/// Record the latency of a request that has just completed.
+	void RecordRequestLatency(Request *request);
+
 	/// Returns the minimum timing seperation (in number of cycles) between
 	/// two commands in two locations, based on the timing protocol matrix.
 	int getTiming(TimingCommand prev, TimingCommand next,
@@ -192,6 +303,10 @@ public:
 	/// Dump the object to an output stream.
 	void dump(std::ostream &os = std::cout) const;
 
+	/// Dump the statistics of the controller, including the row buffer
+	/// hit rate and the latency of the requests of each source.
+	void DumpReport(std::ostream &os = std::cout) const;
+
 	/// Dump object with the << operator
 	friend std::ostream &operator<<(std::ostream &os,
 			const Controller &object)
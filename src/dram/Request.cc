@@ -35,13 +35,13 @@ Request::Request()
 
 void Request::setFinished()
 {
-	// FIXME: If not in stand alone DRAM sim, return request back up
-	// through cache hierarchy.
-
 	// Debug
 	long long cycle = System::frequency_domain->getCycle();
 	System::activity << misc::fmt("[%lld] Request complete for 0x%llx\n",
 		cycle, address->getEncoded());
+
+	// Return to the memory hierarchy
+	queue.WakeupAll();
 }
 
 
@@ -50,4 +50,10 @@ void Request::setEncodedAddress(long long addr)
 	address.reset(new Address(addr));
 }
 
+
+void Request::setEncodedAddress(long long addr, const Controller *controller)
+{
+	address.reset(new Address(addr, controller));
+}
+
 }  // namespace dram
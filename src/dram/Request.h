@@ -22,12 +22,15 @@
 
 #include <memory>
 
+#include <lib/esim/Queue.h>
+
 
 namespace dram
 {
 
 // Forward declarations
 class Address;
+class Controller;
 
 
 enum RequestType
@@ -43,6 +46,15 @@ class Request
 	RequestType type;
 	std::unique_ptr<Address> address;
 
+	// Identifier of the source that issued the request
+	int source = 0;
+
+	// Cycle when the request arrived to the controller
+	long long cycle_created = 0;
+
+	// Event chains suspended until the request completes
+	esim::Queue queue;
+
 public:
 
 	Request();
@@ -53,16 +65,40 @@ public:
 	/// Sets the type of the request.
 	void setType(RequestType new_type) { type = new_type; }
 
+	/// Returns the identifier of the source that issued the request.
+	int getSource() const { return source; }
+
+	/// Sets the identifier of the source that issued the request, as
+	/// returned by Controller::getSourceId(). Application-aware schedulers
+	/// and per-source statistics rely on it.
+	void setSource(int source) { this->source = source; }
+
+	/// Returns the cycle when the request arrived to the controller.
+	long long getCycleCreated() const { return cycle_created; }
+
+	/// Sets the cycle when the request arrived to the controller.
+	void setCycleCreated(long long cycle) { cycle_created = cycle; }
+
 	/// Marks the request as completed, which should happen when the
-	/// associated read or write command finishes.
+	/// associated read or write command finishes. Event chains suspended
+	/// with Wait() are resumed.
 	void setFinished();
 
+	/// Suspend the current event chain until the request completes, and
+	/// continue it with \a event at that time. This function should only
+	/// be invoked in the body of an event handler.
+	void Wait(esim::Event *event) { queue.Wait(event); }
+
 	/// Returns a pointer to the address object of the request.
 	Address *getAddress() { return address.get(); }
 
 	/// Sets the encoded address of the request, which will also decode
 	/// the address into its components.
 	void setEncodedAddress(long long addr);
+
+	/// Sets the encoded address of the request, decoding it relative to
+	/// the given controller, as described in the Address constructor.
+	void setEncodedAddress(long long addr, const Controller *controller);
 };
 
 }  // namespace dram
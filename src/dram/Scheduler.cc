@@ -17,12 +17,15 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
+#include <algorithm>
 #include <climits>
 
 #include <lib/cpp/String.h>
 
+#include "Address.h"
 #include "Bank.h"
 #include "Channel.h"
+#include "Controller.h"
 #include "System.h"
 #include "Scheduler.h"
 
@@ -33,7 +36,10 @@ namespace dram
 misc::StringMap SchedulerTypeMap
 {
 	{ "RankBankRoundRobin", SchedulerRankBankRoundRobin},
-	{ "OldestFirst", SchedulerOldestFirst }
+	{ "OldestFirst", SchedulerOldestFirst },
+	{ "FrFcfs", SchedulerFrFcfs },
+	{ "FrFcfsCap", SchedulerFrFcfsCap },
+	{ "Bliss", SchedulerBliss }
 };
 
 
@@ -128,4 +134,189 @@ Bank *RankBankRoundRobin::FindNext()
 	return nullptr;
 }
 
+Bank *FrFcfs::FindNext()
+{
+	// Get the current cycle.
+	long long cycle = System::frequency_domain->getCycle();
+
+	// Keep track of the best bank found so far and its sorting keys, in
+	// order of importance.
+	Bank *best_bank = nullptr;
+	long long best_ready_cycle = LLONG_MAX;
+	bool best_low_priority = true;
+	bool best_column = false;
+	long long best_cycle_created = LLONG_MAX;
+
+	// Get the number of banks in each rank of the channel.
+	int num_banks = channel->getNumBanks();
+
+	// Iterate through all the ranks and banks.
+	for (int i = 0; i < channel->getNumBanksTotal(); i++)
+	{
+		// Get the current bank
+		Bank *bank = channel->getRank(i / num_banks)
+				->getBank(i % num_banks);
+
+		// Move to the next bank if this one has no commands in queue.
+		if (bank->getNumCommandsInQueue() == 0)
+			continue;
+
+		// Compute the sorting keys of the front command.  All commands
+		// that can run in this cycle are equally ready.
+		Command *command = bank->getFrontCommand();
+		long long ready_cycle = std::max(bank->getFrontCommandTiming(),
+				cycle);
+		bool low_priority = isLowPriority(
+				command->getRequest()->getSource());
+		bool column = command->getType() == CommandRead ||
+				command->getType() == CommandWrite;
+		long long cycle_created = command->getCycleCreated();
+
+		// Compare with the best bank so far.
+		bool better;
+		if (ready_cycle != best_ready_cycle)
+			better = ready_cycle < best_ready_cycle;
+		else if (low_priority != best_low_priority)
+			better = !low_priority;
+		else if (column != best_column)
+			better = column;
+		else
+			better = cycle_created < best_cycle_created;
+
+		// Make this the best bank if it is.
+		if (better)
+		{
+			best_bank = bank;
+			best_ready_cycle = ready_cycle;
+			best_low_priority = low_priority;
+			best_column = column;
+			best_cycle_created = cycle_created;
+		}
+	}
+
+	// Return the best bank, or nullptr if no bank has commands.
+	return best_bank;
+}
+
+
+int FrFcfs::SelectRequest(Bank *bank)
+{
+	// Find the oldest request with the highest priority, preferring
+	// those that hit in the row that will be open.  Requests are in
+	// order of arrival.
+	int best_position = 0;
+	bool best_low_priority = true;
+	bool best_row_hit = false;
+	for (int i = 0; i < bank->getNumRequestsInQueue(); i++)
+	{
+		Request *request = bank->getRequestInQueue(i);
+		bool low_priority = isLowPriority(request->getSource());
+		bool row_hit = request->getAddress()->getRow() ==
+				bank->getActiveRowFuture();
+
+		// Keep the first request with better keys.
+		if ((!low_priority && best_low_priority) ||
+				(low_priority == best_low_priority &&
+				row_hit && !best_row_hit) ||
+				i == 0)
+		{
+			best_position = i;
+			best_low_priority = low_priority;
+			best_row_hit = row_hit;
+		}
+	}
+
+	// Return the position of the selected request.
+	return best_position;
+}
+
+
+FrFcfsCap::FrFcfsCap(Channel *owner)
+		:
+		FrFcfs(owner),
+		cap(owner->getController()->getStarvationCap()),
+		num_bypasses(owner->getNumBanksTotal())
+{
+}
+
+
+int FrFcfsCap::SelectRequest(Bank *bank)
+{
+	// Get the bypass counter of the bank.
+	int &bypasses = num_bypasses[bank->getRank()->getId() *
+			channel->getNumBanks() + bank->getId()];
+
+	// Serve the oldest request if it has been bypassed too many times.
+	int position = FrFcfs::SelectRequest(bank);
+	if (position == 0 || bypasses >= cap)
+	{
+		bypasses = 0;
+		return 0;
+	}
+
+	// A younger request bypasses the oldest one.
+	bypasses++;
+	return position;
+}
+
+
+Bliss::Bliss(Channel *owner)
+		:
+		FrFcfs(owner),
+		threshold(owner->getController()->getBlacklistThreshold()),
+		clearing_interval(owner->getController()->
+				getBlacklistClearingInterval()),
+		next_clearing_cycle(clearing_interval)
+{
+}
+
+
+Bank *Bliss::FindNext()
+{
+	// Clear the blacklist periodically.
+	long long cycle = System::frequency_domain->getCycle();
+	if (cycle >= next_clearing_cycle)
+	{
+		blacklist.assign(blacklist.size(), false);
+		next_clearing_cycle = cycle + clearing_interval;
+	}
+
+	// Apply FR-FCFS with blacklisted sources as low priority.
+	return FrFcfs::FindNext();
+}
+
+
+void Bliss::CommandRun(Command *command)
+{
+	// Only read and write commands serve requests.
+	if (command->getType() != CommandRead &&
+			command->getType() != CommandWrite)
+		return;
+
+	// Count consecutive requests served from the same source.
+	int source = command->getRequest()->getSource();
+	if (source == last_source)
+	{
+		num_consecutive++;
+	}
+	else
+	{
+		last_source = source;
+		num_consecutive = 1;
+	}
+
+	// Blacklist the source if it exceeds the threshold.
+	if (num_consecutive > threshold)
+	{
+		if (source >= (int) blacklist.size())
+			blacklist.resize(source + 1);
+		blacklist[source] = true;
+
+		// Debug
+		long long cycle = System::frequency_domain->getCycle();
+		System::debug << misc::fmt("[%lld] Scheduler blacklists "
+				"source %d\n", cycle, source);
+	}
+}
+
 }  // namespace dram
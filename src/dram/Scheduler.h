@@ -21,6 +21,7 @@
 #define DRAM_SCHEDULER_H
 
 #include <utility>
+#include <vector>
 
 #include <lib/cpp/String.h>
 
@@ -39,7 +40,10 @@ class Channel;
 enum SchedulerType
 {
 	SchedulerRankBankRoundRobin,
-	SchedulerOldestFirst
+	SchedulerOldestFirst,
+	SchedulerFrFcfs,
+	SchedulerFrFcfsCap,
+	SchedulerBliss
 };
 
 // String map for SchedulerType
@@ -50,7 +54,8 @@ extern misc::StringMap SchedulerTypeMap;
 /// constructor must contain at least a pointer to the channel that owns it
 /// and should call the base class constructor.  The FindNext method should
 /// be implemented with the scheduling algorithm, and any state variables
-/// required should be added to the class.
+/// required should be added to the class. Schedulers that reorder requests
+/// within a bank should also override SelectRequest.
 /// After the new scheduler is made, add it to the SchedulerType enum,
 /// SchedulerTypeMap StringMap and the switch block in Channel::Channel.
 class Scheduler
@@ -69,10 +74,31 @@ public:
 	{
 	}
 
+	/// Virtual destructor
+	virtual ~Scheduler()
+	{
+	}
+
 	/// Returns the pointer to the next bank that should have its command
 	/// scheduled next.  In the case that one isn't found, nullptr is
 	/// returned.
 	virtual Bank *FindNext() = 0;
+
+	/// Returns whether the scheduler reorders the requests of a bank.
+	/// If it does, requests wait in the bank until its command queue is
+	/// empty, and SelectRequest chooses which one is broken down into
+	/// commands next.  Otherwise, requests are broken down into commands
+	/// as soon as they reach the bank.
+	virtual bool isReordering() const { return false; }
+
+	/// Returns the position in the request queue of a bank of the request
+	/// that should be broken down into commands next.  By default,
+	/// requests are served in the order they arrived.
+	virtual int SelectRequest(Bank *bank) { return 0; }
+
+	/// Notifies the scheduler that the front command of a bank returned
+	/// by FindNext is being run.
+	virtual void CommandRun(Command *command) { }
 };
 
 
@@ -111,6 +137,112 @@ public:
 	Bank *FindNext();
 };
 
+class FrFcfs : public Scheduler
+{
+
+protected:
+
+	// Returns whether requests from the given source should be served
+	// after those from other sources, regardless of their row or age.
+	virtual bool isLowPriority(int source) const { return false; }
+
+public:
+
+	FrFcfs(Channel *owner)
+			:
+			Scheduler(owner)
+	{
+	}
+
+	/// Returns the pointer to the next bank that should have its
+	/// command scheduled next based on the First-Ready First-Come
+	/// First-Served algorithm.  Among the banks whose front command can
+	/// run in this cycle, column accesses (row hits) are preferred over
+	/// precharges and activations, and older commands are preferred
+	/// otherwise.  If no command is ready, the bank whose front command
+	/// is ready first is returned.
+	Bank *FindNext();
+
+	/// Requests are reordered within a bank.
+	bool isReordering() const { return true; }
+
+	/// Returns the position of the oldest request to the row that will be
+	/// open in the bank, or the position of the oldest request if none
+	/// hits in the row.
+	int SelectRequest(Bank *bank);
+};
+
+
+class FrFcfsCap : public FrFcfs
+{
+	// Maximum number of younger row hits that can be served before the
+	// oldest request of a bank.
+	int cap;
+
+	// Number of row hits served before the oldest request of each bank,
+	// indexed by rank * number of banks + bank.
+	std::vector<int> num_bypasses;
+
+public:
+
+	FrFcfsCap(Channel *owner);
+
+	/// Returns the position of the request selected by FR-FCFS, unless
+	/// the oldest request of the bank has already been bypassed by as
+	/// many row hits as the starvation cap.  In that case, the oldest
+	/// request is returned.
+	int SelectRequest(Bank *bank);
+};
+
+
+class Bliss : public FrFcfs
+{
+	// Number of consecutive requests served from the same source after
+	// which the source is blacklisted.
+	int threshold;
+
+	// Number of cycles after which the blacklist is cleared.
+	int clearing_interval;
+
+	// Cycle when the blacklist will be cleared next.
+	long long next_clearing_cycle;
+
+	// Source of the last request served and the number of consecutive
+	// requests served from it.
+	int last_source = -1;
+	int num_consecutive = 0;
+
+	// Blacklisted sources, indexed by source id.
+	std::vector<bool> blacklist;
+
+protected:
+
+	// Sources in the blacklist have low priority.
+	bool isLowPriority(int source) const { return isBlacklisted(source); }
+
+public:
+
+	Bliss(Channel *owner);
+
+	/// Returns whether the source is currently blacklisted.
+	bool isBlacklisted(int source) const
+	{
+		return source < (int) blacklist.size() && blacklist[source];
+	}
+
+	/// Returns the pointer to the next bank that should have its
+	/// command scheduled next based on the Blacklisting algorithm.
+	/// Commands from sources that are not blacklisted go first, and then
+	/// the order of FR-FCFS applies.  The blacklist is cleared
+	/// periodically.
+	Bank *FindNext();
+
+	/// Tracks the number of consecutive requests served from the same
+	/// source when a read or write command is run, and blacklists the
+	/// source if the number exceeds the threshold.
+	void CommandRun(Command *command);
+};
+
 }  // namespace dram
 
 #endif
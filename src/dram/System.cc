@@ -19,6 +19,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <fstream>
 #include <iostream>
 
 #include <lib/cpp/CommandLine.h>
@@ -47,6 +48,8 @@ std::string activity_file;
 
 std::string config_file;
 
+std::string report_file;
+
 bool System::stand_alone = false;
 
 bool System::help = false;
@@ -93,8 +96,23 @@ const std::string System::help_message =
 		"\n"
 		"  PagePolicy = {Open|Closed} (Default = Open) \n"
 		"      Policy that dictates whether the row of a bank remains open or closed.\n"
-		"  SchedulingPolicy = {OldestFirst|BankRoundRobin} (Default = OldestFirst)\n"
+		"  SchedulingPolicy = {OldestFirst|RankBankRoundRobin|FrFcfs|FrFcfsCap|Bliss}\n"
+		"      (Default = OldestFirst)\n"
 		"      Policy that determines which bank is allowed to execute a command.\n"
+		"      FrFcfs serves requests that hit in the open row first, and older\n"
+		"      requests otherwise. FrFcfsCap limits the number of younger row hits\n"
+		"      that can be served before the oldest request of a bank. Bliss\n"
+		"      additionally deprioritizes sources that have been served too many\n"
+		"      requests in a row.\n"
+		"  StarvationCap = <num> (Default = 4)\n"
+		"      Maximum number of row hits served before an older request with\n"
+		"      policy FrFcfsCap.\n"
+		"  BlacklistThreshold = <num> (Default = 4)\n"
+		"      Number of consecutive requests served from the same source after\n"
+		"      which it is blacklisted with policy Bliss.\n"
+		"  BlacklistClearingInterval = <cycles> (Default = 10000)\n"
+		"      Number of cycles after which the blacklist is cleared with policy\n"
+		"      Bliss.\n"
 		"  NumChannels = <num> (Default =  1)\n"
 		"      Number of channels in the DRAM system.\n"
 		"  NumRanks = <num> (Default = 2)\n"
@@ -181,20 +199,10 @@ int System::getCapacity()
 
 void System::RegisterOptions()
 {
-/*
-	//
-	// FIXME: These options are removed, in order to be excluded from
-	// the m2s --help. However, later when we hook up the DRAM model to
-	// the memory system, it will come back.
-	// 
-	// FIXME 2: A whole --dram-trace option should be added as an 
-	// input to the stand-alone DRAM. Otherwise, the stand-alone
-	// does not make any sense. It cannot be actions, as part of the
-	// configuration file.
-	//
-	// FIXME 3: The debug and debug_activity files should be combined
-	// into one. It does not make sense to have both of them as two
-	// separate file.  
+	// FIXME: The debug and debug_activity files should be combined into
+	// one. It does not make sense to have both of them as two separate
+	// files.
+
 	// Get command line object
 	misc::CommandLine *command_line = misc::CommandLine::getInstance();
 
@@ -217,14 +225,29 @@ void System::RegisterOptions()
 	command_line->RegisterString("--dram-config <file>",
 			config_file,
 			"DRAM configuration file. Memory controllers and "
-			"their components can be defined here.");
+			"their components can be defined here. Main memory "
+			"modules of the memory hierarchy are connected to a "
+			"controller with variable 'DramController' in the "
+			"memory configuration file.");
+
+	// DRAM report
+	command_line->RegisterString("--dram-report <file>",
+			report_file,
+			"File for a report on the DRAM controllers, including "
+			"the row buffer hit rate and the latency of the "
+			"requests of each source.");
 
 	// Help message for dram configuration
 	command_line->RegisterBool("--dram-help",
 			help,
-			"Print help message describing the network configuration"
+			"Print help message describing the DRAM configuration"
 			" file, passed in option '--dram-config <file>'.");
 
+/*
+	// FIXME: A whole --dram-trace option should be added as an input to
+	// the stand-alone DRAM. Otherwise, the stand-alone does not make any
+	// sense. It cannot be actions, as part of the configuration file.
+
 	// Stand-alone simulator
 	command_line->RegisterBool("--dram-sim",
 			stand_alone,
@@ -237,7 +260,6 @@ void System::RegisterOptions()
 
 void System::ProcessOptions()
 {
-/*
 	// DRAM help
 	if (help)
 	{
@@ -257,7 +279,12 @@ void System::ProcessOptions()
 	if (stand_alone && config_file.empty())
 		throw Error(misc::fmt("Option --dram-sim requires "
 				" --dram-config option "));
-*/
+}
+
+
+bool System::hasConfigFile()
+{
+	return !config_file.empty();
 }
 
 
@@ -332,6 +359,15 @@ void System::Run()
 }
 
 
+Controller *System::getController(const std::string &name) const
+{
+	for (auto &controller : controllers)
+		if (controller->getName() == name)
+			return controller.get();
+	return nullptr;
+}
+
+
 int System::getNextCommandId()
 {
 	next_command_id++;
@@ -428,6 +464,41 @@ void System::Write(long long address)
 }
 
 
+void System::DumpReport()
+{
+	// No report requested
+	if (report_file.empty())
+		return;
+
+	// Try to open the file
+	std::ofstream f(report_file);
+	if (!f)
+		throw Error(misc::fmt("%s: cannot open file for write",
+				report_file.c_str()));
+
+	// Dump the DRAM report
+	DumpReport(f);
+}
+
+
+void System::DumpReport(std::ostream &os) const
+{
+	// Dump introduction to the DRAM report file
+	os << "; Report for DRAM controllers\n";
+	os << ";    Requests - Read and write requests received\n";
+	os << ";    RowHits - Requests to the row open in their bank\n";
+	os << ";    RowMisses - Requests that found their bank precharged\n";
+	os << ";    RowConflicts - Requests that found another row open\n";
+	os << ";    AverageLatency - Cycles from the arrival of a request "
+			"to the end of its read or write command\n";
+	os << "\n\n";
+
+	// Dump report for each controller
+	for (auto &controller : controllers)
+		controller->DumpReport(os);
+}
+
+
 void System::Dump(std::ostream &os) const
 {
 	
@@ -87,9 +87,6 @@ class System
 	// command have a unique id for logging purposes.
 	int next_command_id = -1;
 
-	/// Finds the integer base 2 log of a number.
-	int Log2(unsigned num);
-
 	/// Sets the sizes of each address component, in the number of bits
 	/// required to represent it.
 	void GenerateAddressSizes();
@@ -119,13 +116,27 @@ public:
 	/// Obtain the instance of the dram simulator singleton.
 	static System *getInstance();
 
+	/// Return whether the singleton has been instantiated.
+	static bool hasInstance() { return instance.get(); }
+
 	/// Returns a channel that belongs to this controller with the
 	/// specified id.
 	Controller *getController(int id) { return controllers[id].get(); }
 
+	/// Returns the controller with the given name, or nullptr if no
+	/// controller with that name exists.
+	Controller *getController(const std::string &name) const;
+
 	/// Returns whether or not DRAM is running as a stand alone simulator.
 	static bool isStandAlone() { return stand_alone; }
 
+	/// Return whether a DRAM configuration file was given with option
+	/// '--dram-config'.
+	static bool hasConfigFile();
+
+	/// Finds the integer base 2 log of a number.
+	static int Log2(unsigned num);
+
 	/// Returns the size in bits of the physical channel address component.
 	int getPhysicalSize() const { return physical_size; }
 
@@ -201,6 +212,13 @@ public:
 	/// Send a write request to the dram device
 	void Write(long long address);
 
+	/// Dump the DRAM report in the file given with option
+	/// '--dram-report', if any.
+	void DumpReport();
+
+	/// Dump the DRAM report to an output stream.
+	void DumpReport(std::ostream &os) const;
+
 	/// Dump the object to an output stream.
 	void Dump(std::ostream &os = std::cout) const;
 
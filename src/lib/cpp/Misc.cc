@@ -215,5 +215,38 @@ std::string getBaseName(const std::string &path)
 	return path.substr(0, dot_index);
 }
 
+
+
+
+//
+// Binary streams
+//
+
+void ReadBinary(std::istream &is, char *buffer, unsigned size)
+{
+	is.read(buffer, size);
+	if (!is || (unsigned) is.gcount() != size)
+		throw Error("Unexpected end of binary stream");
+}
+
+
+void WriteBinaryString(std::ostream &os, const std::string &s)
+{
+	unsigned length = s.length();
+	WriteBinary(os, length);
+	os.write(s.data(), length);
+}
+
+
+std::string ReadBinaryString(std::istream &is)
+{
+	unsigned length;
+	ReadBinary(is, length);
+	std::string s(length, '\0');
+	if (length)
+		ReadBinary(is, &s[0], length);
+	return s;
+}
+
 }  // namespace Misc
 
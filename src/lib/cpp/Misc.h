@@ -182,6 +182,39 @@ std::string getBaseName(const std::string &path);
 
 
 
+//
+// Binary streams
+//
+
+/// Read exactly \a size bytes from an input stream into \a buffer.
+///
+/// \throw
+///	This function throws a misc::Error if the stream ends or fails
+///	before all bytes are read.
+void ReadBinary(std::istream &is, char *buffer, unsigned size);
+
+/// Write the binary representation of a plain value into an output stream.
+template<typename T> inline void WriteBinary(std::ostream &os, const T &value)
+{
+	os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+/// Read the binary representation of a plain value, as written by
+/// WriteBinary(), from an input stream.
+template<typename T> inline void ReadBinary(std::istream &is, T &value)
+{
+	ReadBinary(is, reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+/// Write a string into a binary output stream, preceded by its length.
+void WriteBinaryString(std::ostream &os, const std::string &s);
+
+/// Read a string written with WriteBinaryString() from an input stream.
+std::string ReadBinaryString(std::istream &is);
+
+
+
+
 //
 // Miscellaneous
 //
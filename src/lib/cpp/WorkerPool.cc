@@ -0,0 +1,126 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Error.h"
+#include "WorkerPool.h"
+
+
+namespace misc
+{
+
+
+WorkerPool::~WorkerPool()
+{
+	// Finish host threads
+	pthread_mutex_lock(&mutex);
+	threads_exit = true;
+	pthread_cond_broadcast(&start_cond);
+	pthread_mutex_unlock(&mutex);
+	for (pthread_t thread : threads)
+		pthread_join(thread, nullptr);
+}
+
+
+void *WorkerPool::ThreadMain(void *arg)
+{
+	WorkerPool *pool = (WorkerPool *) arg;
+	long long last_batch_id = 0;
+
+	pthread_mutex_lock(&pool->mutex);
+	while (true)
+	{
+		// Wait for a new batch
+		while (pool->batch_id == last_batch_id && !pool->threads_exit)
+			pthread_cond_wait(&pool->start_cond, &pool->mutex);
+		if (pool->threads_exit)
+			break;
+		last_batch_id = pool->batch_id;
+
+		// Execute tasks until the batch is exhausted
+		pool->BeginBatch();
+		while (pool->next_task < pool->num_tasks)
+		{
+			int index = pool->next_task++;
+			pthread_mutex_unlock(&pool->mutex);
+			std::exception_ptr exception;
+			try
+			{
+				pool->ExecuteTask(index);
+			}
+			catch (...)
+			{
+				exception = std::current_exception();
+			}
+			pthread_mutex_lock(&pool->mutex);
+			if (exception && !pool->batch_exception)
+				pool->batch_exception = exception;
+		}
+		pool->EndBatch();
+
+		// Notify the main thread when the last host thread is done
+		if (--pool->batch_pending == 0)
+			pthread_cond_signal(&pool->done_cond);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	return nullptr;
+}
+
+
+void WorkerPool::Start(int num_tasks, int num_threads)
+{
+	// Create host threads the first time
+	while ((int) threads.size() < num_threads)
+	{
+		pthread_t thread;
+		if (pthread_create(&thread, nullptr, ThreadMain, this))
+			throw Error("Cannot create host thread");
+		threads.push_back(thread);
+	}
+
+	// Publish the batch
+	pthread_mutex_lock(&mutex);
+	this->num_tasks = num_tasks;
+	next_task = 0;
+	batch_pending = threads.size();
+	batch_exception = nullptr;
+	batch_id++;
+	pthread_cond_broadcast(&start_cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+
+void WorkerPool::Wait()
+{
+	// Wait for all host threads to finish the batch
+	pthread_mutex_lock(&mutex);
+	while (batch_pending)
+		pthread_cond_wait(&done_cond, &mutex);
+	std::exception_ptr exception = batch_exception;
+	batch_exception = nullptr;
+	num_tasks = 0;
+	pthread_mutex_unlock(&mutex);
+
+	// Propagate errors from host threads
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
+
+}  // namespace misc
+
@@ -0,0 +1,113 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_WORKER_POOL_H
+#define LIB_CPP_WORKER_POOL_H
+
+#include <exception>
+#include <pthread.h>
+#include <vector>
+
+
+namespace misc
+{
+
+
+/// Pool of host threads executing batches of independent tasks. A derived
+/// class defines what a task does by overriding ExecuteTask(). Each task of
+/// a batch is picked up by one host thread, and the first exception thrown
+/// by a task is propagated to the thread waiting for the batch.
+class WorkerPool
+{
+	// Host threads of the pool, created on the first batch
+	std::vector<pthread_t> threads;
+
+	// Mutex and conditions protecting the fields below, used to
+	// communicate the main thread with the host threads
+	pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+	pthread_cond_t start_cond = PTHREAD_COND_INITIALIZER;
+	pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+
+	// Number of tasks of the current batch, and index of the next task to
+	// be picked up by a host thread
+	int num_tasks = 0;
+	int next_task = 0;
+
+	// Identifier of the last batch, used by host threads to detect that
+	// a new batch is available
+	long long batch_id = 0;
+
+	// Number of host threads still working on the current batch
+	int batch_pending = 0;
+
+	// First exception thrown while executing the current batch
+	std::exception_ptr batch_exception;
+
+	// Flag telling host threads to finish
+	bool threads_exit = false;
+
+	// Main function of the host threads
+	static void *ThreadMain(void *arg);
+
+protected:
+
+	/// Execute the task with the given index in the current batch. This
+	/// function runs on a host thread of the pool.
+	virtual void ExecuteTask(int index) = 0;
+
+	/// Function invoked on each host thread before it picks up the first
+	/// task of a batch.
+	virtual void BeginBatch() { }
+
+	/// Function invoked on each host thread after the tasks of a batch are
+	/// exhausted. It runs with the pool mutex locked, so it can safely
+	/// merge per-thread state, such as statistics, into shared state.
+	virtual void EndBatch() { }
+
+public:
+
+	/// Destructor, finishing the host threads of the pool
+	virtual ~WorkerPool();
+
+	/// Start executing \a num_tasks tasks on \a num_threads host threads
+	/// and return without waiting for them. Host threads are created the
+	/// first time. A call to Wait() must follow before the next batch.
+	void Start(int num_tasks, int num_threads);
+
+	/// Wait for all host threads to finish the current batch, and throw
+	/// the first exception thrown by any of its tasks.
+	void Wait();
+
+	/// Execute \a num_tasks tasks on \a num_threads host threads,
+	/// returning when all of them finish.
+	void Run(int num_tasks, int num_threads)
+	{
+		Start(num_tasks, num_threads);
+		Wait();
+	}
+
+	/// Return the number of host threads created so far
+	int getNumThreads() const { return threads.size(); }
+};
+
+
+}  // namespace misc
+
+#endif
+
@@ -0,0 +1,130 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cassert>
+
+#include "CalendarQueue.h"
+
+
+namespace esim
+{
+
+CalendarQueue::CalendarQueue(long long bucket_width) :
+		buckets(NumBuckets),
+		bucket_width(bucket_width)
+{
+	assert(bucket_width > 0);
+}
+
+
+void CalendarQueue::setBucketWidth(long long bucket_width)
+{
+	// Ignore if there are frames in the queue
+	assert(bucket_width > 0);
+	if (!empty())
+		return;
+
+	// Align the current bucket with the new width
+	this->bucket_width = bucket_width;
+	current_bucket_time = current_bucket_time / bucket_width * bucket_width;
+}
+
+
+void CalendarQueue::InsertInBucket(FramePointer<Frame> frame)
+{
+	// Find bucket. Frames scheduled before the current bucket go into the
+	// current bucket, where they are sorted before any other frame.
+	assert(frame->time < getHorizon());
+	int index = current_bucket;
+	if (frame->time >= current_bucket_time)
+		index = (current_bucket + (frame->time - current_bucket_time) /
+				bucket_width) & (NumBuckets - 1);
+	auto &bucket = buckets[index];
+	num_frames_in_buckets++;
+
+	// Frames are usually scheduled in order within a bucket, since they
+	// have increasing schedule sequence numbers. Look for the insertion
+	// point starting at the back.
+	Frame::ComparePointers later;
+	auto it = bucket.end();
+	while (it != bucket.begin() && later(*(it - 1), frame))
+		--it;
+	if (it == bucket.end())
+		bucket.push_back(std::move(frame));
+	else
+		bucket.insert(it, std::move(frame));
+}
+
+
+void CalendarQueue::MigrateOverflow()
+{
+	while (!overflow.empty() && overflow.top()->time < getHorizon())
+	{
+		FramePointer<Frame> frame = overflow.top();
+		overflow.pop();
+		InsertInBucket(std::move(frame));
+	}
+}
+
+
+void CalendarQueue::Advance()
+{
+	assert(!empty());
+	while (buckets[current_bucket].empty())
+	{
+		// If all buckets are empty, jump straight to the bucket of the
+		// first frame in the overflow heap. Otherwise, move on to the
+		// next bucket, which extends the horizon by one bucket.
+		if (!num_frames_in_buckets)
+		{
+			long long time = overflow.top()->time;
+			current_bucket_time = time / bucket_width * bucket_width;
+		}
+		else
+		{
+			current_bucket = (current_bucket + 1) & (NumBuckets - 1);
+			current_bucket_time += bucket_width;
+		}
+
+		// Bring frames that are now within the horizon
+		MigrateOverflow();
+	}
+}
+
+
+void CalendarQueue::push(FramePointer<Frame> frame)
+{
+	if (frame->time < getHorizon())
+		InsertInBucket(std::move(frame));
+	else
+		overflow.push(std::move(frame));
+}
+
+
+void CalendarQueue::pop()
+{
+	if (buckets[current_bucket].empty())
+		Advance();
+	buckets[current_bucket].pop_front();
+	num_frames_in_buckets--;
+}
+
+
+}  // namespace esim
+
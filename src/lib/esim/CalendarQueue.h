@@ -0,0 +1,128 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_ESIM_CALENDAR_QUEUE_H
+#define LIB_CPP_ESIM_CALENDAR_QUEUE_H
+
+#include <deque>
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include "Frame.h"
+
+
+namespace esim
+{
+
+/// Calendar queue used by the simulation engine as an alternative to the
+/// binary heap of pending events. Time is divided in buckets of a fixed
+/// width, and a circular array of buckets covers the near future. Each
+/// bucket keeps its frames sorted by time and schedule sequence number,
+/// so frames are extracted in exactly the same order as from the event
+/// heap. Frames scheduled beyond the range covered by the buckets are kept
+/// in an overflow heap, and moved into the buckets as time advances.
+class CalendarQueue
+{
+	// Number of buckets in the calendar, must be a power of 2
+	static const int NumBuckets = 1024;
+
+	// Circular array of buckets
+	std::vector<std::deque<FramePointer<Frame>>> buckets;
+
+	// Frames scheduled beyond the last bucket
+	std::priority_queue<FramePointer<Frame>,
+			std::vector<FramePointer<Frame>>,
+			Frame::ComparePointers> overflow;
+
+	// Time covered by each bucket in picoseconds
+	long long bucket_width;
+
+	// Index of the current bucket, containing the next frame
+	int current_bucket = 0;
+
+	// Start time of the current bucket in picoseconds
+	long long current_bucket_time = 0;
+
+	// Number of frames in the buckets, not counting the overflow heap
+	int num_frames_in_buckets = 0;
+
+	// Return the time past the end of the last bucket
+	long long getHorizon() const
+	{
+		return current_bucket_time + bucket_width * NumBuckets;
+	}
+
+	// Insert a frame in its bucket. The frame time must be before the
+	// horizon. Frames scheduled before the current bucket are inserted in
+	// the current bucket.
+	void InsertInBucket(FramePointer<Frame> frame);
+
+	// Move all frames from the overflow heap that fall before the horizon
+	// into their buckets.
+	void MigrateOverflow();
+
+	// Advance the current bucket until it contains frames. The calendar
+	// queue must not be empty.
+	void Advance();
+
+public:
+
+	/// Constructor
+	///
+	/// \param bucket_width
+	///	Time covered by each bucket in picoseconds. The best performance
+	///	is obtained with the cycle time of the fastest frequency domain.
+	CalendarQueue(long long bucket_width = 1000);
+
+	/// Change the time covered by each bucket. This only takes effect if
+	/// the queue is empty, since the position of the frames in the buckets
+	/// depends on it.
+	void setBucketWidth(long long bucket_width);
+
+	/// Insert a frame. Its scheduled time and schedule sequence number
+	/// must have been assigned.
+	void push(FramePointer<Frame> frame);
+
+	/// Return the frame with the earliest time, and for equal times, with
+	/// the lowest schedule sequence number. The queue must not be empty.
+	const FramePointer<Frame> &top()
+	{
+		if (buckets[current_bucket].empty())
+			Advance();
+		return buckets[current_bucket].front();
+	}
+
+	/// Remove the frame returned by top()
+	void pop();
+
+	/// Return the number of frames in the queue
+	size_t size() const
+	{
+		return num_frames_in_buckets + overflow.size();
+	}
+
+	/// Return whether the queue is empty
+	bool empty() const { return size() == 0; }
+};
+
+
+}  // namespace esim
+
+#endif
@@ -32,6 +32,14 @@ misc::Debug Engine::debug;
 
 std::unique_ptr<Engine> Engine::instance;
 
+Engine::SchedulerKind Engine::scheduler_kind = Engine::SchedulerHeap;
+
+const misc::StringMap Engine::SchedulerKindMap =
+{
+	{ "heap", SchedulerHeap },
+	{ "calendar", SchedulerCalendar }
+};
+
 const char *engine_err_finalization =
 	"The finalization process of the event-driven simulation is trying to "
 	"empty the event heap by scheduling all pending events. If the number of "
@@ -56,6 +64,10 @@ Engine::Engine() : timer("esim::Timer")
 	// Initialize timer
 	timer.Start();
 
+	// Create calendar queue
+	if (scheduler_kind == SchedulerCalendar)
+		calendar = misc::new_unique<CalendarQueue>();
+
 	// Create null event
 	null_event = RegisterEvent("Null event", nullptr, nullptr);
 
@@ -94,16 +106,16 @@ bool Engine::Drain(int max_events)
 	while (1)
 	{
 		// No more elements in heap
-		if (heap.size() == 0)
+		if (getNumPendingEvents() == 0)
 			return false;
 
 		// Get frame from top of the heap
 		assert(current_frame == nullptr);
-		current_frame = heap.top();
+		current_frame = getNextFrame();
 		assert(current_frame->in_heap);
 
 		// Extract from heap
-		heap.pop();
+		PopNextFrame();
 		current_frame->in_heap = false;
 
 		// Debug
@@ -208,30 +220,33 @@ void Engine::ProcessEvents()
 	while (1)
 	{
 		// No more elements in heap
-		if (heap.size() == 0)
+		if (getNumPendingEvents() == 0)
 			break;
 
 		// Stop when we find the first event that should run in the
 		// future.
-		if (heap.top()->time > current_time)
+		const FramePointer<Frame> &next_frame = getNextFrame();
+		if (next_frame->time > current_time)
 			break;
 		
 		// Get frame from top of heap
 		assert(current_frame == nullptr);
-		current_frame = heap.top();
+		current_frame = next_frame;
 		assert(current_frame->in_heap);
 
 		// Remove frame from the heap
-		heap.pop();
+		PopNextFrame();
 		current_frame->in_heap = false;
 
 		// Debug
 		Event *event = current_frame->event;
 		FrequencyDomain *frequency_domain = event->getFrequencyDomain();
-		debug << misc::fmt("[%.2fns] Event '%s/%s' triggered\n",
-				(double) current_time / 1000,
-				frequency_domain->getName().c_str(),
-				event->getName().c_str());
+		if (debug)
+			debug << misc::fmt("[%.2fns] Event '%s/%s' "
+					"triggered\n",
+					(double) current_time / 1000,
+					frequency_domain->getName().c_str(),
+					event->getName().c_str());
 
 		// The event is being run, so decrement the number of in-flight
 		// events of its type.
@@ -255,6 +270,30 @@ void Engine::ProcessEvents()
 }
 
 
+long long Engine::getNextEventTime()
+{
+	return getNumPendingEvents() ? getNextFrame()->time : -1;
+}
+
+
+void Engine::SkipTo(long long time)
+{
+	// Sanity
+	assert(time >= current_time);
+	assert(time % shortest_cycle_time == 0);
+
+	// Events cannot be skipped
+	long long next_event_time = getNextEventTime();
+	if (next_event_time >= 0 && next_event_time < time)
+		throw misc::Panic(misc::fmt("Cannot skip to time %lld with "
+				"an event pending at time %lld",
+				time, next_event_time));
+
+	// Advance time
+	current_time = time;
+}
+
+
 FrequencyDomain *Engine::RegisterFrequencyDomain(const std::string &name,
 		int frequency)
 {
@@ -266,6 +305,8 @@ FrequencyDomain *Engine::RegisterFrequencyDomain(const std::string &name,
 	{
 		fastest_frequency = frequency;
 		shortest_cycle_time = 1000000ll / frequency;
+		if (calendar)
+			calendar->setBucketWidth(shortest_cycle_time);
 	}
 
 	// Return created frequency domain
@@ -285,6 +326,8 @@ void Engine::UpdateFastestFrequency()
 			shortest_cycle_time = frequency_domain.getCycleTime();
 		}
 	}
+	if (calendar)
+		calendar->setBucketWidth(shortest_cycle_time);
 }
 
 
@@ -298,7 +341,7 @@ Event *Engine::RegisterEvent(const std::string &name,
 	
 	
 void Engine::Schedule(Event *event,
-		std::shared_ptr<Frame> frame,
+		FramePointer<Frame> frame,
 		int after,
 		int period)
 {
@@ -355,21 +398,23 @@ void Engine::Schedule(Event *event,
 	frame->schedule_sequence = ++schedule_sequence_counter;
 
 	// Insert frame into the heap
-	heap.emplace(frame);
 	frame->in_heap = true;
+	InsertFrame(frame);
 
 	// Increment the number of in-flight events of this type.
 	event->incInFlight();
 
 	// Debug
-	debug << misc::fmt("[%.2fns] Event '%s/%s' scheduled for [%.2fns]\n",
-			(double) current_time / 1000,
-			frequency_domain->getName().c_str(),
-			event->getName().c_str(),
-			(double) frame->time / 1000);
+	if (debug)
+		debug << misc::fmt("[%.2fns] Event '%s/%s' scheduled "
+				"for [%.2fns]\n",
+				(double) current_time / 1000,
+				frequency_domain->getName().c_str(),
+				event->getName().c_str(),
+				(double) frame->time / 1000);
 
 	// Warn when heap is overloaded
-	if (!max_inflight_events_warning && (int) heap.size() >=
+	if (!max_inflight_events_warning && (int) getNumPendingEvents() >=
 			max_inflight_events)
 	{
 		max_inflight_events_warning = true;
@@ -387,16 +432,16 @@ void Engine::Next(Event *event,
 {
 	// Use current event's frame if this function is invoked within an
 	// event handler, or create new frame otherwise.
-	std::shared_ptr<Frame> frame = current_frame;
+	FramePointer<Frame> frame = current_frame;
 	if (!frame)
-		frame = misc::new_shared<Frame>();
+		frame = new_frame<Frame>();
 
 	// Schedule event
-	Schedule(event, frame, after, period);
+	Schedule(event, std::move(frame), after, period);
 }
 
 
-void Engine::Execute(Event *event, std::shared_ptr<Frame> frame,
+void Engine::Execute(Event *event, FramePointer<Frame> frame,
 		Event *receive_event)
 {
 	// Null event
@@ -404,7 +449,7 @@ void Engine::Execute(Event *event, std::shared_ptr<Frame> frame,
 		return;
 
 	// Save old current frame
-	std::shared_ptr<Frame> old_current_frame = current_frame;
+	FramePointer<Frame> old_current_frame = current_frame;
 
 	// Create new frame if none exists
 	frame->parent_frame = current_frame;
@@ -421,21 +466,21 @@ void Engine::Execute(Event *event, std::shared_ptr<Frame> frame,
 
 
 void Engine::Call(Event *event,
-		std::shared_ptr<Frame> frame,
+		FramePointer<Frame> frame,
 		Event *return_event,
 		int after,
 		int period)
 {
 	// Create new frame if none passed
 	if (frame == nullptr)
-		frame = misc::new_shared<Frame>();
+		frame = new_frame<Frame>();
 
 	// Set return event and frame
 	frame->return_event = return_event;
 	frame->parent_frame = current_frame;
 
 	// Schedule event
-	Schedule(event, frame, after, period);
+	Schedule(event, std::move(frame), after, period);
 }
 
 
@@ -464,7 +509,7 @@ void Engine::EndEvent(Event *event)
 		return;
 	
 	// Create frame
-	auto frame = misc::new_shared<Frame>();
+	auto frame = new_frame<Frame>();
 	frame->event = event;
 
 	// Add event to queue of end events
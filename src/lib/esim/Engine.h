@@ -33,6 +33,7 @@
 #include <lib/cpp/String.h>
 #include <lib/cpp/Timer.h>
 
+#include "CalendarQueue.h"
 #include "Event.h"
 #include "Frame.h"
 #include "FrequencyDomain.h"
@@ -63,9 +64,27 @@ public:
 /// Event-driven simulator engine
 class Engine
 {
+public:
+
+	/// Data structure used to keep the pending events
+	enum SchedulerKind
+	{
+		SchedulerInvalid = 0,
+		SchedulerHeap,
+		SchedulerCalendar
+	};
+
+	/// String map for SchedulerKind
+	static const misc::StringMap SchedulerKindMap;
+
+private:
+
 	// Unique instance of this class
 	static std::unique_ptr<Engine> instance;
 
+	// Data structure for pending events used by new instances
+	static SchedulerKind scheduler_kind;
+
 	/// Debugger
 	static misc::Debug debug;
 
@@ -88,12 +107,16 @@ class Engine
 	std::list<FrequencyDomain> frequency_domains;
 
 	// Heap of pending events
-	std::priority_queue<std::shared_ptr<Frame>,
-			std::vector<std::shared_ptr<Frame>>,
-			Frame::CompareSharedPointers> heap;
+	std::priority_queue<FramePointer<Frame>,
+			std::vector<FramePointer<Frame>>,
+			Frame::ComparePointers> heap;
+
+	// Calendar queue of pending events, used instead of the heap when
+	// the engine was created with the calendar scheduler
+	std::unique_ptr<CalendarQueue> calendar;
 
 	// Queue of frames associated with the end events
-	std::queue<std::shared_ptr<Frame>> end_frames;
+	std::queue<FramePointer<Frame>> end_frames;
 
 	// Null event type used to schedule useless events
 	Event *null_event = nullptr;
@@ -112,7 +135,7 @@ class Engine
 
 	// When an event handler is being executed, this is the current frame.
 	// Otherwise, it is null.
-	std::shared_ptr<Frame> current_frame;
+	FramePointer<Frame> current_frame;
 
 	// Counter used to assign values to the 'schedule_sequence' field
 	// of Frame instances
@@ -135,6 +158,37 @@ class Engine
 	// Signals received from the user are captured by this function
 	static void SignalHandler(int sig);
 
+	// Return the number of pending events
+	size_t getNumPendingEvents() const
+	{
+		return calendar ? calendar->size() : heap.size();
+	}
+
+	// Return the frame of the next pending event. There must be at least
+	// one pending event.
+	const FramePointer<Frame> &getNextFrame()
+	{
+		return calendar ? calendar->top() : heap.top();
+	}
+
+	// Remove the frame returned by getNextFrame()
+	void PopNextFrame()
+	{
+		if (calendar)
+			calendar->pop();
+		else
+			heap.pop();
+	}
+
+	// Insert a frame in the pending events
+	void InsertFrame(FramePointer<Frame> frame)
+	{
+		if (calendar)
+			calendar->push(std::move(frame));
+		else
+			heap.emplace(std::move(frame));
+	}
+
 	// Drain the event heap, with a maximum number of events specified in
 	// the argument. If this number is exceeded, the function returns true.
 	// If the heap is drained successfully, the function returns false.
@@ -155,6 +209,19 @@ public:
 	/// Destroy the singleton if allocated.
 	static void Destroy() { instance = nullptr; }
 
+	/// Select the data structure used to keep the pending events. This
+	/// only affects instances created after the call. Both data structures
+	/// run events in the same order: by time, and for events scheduled
+	/// for the same time, in the order in which they were scheduled.
+	static void setSchedulerKind(SchedulerKind kind)
+	{
+		scheduler_kind = kind;
+	}
+
+	/// Return the data structure used to keep the pending events in new
+	/// instances.
+	static SchedulerKind getSchedulerKind() { return scheduler_kind; }
+
 	/// Force end of simulation with a specific reason.
 	void Finish(const std::string &reason)
 	{
@@ -195,6 +262,17 @@ public:
 	/// Return the current simulated time in picoseconds.
 	long long getTime() const { return current_time; }
 
+	/// Return the time in picoseconds of the earliest pending event, or -1
+	/// if there are no pending events.
+	long long getNextEventTime();
+
+	/// Advance the simulation time to \a time without going through the
+	/// cycles in between. This function can be used by a timing simulator
+	/// that knows that none of its components can make progress before
+	/// that time. The given time must be a multiple of the shortest cycle
+	/// time, and no event can be pending for an earlier time.
+	void SkipTo(long long time);
+
 	/// Return the current cycle in the fastest registered frequency domain.
 	/// At least one frequency domain must have been registered.
 	long long getCycle() const
@@ -234,7 +312,7 @@ public:
 
 	/// If an event handler is currently executing, return the current
 	/// frame. Otherwise, return `nullptr`.
-	const std::shared_ptr<Frame> &getCurrentFrame() const
+	const FramePointer<Frame> &getCurrentFrame() const
 	{
 		return current_frame;
 	}
@@ -292,7 +370,7 @@ public:
 	/// not be invoked from outside of this library. Use Call() or Next()
 	/// instead. See Next() for the meaning of the arguments.
 	void Schedule(Event *event,
-			std::shared_ptr<Frame> event_frame,
+			FramePointer<Frame> event_frame,
 			int after = 0,
 			int period = 0);
 
@@ -330,7 +408,7 @@ public:
 	///	Type of event to execute
 	///
 	/// \param event_frame
-	///	Data associated with the event, given as a shared pointer. This
+	///	Data associated with the event, created with new_frame(). This
 	///	object will be freed automatically when the last reference to
 	///	it disappears.
 	///
@@ -339,7 +417,7 @@ public:
 	///	invocation to Return() will cause \a return_event to be
 	///	scheduled, using the current frame as the event data.
 	///
-	void Execute(Event *event, std::shared_ptr<Frame> event_frame,
+	void Execute(Event *event, FramePointer<Frame> event_frame,
 			Event *return_event);
 
 	/// Schedule an event, creating a new event chain with its new event
@@ -355,7 +433,7 @@ public:
 	///	Type of event to schedule
 	///
 	/// \param frame
-	///	Data associated with the event, given as a shared pointer. This
+	///	Data associated with the event, created with new_frame(). This
 	///	object will be freed automatically when the last reference to
 	///	it disappears.
 	///
@@ -374,7 +452,7 @@ public:
 	///	respect to the event's frequency domain.
 	///
 	void Call(Event *event,
-			std::shared_ptr<Frame> frame = nullptr,
+			FramePointer<Frame> frame = nullptr,
 			Event *return_event = nullptr,
 			int after = 0,
 			int period = 0);
@@ -17,12 +17,83 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <new>
+
 #include "Frame.h"
 
 
 namespace esim
 {
 
+// Sizes of memory blocks in the frame pools are multiples of this value
+static const size_t frame_pool_granularity = 16;
+
+// Largest block size served from the frame pools. Larger frames are
+// allocated with the global allocator.
+static const size_t frame_pool_max_size = 512;
+
+// Number of blocks allocated at once when a frame pool runs empty
+static const int frame_pool_chunk_size = 64;
+
+// Free block in a frame pool, linked with the other free blocks of the same
+// size. The memory of a frame pool is never returned to the system.
+struct FramePoolBlock
+{
+	FramePoolBlock *next;
+};
+
+// Lists of free blocks, one per block size. The lists are private to each
+// host thread, so they can be accessed without locking.
+static thread_local FramePoolBlock *frame_pools[frame_pool_max_size /
+		frame_pool_granularity];
+
+
+void *Frame::operator new(size_t size)
+{
+	// Large frame
+	if (size > frame_pool_max_size)
+		return ::operator new(size);
+
+	// Allocate a new chunk of blocks if the pool is empty
+	int index = (size - 1) / frame_pool_granularity;
+	FramePoolBlock *&pool = frame_pools[index];
+	if (!pool)
+	{
+		size_t block_size = (index + 1) * frame_pool_granularity;
+		char *chunk = (char *) ::operator new(block_size *
+				frame_pool_chunk_size);
+		for (int i = 0; i < frame_pool_chunk_size; i++)
+		{
+			auto block = (FramePoolBlock *) (chunk + i * block_size);
+			block->next = pool;
+			pool = block;
+		}
+	}
+
+	// Take block from the pool
+	FramePoolBlock *block = pool;
+	pool = block->next;
+	return block;
+}
+
+
+void Frame::operator delete(void *block, size_t size)
+{
+	// Large frame
+	if (size > frame_pool_max_size)
+	{
+		::operator delete(block);
+		return;
+	}
+
+	// Return block to the pool
+	FramePoolBlock *&pool = frame_pools[(size - 1) /
+			frame_pool_granularity];
+	auto free_block = (FramePoolBlock *) block;
+	free_block->next = pool;
+	pool = free_block;
+}
+
 
 }  // namespace esim
 
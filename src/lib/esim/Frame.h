@@ -20,8 +20,11 @@
 #ifndef LIB_CPP_ESIM_FRAME_H
 #define LIB_CPP_ESIM_FRAME_H
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <utility>
 
 
 namespace esim
@@ -29,6 +32,153 @@ namespace esim
 
 // Forward declarations
 class Event;
+class Frame;
+
+
+/// Smart pointer to an event frame. The reference count is stored in the
+/// frame itself, so copying the pointer does not need a separate control
+/// block. The frame is freed when the last pointer referencing it
+/// disappears. The reference count is atomic, since frames scheduled or
+/// returned across partitions of the parallel simulation are referenced
+/// from several host threads.
+///
+/// A pointer can also be created from a \c std::shared_ptr to a frame, for
+/// code that still creates frames with \c misc::new_shared(). Such a frame
+/// stays alive as long as it is referenced by either kind of pointer.
+template<typename T> class FramePointer
+{
+	// Pointers to frames of other types need to access the raw pointer
+	template<typename U> friend class FramePointer;
+
+	// Referenced frame, or null
+	T *pointer = nullptr;
+
+	// Add a reference to the frame
+	void Acquire();
+
+	// Remove the reference to the frame, freeing it if it was the last
+	// one, and make the pointer null.
+	void Release();
+
+public:
+
+	/// Create a null pointer
+	FramePointer() { }
+
+	/// Create a null pointer
+	FramePointer(std::nullptr_t) { }
+
+	/// Create a pointer to a frame allocated with \c new. Use new_frame()
+	/// instead of this constructor.
+	explicit FramePointer(T *pointer) : pointer(pointer)
+	{
+		Acquire();
+	}
+
+	/// Copy constructor
+	FramePointer(const FramePointer &other) : pointer(other.pointer)
+	{
+		Acquire();
+	}
+
+	/// Move constructor
+	FramePointer(FramePointer &&other) : pointer(other.pointer)
+	{
+		other.pointer = nullptr;
+	}
+
+	/// Copy constructor from a pointer to a derived frame type
+	template<typename U> FramePointer(const FramePointer<U> &other) :
+			pointer(other.pointer)
+	{
+		Acquire();
+	}
+
+	/// Move constructor from a pointer to a derived frame type
+	template<typename U> FramePointer(FramePointer<U> &&other) :
+			pointer(other.pointer)
+	{
+		other.pointer = nullptr;
+	}
+
+	/// Create a pointer to a frame owned by a \c std::shared_ptr
+	template<typename U> FramePointer(const std::shared_ptr<U> &other);
+
+	/// Destructor
+	~FramePointer() { Release(); }
+
+	/// Copy assignment. The previous frame is released after taking the
+	/// new reference, since the new frame could be only referenced from
+	/// the previous one (e.g. when traversing a list of frames).
+	FramePointer &operator=(const FramePointer &other)
+	{
+		FramePointer copy(other);
+		std::swap(pointer, copy.pointer);
+		return *this;
+	}
+
+	/// Move assignment
+	FramePointer &operator=(FramePointer &&other)
+	{
+		FramePointer moved(std::move(other));
+		std::swap(pointer, moved.pointer);
+		return *this;
+	}
+
+	/// Make the pointer null
+	FramePointer &operator=(std::nullptr_t)
+	{
+		Release();
+		return *this;
+	}
+
+	/// Return the raw pointer to the frame
+	T *get() const { return pointer; }
+
+	/// Access the frame
+	T *operator->() const { return pointer; }
+
+	/// Access the frame
+	T &operator*() const { return *pointer; }
+
+	/// Return whether the pointer is not null
+	explicit operator bool() const { return pointer != nullptr; }
+
+	/// Compare two pointers
+	template<typename U> bool operator==(const FramePointer<U> &other) const
+	{
+		return pointer == other.pointer;
+	}
+
+	/// Compare two pointers
+	template<typename U> bool operator!=(const FramePointer<U> &other) const
+	{
+		return pointer != other.pointer;
+	}
+
+	/// Return whether the pointer is null
+	bool operator==(std::nullptr_t) const { return pointer == nullptr; }
+
+	/// Return whether the pointer is not null
+	bool operator!=(std::nullptr_t) const { return pointer != nullptr; }
+};
+
+
+/// Create a new frame of type \a T, which must be \c esim::Frame or a class
+/// derived from it, passing the given arguments to its constructor. This
+/// function replaces \c misc::new_shared() for event frames. The following
+/// example creates a frame and schedules an event with it:
+///
+/// \code
+///	auto frame = esim::new_frame<MyFrame>(arg1, arg2);
+///	esim::Engine::getInstance()->Call(event, frame);
+/// \endcode
+///
+template<typename T, typename... Args> FramePointer<T>
+		new_frame(Args&&... args)
+{
+	return FramePointer<T>(new T(std::forward<Args>(args)...));
+}
 
 
 /// This class represents data associated with an event.
@@ -38,8 +188,18 @@ class Frame
 	// the frame. This is preferrable to creating public fields or getters/
 	// setters, in order to make it clear that user classes derived from
 	// this one should not have access to these values.
+	friend class CalendarQueue;
 	friend class Engine;
 	friend class Queue;
+	template<typename T> friend class FramePointer;
+
+	// Number of frame pointers referencing this frame
+	std::atomic<int> reference_count{0};
+
+	// Shared pointer keeping the frame alive while frame pointers
+	// reference it, if the frame was allocated with misc::new_shared()
+	// instead of new_frame().
+	std::shared_ptr<Frame> owner;
 
 	// Event associated with this frame when the frame is enqueued in the
 	// event heap.
@@ -64,7 +224,7 @@ class Frame
 	bool in_heap = false;
 
 	// Parent frame is this event was invoked as a call
-	std::shared_ptr<Frame> parent_frame;
+	FramePointer<Frame> parent_frame;
 
 	// Event type to invoke upon return, or null if there is no parent
 	// event
@@ -75,7 +235,7 @@ class Frame
 
 	// Pointer to next frames in a waiting queue, or null if the event
 	// frame is not suspended in a queue.
-	std::shared_ptr<Frame> next;
+	FramePointer<Frame> next;
 
 	// Event type scheduled when the frame is woken up from a queue
 	Event *wakeup_event = nullptr;
@@ -84,10 +244,10 @@ public:
 	
 	// Comparison lambda, used as the comparison function in the event
 	// min-heap of the simulation engine.
-	struct CompareSharedPointers
+	struct ComparePointers
 	{
-		bool operator()(const std::shared_ptr<Frame> &lhs,
-				const std::shared_ptr<Frame> &rhs) const
+		bool operator()(const FramePointer<Frame> &lhs,
+				const FramePointer<Frame> &rhs) const
 		{
 			return lhs->time > rhs->time ||
 					(lhs->time == rhs->time &&
@@ -99,6 +259,15 @@ public:
 	/// Virtual destructor to make class polymorphic
 	virtual ~Frame() { }
 
+	/// Allocate a frame, or an object of any class derived from it. Frames
+	/// of up to 512 bytes are taken from per-size pools of recycled memory
+	/// blocks, since they are created and freed at a very high rate.
+	static void *operator new(size_t size);
+
+	/// Return the memory of a frame to the pool. The size is the one of the
+	/// dynamic type of the frame, given that the destructor is virtual.
+	static void operator delete(void *block, size_t size);
+
 	/// Return whether the frame is currently suspended in an event queue.
 	bool isInQueue() const { return in_queue; }
 	
@@ -108,6 +277,44 @@ public:
 };
 
 
+template<typename T> template<typename U>
+FramePointer<T>::FramePointer(const std::shared_ptr<U> &other) :
+		pointer(other.get())
+{
+	Frame *frame = pointer;
+	if (frame && !frame->owner)
+		frame->owner = other;
+	Acquire();
+}
+
+
+template<typename T> void FramePointer<T>::Acquire()
+{
+	if (pointer)
+		static_cast<Frame *>(pointer)->reference_count.fetch_add(1,
+				std::memory_order_relaxed);
+}
+
+
+template<typename T> void FramePointer<T>::Release()
+{
+	Frame *frame = pointer;
+	pointer = nullptr;
+	if (!frame || frame->reference_count.fetch_sub(1,
+			std::memory_order_acq_rel) != 1)
+		return;
+
+	// A frame owned by shared pointers is freed when the last of them
+	// disappears, which could be the one released here.
+	if (frame->owner)
+	{
+		std::shared_ptr<Frame> owner = std::move(frame->owner);
+		return;
+	}
+	delete frame;
+}
+
+
 }  // namespace esim
 
 #endif
@@ -24,6 +24,7 @@
 #include <memory>
 
 #include "Event.h"
+#include "Frame.h"
 
 
 namespace esim
@@ -36,19 +37,19 @@ namespace esim
 class Queue
 {
 	// Head pointer
-	std::shared_ptr<Frame> head;
+	FramePointer<Frame> head;
 
 	// Tail pointer
-	std::shared_ptr<Frame> tail;
+	FramePointer<Frame> tail;
 
 	// Remove an event frame from the queue.
-	std::shared_ptr<Frame> PopFront();
+	FramePointer<Frame> PopFront();
 
 	// Add an event frame to the tail of the queue
-	void PushBack(std::shared_ptr<Frame> frame);
+	void PushBack(FramePointer<Frame> frame);
 
 	// Add an event frame to the front of the queue
-	void PushFront(std::shared_ptr<Frame> frame);
+	void PushFront(FramePointer<Frame> frame);
 
 public:
 
@@ -74,15 +74,26 @@ std::string m2s_cuda_debug;
 // Event-driven simulator debugger
 std::string m2s_debug_esim;
 
+// Data structure for pending events in the event-driven simulator
+esim::Engine::SchedulerKind m2s_esim_scheduler = esim::Engine::SchedulerHeap;
+
 // Inifile debugger
 std::string m2s_debug_inifile;
 
 // Call stack debugger
 std::string m2s_debug_callstack;
 
+// Checkpoint file to load instead of running programs
+std::string m2s_load_checkpoint;
+
 // Maximum simulation time
 long long m2s_max_time = 0;
 
+// Checkpoint file to save, and number of x86 instructions to emulate before
+// saving it
+std::string m2s_save_checkpoint;
+long long m2s_save_checkpoint_inst = 0;
+
 // Binary file for OpenCL runtime
 std::string m2s_opencl_binary;
 
@@ -194,8 +205,32 @@ void LoadProgram(const std::vector<std::string> &arguments,
 // Load programs from context configuration file
 void LoadPrograms()
 {
-	// Load command-line program
+	// Checkpoints are only saved in functional simulation, where no
+	// instruction is in flight in the pipeline.
 	misc::CommandLine *command_line = misc::CommandLine::getInstance();
+	if (!m2s_save_checkpoint.empty() &&
+			x86::Timing::getSimKind() != comm::Arch::SimFunctional)
+		throw misc::Error("Option '--save-checkpoint' is only "
+				"supported in x86 functional simulation");
+
+	// Stop x86 emulation exactly where the checkpoint is saved
+	if (!m2s_save_checkpoint.empty())
+		x86::Emulator::getInstance()->setStopInstruction(
+				m2s_save_checkpoint_inst);
+
+	// Restore contexts from checkpoint instead of loading programs
+	if (!m2s_load_checkpoint.empty())
+	{
+		if (command_line->getNumArguments() ||
+				!m2s_context_config.empty())
+			throw misc::Error("Option '--load-checkpoint' cannot be "
+					"used together with a program");
+		x86::Emulator *emulator = x86::Emulator::getInstance();
+		emulator->LoadCheckpoint(m2s_load_checkpoint);
+		return;
+	}
+
+	// Load command-line program
 	LoadProgram(command_line->getArguments());
 
 	// Load more programs if context configuration file was specified
@@ -286,6 +321,16 @@ void RegisterOptions()
 			m2s_debug_esim,
 			"Dump debug information related with the event-driven "
 			"simulation engine.");
+
+	// Event scheduler of event-driven simulator
+	command_line->RegisterEnum("--esim-scheduler {heap|calendar} "
+			"(default = heap)",
+			(int &) m2s_esim_scheduler,
+			esim::Engine::SchedulerKindMap,
+			"Data structure used by the event-driven simulation "
+			"engine to keep pending events. A calendar queue "
+			"is faster than a heap when many events are in "
+			"flight. Both run events in the same order.");
 	
 	// Debugger for Inifile parser
 	command_line->RegisterString("--inifile-debug <file>",
@@ -293,6 +338,17 @@ void RegisterOptions()
 			"Dump debug information about all processed INI files "
 			"into the specified path.");
 	
+	// Load checkpoint
+	command_line->RegisterString("--load-checkpoint <file>",
+			m2s_load_checkpoint,
+			"Restore the state of the x86 emulator from a checkpoint "
+			"file previously generated with option "
+			"'--save-checkpoint', and continue simulation from that "
+			"point. No program can be given in the command line or "
+			"in a context configuration file with this option. "
+			"Timing simulation can be enabled on the restored "
+			"contexts, starting with empty caches and predictors.");
+
 	// Maximum simulation time
 	command_line->RegisterInt64("--max-time <time> (default = 0)",
 			m2s_max_time,
@@ -300,6 +356,25 @@ void RegisterOptions()
 			"will stop once this time is exceeded. A value of 0 "
 			"(default) means no time limit.");
 	
+	// Save checkpoint
+	command_line->RegisterString("--save-checkpoint <file>",
+			m2s_save_checkpoint,
+			"Save the state of the x86 emulator into a checkpoint "
+			"file and stop simulation, once the number of emulated "
+			"x86 instructions reaches exactly the value given in "
+			"option '--at-inst', which is required. The checkpoint "
+			"includes registers, memory, open files, and signal "
+			"state of all contexts, and can only be saved in "
+			"functional simulation. Contexts waiting in a futex are "
+			"saved as suspended, while contexts suspended in other "
+			"system calls run the system call again when the "
+			"checkpoint is loaded.");
+	command_line->RegisterInt64("--at-inst <num>",
+			m2s_save_checkpoint_inst,
+			"Number of x86 instructions after which the checkpoint "
+			"given in option '--save-checkpoint' is saved. The "
+			"value must be greater than 0.");
+
 	// Trace file
 	command_line->RegisterString("--trace <file>",
 			m2s_trace_file,
@@ -389,6 +464,9 @@ void ProcessOptions()
 	if (!m2s_debug_esim.empty())
 		esim::Engine::setDebugPath(m2s_debug_esim);
 
+	// Event scheduler of event-driven simulator
+	esim::Engine::setSchedulerKind(m2s_esim_scheduler);
+
 	// Inifile debugger
 	if (!m2s_debug_inifile.empty())
 		misc::IniFile::setDebugPath(m2s_debug_inifile);
@@ -412,6 +490,17 @@ void ProcessOptions()
 		trace_system->setPath(m2s_trace_file);
 	}
 
+	// Checkpoints
+	if (m2s_save_checkpoint_inst < 0)
+		throw misc::Error("Value for option '--at-inst' must be "
+				"greater than 0");
+	if (m2s_save_checkpoint_inst && m2s_save_checkpoint.empty())
+		throw misc::Error("Option '--at-inst' requires option "
+				"'--save-checkpoint'");
+	if (!m2s_save_checkpoint.empty() && !m2s_save_checkpoint_inst)
+		throw misc::Error("Option '--save-checkpoint' requires option "
+				"'--at-inst'");
+
 	// Visualization
 	if (!m2s_visual_file.empty())
 		visual_run(m2s_visual_file.c_str());
@@ -481,6 +570,19 @@ void MainLoop()
 		if (num_active_timing_simulators)
 			esim->ProcessEvents();
 
+		// Save checkpoint once the x86 emulator reached the requested
+		// number of instructions, where it stopped emulation.
+		if (!m2s_save_checkpoint.empty() && !esim->hasFinished())
+		{
+			x86::Emulator *emulator = x86::Emulator::getInstance();
+			if (emulator->getNumInstructions() >=
+					m2s_save_checkpoint_inst)
+			{
+				emulator->SaveCheckpoint(m2s_save_checkpoint);
+				esim->Finish("Checkpoint");
+			}
+		}
+
 		// If neither functional nor timing simulation was performed for
 		// any architecture, it means that all guest contexts finished
 		// execution - simulation can end.
@@ -564,6 +666,13 @@ void DumpReports()
 		mem_system->DumpReport();
 	}
 
+	// Dumping DRAM report
+	if (dram::System::hasInstance())
+	{
+		dram::System *dram_system = dram::System::getInstance();
+		dram_system->DumpReport();
+	}
+
 	// Dumping network report
 	if (net::System::hasInstance())
 	{
@@ -676,6 +785,16 @@ int MainProgram(int argc, char **argv)
 		net::System *net_system = net::System::getInstance();
 		net_system->ReadConfiguration();
 
+		// The DRAM configuration file is loaded before the memory
+		// configuration file too, since main memory modules refer to
+		// DRAM controllers by name. The DRAM system is only created
+		// if a DRAM configuration file was given.
+		if (dram::System::hasConfigFile())
+		{
+			dram::System *dram_system = dram::System::getInstance();
+			dram_system->ReadConfiguration();
+		}
+
 		// Parse the memory configuration file
 		mem::System *memory_system = mem::System::getInstance();
 		memory_system->ReadConfiguration();
@@ -17,6 +17,14 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <lib/cpp/Error.h>
+
 #include "Cache.h"
 #include "System.h"
 
@@ -28,7 +36,12 @@ const misc::StringMap Cache::ReplacementPolicyMap =
 {
 	{ "LRU", ReplacementLRU },
 	{ "FIFO", ReplacementFIFO },
-	{ "Random", ReplacementRandom }
+	{ "Random", ReplacementRandom },
+	{ "PLRU", ReplacementPLRU },
+	{ "SRRIP", ReplacementSRRIP },
+	{ "BRRIP", ReplacementBRRIP },
+	{ "DRRIP", ReplacementDRRIP },
+	{ "SHiP", ReplacementSHiP }
 };
 
 
@@ -75,20 +88,135 @@ Cache::Cache(const std::string &name,
 	// Allocate blocks and sets
 	blocks = misc::new_unique_array<Block>(num_blocks);
 	sets = misc::new_unique_array<Set>(num_sets);
+	tags = misc::new_unique_array<unsigned>(num_blocks);
+	transient_tags = misc::new_unique_array<unsigned>(num_blocks);
+	states = misc::new_unique_array<unsigned char>(num_blocks);
 	
-	// Initialize sets and blocks
+	// Initialize sets and blocks. Blocks start in way order for LRU and
+	// FIFO, and with a distant re-reference prediction for RRIP.
+	assert(num_ways <= 1u << 16);
 	for (unsigned set_id = 0; set_id < num_sets; set_id++)
 	{
 		Set *set = getSet(set_id);
+		set->blocks = getBlock(set_id, 0);
+		if (replacement_policy == ReplacementPLRU)
+			set->plru_bits.assign(num_ways, false);
 		for (unsigned way_id = 0; way_id < num_ways; way_id++)
 		{
 			Block *block = getBlock(set_id, way_id);
+			block->cache = this;
 			block->way_id = way_id;
-			set->lru_list.PushBack(block->lru_node);
+			block->age = isRRIP() ? max_rrpv : way_id;
 		}
 	}
+
+	// Set-dueling counter starts right below the BRRIP threshold
+	psel = (1 << (psel_bits - 1)) - 1;
+
+	// Signature history counters start weakly re-referenced
+	if (replacement_policy == ReplacementSHiP)
+		shct.assign(1 << ship_signature_bits, 1);
+}
+
+
+Cache::DuelingRole Cache::getDuelingRole(unsigned set_id) const
+{
+	// Leader sets are spread evenly across the cache. The first set of
+	// each group is an SRRIP leader, and the second a BRRIP leader.
+	unsigned group_size = std::max(4u, num_sets / num_drrip_leader_sets);
+	switch (set_id % group_size)
+	{
+	case 0: return DuelingLeaderSRRIP;
+	case 1: return DuelingLeaderBRRIP;
+	default: return DuelingFollower;
+	}
+}
+
+
+void Cache::MoveToHead(unsigned set_id, Block *block)
+{
+	// Blocks more recent than this one age by one position
+	for (unsigned way_id = 0; way_id < num_ways; way_id++)
+	{
+		Block *other = getBlock(set_id, way_id);
+		if (other->age < block->age)
+			other->age++;
+	}
+	block->age = 0;
+}
+
+
+void Cache::UpdatePLRU(Set *set, unsigned way_id)
+{
+	// Walk up from the leaf, making each node point to the other half
+	for (unsigned node = way_id + num_ways; node > 1; node /= 2)
+		set->plru_bits[node / 2] = !(node & 1);
 }
 
+
+int Cache::getInsertionRRPV(unsigned set_id, Block *block)
+{
+	// Choose between SRRIP and BRRIP insertion
+	bool bimodal;
+	switch (replacement_policy)
+	{
+	case ReplacementSRRIP:
+
+		bimodal = false;
+		break;
+
+	case ReplacementBRRIP:
+
+		bimodal = true;
+		break;
+
+	case ReplacementDRRIP:
+
+		// Misses in leader sets train the selection counter, while
+		// follower sets use the policy with fewer misses.
+		switch (getDuelingRole(set_id))
+		{
+		case DuelingLeaderSRRIP:
+
+			psel = std::min(psel + 1, (1 << psel_bits) - 1);
+			bimodal = false;
+			break;
+
+		case DuelingLeaderBRRIP:
+
+			psel = std::max(psel - 1, 0);
+			bimodal = true;
+			break;
+
+		default:
+
+			bimodal = isBRRIPSelected();
+		}
+		break;
+
+	case ReplacementSHiP:
+
+		// Signatures whose blocks were not reused are inserted with a
+		// distant re-reference prediction
+		return shct[block->signature] ? max_rrpv - 1 : max_rrpv;
+
+	default:
+
+		throw misc::Panic("Invalid replacement policy");
+	}
+
+	// SRRIP insertion
+	if (!bimodal)
+		return max_rrpv - 1;
+
+	// BRRIP insertion
+	if (++brrip_counter < brrip_throttle)
+		return max_rrpv;
+	brrip_counter = 0;
+	return max_rrpv - 1;
+}
+
+
 void Cache::DecodeAddress(unsigned address,
 		unsigned &set_id,
 		unsigned &tag,
@@ -100,6 +228,64 @@ void Cache::DecodeAddress(unsigned address,
 }
 
 
+// Return a bit mask of the positions among the first 'count' elements of
+// 'values' that are equal to 'value', where 'count' is at most 32.
+static unsigned MatchValues(const unsigned *values,
+		unsigned count,
+		unsigned value)
+{
+	unsigned mask = 0;
+	unsigned index = 0;
+
+#ifdef __SSE2__
+	// Compare four values at a time
+	__m128i key = _mm_set1_epi32(value);
+	for (; index + 4 <= count; index += 4)
+	{
+		__m128i chunk = _mm_loadu_si128((const __m128i *)
+				(values + index));
+		__m128i equal = _mm_cmpeq_epi32(chunk, key);
+		mask |= (unsigned) _mm_movemask_ps(_mm_castsi128_ps(equal))
+				<< index;
+	}
+#endif
+
+	// Remaining values
+	for (; index < count; index++)
+		if (values[index] == value)
+			mask |= 1u << index;
+	return mask;
+}
+
+
+unsigned Cache::MatchTags(unsigned set_id,
+		unsigned first_way,
+		unsigned tag,
+		unsigned &transient_mask) const
+{
+	assert(misc::inRange(set_id, 0, num_sets - 1));
+	assert(first_way < num_ways);
+	unsigned index = set_id * num_ways + first_way;
+	unsigned count = num_ways - first_way;
+	if (count > max_match_ways)
+		count = max_match_ways;
+
+	// Transient tags
+	transient_mask = MatchValues(&transient_tags[index], count, tag);
+
+	// Tags. Stale tags of invalid blocks are discarded, which is rare
+	// enough to be checked one by one.
+	unsigned mask = MatchValues(&tags[index], count, tag);
+	for (unsigned bits = mask; bits; bits &= bits - 1)
+	{
+		unsigned bit = __builtin_ctz(bits);
+		if (states[index + bit] == BlockInvalid)
+			mask &= ~(1u << bit);
+	}
+	return mask;
+}
+
+
 bool Cache::FindBlock(unsigned address,
 		unsigned &set_id,
 		unsigned &way_id,
@@ -110,12 +296,16 @@ bool Cache::FindBlock(unsigned address,
 	unsigned tag = address & ~block_mask;
 
 	// Find block
-	for (way_id = 0; way_id < num_ways; way_id++)
+	for (unsigned first_way = 0; first_way < num_ways;
+			first_way += max_match_ways)
 	{
-		Block *block = getBlock(set_id, way_id);
-		if (block->tag == tag && block->state != BlockInvalid)
+		unsigned transient_mask;
+		unsigned mask = MatchTags(set_id, first_way, tag,
+				transient_mask);
+		if (mask)
 		{
-			state = block->state;
+			way_id = first_way + __builtin_ctz(mask);
+			state = (BlockState) states[set_id * num_ways + way_id];
 			return true;
 		}
 	}
@@ -142,22 +332,17 @@ void Cache::setBlock(unsigned set_id,
 			tag,
 			BlockStateMap[state]);
 	
-	// Get set and block
-	Set *set = getSet(set_id);
+	// Get block
 	Block *block = getBlock(set_id, way_id);
 
 	// If the block is being brought to the cache now for the first time,
-	// update the FIFO list.
+	// update the FIFO order.
 	if (replacement_policy == ReplacementFIFO
-			&& block->tag != tag)
-	{
-		set->lru_list.Erase(block->lru_node);
-		set->lru_list.PushFront(block->lru_node);
-	}
+			&& block->getTag() != tag)
+		MoveToHead(set_id, block);
 
 	// Set new values for block
-	block->tag = tag;
-	block->state = state;
+	block->setStateTag(state, tag);
 }
 
 
@@ -167,8 +352,8 @@ void Cache::getBlock(unsigned set_id,
 		BlockState &state) const
 {
 	Block *block = getBlock(set_id, way_id);
-	tag = block->tag;
-	state = block->state;
+	tag = block->getTag();
+	state = block->getState();
 }
 
 
@@ -178,18 +363,90 @@ void Cache::AccessBlock(unsigned set_id, unsigned way_id)
 	Set *set = getSet(set_id);
 	Block *block = getBlock(set_id, way_id);
 
-	// A block is moved to the head of the list for LRU policy. It will also
-	// be moved if it is its first access for FIFO policy, i.e., if the
-	// state of the block was invalid.
-	bool move_to_head = replacement_policy == ReplacementLRU ||
-			(replacement_policy == ReplacementFIFO
-			&& block->state == BlockInvalid);
-	
-	// Move to the head of the LRU list
-	if (move_to_head)
+	switch (replacement_policy)
+	{
+	case ReplacementLRU:
+
+		MoveToHead(set_id, block);
+		break;
+
+	case ReplacementFIFO:
+
+		// A block is moved to the head for FIFO only on its first
+		// access, i.e., if the state of the block was invalid.
+		if (block->getState() == BlockInvalid)
+			MoveToHead(set_id, block);
+		break;
+
+	case ReplacementPLRU:
+
+		UpdatePLRU(set, way_id);
+		break;
+
+	case ReplacementSRRIP:
+	case ReplacementBRRIP:
+	case ReplacementDRRIP:
+	case ReplacementSHiP:
+
+		// Hit promotion. The first reuse of a block trains the counter
+		// of the signature that inserted it.
+		block->age = 0;
+		if (replacement_policy == ReplacementSHiP && !block->reused)
+		{
+			block->reused = true;
+			if (shct[block->signature] < max_shct)
+				shct[block->signature]++;
+		}
+		break;
+
+	default:
+
+		break;
+	}
+}
+
+
+void Cache::InsertBlock(unsigned set_id, unsigned way_id, unsigned pc)
+{
+	// Get set and block
+	Set *set = getSet(set_id);
+	Block *block = getBlock(set_id, way_id);
+
+	switch (replacement_policy)
 	{
-		set->lru_list.Erase(block->lru_node);
-		set->lru_list.PushFront(block->lru_node);
+	case ReplacementLRU:
+	case ReplacementFIFO:
+
+		MoveToHead(set_id, block);
+		break;
+
+	case ReplacementPLRU:
+
+		UpdatePLRU(set, way_id);
+		break;
+
+	case ReplacementSHiP:
+
+		// A block evicted without being reused trains the counter of
+		// the signature that inserted it.
+		if (block->getState() != BlockInvalid && !block->reused &&
+				shct[block->signature] > 0)
+			shct[block->signature]--;
+		block->signature = getSignature(pc);
+		block->reused = false;
+		block->age = getInsertionRRPV(set_id, block);
+		break;
+
+	case ReplacementSRRIP:
+	case ReplacementBRRIP:
+	case ReplacementDRRIP:
+
+		block->age = getInsertionRRPV(set_id, block);
+		break;
+
+	default:
+
+		break;
 	}
 }
 
@@ -199,29 +456,74 @@ unsigned Cache::ReplaceBlock(unsigned set_id)
 	// Get the set
 	Set *set = getSet(set_id);
 
-	// For LRU and FIFO replacement policies, return the block at the end of
-	// the block list in the set.
-	if (replacement_policy == ReplacementLRU ||
-			replacement_policy == ReplacementFIFO)
+	switch (replacement_policy)
 	{
-		// Get block at the end of LRU list
-		Block *block = misc::cast<Block *>(set->lru_list.Back());
-		assert(block);
+	case ReplacementLRU:
+	case ReplacementFIFO:
+	{
+		// Find the block at the end of the LRU or FIFO order
+		Block *block = set->blocks;
+		for (unsigned way_id = 1; way_id < num_ways; way_id++)
+			if (set->blocks[way_id].age > block->age)
+				block = &set->blocks[way_id];
+		assert(block->age == num_ways - 1);
 
 		// Move it to the head to avoid making it a candidate in the
-		// next call to getReplacementBlock().
-		set->lru_list.Erase(block->lru_node);
-		set->lru_list.PushFront(block->lru_node);
+		// next call to ReplaceBlock().
+		MoveToHead(set_id, block);
 
 		// Return way index of the selected block
 		return block->way_id;
 	}
 
-	// Random replacement policy
-	assert(replacement_policy == ReplacementRandom);
-	return random() % num_ways;
+	case ReplacementPLRU:
+	{
+		// Follow the tree bits down to a leaf
+		unsigned node = 1;
+		while (node < num_ways)
+			node = 2 * node + set->plru_bits[node];
+		unsigned way_id = node - num_ways;
+
+		// Point away from the selected block to avoid making it a
+		// candidate in the next call to ReplaceBlock().
+		UpdatePLRU(set, way_id);
+		return way_id;
+	}
+
+	case ReplacementSRRIP:
+	case ReplacementBRRIP:
+	case ReplacementDRRIP:
+	case ReplacementSHiP:
+
+		// Select the first block with a distant re-reference
+		// prediction, aging all blocks in the set until one is found.
+		while (true)
+		{
+			for (unsigned way_id = 0; way_id < num_ways; way_id++)
+			{
+				// Lower the prediction of the selected block to
+				// avoid making it a candidate in the next call
+				// to ReplaceBlock().
+				Block *block = &set->blocks[way_id];
+				if (block->age >= max_rrpv)
+				{
+					block->age = max_rrpv - 1;
+					return way_id;
+				}
+			}
+			for (unsigned way_id = 0; way_id < num_ways; way_id++)
+				set->blocks[way_id].age++;
+		}
+
+	case ReplacementRandom:
+
+		return random() % num_ways;
+
+	default:
+
+		throw misc::Panic("Invalid replacement policy");
+	}
 }
 
 
 }  // namespace mem
-
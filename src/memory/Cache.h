@@ -20,9 +20,11 @@
 #ifndef MEMORY_CACHE_H
 #define MEMORY_CACHE_H
 
+#include <cassert>
 #include <memory>
+#include <vector>
 
-#include <lib/cpp/List.h>
+#include <lib/cpp/Misc.h>
 #include <lib/cpp/String.h>
 
 
@@ -39,7 +41,12 @@ public:
 		ReplacementInvalid,
 		ReplacementLRU,
 		ReplacementFIFO,
-		ReplacementRandom
+		ReplacementRandom,
+		ReplacementPLRU,
+		ReplacementSRRIP,
+		ReplacementBRRIP,
+		ReplacementDRRIP,
+		ReplacementSHiP
 	};
 
 	/// String map for ReplacementPolicy
@@ -70,53 +77,103 @@ public:
 	/// String map for BlockState
 	static const misc::StringMap BlockStateMap;
 
-	/// Cache block. This class is a child of misc::List::Node because one
-	/// block will belong to one set's LRU list. See documentation of
-	/// misc::List::Node for details.
+	/// Number of bits of the re-reference prediction values (RRPV) used by
+	/// the RRIP-based replacement policies
+	static const int rrpv_bits = 2;
+
+	/// Maximum re-reference prediction value, meaning that the block is
+	/// predicted to be re-referenced in the distant future
+	static const int max_rrpv = (1 << rrpv_bits) - 1;
+
+	/// One out of this many insertions are done with a long re-reference
+	/// interval prediction under the BRRIP policy. The rest are done with
+	/// a distant prediction.
+	static const int brrip_throttle = 32;
+
+	/// Number of leader sets dedicated to each policy in DRRIP
+	static const int num_drrip_leader_sets = 32;
+
+	/// Number of bits of the DRRIP policy selection counter
+	static const int psel_bits = 10;
+
+	/// Number of bits of the signatures used by SHiP
+	static const int ship_signature_bits = 14;
+
+	/// Maximum value of the saturating counters of the SHiP signature
+	/// history counter table
+	static const int max_shct = 3;
+
+	/// Maximum number of ways compared by one call to MatchTags()
+	static const unsigned max_match_ways = 32;
+
+	/// Cache block. The tag, transient tag, and state of the block are
+	/// kept in packed per-set arrays of the cache, so that lookups only
+	/// touch the fields being compared. This object holds the rest of the
+	/// block metadata, and accesses the packed fields through the cache.
 	class Block
 	{
 		// Only Cache needs to initialize fields
 		friend class Cache;
 
-		// Block tag
-		unsigned tag = 0;
-
-		// Transient tag assigned by NMOESI protocol
-		unsigned transient_tag = 0;
+		// Cache that the block belongs to
+		Cache *cache = nullptr;
 
 		// Way identifier
 		unsigned way_id = 0;
 
-		// Block state
-		BlockState state = BlockInvalid;
+		// Whether the block was brought by a prefetch and has not been
+		// accessed by a demand access since then
+		bool prefetched = false;
 
-		// The block belongs to an LRU list
-		misc::List<Block>::Node lru_node;
-	
-	public:
+		// Whether the block was accessed again since it was inserted,
+		// used by SHiP to train the signature history counters
+		bool reused = false;
 
-		/// Constructor
-		Block() : lru_node(this)
-		{
-		}
+		// Replacement state. For LRU and FIFO, position of the block in
+		// the recency or insertion order of its set, where 0 is the most
+		// recent. For RRIP-based policies, re-reference prediction value.
+		unsigned short age = 0;
+
+		// SHiP signature of the instruction that inserted the block
+		unsigned short signature = 0;
+
+		// Return the position of the block in the packed arrays
+		unsigned getIndex() const { return this - cache->blocks.get(); }
+
+	public:
 
 		/// Get the block tag
-		unsigned getTag() const { return tag; }
+		unsigned getTag() const { return cache->tags[getIndex()]; }
 
 		/// Get the way index of this block
 		unsigned getWayId() const { return way_id; }
 
 		/// Get the transient trag set in this block
-		unsigned getTransientTag() const { return transient_tag; }
+		unsigned getTransientTag() const
+		{
+			return cache->transient_tags[getIndex()];
+		}
 
 		/// Get the block state
-		BlockState getState() const { return state; }
+		BlockState getState() const
+		{
+			return (BlockState) cache->states[getIndex()];
+		}
+
+		/// Return whether the block was brought by a prefetch and has
+		/// not been used by a demand access yet.
+		bool isPrefetched() const { return prefetched; }
+
+		/// Set or clear the flag indicating that the block was brought
+		/// by a prefetch and has not been used yet.
+		void setPrefetched(bool prefetched) { this->prefetched = prefetched; }
 
 		/// Set new state and tag
 		void setStateTag(BlockState state, unsigned tag)
 		{
-			this->state = state;
-			this->tag = tag;
+			unsigned index = getIndex();
+			cache->states[index] = state;
+			cache->tags[index] = tag;
 		}
 	};
 
@@ -128,13 +185,24 @@ private:
 		// Only Cache needs to initialize fields
 		friend class Cache;
 
-		// List of blocks in LRU order
-		misc::List<Block> lru_list;
+		// Bits of the binary tree used by PLRU, with the root at
+		// position 1, and the children of node i at positions 2i and
+		// 2i + 1. Each bit points to the half of the subtree that
+		// should be replaced next, 0 for the left half.
+		std::vector<bool> plru_bits;
 
 		// Position in Cache::blocks where the blocks start for this set
 		Block *blocks;
 	};
 
+	// Role of a set under the DRRIP set-dueling mechanism
+	enum DuelingRole
+	{
+		DuelingFollower,
+		DuelingLeaderSRRIP,
+		DuelingLeaderBRRIP
+	};
+
 	// Name of the cache, used for debugging purposes
 	std::string name;
 
@@ -164,13 +232,61 @@ private:
 	// Array of blocks
 	std::unique_ptr<Block[]> blocks;
 
-	/// Return a pointer to a cache set
+	// Packed tags, transient tags, and states of all blocks, indexed by
+	// set * num_ways + way
+	std::unique_ptr<unsigned[]> tags;
+	std::unique_ptr<unsigned[]> transient_tags;
+	std::unique_ptr<unsigned char[]> states;
+
+	// Counter of insertions under BRRIP, used to insert one out of
+	// 'brrip_throttle' blocks with a long re-reference interval
+	int brrip_counter = 0;
+
+	// DRRIP policy selection counter. It is incremented on misses in the
+	// SRRIP leader sets, and decremented on misses in the BRRIP leader
+	// sets. Follower sets use BRRIP when the most significant bit is set.
+	int psel = 0;
+
+	// SHiP signature history counter table, indexed by signature
+	std::vector<unsigned char> shct;
+
+	// Return a pointer to a cache set
 	Set *getSet(unsigned set_id)
 	{
 		assert(misc::inRange(set_id, 0, num_sets - 1));
 		return &sets[set_id];
 	}
 
+	// Return whether the replacement policy is based on re-reference
+	// interval prediction
+	bool isRRIP() const
+	{
+		return replacement_policy == ReplacementSRRIP ||
+				replacement_policy == ReplacementBRRIP ||
+				replacement_policy == ReplacementDRRIP ||
+				replacement_policy == ReplacementSHiP;
+	}
+
+	// Return the role of a set in the DRRIP set dueling
+	DuelingRole getDuelingRole(unsigned set_id) const;
+
+	// Return the SHiP signature for an instruction address
+	static unsigned getSignature(unsigned pc)
+	{
+		return (pc ^ (pc >> ship_signature_bits)) &
+				((1 << ship_signature_bits) - 1);
+	}
+
+	// Make a block the most recently used in the LRU order, or the most
+	// recently inserted in the FIFO order of its set
+	void MoveToHead(unsigned set_id, Block *block);
+
+	// Update the PLRU tree of a set to point away from a block
+	void UpdatePLRU(Set *set, unsigned way_id);
+
+	// Return the RRPV of a block inserted in a set
+	int getInsertionRRPV(unsigned set_id, Block *block);
+
 public:
 
 	/// Constructor
@@ -272,11 +388,33 @@ public:
 			unsigned &tag,
 			BlockState &state) const;
 
-	/// Mark a block as last accessed as per the LRU policy. This function
-	/// internally updates the linked list that keeps track of the LRU order
-	/// of the blocks in a set.
+	/// Record an access to a block present in the cache, updating the
+	/// replacement state of its set as per the replacement policy.
+	///
+	/// \param set_id
+	///	Set of the block.
+	///
+	/// \param way_id
+	///	Way of the block.
+	///
 	void AccessBlock(unsigned set_id, unsigned way_id);
 
+	/// Record that a new block is being inserted in a way previously
+	/// returned by ReplaceBlock(), updating the replacement state of the
+	/// set. The block must still contain the tag and state of the block
+	/// being evicted, if any.
+	///
+	/// \param set_id
+	///	Set of the block.
+	///
+	/// \param way_id
+	///	Way of the block.
+	///
+	/// \param pc
+	///	Address of the instruction causing the miss, or 0 if unknown.
+	///
+	void InsertBlock(unsigned set_id, unsigned way_id, unsigned pc = 0);
+
 	/// Return the way index of the block to be replaced in the given set,
 	/// as per the current block replacement policy.
 	unsigned ReplaceBlock(unsigned set_id);
@@ -284,10 +422,40 @@ public:
 	/// Set the transient tag of a block.
 	void setTransientTag(unsigned set_id, unsigned way_id, unsigned tag)
 	{
-		Block *block = getBlock(set_id, way_id);
-		block->transient_tag = tag;
+		assert(misc::inRange(set_id, 0, num_sets - 1));
+		assert(misc::inRange(way_id, 0, num_ways - 1));
+		transient_tags[set_id * num_ways + way_id] = tag;
 	}
 
+	/// Compare a tag against the blocks of a set, up to \c max_match_ways
+	/// ways at a time.
+	///
+	/// \param set_id
+	///	Set to search.
+	///
+	/// \param first_way
+	///	First way to compare. Ways \a first_way up to \a first_way +
+	///	\c max_match_ways - 1 are compared, or up to the last way in
+	///	the set.
+	///
+	/// \param tag
+	///	Tag to search for.
+	///
+	/// \param transient_mask
+	///	Return here a bit mask of the compared ways whose transient tag
+	///	is equal to \a tag, where bit i corresponds to way \a first_way
+	///	+ i.
+	///
+	/// \return
+	///	Bit mask of the compared ways holding tag \a tag in a state
+	///	other than invalid, where bit i corresponds to way \a first_way
+	///	+ i.
+	///
+	unsigned MatchTags(unsigned set_id,
+			unsigned first_way,
+			unsigned tag,
+			unsigned &transient_mask) const;
+
 
 
 	//
@@ -318,6 +486,19 @@ public:
 
 	/// Return the log2 of the block size
 	int getLogBlockSize() const { return log_block_size; }
+
+	/// Return the replacement state of a block. For LRU and FIFO, this is
+	/// the position of the block in the order of its set, where 0 is the
+	/// most recent. For RRIP-based policies, this is the re-reference
+	/// prediction value of the block.
+	unsigned getBlockAge(unsigned set_id, unsigned way_id) const
+	{
+		return getBlock(set_id, way_id)->age;
+	}
+
+	/// Return whether the DRRIP policy is currently using BRRIP for the
+	/// follower sets
+	bool isBRRIPSelected() const { return psel >= 1 << (psel_bits - 1); }
 };
 
 
@@ -30,6 +30,17 @@ namespace mem
 
 const int Directory::NoOwner;
 
+const Directory::Entry Directory::empty_entry;
+
+
+Directory::Set::Set(int num_ways, int num_sub_blocks, int num_nodes)
+		:
+		sharers(num_ways * num_sub_blocks * num_nodes)
+{
+	entries = misc::new_unique_array<Entry>(num_ways * num_sub_blocks);
+	locks = misc::new_unique_array<Lock>(num_ways);
+}
+
 
 Directory::Directory(const std::string &name,
 		int num_sets,
@@ -41,15 +52,23 @@ Directory::Directory(const std::string &name,
 		num_sets(num_sets),
 		num_ways(num_ways),
 		num_sub_blocks(num_sub_blocks),
-		num_nodes(num_nodes),
-		sharers(num_sets * num_ways * num_sub_blocks * num_nodes)
+		num_nodes(num_nodes)
 {
-	// Initialize entries
-	entries = misc::new_unique_array<Entry>(num_sets
-			* num_ways * num_sub_blocks);
+	// Sets are allocated on demand
+	sets = misc::new_unique_array<std::unique_ptr<Set>>(num_sets);
+}
+
 
-	// Initialize locks
-	locks = misc::new_unique_array<Lock>(num_sets * num_ways);
+Directory::Set *Directory::getOrAllocateSet(int set_id)
+{
+	assert(misc::inRange(set_id, 0, num_sets - 1));
+	std::unique_ptr<Set> &set = sets[set_id];
+	if (!set)
+	{
+		set.reset(new Set(num_ways, num_sub_blocks, num_nodes));
+		num_allocated_sets++;
+	}
+	return set.get();
 }
 	
 
@@ -57,8 +76,8 @@ void Directory::setOwner(int set_id, int way_id, int sub_block_id, int owner)
 {
 	// Set owner
 	assert(owner == NoOwner || misc::inRange(owner, 0, num_nodes - 1));
-	Entry *entry = getEntry(set_id, way_id, sub_block_id);
-	entry->setOwner(owner);
+	Entry *entry = getEntryForUpdate(set_id, way_id, sub_block_id);
+	entry->owner = owner;
 
 	// Trace
 	System::trace << misc::fmt("mem.set_owner dir=\"%s\" "
@@ -89,20 +108,18 @@ void Directory::setSharer(int set_id, int way_id, int sub_block_id, int node_id)
 	assert(misc::inRange(node_id, 0, num_nodes - 1));
 
 	// Get position in bitmap
-	int bit_id = set_id * num_ways * num_sub_blocks * num_nodes +
-			way_id * num_sub_blocks * num_nodes +
-			sub_block_id * num_nodes +
-			node_id;
+	Set *set = getOrAllocateSet(set_id);
+	int bit_id = getSharerIndex(way_id, sub_block_id, node_id);
 	
 	// Check if already set
-	if (sharers[bit_id])
+	if (set->sharers[bit_id])
 		return;
 	
 	// Set sharer
-	Entry *entry = getEntry(set_id, way_id, sub_block_id);
-	assert(entry->getNumSharers() < num_nodes);
-	entry->incNumSharers();
-	sharers.Set(bit_id);
+	Entry *entry = getEntryForUpdate(set_id, way_id, sub_block_id);
+	assert(entry->num_sharers < num_nodes);
+	entry->num_sharers++;
+	set->sharers.Set(bit_id);
 	
 	// Trace
 	System::trace << misc::fmt("mem.set_sharer dir=\"%s\" "
@@ -131,21 +148,23 @@ void Directory::clearSharer(int set_id, int way_id, int sub_block_id, int node_i
 	assert(misc::inRange(sub_block_id, 0, num_sub_blocks - 1));
 	assert(misc::inRange(node_id, 0, num_nodes - 1));
 
+	// Nothing to clear if the set was never modified
+	Set *set = getSet(set_id);
+	if (!set)
+		return;
+
 	// Get position in bitmap
-	int bit_id = set_id * num_ways * num_sub_blocks * num_nodes +
-			way_id * num_sub_blocks * num_nodes +
-			sub_block_id * num_nodes +
-			node_id;
+	int bit_id = getSharerIndex(way_id, sub_block_id, node_id);
 	
 	// Check if already clear
-	if (!sharers[bit_id])
+	if (!set->sharers[bit_id])
 		return;
 	
 	// Clear sharer
-	Entry *entry = getEntry(set_id, way_id, sub_block_id);
-	assert(entry->getNumSharers() > 0);
-	entry->decNumSharers();
-	sharers.Set(bit_id, false);
+	Entry *entry = getEntryForUpdate(set_id, way_id, sub_block_id);
+	assert(entry->num_sharers > 0);
+	entry->num_sharers--;
+	set->sharers.Set(bit_id, false);
 	
 	// Trace
 	System::trace << misc::fmt("mem.clear_sharer dir=\"%s\" "
@@ -170,19 +189,18 @@ void Directory::clearSharer(int set_id, int way_id, int sub_block_id, int node_i
 void Directory::clearAllSharers(int set_id, int way_id, int sub_block_id)
 {
 	// Skip if no sharer is present
-	Entry *entry = getEntry(set_id, way_id, sub_block_id);
-	if (entry->getNumSharers() == 0)
+	if (getEntry(set_id, way_id, sub_block_id)->getNumSharers() == 0)
 		return;
 	
 	// Get position in bitmap
-	int bit_id = set_id * num_ways * num_sub_blocks * num_nodes +
-			way_id * num_sub_blocks * num_nodes +
-			sub_block_id * num_nodes;
+	Set *set = getSet(set_id);
+	int bit_id = getSharerIndex(way_id, sub_block_id, 0);
 	
 	// Clear all sharers
-	entry->setNumSharers(0);
+	Entry *entry = getEntryForUpdate(set_id, way_id, sub_block_id);
+	entry->num_sharers = 0;
 	for (int i = 0; i < num_nodes; i++)
-		sharers.Set(bit_id + i, false);
+		set->sharers.Set(bit_id + i, false);
 	
 	// Trace
 	System::trace << misc::fmt("mem.clear_all_sharers dir=\"%s\" "
@@ -210,14 +228,13 @@ bool Directory::isSharer(int set_id, int way_id, int sub_block_id, int node_id)
 	assert(misc::inRange(sub_block_id, 0, num_sub_blocks - 1));
 	assert(misc::inRange(node_id, 0, num_nodes - 1));
 
-	// Get position in bitmap
-	int bit_id = set_id * num_ways * num_sub_blocks * num_nodes +
-			way_id * num_sub_blocks * num_nodes +
-			sub_block_id * num_nodes +
-			node_id;
-	
+	// Sets that were never modified have no sharers
+	Set *set = getSet(set_id);
+	if (!set)
+		return false;
+
 	// Return whether sharer is present
-	return sharers[bit_id];
+	return set->sharers[getSharerIndex(way_id, sub_block_id, node_id)];
 }
 
 
@@ -226,7 +243,7 @@ bool Directory::isBlockSharedOrOwned(int set_id, int way_id)
 	// Look for an owner or sharer
 	for (int sub_block_id = 0; sub_block_id < num_sub_blocks; sub_block_id++)
 	{
-		Entry *entry = getEntry(set_id, way_id, sub_block_id);
+		const Entry *entry = getEntry(set_id, way_id, sub_block_id);
 		if (entry->getNumSharers() > 0 || entry->getOwner() != NoOwner)
 			return true;
 	}
@@ -239,7 +256,7 @@ bool Directory::isBlockSharedOrOwned(int set_id, int way_id)
 void Directory::DumpSharers(int set_id, int way_id, int sub_block_id,
 		std::ostream &os)
 {
-	Entry *entry = getEntry(set_id, way_id, sub_block_id);
+	const Entry *entry = getEntry(set_id, way_id, sub_block_id);
 	os << misc::fmt("  %d sharers: { ", entry->getNumSharers());
 	for (int i = 0; i < num_nodes; i++)
 		if (isSharer(set_id, way_id, sub_block_id, i))
@@ -256,9 +273,8 @@ bool Directory::LockEntry(
 {
 	// Get lock
 	assert(access_id > 0);
-	assert(misc::inRange(set_id, 0, num_sets - 1));
 	assert(misc::inRange(way_id, 0, num_ways - 1));
-	Lock *lock = &locks[set_id * num_ways + way_id];
+	Lock *lock = &getOrAllocateSet(set_id)->locks[way_id];
 
 	// If the entry is already locked, enqueue a new waiter and return
 	// failure to lock.
@@ -300,10 +316,11 @@ bool Directory::LockEntry(
 
 void Directory::UnlockEntry(int set_id, int way_id, long long access_id)
 {
-	// Get lock
-	assert(misc::inRange(set_id, 0, num_sets - 1));
+	// Get lock. The set was allocated when the entry was locked.
 	assert(misc::inRange(way_id, 0, num_ways - 1));
-	Lock *lock = &locks[set_id * num_ways + way_id];
+	Set *set = getSet(set_id);
+	assert(set);
+	Lock *lock = &set->locks[way_id];
 	assert(lock->access_id > 0);
 	assert(access_id == lock->access_id);
 
@@ -363,13 +380,14 @@ void Directory::UnlockEntry(int set_id, int way_id, long long access_id)
 
 long long Directory::getEntryAccessId(int set_id, int way_id) const
 {
-	// Get lock
-	assert(misc::inRange(set_id, 0, num_sets - 1));
+	// Entries in sets that were never allocated are not locked
 	assert(misc::inRange(way_id, 0, num_ways - 1));
-	Lock *lock = &locks[set_id * num_ways + way_id];
+	Set *set = getSet(set_id);
+	if (!set)
+		return 0;
 
 	// Return frame locking entry
-	return lock->access_id;
+	return set->locks[way_id].access_id;
 }
 
 
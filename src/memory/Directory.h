@@ -21,6 +21,7 @@
 #define MEMORY_DIRECTORY_H
 
 #include <cassert>
+#include <memory>
 
 #include <lib/cpp/Bitmap.h>
 #include <lib/cpp/Misc.h>
@@ -33,7 +34,9 @@ namespace mem
 // Forward declarations
 class Frame;
 
-/// A cache directory in the memory system
+/// A cache directory in the memory system. The state of each directory set
+/// is allocated the first time one of its entries is modified or locked, so
+/// that large directories only take host memory for the sets in use.
 class Directory
 {
 public:
@@ -44,6 +47,9 @@ public:
 	/// Directory entry
 	class Entry
 	{
+		// Only Directory can modify entries
+		friend class Directory;
+
 		// Owner identifier
 		int owner = NoOwner;
 
@@ -57,21 +63,6 @@ public:
 
 		/// Return number of sharers
 		int getNumSharers() const { return num_sharers; }
-
-		/// Set new owner
-		void setOwner(int owner) { this->owner = owner; }
-
-		/// Increment the number of sharers
-		void incNumSharers() { num_sharers++; }
-
-		/// Decrement the number of sharers
-		void decNumSharers() { num_sharers--; }
-
-		/// Set the number of sharers
-		void setNumSharers(int num_sharers)
-		{
-			this->num_sharers = num_sharers;
-		}
 	};
 
 private:
@@ -87,6 +78,25 @@ private:
 		esim::Queue queue;
 	};
 
+	// State of a directory set
+	struct Set
+	{
+		// Entries, indexed by way * num_sub_blocks + sub_block
+		std::unique_ptr<Entry[]> entries;
+
+		// Entry locks, indexed by way
+		std::unique_ptr<Lock[]> locks;
+
+		// Bitmap of sharers, with 'num_nodes' bits per entry
+		misc::Bitmap sharers;
+
+		// Constructor
+		Set(int num_ways, int num_sub_blocks, int num_nodes);
+	};
+
+	// Entry returned for sets that were not allocated yet
+	static const Entry empty_entry;
+
 	// Name of directory
 	std::string name;
 
@@ -96,14 +106,37 @@ private:
 	int num_sub_blocks;
 	int num_nodes;
 
-	// Bitmap of sharers for the entire directory
-	misc::Bitmap sharers;
+	// Directory sets, allocated on demand
+	std::unique_ptr<std::unique_ptr<Set>[]> sets;
+
+	// Number of sets allocated so far
+	int num_allocated_sets = 0;
 
-	// Directory entries
-	std::unique_ptr<Entry[]> entries;
+	// Return a directory set, or null if it was not allocated yet
+	Set *getSet(int set_id) const
+	{
+		assert(misc::inRange(set_id, 0, num_sets - 1));
+		return sets[set_id].get();
+	}
 
-	// Directory locks
-	std::unique_ptr<Lock[]> locks;
+	// Return a directory set, allocating it if needed
+	Set *getOrAllocateSet(int set_id);
+
+	// Return a modifiable directory entry, allocating its set if needed
+	Entry *getEntryForUpdate(int set_id, int way_id, int sub_block_id)
+	{
+		assert(misc::inRange(way_id, 0, num_ways - 1));
+		assert(misc::inRange(sub_block_id, 0, num_sub_blocks - 1));
+		Set *set = getOrAllocateSet(set_id);
+		return &set->entries[way_id * num_sub_blocks + sub_block_id];
+	}
+
+	// Return the position of a sharer in the bitmap of a set
+	int getSharerIndex(int way_id, int sub_block_id, int node_id) const
+	{
+		return (way_id * num_sub_blocks + sub_block_id) * num_nodes +
+				node_id;
+	}
 
 public:
 
@@ -142,15 +175,19 @@ public:
 	/// Return the number of nodes that can be sharers of each sub-block
 	int getNumNodes() { return num_nodes; }
 
-	/// Return a directory entry
-	Entry *getEntry(int set_id, int way_id, int sub_block_id)
+	/// Return the number of sets whose state has been allocated
+	int getNumAllocatedSets() const { return num_allocated_sets; }
+
+	/// Return a directory entry. Entries in sets that were never modified
+	/// have no owner and no sharers.
+	const Entry *getEntry(int set_id, int way_id, int sub_block_id) const
 	{
-		assert(misc::inRange(set_id, 0, num_sets - 1));
 		assert(misc::inRange(way_id, 0, num_ways - 1));
 		assert(misc::inRange(sub_block_id, 0, num_sub_blocks - 1));
-		return &entries.get()[set_id * num_ways * num_sub_blocks +
-				way_id * num_sub_blocks +
-				sub_block_id];
+		Set *set = getSet(set_id);
+		if (!set)
+			return &empty_entry;
+		return &set->entries[way_id * num_sub_blocks + sub_block_id];
 	}
 
 	/// Set new owner for the directory entry
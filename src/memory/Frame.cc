@@ -40,6 +40,13 @@ Frame::Frame(long long id, Module *module, unsigned address) :
 	assert(module);
 	accesses_iterator = module->getAccessListEnd();
 	write_accesses_iterator = module->getWriteAccessListEnd();
+
+	// Inherit the source module from the memory frame of the current
+	// event handler, or make this module the source for new accesses.
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	Frame *parent_frame = dynamic_cast<Frame *>(
+			esim_engine->getCurrentFrame().get());
+	source_module = parent_frame ? parent_frame->source_module : module;
 }
 
 
@@ -114,6 +114,16 @@ public:
 	/// Type of memory access
 	Module::AccessType access_type = Module::AccessInvalid;
 
+	/// Module where the access originated, typically an L1 cache entry to
+	/// the memory hierarchy. Initialized in the constructor, inherited from
+	/// the frame of the event handler creating this frame, if any. Used to
+	/// tag the requests sent to the DRAM controllers.
+	Module *source_module;
+
+	/// Address of the instruction that originated the access, or 0 if
+	/// unknown. Used to train the prefetchers.
+	unsigned pc = 0;
+
 	/// If true, this access has been coalesced with another access.
 	bool coalesced = false;
 
@@ -153,6 +163,9 @@ public:
 	/// Flag indicating whether this access is a non-coherent write.
 	bool nc_write = false;
 
+	/// Flag indicating whether this access is a prefetch.
+	bool prefetch = false;
+
 	/// Flag indicating whether there is a block eviction in the current
 	/// access.
 	bool eviction = false;
@@ -166,6 +179,14 @@ public:
 	/// Flag indicating whether there was a hit in the cache
 	bool hit = false;
 
+	/// Flag indicating whether a demand access hit on a block brought by a
+	/// prefetch that had not been used yet.
+	bool prefetch_hit = false;
+
+	/// Flag indicating whether a demand access found this prefetch still
+	/// in flight.
+	bool late_prefetch = false;
+
 	/// Flag activated when a block was not found in a find-and-lock
 	/// event for a down-up request.
 	bool block_not_found = false;
@@ -34,63 +34,127 @@ namespace mem
 const unsigned Memory::LogPageSize;
 const unsigned Memory::PageSize;
 const unsigned Memory::PageMask;
+const unsigned Memory::LogPageTableSize;
+const unsigned Memory::PageTableSize;
+const unsigned Memory::LogPageDirectorySize;
+const unsigned Memory::PageDirectorySize;
+const unsigned Memory::TlbSize;
 
 bool Memory::safe_mode = true;
 
 
-Memory::Page *Memory::getPage(unsigned address)
+Memory::Page *Memory::LookupPage(unsigned tag)
 {
-	unsigned tag = address & ~(PageSize - 1);
-	auto it = pages.find(tag);
-	return it == pages.end() ? nullptr : it->second.get();
+	// Walk page directory
+	unsigned page_number = tag >> LogPageSize;
+	PageTable *page_table = page_directory[page_number >>
+			LogPageTableSize].get();
+	if (!page_table)
+		return nullptr;
+	Page *page = page_table->pages[page_number &
+			(PageTableSize - 1)].get();
+	if (!page)
+		return nullptr;
+
+	// Insert in TLB
+	TlbEntry &entry = tlb[page_number & (TlbSize - 1)];
+	entry.tag = tag;
+	entry.page = page;
+	return page;
+}
+
+
+Memory::Page *Memory::FindPage(unsigned tag) const
+{
+	// Scan page tables starting at the one containing the tag, skipping
+	// empty regions of the address space.
+	unsigned page_number = tag >> LogPageSize;
+	unsigned index = page_number & (PageTableSize - 1);
+	for (unsigned dir_index = page_number >> LogPageTableSize;
+			dir_index < PageDirectorySize; dir_index++)
+	{
+		PageTable *page_table = page_directory[dir_index].get();
+		for (; page_table && index < PageTableSize; index++)
+			if (page_table->pages[index])
+				return page_table->pages[index].get();
+		index = 0;
+	}
+
+	// No page found
+	return nullptr;
+}
+
+
+void Memory::FreePage(unsigned tag)
+{
+	// Find page table
+	unsigned page_number = tag >> LogPageSize;
+	auto &page_table = page_directory[page_number >> LogPageTableSize];
+	if (!page_table)
+		return;
+
+	// Find page
+	auto &page = page_table->pages[page_number & (PageTableSize - 1)];
+	if (!page)
+		return;
+
+	// Invalidate TLB entry
+	TlbEntry &entry = tlb[page_number & (TlbSize - 1)];
+	if (entry.page == page.get())
+		entry.page = nullptr;
+
+	// Free page, and page table if it became empty
+	page.reset();
+	num_pages--;
+	if (!--page_table->num_pages)
+		page_table.reset();
+}
+
+
+void Memory::Clear()
+{
+	// Free all page tables
+	for (auto &page_table : page_directory)
+		page_table.reset();
+	num_pages = 0;
+
+	// Invalidate TLB
+	for (auto &entry : tlb)
+		entry.page = nullptr;
 }
 
 
-Memory::Page *Memory::getNextPage(unsigned address)
+Memory::Page *Memory::getNextPage(unsigned address) const
 {
 	// Get tag of the page just following address
 	unsigned tag = (address + PageSize) & ~(PageSize - 1);
 	if (!tag)
 		return nullptr;
 
-	// Look for a page exactly following the given address. If it is found,
-	// return it.
-	auto it = pages.find(tag);
-	if (it != pages.end())
-		return it->second.get();
-	
-	// Page following address is not found, so check all memory pages to
-	// find the one with the lowest tag following address.
-	unsigned min_tag = 0xffffffff;
-	Page *min_page = nullptr;
-	for (auto &pair : pages)
-	{
-		Page *page = pair.second.get();
-		if (page->getTag() > tag && page->getTag() < min_tag)
-		{
-			min_tag = page->getTag();
-			min_page = page;
-		}
-	}
-
-	// Return the found page (or nullptr)
-	return min_page;
+	// Return the page with the lowest tag following address
+	return FindPage(tag);
 }
 
 Memory::Page *Memory::newPage(unsigned address, unsigned perm)
 {
-	// Allocate new page
+	// Find page table, or create it
 	unsigned tag = address & ~(PageSize - 1);
-	auto ret = pages.emplace(tag, misc::new_unique<Page>(tag, perm));
-
-	// Check tag page was inserted successfully
-	bool success = ret.second;
-	if (!success)
+	unsigned page_number = tag >> LogPageSize;
+	auto &page_table = page_directory[page_number >> LogPageTableSize];
+	if (!page_table)
+		page_table = misc::new_unique<PageTable>();
+
+	// Check that page does not exist
+	auto &entry = page_table->pages[page_number & (PageTableSize - 1)];
+	if (entry)
 		throw misc::Panic("Memory page already exists");
 
-	// Obtain inserted page
-	auto it = ret.first;
-	Page *page = it->second.get();
+	// Allocate new page
+	entry = misc::new_unique<Page>(tag, perm);
+	page_table->num_pages++;
+	num_pages++;
+	Page *page = entry.get();
+	UpdatePageVersion(page);
 
 	// Return it
 	return page;
@@ -117,16 +181,20 @@ void Memory::Copy(unsigned dest, unsigned src, unsigned size)
 		
 		// Different actions depending on whether source and
 		// destination page data are allocated.
-		if (page_src->getData())
+		UpdateExecPageVersion(page_dest);
+		if (page_src->getReadData())
 		{
 			page_dest->AllocateData();
-			memcpy(page_dest->getData(), page_src->getData(),
+			memcpy(page_dest->getData(), page_src->getReadData(),
 					PageSize);
 		}
 		else
 		{
-			if (page_dest->getData())
+			if (page_dest->getReadData())
+			{
+				page_dest->AllocateData();
 				memset(page_dest->getData(), 0, PageSize);
+			}
 		}
 
 		// Advance pointers
@@ -152,6 +220,15 @@ char *Memory::getBuffer(unsigned address, unsigned size, AccessType access)
 	// Check page permissions
 	if ((page->getPerm() & access) != access && safe)
 		throw Error(misc::fmt("[0x%x] Permission denied", address));
+
+	// Reads and instruction fetches use the host memory backing the
+	// page, since the caller does not modify the content.
+	if (!(access & (AccessWrite | AccessInit)) && page->getReadData())
+		return const_cast<char *>(page->getReadData()) + offset;
+
+	// The caller may modify the content through the returned pointer
+	if (access & (AccessWrite | AccessInit))
+		UpdateExecPageVersion(page);
 	
 	// Return pointer to page data
 	page->AllocateData();
@@ -200,8 +277,8 @@ void Memory::AccessAtPageBoundary(unsigned address, unsigned size,
 	// Read/execute access
 	if (access == AccessRead || access == AccessExec)
 	{
-		if (page->getData())
-			memcpy(buffer, page->getData() + offset, size);
+		if (page->getReadData())
+			memcpy(buffer, page->getReadData() + offset, size);
 		else
 			memset(buffer, 0, size);
 		return;
@@ -210,6 +287,7 @@ void Memory::AccessAtPageBoundary(unsigned address, unsigned size,
 	// Write/initialize access
 	if (access == AccessWrite || access == AccessInit)
 	{
+		UpdateExecPageVersion(page);
 		page->AllocateData();
 		memcpy(page->getData() + offset, buffer, size);
 		return;
@@ -248,19 +326,19 @@ Memory::Memory(const Memory &memory)
 {
 	// Copy pages
 	safe = false;
-	for (auto &it : memory.pages)
+	for (Page *src_page = memory.FindPage(0); src_page;
+			src_page = memory.getNextPage(src_page->getTag()))
 	{
-		// Get source page
-		Page *src_page = it.second.get();
-
 		// Create destination page with same permissions
-		newPage(src_page->getTag(), src_page->getPerm());
+		Page *page = newPage(src_page->getTag(), src_page->getPerm());
 
-		// Copy data if any
+		// Copy data if any, or share the same host memory
 		if (src_page->getData())
 			Access(src_page->getTag(), PageSize,
 					src_page->getData(),
 					AccessInit);
+		else if (src_page->getSharedData())
+			page->setSharedData(src_page->getSharedData());
 	}
 
 	// Copy other fields
@@ -349,7 +427,34 @@ void Memory::Map(unsigned address, unsigned size, unsigned perm)
 		Page *page = getPage(tag);
 		if (!page)
 			page = newPage(tag, perm);
-		page->addPerm(perm);
+		if ((page->getPerm() | perm) != page->getPerm())
+		{
+			page->addPerm(perm);
+			UpdatePageVersion(page);
+		}
+	}
+}
+
+
+void Memory::MapShared(unsigned address, unsigned size, unsigned perm,
+		const std::shared_ptr<const char> &data)
+{
+	// Map pages, which must not exist yet
+	assert(!(address & (PageSize - 1)));
+	unsigned tag1 = address;
+	unsigned tag2 = (address + size - 1) & ~(PageSize-1);
+	for (unsigned tag = tag1; tag <= tag2; tag += PageSize)
+		assert(!getPage(tag));
+	Map(address, size, perm);
+
+	// Back pages with host memory. The aliasing constructor of the shared
+	// pointer keeps the whole host region alive from each page.
+	for (unsigned tag = tag1; tag <= tag2; tag += PageSize)
+	{
+		Page *page = getPage(tag);
+		page->setSharedData(std::shared_ptr<const char>(data,
+				data.get() + (tag - address)));
+		UpdatePageVersion(page);
 	}
 }
 
@@ -364,7 +469,7 @@ void Memory::Unmap(unsigned address, unsigned size)
 
 	// Deallocate pages
 	for (unsigned tag = tag1; tag <= tag2; tag += PageSize)
-		pages.erase(tag);
+		FreePage(tag);
 }
 
 
@@ -385,6 +490,7 @@ void Memory::Protect(unsigned address, unsigned size, unsigned perm)
 
 		// Set page new protection flags
 		page->setPerm(perm);
+		UpdatePageVersion(page);
 	}
 }
 
@@ -481,19 +587,19 @@ void Memory::Clone(const Memory &memory)
 
 	// Copy pages
 	safe = false;
-	for (auto &it : memory.pages)
+	for (Page *src_page = memory.FindPage(0); src_page;
+			src_page = memory.getNextPage(src_page->getTag()))
 	{
-		// Get source page
-		Page *src_page = it.second.get();
-
 		// Create destination page with same permissions
-		newPage(src_page->getTag(), src_page->getPerm());
+		Page *page = newPage(src_page->getTag(), src_page->getPerm());
 
-		// Copy data if any
+		// Copy data if any, or share the same host memory
 		if (src_page->getData())
 			Access(src_page->getTag(), PageSize,
 					src_page->getData(),
 					AccessInit);
+		else if (src_page->getSharedData())
+			page->setSharedData(src_page->getSharedData());
 	}
 
 
@@ -503,5 +609,54 @@ void Memory::Clone(const Memory &memory)
 }
 
 
+void Memory::SaveCheckpoint(std::ostream &os) const
+{
+	// Heap break and number of pages
+	misc::WriteBinary(os, heap_break);
+	misc::WriteBinary(os, num_pages);
+
+	// Pages, in increasing order of their tags
+	for (Page *page = FindPage(0); page;
+			page = getNextPage(page->getTag()))
+	{
+		const char *data = page->getReadData();
+		misc::WriteBinary(os, page->getTag());
+		misc::WriteBinary(os, page->getPerm());
+		misc::WriteBinary(os, (bool) data);
+		if (data)
+			os.write(data, PageSize);
+	}
+}
+
+
+void Memory::LoadCheckpoint(std::istream &is)
+{
+	// Clear current content
+	Clear();
+
+	// Heap break and number of pages
+	unsigned count;
+	misc::ReadBinary(is, heap_break);
+	misc::ReadBinary(is, count);
+
+	// Pages
+	for (unsigned i = 0; i < count; i++)
+	{
+		unsigned tag;
+		unsigned perm;
+		bool has_data;
+		misc::ReadBinary(is, tag);
+		misc::ReadBinary(is, perm);
+		misc::ReadBinary(is, has_data);
+		Page *page = newPage(tag, perm);
+		if (has_data)
+		{
+			page->AllocateData();
+			misc::ReadBinary(is, page->getData(), PageSize);
+		}
+	}
+}
+
+
 } // namespace mem
 
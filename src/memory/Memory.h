@@ -21,9 +21,9 @@
 #define MEMORY_MEMORY_H
 
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <memory>
-#include <unordered_map>
 
 #include <lib/cpp/Error.h>
 #include <lib/cpp/Misc.h>
@@ -82,6 +82,15 @@ public:
 
 		// The page data
 		std::unique_ptr<char[]> data;
+
+		// Read-only host memory with the content of the page, used
+		// while the page data is not allocated. The pointer keeps the
+		// host memory alive for as long as the page uses it.
+		std::shared_ptr<const char> shared_data;
+
+		// Version of the page, taken from a counter in the memory
+		// object the page belongs to.
+		long long version = 0;
 	
 	public:
 
@@ -105,12 +114,45 @@ public:
 		/// was not allocated.
 		char *getData() { return data.get(); }
 
-		/// Allocate the page data. If the data buffer was allocated
-		/// before, this call is ignored.
+		/// Return the read-only host memory backing the page content,
+		/// or `nullptr` if the page is not backed by host memory.
+		const std::shared_ptr<const char> &getSharedData() const
+		{
+			return shared_data;
+		}
+
+		/// Return a pointer to the page content for reading. This is
+		/// the page data if allocated, or the host memory backing the
+		/// page otherwise. If the page has no content, the function
+		/// returns `nullptr`, and the page should be read as zeros.
+		const char *getReadData() const
+		{
+			return data ? data.get() : shared_data.get();
+		}
+
+		/// Back the page content with read-only host memory, pointing
+		/// to PageSize bytes. The page must not have data allocated,
+		/// nor be backed by host memory already.
+		void setSharedData(const std::shared_ptr<const char> &shared_data)
+		{
+			assert(data == nullptr);
+			assert(this->shared_data == nullptr);
+			this->shared_data = shared_data;
+		}
+
+		/// Allocate the page data. If the page is backed by host
+		/// memory, its content is copied into the new data buffer. If
+		/// the data buffer was allocated before, this call is ignored.
 		void AllocateData()
 		{
-			if (data == nullptr)
-				data = misc::new_unique_array<char>(PageSize);
+			if (data != nullptr)
+				return;
+			data = misc::new_unique_array<char>(PageSize);
+			if (shared_data)
+			{
+				memcpy(data.get(), shared_data.get(), PageSize);
+				shared_data.reset();
+			}
 		}
 
 		/// Set the page permissions, given as a bitmap of flags of
@@ -120,6 +162,18 @@ public:
 		/// Add a flag to the page permissions, given as a bitmap of
 		/// flags of type AccessType.
 		void addPerm(unsigned perm) { this->perm |= perm; }
+
+		/// Return the page version. A new version is assigned to the
+		/// page every time it is created, its permissions change, or
+		/// its content is modified while it has execution permission.
+		/// Clients caching information derived from executable code
+		/// (such as decoded instructions) can compare versions to
+		/// detect stale data. Versions are never reused within a
+		/// memory object, even after the page is unmapped.
+		long long getVersion() const { return version; }
+
+		/// Set the page version
+		void setVersion(long long version) { this->version = version; }
 	};
 
 private:
@@ -128,8 +182,56 @@ private:
 	// safe mode.
 	static bool safe_mode;
 
-	/// Hash table of memory pages, indexed by the page tag.
-	std::unordered_map<unsigned, std::unique_ptr<Page>> pages;
+	/// Log base 2 of the number of entries in a second-level page table
+	static const unsigned LogPageTableSize = 10;
+
+	/// Number of entries in a second-level page table
+	static const unsigned PageTableSize = 1u << LogPageTableSize;
+
+	/// Log base 2 of the number of entries in the page directory. The
+	/// directory and the page tables cover the 32-bit address space.
+	static const unsigned LogPageDirectorySize =
+			32 - LogPageSize - LogPageTableSize;
+
+	/// Number of entries in the page directory
+	static const unsigned PageDirectorySize = 1u << LogPageDirectorySize;
+
+	/// Number of entries in the software TLB
+	static const unsigned TlbSize = 64;
+
+	/// Second-level page table, covering a contiguous range of
+	/// PageTableSize pages. A page table is freed when its last page
+	/// is unmapped.
+	struct PageTable
+	{
+		// Pages, indexed by the intermediate bits of the page tag
+		std::unique_ptr<Page> pages[PageTableSize];
+
+		// Number of allocated pages
+		unsigned num_pages = 0;
+	};
+
+	/// Entry of the software TLB
+	struct TlbEntry
+	{
+		// Page tag
+		unsigned tag = 0;
+
+		// Page, or `nullptr` if the entry is empty
+		Page *page = nullptr;
+	};
+
+	/// Page directory, indexed by the most significant bits of the page
+	/// tag. Entries are `nullptr` for address ranges with no page.
+	std::unique_ptr<PageTable> page_directory[PageDirectorySize];
+
+	/// Direct-mapped cache of recently accessed pages, checked before
+	/// walking the page directory. Only existing pages are cached, so
+	/// entries need to be invalidated only when pages are freed.
+	TlbEntry tlb[TlbSize];
+
+	/// Number of allocated pages
+	unsigned num_pages = 0;
 
 	/// Safe mode
 	bool safe;
@@ -137,13 +239,40 @@ private:
 	/// Heap break for CPU contexts
 	unsigned heap_break = 0;
 
-	/// Last accessed address
+	/// Last address accessed with Access(). Accesses through getBuffer()
+	/// and instruction fetches served by the x86 decoded instruction cache
+	/// do not update it.
 	unsigned last_address = 0;
 
+	/// Counter used to assign page versions
+	long long version_counter = 0;
+
+	/// Assign a new version to a page
+	void UpdatePageVersion(Page *page) { page->setVersion(++version_counter); }
+
+	/// Assign a new version to a page only if it has execution permission.
+	/// This is called on every write to a page.
+	void UpdateExecPageVersion(Page *page)
+	{
+		if (page->getPerm() & AccessExec)
+			UpdatePageVersion(page);
+	}
+
 	/// Create a new page and add it to the page table. The value given in
 	/// \a perm is an *or*'ed bitmap of AccessType flags.
 	Page *newPage(unsigned address, unsigned perm);
 
+	/// Free the page with tag \a tag, if it exists
+	void FreePage(unsigned tag);
+
+	/// Look up a page in the page directory, bypassing the TLB, and
+	/// insert it in the TLB if found.
+	Page *LookupPage(unsigned tag);
+
+	/// Return the allocated page with the lowest tag equal or greater than
+	/// \a tag, or `nullptr` if there is none.
+	Page *FindPage(unsigned tag) const;
+
 	// Access memory without exceeding page boundaries
 	void AccessAtPageBoundary(unsigned address, unsigned size, char *buffer,
 			AccessType access);
@@ -169,16 +298,36 @@ public:
 	bool getSafe() const { return safe; }
 
 	/// Clear content of memory
-	void Clear() { pages.clear(); }
+	void Clear();
 
 	/// Return the memory page corresponding to an address, or `nullptr` if
 	/// there is currently no page allocated for that address.
-	Page *getPage(unsigned address);
+	Page *getPage(unsigned address)
+	{
+		unsigned tag = address & PageMask;
+		TlbEntry &entry = tlb[(tag >> LogPageSize) & (TlbSize - 1)];
+		if (entry.page && entry.tag == tag)
+			return entry.page;
+		return LookupPage(tag);
+	}
+
+	/// Return the number of allocated pages
+	unsigned getNumPages() const { return num_pages; }
+
+	/// Map the pages covering \a size bytes starting at page-aligned
+	/// address \a address, as done by Map(), and back their content with
+	/// the read-only host memory pointed to by \a data. The host memory
+	/// must hold the content of all pages in the range, and it is shared
+	/// by them until they are written for the first time, at which point
+	/// each written page gets a private copy. No page in the range can be
+	/// mapped already.
+	void MapShared(unsigned address, unsigned size, unsigned perm,
+			const std::shared_ptr<const char> &data);
 
 	/// Return the memory page following \a address in the current memory
 	/// map. This function is useful to reconstruct consecutive ranges of
 	/// mapped pages.
-	Page *getNextPage(unsigned address);
+	Page *getNextPage(unsigned address) const;
 
  	/// Allocate, if not already allocated, all necessary memory pages to
 	/// access \a size bytes after base address \a address. These fields
@@ -404,7 +553,10 @@ public:
 	///	Return a pointer to the memory content. If the requested exceeds
 	///	page boundaries, the function returns null. This function is
 	///	useful to read content from memory directly with zero-copy
-	///	operations.
+	///	operations. For an access without AccessWrite or AccessInit, the
+	///	returned pointer can refer to read-only host memory backing the
+	///	page (see MapShared()), and must not be written. Only the other
+	///	accesses give the page a private copy of its content.
 	///
 	/// \throw
 	///	This function will throw a Memory::Error if the memory is on
@@ -450,6 +602,17 @@ public:
 	/// Copy the content and attributes from another memory object
 	void Clone(const Memory &memory);
 
+	/// Save the memory pages, their permissions, and the heap break into
+	/// a binary checkpoint stream.
+	void SaveCheckpoint(std::ostream &os) const;
+
+	/// Replace the content of the memory with the pages saved in a
+	/// checkpoint stream with a previous call to SaveCheckpoint().
+	///
+	/// \throw
+	///	A misc::Error is thrown if the stream is truncated.
+	void LoadCheckpoint(std::istream &is);
+
 };
 
 
@@ -17,12 +17,18 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
 #include <climits>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
 
+#include <dram/Address.h>
+#include <dram/Controller.h>
+#include <dram/Request.h>
+
 #include "Frame.h"
+#include "Mmu.h"
 #include "Module.h"
 #include "System.h"
 
@@ -119,7 +125,7 @@ Module *Module::getOwner(int set_id, int way_id, int sub_block_id) const
 {
 	// Get directory entry
 	assert(directory.get());
-	Directory::Entry *entry = directory->getEntry(set_id,
+	const Directory::Entry *entry = directory->getEntry(set_id,
 			way_id,
 			sub_block_id);
 
@@ -162,14 +168,16 @@ bool Module::canAccess(int address) const
 long long Module::Access(AccessType access_type,
 		unsigned address,
 		int *witness,
-		esim::Event *return_event)
+		esim::Event *return_event,
+		unsigned pc)
 {
 	// Create a new event frame
-	auto frame = misc::new_shared<Frame>(
+	auto frame = esim::new_frame<Frame>(
 			Frame::getNewId(),
 			this,
 			address);
 	frame->witness = witness;
+	frame->pc = pc;
 
 	// Select initial event type
 	esim::Event *event;
@@ -197,6 +205,11 @@ long long Module::Access(AccessType access_type,
 			event = System::event_nc_store;
 			break;
 
+		case AccessPrefetch:
+
+			event = System::event_prefetch;
+			break;
+
 		default:
 
 			throw misc::Panic("Invalid access type");
@@ -238,10 +251,78 @@ long long Module::Access(AccessType access_type,
 }
 
 
+void Module::RecordLatePrefetch(Frame *frame)
+{
+	// Only prefetches not counted as late already
+	if (frame->access_type != AccessPrefetch || frame->late_prefetch)
+		return;
+
+	// Record
+	frame->late_prefetch = true;
+	num_late_prefetches++;
+}
+
+
+bool Module::canPrefetch() const
+{
+	// Prefetches can take at most half of the MSHR entries, leaving the
+	// rest for demand accesses.
+	if (mshr_size && num_in_flight_prefetches >= std::max(1, mshr_size / 2))
+		return false;
+
+	// There must be room for a regular access
+	return canAccess(0);
+}
+
+
+void Module::NotifyPrefetcher(unsigned pc,
+		unsigned address,
+		bool hit,
+		bool prefetch_hit)
+{
+	// Nothing if there is no prefetcher
+	if (!prefetcher)
+		return;
+
+	// Train prefetcher
+	prefetch_addresses.clear();
+	prefetcher->Access(pc, address, hit, prefetch_hit, prefetch_addresses);
+
+	// Issue prefetches
+	for (unsigned prefetch_address : prefetch_addresses)
+	{
+		// Discard blocks already present or in flight
+		int set;
+		int way;
+		int tag;
+		Cache::BlockState state;
+		if (FindBlock(prefetch_address, set, way, tag, state) ||
+				isInFlightAddress(prefetch_address))
+			continue;
+
+		// Drop prefetches crossing a page boundary, or for which
+		// there are no resources available.
+		num_prefetch_requests++;
+		if ((prefetch_address ^ address) & Mmu::PageMask ||
+				!ServesAddress(prefetch_address) ||
+				!canPrefetch())
+		{
+			num_dropped_prefetches++;
+			continue;
+		}
+
+		// Issue prefetch
+		Access(AccessPrefetch, prefetch_address & ~(block_size - 1));
+	}
+}
+
+
 void Module::StartAccess(Frame *frame, AccessType access_type)
 {
 	// Record access type
 	frame->access_type = access_type;
+	if (access_type == AccessPrefetch)
+		num_in_flight_prefetches++;
 
 	// Insert in access list
 	frame->accesses_iterator = accesses.insert(accesses.end(),
@@ -276,6 +357,13 @@ void Module::FinishAccess(Frame *frame)
 		frame->write_accesses_iterator = write_accesses.end();
 	}
 
+	// Update number of in-flight prefetches
+	if (frame->access_type == Module::AccessPrefetch)
+	{
+		assert(num_in_flight_prefetches > 0);
+		num_in_flight_prefetches--;
+	}
+
 	// Remove from hash table
 	unsigned block_address = frame->getAddress() >> log_block_size;
 	auto range = in_flight_block_addresses.equal_range(block_address);
@@ -786,6 +874,17 @@ void Module::DumpReport(std::ostream &os) const
 	os << misc::fmt("BlockSize = %d\n", block_size);
 	os << misc::fmt("DataLatency = %d\n", data_latency);
 	os << misc::fmt("Ports = %d\n", num_ports);
+	if (prefetcher)
+	{
+		os << "Prefetcher = " << Prefetcher::TypeMap.MapValue(
+				prefetcher->getType()) << "\n";
+		os << misc::fmt("PrefetchDegree = %d\n",
+				prefetcher->getDegree());
+		os << misc::fmt("PrefetchDistance = %d\n",
+				prefetcher->getDistance());
+		os << misc::fmt("PrefetchTableSize = %d\n",
+				prefetcher->getTableSize());
+	}
 	os << "\n";
 
 	// Statistics - Accesses
@@ -843,6 +942,43 @@ void Module::DumpReport(std::ostream &os) const
 			num_non_blocking_nc_writes);
 	os << "\n";
 
+	// Statistics - Prefetches. Accuracy is the fraction of prefetched
+	// blocks used by a demand access, and coverage is the fraction of
+	// demand misses avoided by prefetches.
+	if (prefetcher)
+	{
+		long long num_misses = num_accesses - num_hits;
+		os << misc::fmt("PrefetchRequests = %lld\n",
+				num_prefetch_requests);
+		os << misc::fmt("Prefetches = %lld\n", num_prefetches);
+		os << misc::fmt("DroppedPrefetches = %lld\n",
+				num_dropped_prefetches);
+		os << misc::fmt("UsefulPrefetches = %lld\n",
+				num_useful_prefetches);
+		os << misc::fmt("LatePrefetches = %lld\n",
+				num_late_prefetches);
+		os << misc::fmt("UselessPrefetches = %lld\n",
+				num_useless_prefetches);
+		os << misc::fmt("PrefetchAccuracy = %.4g\n", num_prefetches ?
+				(double) num_useful_prefetches / num_prefetches :
+				0.0);
+		os << misc::fmt("PrefetchCoverage = %.4g\n",
+				num_useful_prefetches + num_misses ?
+				(double) num_useful_prefetches /
+				(num_useful_prefetches + num_misses) : 0.0);
+		os << "\n";
+	}
+
+	// Statistics - DRAM
+	if (dram_controller)
+	{
+		os << misc::fmt("DramController = %s\n",
+				dram_controller->getName().c_str());
+		os << misc::fmt("DramReads = %lld\n", num_dram_reads);
+		os << misc::fmt("DramWrites = %lld\n", num_dram_writes);
+		os << "\n";
+	}
+
 	// Statistics - Conflicts
 	os << misc::fmt("DirectoryEntryConflicts = %lld\n", 
 			num_directory_entry_conflicts);
@@ -1142,23 +1278,31 @@ bool Module::FindBlock(unsigned address,
 		throw misc::Panic("Invalid range type");
 	}
 
-	// Find way in set
-	for (way = 0; way < (int) cache->getNumWays(); way++)
+	// Find way in set, comparing groups of ways at a time
+	int num_ways = cache->getNumWays();
+	for (int first_way = 0; first_way < num_ways;
+			first_way += Cache::max_match_ways)
 	{
-		// Get block
-		Cache::Block *block = cache->getBlock(set, way);
-		state = block->getState();
-
-		// Permanent tag available with state other than invalid
-		if (block->getTag() == (unsigned) tag && state)
-			return true;
-
-		// Transient tag available while directory entry is locked.
-		// This is considered a hit, regardless of the state of the
-		// block.
-		if (block->getTransientTag() == (unsigned) tag &&
-				directory->isEntryLocked(set, way))
-			return true;
+		// Ways with the permanent tag available with state other than
+		// invalid, or with the transient tag available
+		unsigned transient_mask;
+		unsigned mask = cache->MatchTags(set, first_way, tag,
+				transient_mask);
+
+		// Check candidates in way order. A transient tag is only a hit
+		// while the directory entry is locked, regardless of the state
+		// of the block.
+		for (unsigned bits = mask | transient_mask; bits;
+				bits &= bits - 1)
+		{
+			way = first_way + __builtin_ctz(bits);
+			if ((mask & (1u << (way - first_way))) ||
+					directory->isEntryLocked(set, way))
+			{
+				state = cache->getBlock(set, way)->getState();
+				return true;
+			}
+		}
 	}
 
 	// Miss
@@ -1174,7 +1318,7 @@ void Module::Flush(int *witness)
 	esim::Engine *esim_engine = esim::Engine::getInstance();
 
 	// Create a new event frame
-	auto new_frame = misc::new_shared<Frame>(
+	auto new_frame = esim::new_frame<Frame>(
 			Frame::getNewId(),
 			this,
 			0);
@@ -1227,7 +1371,7 @@ void Module::FlushCache()
 			esim::Engine *esim_engine = esim::Engine::getInstance();
 
 			// Create new frame
-			auto new_frame = misc::new_shared<Frame>(
+			auto new_frame = esim::new_frame<Frame>(
 					frame->getId(),
 					this,
 					frame->tag);
@@ -1251,6 +1395,10 @@ void Module::UpdateStats(Frame *frame)
 	// Assert that the frame module is in fact the module
 	assert(this == frame->getModule());
 
+	// Prefetches are not demand accesses, and have their own statistics
+	if (frame->prefetch)
+		return;
+
 	// Record access type. I purposefully chose to record both hits and
 	// misses separately here so that we can sanity check them against
 	// the total number of accesses.
@@ -1355,6 +1503,35 @@ void Module::UpdateStats(Frame *frame)
 }
 
 
+void Module::AccessData(esim::Event *event, unsigned address, bool write,
+		Module *source)
+{
+	// Fixed latency if the module is not backed by a DRAM controller
+	if (!dram_controller)
+	{
+		esim::Engine *esim_engine = esim::Engine::getInstance();
+		esim_engine->Next(event, data_latency);
+		return;
+	}
+
+	// Create DRAM request
+	auto request = std::make_shared<dram::Request>();
+	request->setType(write ? dram::RequestWrite : dram::RequestRead);
+	request->setEncodedAddress(address, dram_controller);
+	request->setSource(dram_controller->getSourceId(source->getName()));
+
+	// Suspend the event chain until the request completes
+	request->Wait(event);
+	dram_controller->AddRequest(request);
+
+	// Statistics
+	if (write)
+		num_dram_writes++;
+	else
+		num_dram_reads++;
+}
+
+
 int Module::getRetryLatency() const
 {
 	// To support a data latency of zero, we must ensure that at least
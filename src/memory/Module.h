@@ -32,9 +32,11 @@
 
 #include "Cache.h"
 #include "Directory.h"
+#include "Prefetcher.h"
 
 
 // Forward declarations
+namespace dram { class Controller; }
 namespace net { class Network; }
 namespace net { class Node; }
 
@@ -74,7 +76,8 @@ public:
 		AccessInvalid = 0,
 		AccessLoad,
 		AccessStore,
-		AccessNCStore
+		AccessNCStore,
+		AccessPrefetch
 	};
 
 	// Port in a memory module
@@ -109,6 +112,10 @@ private:
 	// Latency for data access in cycles
 	int data_latency = 1;
 
+	// DRAM controller serving the data accesses of a main memory module,
+	// or null if they take a fixed latency
+	dram::Controller *dram_controller = nullptr;
+
 	// Directory access latency
 	int directory_latency = 1;
 
@@ -251,6 +258,16 @@ private:
 	// List of next-level modules, closer to main memory
 	std::vector<Module *> low_modules;
 
+	// Hardware prefetcher, or nullptr if the module has none
+	std::unique_ptr<Prefetcher> prefetcher;
+
+	// Number of in-flight prefetches
+	int num_in_flight_prefetches = 0;
+
+	// Addresses produced by the prefetcher on the last access, kept as a
+	// member to avoid allocations on every access.
+	std::vector<unsigned> prefetch_addresses;
+
 	
 
 
@@ -268,6 +285,16 @@ private:
 
 	long long num_conflict_invalidations = 0;
 
+	long long num_prefetch_requests = 0;
+	long long num_prefetches = 0;
+	long long num_dropped_prefetches = 0;
+	long long num_useful_prefetches = 0;
+	long long num_late_prefetches = 0;
+	long long num_useless_prefetches = 0;
+
+	long long num_dram_reads = 0;
+	long long num_dram_writes = 0;
+
 public:
 	
 	// Statistics for up-down accesses
@@ -388,6 +415,9 @@ public:
 	/// Return block size
 	int getBlockSize() const { return block_size; }
 
+	/// Return the log base 2 of the block size
+	int getLogBlockSize() const { return log_block_size; }
+
 	/// Return the size of the smallest block in the higher modules (those
 	/// closer to the processor).
 	int getSubBlockSize() const { return sub_block_size; }
@@ -422,6 +452,29 @@ public:
 	/// Return data access latency
 	int getDataLatency() const { return data_latency; }
 
+	/// Connect a main memory module to a DRAM controller, which serves
+	/// its data accesses instead of the fixed data latency.
+	void setDramController(dram::Controller *dram_controller)
+	{
+		assert(type == TypeMainMemory);
+		this->dram_controller = dram_controller;
+	}
+
+	/// Return the DRAM controller of a main memory module, or null if
+	/// the module is not connected to any.
+	dram::Controller *getDramController() const { return dram_controller; }
+
+	/// Access the data of the block at \a address, and continue the
+	/// current event chain with \a event when the access completes. If
+	/// the module is connected to a DRAM controller, the event chain is
+	/// suspended until the controller completes a read or write request
+	/// for the address, depending on \a write. The request is tagged with
+	/// the name of \a source, the module that originated the access.
+	/// Otherwise, the access takes the data latency of the module. This
+	/// function should only be invoked in the body of an event handler.
+	void AccessData(esim::Event *event, unsigned address, bool write,
+			Module *source);
+
 	/// Set the high network and high network node that the module is
 	/// connected to.
 	void setHighNetwork(net::Network *high_network,
@@ -460,6 +513,17 @@ public:
 	/// created by a call to setCache(). If setCache() wasn't invoked
 	/// before, return nullptr.
 	Cache *getCache() const { return cache.get(); }
+
+	/// Associate a hardware prefetcher with the module. Argument
+	/// \a prefetcher can be \c nullptr for no prefetching.
+	void setPrefetcher(std::unique_ptr<Prefetcher> prefetcher)
+	{
+		this->prefetcher = std::move(prefetcher);
+	}
+
+	/// Return the prefetcher associated with the module, or \c nullptr
+	/// if the module has no prefetcher.
+	Prefetcher *getPrefetcher() const { return prefetcher.get(); }
 	
 	/// Set the address range served by the module between \a low and
 	/// \a high physical addresses.
@@ -617,7 +681,7 @@ public:
 	int getNumSharers(int set_id, int way_id, int sub_block_id) const
 	{
 		assert(directory.get());
-		Directory::Entry *entry = directory->getEntry(set_id, way_id,
+		const Directory::Entry *entry = directory->getEntry(set_id, way_id,
 				sub_block_id);
 		return entry->getNumSharers();
 	}
@@ -641,6 +705,10 @@ public:
 	///	current frame will be available within the event handler of
 	///	\a return_event. Use \c nullptr (default) for no return event.
 	///
+	/// \param pc
+	///	Address of the instruction that originated the access, used
+	///	to train the prefetcher. This argument is optional.
+	///
 	/// \return frame_id
 	///	The function returns a unique identifier of the new memory
 	///	access.
@@ -648,7 +716,44 @@ public:
 	long long Access(AccessType access_type,
 			unsigned address,
 			int *witness = nullptr,
-			esim::Event *return_event = nullptr);
+			esim::Event *return_event = nullptr,
+			unsigned pc = 0);
+
+	/// Return whether a prefetch can be issued to the module. Prefetches
+	/// have a lower priority than demand accesses: they need a free port
+	/// and MSHR entry, and can take at most half of the MSHR entries.
+	bool canPrefetch() const;
+
+	/// Train the prefetcher with a demand access to the module, and issue
+	/// the prefetches it produces. Blocks that are already present in the
+	/// cache or in flight are not prefetched, and prefetches are dropped
+	/// if they cross a page boundary or if canPrefetch() fails. This
+	/// function has no effect if the module has no prefetcher.
+	///
+	/// \param pc
+	///	Address of the instruction that originated the access, or 0.
+	///
+	/// \param address
+	///	Physical address accessed.
+	///
+	/// \param hit
+	///	Whether the access hit in the cache.
+	///
+	/// \param prefetch_hit
+	///	Whether the access hit on a prefetched block not used yet.
+	///
+	void NotifyPrefetcher(unsigned pc,
+			unsigned address,
+			bool hit,
+			bool prefetch_hit);
+
+	/// Notify the prefetcher, if any, that a block was brought into the
+	/// cache by a demand access or by a prefetch.
+	void NotifyPrefetcherFill(unsigned address, bool prefetch)
+	{
+		if (prefetcher)
+			prefetcher->Fill(address, prefetch);
+	}
 	
 	/// Add the given frame to the list of in-flight accesses, and record
 	/// its access type. This function is invoked internally by the event
@@ -792,6 +897,16 @@ public:
 	// Statistics
 	//
 
+	/// Return the number of accesses
+	long long getNumAccesses() const { return num_accesses; }
+
+	/// Return the number of accesses that hit in the module, including
+	/// reads, writes, and non-coherent writes.
+	long long getNumHits() const
+	{
+		return num_read_hits + num_write_hits + num_nc_write_hits;
+	}
+
 	/// Increment number of accesses
 	void incAccesses() { num_accesses++; }
 
@@ -827,6 +942,34 @@ public:
 	/// Increment the number of accesses to the data.
 	void incDataAccesses() { num_data_accesses++; }
 
+	/// Return the number of blocks brought by prefetches.
+	long long getNumPrefetches() const { return num_prefetches; }
+
+	/// Return the number of prefetched blocks used by a demand access.
+	long long getNumUsefulPrefetches() const { return num_useful_prefetches; }
+
+	/// Return the number of prefetches found in flight by a demand access.
+	long long getNumLatePrefetches() const { return num_late_prefetches; }
+
+	/// Increment the number of blocks brought by prefetches.
+	void incPrefetches() { num_prefetches++; }
+
+	/// Increment the number of prefetches dropped after being requested
+	/// by the prefetcher.
+	void incDroppedPrefetches() { num_dropped_prefetches++; }
+
+	/// Increment the number of prefetched blocks used by a demand access.
+	void incUsefulPrefetches() { num_useful_prefetches++; }
+
+	/// Record that a demand access to the module found the in-flight
+	/// access \a frame to the same block. If \a frame is a prefetch, the
+	/// prefetch is counted as late, only once.
+	void RecordLatePrefetch(Frame *frame);
+
+	/// Increment the number of prefetched blocks replaced before being
+	/// used.
+	void incUselessPrefetches() { num_useless_prefetches++; }
+
 	/// Update the following statistics based on the information collected
 	/// from the given frame:
 	///
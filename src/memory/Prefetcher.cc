@@ -0,0 +1,395 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/Misc.h>
+
+#include "Prefetcher.h"
+
+
+namespace mem
+{
+
+
+//
+// Class 'Prefetcher'
+//
+
+const misc::StringMap Prefetcher::TypeMap =
+{
+	{ "None", TypeNone },
+	{ "Stride", TypeStride },
+	{ "Stream", TypeStream },
+	{ "BestOffset", TypeBestOffset }
+};
+
+
+Prefetcher::Prefetcher(Type type,
+		int block_size,
+		int degree,
+		int distance,
+		int table_size)
+		:
+		type(type),
+		block_size(block_size),
+		degree(degree),
+		distance(distance),
+		table_size(table_size)
+{
+	// Check arguments
+	assert(block_size > 0 && !(block_size & (block_size - 1)));
+	assert(table_size > 0 && !(table_size & (table_size - 1)));
+	assert(degree > 0);
+	assert(distance > 0);
+	log_block_size = misc::LogBase2(block_size);
+}
+
+
+std::unique_ptr<Prefetcher> Prefetcher::Create(Type type,
+		int block_size,
+		int degree,
+		int distance,
+		int table_size)
+{
+	switch (type)
+	{
+
+	case TypeNone:
+
+		return nullptr;
+
+	case TypeStride:
+
+		return misc::new_unique<StridePrefetcher>(block_size,
+				degree, distance, table_size);
+
+	case TypeStream:
+
+		return misc::new_unique<StreamPrefetcher>(block_size,
+				degree, distance, table_size);
+
+	case TypeBestOffset:
+
+		return misc::new_unique<BestOffsetPrefetcher>(block_size,
+				degree, distance, table_size);
+
+	default:
+
+		throw misc::Panic("Invalid prefetcher type");
+	}
+}
+
+
+
+
+//
+// Class 'StridePrefetcher'
+//
+
+StridePrefetcher::StridePrefetcher(int block_size,
+		int degree,
+		int distance,
+		int table_size)
+		:
+		Prefetcher(TypeStride,
+				block_size,
+				degree,
+				distance,
+				table_size)
+{
+	table.resize(table_size);
+}
+
+
+void StridePrefetcher::Access(unsigned pc,
+		unsigned address,
+		bool hit,
+		bool prefetch_hit,
+		std::vector<unsigned> &addresses)
+{
+	// Look up the entry of the instruction, and replace it on a miss
+	Entry &entry = table[(pc ^ (pc >> 10)) & (table_size - 1)];
+	if (!entry.valid || entry.pc != pc)
+	{
+		entry.valid = true;
+		entry.pc = pc;
+		entry.last_address = address;
+		entry.stride = 0;
+		entry.confidence = 0;
+		return;
+	}
+
+	// Repeated accesses to the same address do not train the entry
+	int stride = address - entry.last_address;
+	if (!stride)
+		return;
+	entry.last_address = address;
+
+	// Update confidence. The stride is replaced only after the
+	// confidence drops to zero.
+	if (stride == entry.stride)
+	{
+		if (entry.confidence < max_confidence)
+			entry.confidence++;
+	}
+	else if (entry.confidence > 0)
+	{
+		entry.confidence--;
+	}
+	else
+	{
+		entry.stride = stride;
+	}
+
+	// Nothing to prefetch if the stride is not confirmed
+	if (entry.confidence < min_confidence)
+		return;
+
+	// Prefetch the next blocks along the stride. Strides shorter than
+	// a block advance one block per prefetch.
+	int step = entry.stride;
+	if (step > -block_size && step < block_size)
+		step = step > 0 ? block_size : -block_size;
+	long long max_offset = (long long) distance * block_size;
+	for (int i = 1; i <= degree; i++)
+	{
+		long long offset = (long long) step * i;
+		if (offset > max_offset || offset < -max_offset)
+			break;
+		addresses.push_back(address + (unsigned) offset);
+	}
+}
+
+
+
+
+//
+// Class 'StreamPrefetcher'
+//
+
+StreamPrefetcher::StreamPrefetcher(int block_size,
+		int degree,
+		int distance,
+		int table_size)
+		:
+		Prefetcher(TypeStream,
+				block_size,
+				degree,
+				distance,
+				table_size)
+{
+	streams.resize(table_size);
+}
+
+
+void StreamPrefetcher::Access(unsigned pc,
+		unsigned address,
+		bool hit,
+		bool prefetch_hit,
+		std::vector<unsigned> &addresses)
+{
+	// Only misses and first hits on prefetched blocks train the streams
+	if (hit && !prefetch_hit)
+		return;
+	unsigned block = address >> log_block_size;
+	num_accesses++;
+
+	// Look for a stream whose last access is close to the block
+	Stream *stream = nullptr;
+	for (auto &candidate : streams)
+	{
+		int delta = block - candidate.last_block;
+		if (candidate.valid && delta >= -distance && delta <= distance)
+		{
+			stream = &candidate;
+			break;
+		}
+	}
+
+	// No stream found, replace an invalid or the least recently used one
+	if (!stream)
+	{
+		stream = &streams[0];
+		for (auto &candidate : streams)
+		{
+			if (!candidate.valid)
+			{
+				stream = &candidate;
+				break;
+			}
+			if (candidate.last_access < stream->last_access)
+				stream = &candidate;
+		}
+		*stream = Stream();
+		stream->valid = true;
+		stream->last_block = block;
+		stream->next_block = block;
+		stream->last_access = num_accesses;
+		return;
+	}
+
+	// Another access to the last block does not train the stream
+	stream->last_access = num_accesses;
+	int delta = block - stream->last_block;
+	if (!delta)
+		return;
+
+	// Update the direction. Accesses against the current direction,
+	// possibly due to reordering in the processor, lower the confidence
+	// before the direction is reversed.
+	int direction = delta > 0 ? 1 : -1;
+	if (direction == stream->direction)
+	{
+		if (stream->confidence < min_confidence + 1)
+			stream->confidence++;
+		stream->last_block = block;
+	}
+	else if (stream->confidence > 0)
+	{
+		stream->confidence--;
+	}
+	else
+	{
+		stream->direction = direction;
+		stream->confidence = 1;
+		stream->last_block = block;
+		stream->next_block = block + direction;
+	}
+
+	// Nothing to prefetch until the stream is confirmed
+	if (stream->confidence < min_confidence)
+		return;
+
+	// Prefetch ahead of the stream, staying at most 'distance' blocks
+	// ahead of the last access.
+	block = stream->last_block;
+	if ((int) (stream->next_block - block) * stream->direction <= 0)
+		stream->next_block = block + stream->direction;
+	for (int i = 0; i < degree; i++)
+	{
+		int ahead = (int) (stream->next_block - block) * stream->direction;
+		if (ahead > distance)
+			break;
+		addresses.push_back(stream->next_block << log_block_size);
+		stream->next_block += stream->direction;
+	}
+}
+
+
+
+
+//
+// Class 'BestOffsetPrefetcher'
+//
+
+BestOffsetPrefetcher::BestOffsetPrefetcher(int block_size,
+		int degree,
+		int distance,
+		int table_size)
+		:
+		Prefetcher(TypeBestOffset,
+				block_size,
+				degree,
+				distance,
+				table_size)
+{
+	// Candidate offsets are the numbers up to the distance with no prime
+	// factors other than 2, 3, and 5.
+	for (int candidate = 1; candidate <= distance; candidate++)
+	{
+		int value = candidate;
+		for (int factor : { 2, 3, 5 })
+			while (value % factor == 0)
+				value /= factor;
+		if (value == 1)
+			offsets.push_back(candidate);
+	}
+
+	// Initialize tables
+	scores.resize(offsets.size());
+	recent_fills.resize(table_size);
+}
+
+
+void BestOffsetPrefetcher::EndLearningPhase()
+{
+	// Select the offset with the highest score
+	int best = 0;
+	for (int index = 1; index < (int) scores.size(); index++)
+		if (scores[index] > scores[best])
+			best = index;
+	offset = scores[best] > bad_score ? offsets[best] : 0;
+
+	// Start a new phase
+	std::fill(scores.begin(), scores.end(), 0);
+	test_index = 0;
+	round = 0;
+}
+
+
+void BestOffsetPrefetcher::Access(unsigned pc,
+		unsigned address,
+		bool hit,
+		bool prefetch_hit,
+		std::vector<unsigned> &addresses)
+{
+	// Only misses and first hits on prefetched blocks trigger learning
+	// and prefetching.
+	if (hit && !prefetch_hit)
+		return;
+	unsigned block = address >> log_block_size;
+
+	// Test the next offset. The offset would have been timely if the
+	// block at that offset behind the current one was recently filled.
+	bool end_phase = false;
+	if (isRecentFill(block - offsets[test_index]) &&
+			++scores[test_index] >= max_score)
+		end_phase = true;
+	if (++test_index == (int) offsets.size())
+	{
+		test_index = 0;
+		if (++round >= max_rounds)
+			end_phase = true;
+	}
+	if (end_phase)
+		EndLearningPhase();
+
+	// Prefetch with the current offset
+	if (offset)
+		addresses.push_back((block + offset) << log_block_size);
+}
+
+
+void BestOffsetPrefetcher::Fill(unsigned address, bool prefetch)
+{
+	// Blocks brought by a prefetch are recorded by the address of the
+	// access that triggered them. Demand fills are only recorded while
+	// prefetching is turned off.
+	unsigned block = address >> log_block_size;
+	if (prefetch && offset)
+		addRecentFill(block - offset);
+	else if (!prefetch && !offset)
+		addRecentFill(block);
+}
+
+
+}  // namespace mem
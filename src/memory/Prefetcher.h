@@ -0,0 +1,323 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MEMORY_PREFETCHER_H
+#define MEMORY_PREFETCHER_H
+
+#include <memory>
+#include <vector>
+
+#include <lib/cpp/String.h>
+
+
+namespace mem
+{
+
+/// Hardware data prefetcher associated with a cache module. The prefetcher
+/// observes the demand accesses to the module, and produces the addresses of
+/// blocks that should be brought into the cache ahead of time. Issuing the
+/// prefetches is up to the module.
+class Prefetcher
+{
+public:
+
+	/// Prefetcher types
+	enum Type
+	{
+		TypeInvalid = 0,
+		TypeNone,
+		TypeStride,
+		TypeStream,
+		TypeBestOffset
+	};
+
+	/// String map for Type
+	static const misc::StringMap TypeMap;
+
+private:
+
+	// Prefetcher type
+	Type type;
+
+protected:
+
+	// Block size of the module
+	int block_size;
+
+	// Log base 2 of the block size
+	int log_block_size;
+
+	// Maximum number of prefetches produced by one access
+	int degree;
+
+	// How far ahead of the current access prefetches can go, in blocks
+	int distance;
+
+	// Number of entries in the prefetcher table
+	int table_size;
+
+public:
+
+	/// Constructor
+	Prefetcher(Type type,
+			int block_size,
+			int degree,
+			int distance,
+			int table_size);
+
+	/// Destructor
+	virtual ~Prefetcher() {}
+
+	/// Create a prefetcher of the given type. For type \c TypeNone, the
+	/// function returns \c nullptr.
+	static std::unique_ptr<Prefetcher> Create(Type type,
+			int block_size,
+			int degree,
+			int distance,
+			int table_size);
+
+	/// Return the prefetcher type
+	Type getType() const { return type; }
+
+	/// Return the prefetch degree
+	int getDegree() const { return degree; }
+
+	/// Return the prefetch distance in blocks
+	int getDistance() const { return distance; }
+
+	/// Return the number of entries in the prefetcher table
+	int getTableSize() const { return table_size; }
+
+	/// Train the prefetcher with a demand access to the module.
+	///
+	/// \param pc
+	///	Address of the instruction that caused the access, or 0 if
+	///	unknown.
+	///
+	/// \param address
+	///	Physical address accessed.
+	///
+	/// \param hit
+	///	Whether the access hit in the cache.
+	///
+	/// \param prefetch_hit
+	///	Whether the access hit on a block brought by a prefetch that
+	///	had not been used yet.
+	///
+	/// \param addresses
+	///	Addresses to prefetch are appended to this vector.
+	///
+	virtual void Access(unsigned pc,
+			unsigned address,
+			bool hit,
+			bool prefetch_hit,
+			std::vector<unsigned> &addresses) = 0;
+
+	/// Notify the prefetcher that a block was brought into the cache,
+	/// either by a demand miss or by a prefetch.
+	virtual void Fill(unsigned address, bool prefetch) {}
+};
+
+
+/// Stride prefetcher with a reference prediction table indexed by the address
+/// of the instruction. Once the same stride is observed repeatedly for an
+/// instruction, the next blocks along the stride are prefetched.
+class StridePrefetcher : public Prefetcher
+{
+	// Entry of the reference prediction table
+	struct Entry
+	{
+		// Instruction address
+		unsigned pc = 0;
+
+		// Last address accessed by the instruction
+		unsigned last_address = 0;
+
+		// Last stride observed
+		int stride = 0;
+
+		// Saturating confidence counter, 2 bits
+		int confidence = 0;
+
+		// Whether the entry is in use
+		bool valid = false;
+	};
+
+	// Reference prediction table
+	std::vector<Entry> table;
+
+public:
+
+	/// Minimum value of the confidence counter to issue prefetches
+	static const int min_confidence = 2;
+
+	/// Maximum value of the confidence counter
+	static const int max_confidence = 3;
+
+	/// Constructor
+	StridePrefetcher(int block_size,
+			int degree,
+			int distance,
+			int table_size);
+
+	void Access(unsigned pc,
+			unsigned address,
+			bool hit,
+			bool prefetch_hit,
+			std::vector<unsigned> &addresses) override;
+};
+
+
+/// Stream prefetcher. Misses to nearby blocks allocate and train stream
+/// entries. Once a stream has been confirmed in one direction, the blocks
+/// following it are prefetched, staying at most 'distance' blocks ahead of
+/// the last access to the stream.
+class StreamPrefetcher : public Prefetcher
+{
+	// Stream entry
+	struct Stream
+	{
+		// Block address of the last access to the stream
+		unsigned last_block = 0;
+
+		// Next block to prefetch
+		unsigned next_block = 0;
+
+		// Direction of the stream, 1 for ascending, -1 for descending,
+		// or 0 if unknown.
+		int direction = 0;
+
+		// Number of consecutive accesses in the same direction
+		int confidence = 0;
+
+		// Time stamp of the last access, used for replacement
+		long long last_access = 0;
+
+		// Whether the entry is in use
+		bool valid = false;
+	};
+
+	// Streams
+	std::vector<Stream> streams;
+
+	// Counter of trained accesses, used as a time stamp
+	long long num_accesses = 0;
+
+public:
+
+	/// Number of accesses in the same direction needed to start
+	/// prefetching a stream.
+	static const int min_confidence = 2;
+
+	/// Constructor
+	StreamPrefetcher(int block_size,
+			int degree,
+			int distance,
+			int table_size);
+
+	void Access(unsigned pc,
+			unsigned address,
+			bool hit,
+			bool prefetch_hit,
+			std::vector<unsigned> &addresses) override;
+};
+
+
+/// Best-offset prefetcher. Prefetches block X+D on an access to block X,
+/// where offset D is learnt by checking, for every candidate offset d,
+/// whether block X-d was recently filled in the cache. The recent fills are
+/// kept in a direct-mapped table. After each learning phase, the offset with
+/// the highest score is selected, and prefetching is turned off if no offset
+/// scores high enough.
+class BestOffsetPrefetcher : public Prefetcher
+{
+	// Candidate offsets
+	std::vector<int> offsets;
+
+	// Score of each offset in the current learning phase
+	std::vector<int> scores;
+
+	// Index of the next offset to test
+	int test_index = 0;
+
+	// Number of rounds over all offsets in the current learning phase
+	int round = 0;
+
+	// Current prefetch offset, or 0 if prefetching is turned off
+	int offset = 0;
+
+	// Recent fills table, storing block addresses plus 1, so that 0
+	// represents an empty entry.
+	std::vector<unsigned> recent_fills;
+
+	// Return the index in the recent fills table for a block address
+	int getRecentFillIndex(unsigned block) const
+	{
+		return (block ^ (block >> 8)) & (table_size - 1);
+	}
+
+	// Return whether a block address is in the recent fills table
+	bool isRecentFill(unsigned block) const
+	{
+		return recent_fills[getRecentFillIndex(block)] == block + 1;
+	}
+
+	// Record a block address in the recent fills table
+	void addRecentFill(unsigned block)
+	{
+		recent_fills[getRecentFillIndex(block)] = block + 1;
+	}
+
+	// Finish the current learning phase
+	void EndLearningPhase();
+
+public:
+
+	/// Score that ends a learning phase early
+	static const int max_score = 31;
+
+	/// Maximum number of rounds in a learning phase
+	static const int max_rounds = 100;
+
+	/// Score below which prefetching is turned off
+	static const int bad_score = 1;
+
+	/// Constructor
+	BestOffsetPrefetcher(int block_size,
+			int degree,
+			int distance,
+			int table_size);
+
+	/// Return the current prefetch offset in blocks, or 0 if prefetching
+	/// is turned off.
+	int getOffset() const { return offset; }
+
+	void Access(unsigned pc,
+			unsigned address,
+			bool hit,
+			bool prefetch_hit,
+			std::vector<unsigned> &addresses) override;
+
+	void Fill(unsigned address, bool prefetch) override;
+};
+
+
+}  // namespace mem
+
+#endif
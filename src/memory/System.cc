@@ -127,6 +127,22 @@ System::System()
 			EventNCStoreHandler,
 			frequency_domain);
 
+	event_prefetch = esim_engine->RegisterEvent("prefetch",
+			EventPrefetchHandler,
+			frequency_domain);
+	event_prefetch_lock = esim_engine->RegisterEvent("prefetch_lock",
+			EventPrefetchHandler,
+			frequency_domain);
+	event_prefetch_action = esim_engine->RegisterEvent("prefetch_action",
+			EventPrefetchHandler,
+			frequency_domain);
+	event_prefetch_miss = esim_engine->RegisterEvent("prefetch_miss",
+			EventPrefetchHandler,
+			frequency_domain);
+	event_prefetch_finish = esim_engine->RegisterEvent("prefetch_finish",
+			EventPrefetchHandler,
+			frequency_domain);
+
 	event_find_and_lock = esim_engine->RegisterEvent("find_and_lock",
 			EventFindAndLockHandler,
 			frequency_domain);
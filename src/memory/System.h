@@ -109,6 +109,7 @@ class System
 	static void EventLoadHandler(esim::Event *, esim::Frame *);
 	static void EventStoreHandler(esim::Event *, esim::Frame *);
 	static void EventNCStoreHandler(esim::Event *, esim::Frame *);
+	static void EventPrefetchHandler(esim::Event *, esim::Frame *);
 	static void EventFindAndLockHandler(esim::Event *, esim::Frame *);
 	static void EventEvictHandler(esim::Event *, esim::Frame *);
 	static void EventWriteRequestHandler(esim::Event *, esim::Frame *);
@@ -224,6 +225,8 @@ class System
 
 	void ConfigCalculateModuleLevels();
 
+	void ConfigRegisterDramSources();
+
 	void ConfigTrace();
 
 	void ConfigReadCommands(misc::IniFile *ini_file);
@@ -254,6 +257,18 @@ public:
 		return it == module_map.end() ? nullptr : it->second;
 	}
 
+	/// Return an iterator to the first module of the memory system
+	std::list<std::unique_ptr<Module>>::const_iterator getModulesBegin() const
+	{
+		return modules.begin();
+	}
+
+	/// Return a past-the-end iterator to the list of modules
+	std::list<std::unique_ptr<Module>>::const_iterator getModulesEnd() const
+	{
+		return modules.end();
+	}
+
 	/// Return a network given its name, or nullptr if no network with that
 	/// name exists.
 	net::Network *getNetwork(const std::string &name) const
@@ -318,6 +333,12 @@ public:
 	static esim::Event *event_nc_store_unlock;
 	static esim::Event *event_nc_store_finish;
 
+	static esim::Event *event_prefetch;
+	static esim::Event *event_prefetch_lock;
+	static esim::Event *event_prefetch_action;
+	static esim::Event *event_prefetch_miss;
+	static esim::Event *event_prefetch_finish;
+
 	static esim::Event *event_find_and_lock;
 	static esim::Event *event_find_and_lock_port;
 	static esim::Event *event_find_and_lock_action;
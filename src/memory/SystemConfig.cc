@@ -19,6 +19,8 @@
 
 #include <arch/common/Arch.h>
 #include <arch/common/Timing.h>
+#include <dram/Controller.h>
+#include <dram/System.h>
 #include <lib/esim/Engine.h>
 #include <network/EndNode.h>
 #include <network/Node.h>
@@ -107,7 +109,15 @@ const std::string System::help_message =
 	"  Latency = <cycles>\n"
 	"      Memory access latency. This variable is required for a main memory\n"
 	"      module, and should be omitted for a cache module (the access latency\n"
-	"      is specified in the corresponding cache geometry section).\n"
+	"      is specified in the corresponding cache geometry section). It is\n"
+	"      not required for a main memory module backed by a DRAM controller.\n"
+	"  DramController = <name>\n"
+	"      DRAM controller modeling the timing of the main memory module, as\n"
+	"      defined in a 'MemoryController' section of the DRAM configuration\n"
+	"      file (option '--dram-config'). If specified, data accesses complete\n"
+	"      when the DRAM controller serves them, instead of after a fixed\n"
+	"      'Latency'.\n"
+	"      This variable is only allowed for a main memory module.\n"
 	"  Ports = <num>\n"
 	"      Number of read/write ports. This variable is only allowed for a main\n"
 	"      memory module. The number of ports for a cache is specified in a\n"
@@ -141,6 +151,28 @@ const std::string System::help_message =
 	"      When a module serves only a subset of the address space, the user must\n"
 	"      make sure that the rest of the modules at the same level serve the\n"
 	"      remaining address space.\n"
+	"  Prefetcher = {None|Stride|Stream|BestOffset}  (Default = None)\n"
+	"      Hardware data prefetcher. The stride prefetcher detects constant\n"
+	"      strides in the addresses accessed by each instruction. The stream\n"
+	"      prefetcher detects misses to consecutive blocks. The best-offset\n"
+	"      prefetcher learns the block offset that makes prefetches timely.\n"
+	"      Prefetches have lower priority than demand accesses: they are only\n"
+	"      issued when the cache has a free port and MSHR entry, can take at\n"
+	"      most half of the MSHR entries, and never cross a page boundary.\n"
+	"      This variable is only allowed for cache modules.\n"
+	"  PrefetchDegree = <num>  (Default = 2)\n"
+	"      Maximum number of blocks prefetched on each access by the stride\n"
+	"      and stream prefetchers. The best-offset prefetcher always prefetches\n"
+	"      one block.\n"
+	"  PrefetchDistance = <blocks>  (Default = 16)\n"
+	"      Maximum distance in blocks between an access and the blocks it\n"
+	"      prefetches. For the best-offset prefetcher, this is the largest\n"
+	"      offset considered.\n"
+	"  PrefetchTableSize = <entries>  (Default = 64)\n"
+	"      Number of entries of the reference prediction table of the stride\n"
+	"      prefetcher, of the stream table of the stream prefetcher, or of the\n"
+	"      recent fills table of the best-offset prefetcher. Must be a power\n"
+	"      of two.\n"
 	"\n"
 	"Section [CacheGeometry <geo>] defines a geometry for a cache. Caches using\n"
 	"this geometry are instantiated [Module <name>] sections.\n"
@@ -155,8 +187,12 @@ const std::string System::help_message =
 	"      by the product Sets * Assoc * BlockSize.\n"
 	"  Latency = <cycles> (Required)\n"
 	"      Hit latency for a cache in number of cycles.\n"
-	"  Policy = {LRU|FIFO|Random} (Default = LRU)\n"
-	"      Block replacement policy.\n"
+	"  Policy = {LRU|FIFO|Random|PLRU|SRRIP|BRRIP|DRRIP|SHiP} (Default = LRU)\n"
+	"      Block replacement policy. PLRU is a tree-based pseudo-LRU policy.\n"
+	"      SRRIP and BRRIP use static and bimodal re-reference interval\n"
+	"      prediction, and DRRIP selects between both with set dueling. SHiP\n"
+	"      predicts the re-reference interval of inserted blocks based on the\n"
+	"      address of the instruction that caused the miss.\n"
 	"  WritePolicy = {WriteBack|WriteThrough} (Default = WriteBack)\n"
 	"      Cache write policy.\n"
 	"  MSHR = <size> (Default = 16)\n"
@@ -501,6 +537,15 @@ Module *System::ConfigReadCache(misc::IniFile *ini_file,
 	int mshr_size = ini_file->ReadInt(geometry_section, "MSHR", 16);
 	int num_ports = ini_file->ReadInt(geometry_section, "Ports", 2);
 
+	// Prefetcher values
+	std::string prefetcher_str = ini_file->ReadString(section,
+			"Prefetcher", "None");
+	int prefetch_degree = ini_file->ReadInt(section, "PrefetchDegree", 2);
+	int prefetch_distance = ini_file->ReadInt(section,
+			"PrefetchDistance", 16);
+	int prefetch_table_size = ini_file->ReadInt(section,
+			"PrefetchTableSize", 64);
+
 	// Check replacement policy
 	Cache::ReplacementPolicy replacement_policy =
 			(Cache::ReplacementPolicy)
@@ -577,6 +622,36 @@ Module *System::ConfigReadCache(misc::IniFile *ini_file,
 				module_name.c_str(),
 				err_config_note));
 
+	// Check prefetcher
+	Prefetcher::Type prefetcher_type = (Prefetcher::Type)
+			Prefetcher::TypeMap.MapString(prefetcher_str);
+	if (!prefetcher_type)
+		throw Error(misc::fmt("%s: cache %s: %s: "
+				"Invalid prefetcher.\n%s",
+				ini_file->getPath().c_str(),
+				module_name.c_str(),
+				prefetcher_str.c_str(),
+				err_config_note));
+	if (prefetch_degree < 1)
+		throw Error(misc::fmt("%s: cache %s: invalid value for "
+				"variable 'PrefetchDegree'.\n%s",
+				ini_file->getPath().c_str(),
+				module_name.c_str(),
+				err_config_note));
+	if (prefetch_distance < 1)
+		throw Error(misc::fmt("%s: cache %s: invalid value for "
+				"variable 'PrefetchDistance'.\n%s",
+				ini_file->getPath().c_str(),
+				module_name.c_str(),
+				err_config_note));
+	if (prefetch_table_size < 1 ||
+			(prefetch_table_size & (prefetch_table_size - 1)))
+		throw Error(misc::fmt("%s: cache %s: prefetch table size must "
+				"be a power of two.\n%s",
+				ini_file->getPath().c_str(),
+				module_name.c_str(),
+				err_config_note));
+
 	// Create module
 	Module *module = addModule(module_name,
 			Module::TypeCache,
@@ -621,6 +696,13 @@ Module *System::ConfigReadCache(misc::IniFile *ini_file,
 			replacement_policy,
 			write_policy);
 
+	// Create prefetcher
+	module->setPrefetcher(Prefetcher::Create(prefetcher_type,
+			block_size,
+			prefetch_degree,
+			prefetch_distance,
+			prefetch_table_size));
+
 	// Done
 	return module;
 }
@@ -636,7 +718,10 @@ Module *System::ConfigReadMainMemory(misc::IniFile *ini_file,
 	misc::StringTrim(module_name);
 	
 	// Read parameters
-	ini_file->Enforce(section, "Latency");
+	std::string dram_controller_name = ini_file->ReadString(section,
+			"DramController");
+	if (dram_controller_name.empty())
+		ini_file->Enforce(section, "Latency");
 	ini_file->Enforce(section, "BlockSize");
 	int block_size = ini_file->ReadInt(section, "BlockSize", 64);
 	int latency = ini_file->ReadInt(section, "Latency", 1);
@@ -696,6 +781,25 @@ Module *System::ConfigReadMainMemory(misc::IniFile *ini_file,
 			directory_num_ways,
 			directory_latency);
 
+	// DRAM controller
+	if (!dram_controller_name.empty())
+	{
+		dram::Controller *dram_controller = nullptr;
+		if (dram::System::hasInstance())
+			dram_controller = dram::System::getInstance()->
+					getController(dram_controller_name);
+		if (!dram_controller)
+			throw Error(misc::fmt("%s: %s: DRAM controller '%s' not "
+					"found. Make sure it is defined in the "
+					"DRAM configuration file (option "
+					"'--dram-config').\n%s",
+					ini_file->getPath().c_str(),
+					module_name.c_str(),
+					dram_controller_name.c_str(),
+					err_config_note));
+		module->setDramController(dram_controller);
+	}
+
 	// High network
 	std::string network_name = ini_file->ReadString(section, "HighNetwork");
 	std::string network_node_name = ini_file->ReadString(section, "HighNetworkNode");
@@ -1180,7 +1284,7 @@ void System::ConfigCreateSwitches(misc::IniFile *ini_file)
 		// Calculate routes
 		net::RoutingTable *routing_table = network->getRoutingTable();
 		routing_table->Initialize();
-		routing_table->FloydWarshall();
+		routing_table->ShortestPaths();
 
 		// Debug
 		debug << '\n';
@@ -1370,6 +1474,24 @@ void System::ConfigCalculateModuleLevels()
 }
 
 
+void System::ConfigRegisterDramSources()
+{
+	// Any module can originate accesses, either as an entry to the memory
+	// hierarchy or through a command. Register them all as sources in the
+	// DRAM controllers, so that the controllers are not modified while
+	// the simulation runs.
+	for (auto &main_memory : modules)
+	{
+		dram::Controller *dram_controller =
+				main_memory->getDramController();
+		if (!dram_controller)
+			continue;
+		for (auto &module : modules)
+			dram_controller->AddSource(module->getName());
+	}
+}
+
+
 void System::ConfigTrace()
 {
 	// Initialization
@@ -1551,6 +1673,9 @@ void System::ReadConfiguration(misc::IniFile *ini_file)
 	// Compute cache levels relative to the CPU/GPU entry points
 	ConfigCalculateModuleLevels();
 
+	// Register the modules as sources of requests in DRAM controllers
+	ConfigRegisterDramSources();
+
 	// Dump configuration to trace file
 	ConfigTrace();
 }
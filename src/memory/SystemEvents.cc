@@ -47,6 +47,12 @@ esim::Event *System::event_nc_store_miss;
 esim::Event *System::event_nc_store_unlock;
 esim::Event *System::event_nc_store_finish;
 
+esim::Event *System::event_prefetch;
+esim::Event *System::event_prefetch_lock;
+esim::Event *System::event_prefetch_action;
+esim::Event *System::event_prefetch_miss;
+esim::Event *System::event_prefetch_finish;
+
 esim::Event *System::event_find_and_lock;
 esim::Event *System::event_find_and_lock_port;
 esim::Event *System::event_find_and_lock_action;
@@ -201,7 +207,8 @@ void System::EventLoadHandler(esim::Event *event, esim::Frame *esim_frame)
 		}
 
 		// If there is any older access to the same address that this
-		// access could not be coalesced with, wait for it.
+		// access could not be coalesced with, wait for it. If it is a
+		// prefetch, the prefetch was issued too late.
 		older_frame = module->getInFlightAddress(
 				frame->getAddress(),
 				frame);
@@ -210,12 +217,13 @@ void System::EventLoadHandler(esim::Event *event, esim::Frame *esim_frame)
 			debug << misc::fmt("    A-%lld wait for access A-%lld\n",
 					frame->getId(),
 					older_frame->getId());
+			module->RecordLatePrefetch(older_frame);
 			older_frame->queue.Wait(event_load_lock);
 			return;
 		}
 
 		// Call "find_and_lock" event chain
-		auto new_frame = misc::new_shared<Frame>(
+		auto new_frame = esim::new_frame<Frame>(
 				frame->getId(),
 				module,
 				frame->getAddress());
@@ -261,6 +269,12 @@ void System::EventLoadHandler(esim::Event *event, esim::Frame *esim_frame)
 			return;
 		}
 
+		// Train prefetcher
+		module->NotifyPrefetcher(frame->pc,
+				frame->getAddress(),
+				frame->state,
+				frame->prefetch_hit);
+
 		// Hit
 		if (frame->state)
 		{
@@ -270,12 +284,13 @@ void System::EventLoadHandler(esim::Event *event, esim::Frame *esim_frame)
 		}
 
 		// Miss
-		auto new_frame = misc::new_shared<Frame>(
+		auto new_frame = esim::new_frame<Frame>(
 				frame->getId(),
 				module,
 				frame->tag);
 		new_frame->target_module = module->getLowModuleServingAddress(frame->tag);
 		new_frame->request_direction = Frame::RequestDirectionUpDown;
+		new_frame->pc = frame->pc;
 		esim_engine->Call(event_read_request,
 				new_frame,
 				event_load_miss);
@@ -327,6 +342,7 @@ void System::EventLoadHandler(esim::Event *event, esim::Frame *esim_frame)
 				frame->way,
 				frame->tag,
 				frame->shared ? Cache::BlockShared : Cache::BlockExclusive);
+		module->NotifyPrefetcherFill(frame->tag, false);
 
 		// Continue
 		esim_engine->Next(event_load_unlock);
@@ -359,8 +375,8 @@ void System::EventLoadHandler(esim::Event *event, esim::Frame *esim_frame)
 		module->incDataAccesses();
 
 		// Continue with 'load-finish' after latency
-		esim_engine->Next(event_load_finish,
-				module->getDataLatency());
+		module->AccessData(event_load_finish, frame->tag, false,
+				frame->source_module);
 		return;
 	}
 
@@ -481,14 +497,24 @@ void System::EventStoreHandler(esim::Event *event,
 				frame->getId(),
 				module->getName().c_str());
 
-		// If there is any older access, wait for it
+		// If there is any older access, wait for it. Prefetches are
+		// skipped unless they fetch the same block, in which case the
+		// prefetch was issued too late.
 		auto it = frame->accesses_iterator;
 		assert(it != module->getAccessListEnd());
-		if (it != module->getAccessListBegin())
+		while (it != module->getAccessListBegin())
 		{
 			// Get older access
 			--it;
 			Frame *older_frame = *it;
+			if (older_frame->access_type == Module::AccessPrefetch)
+			{
+				int log_block_size = module->getLogBlockSize();
+				if (older_frame->getAddress() >> log_block_size !=
+						frame->getAddress() >> log_block_size)
+					continue;
+				module->RecordLatePrefetch(older_frame);
+			}
 
 			// Debug
 			debug << misc::fmt("    A-%lld wait for access A-%lld\n",
@@ -501,7 +527,7 @@ void System::EventStoreHandler(esim::Event *event,
 		}
 
 		// Call 'find-and-lock'
-		auto new_frame = misc::new_shared<Frame>(
+		auto new_frame = esim::new_frame<Frame>(
 				frame->getId(),
 				module,
 				frame->getAddress());
@@ -548,6 +574,12 @@ void System::EventStoreHandler(esim::Event *event,
 			return;
 		}
 
+		// Train prefetcher
+		module->NotifyPrefetcher(frame->pc,
+				frame->getAddress(),
+				frame->state,
+				frame->prefetch_hit);
+
 		// Hit - state=M/E
 		if (frame->state == Cache::BlockModified ||
 			frame->state == Cache::BlockExclusive)
@@ -559,13 +591,14 @@ void System::EventStoreHandler(esim::Event *event,
 
 		// Miss - state=O/S/I/N
 		// Call 'write-request'
-		auto new_frame = misc::new_shared<Frame>(
+		auto new_frame = esim::new_frame<Frame>(
 				frame->getId(),
 				module,
 				frame->getAddress());
 		new_frame->target_module = module->getLowModuleServingAddress(frame->tag);
 		new_frame->request_direction = Frame::RequestDirectionUpDown;
 		new_frame->witness = frame->witness;
+		new_frame->pc = frame->pc;
 
 		// Set the expected reply size. This might change during the
 		// down up write process, and invalidation
@@ -625,6 +658,8 @@ void System::EventStoreHandler(esim::Event *event,
 		// Update tag/state
 		cache->setBlock(frame->set, frame->way, frame->tag,
 				Cache::BlockModified);
+		if (!frame->state)
+			module->NotifyPrefetcherFill(frame->tag, false);
 
 		// Unlock directory entry
 		directory->UnlockEntry(frame->set,
@@ -633,8 +668,8 @@ void System::EventStoreHandler(esim::Event *event,
 
 		// Continue to 'store-finish' after data latency
 		module->incDataAccesses();
-		esim_engine->Next(event_store_finish,
-				module->getDataLatency());
+		module->AccessData(event_store_finish, frame->tag, true,
+				frame->source_module);
 		return;
 	}
 
@@ -777,7 +812,7 @@ void System::EventNCStoreHandler(esim::Event *event,
 		}
 
 		// Call find and lock
-		auto new_frame = misc::new_shared<Frame>(
+		auto new_frame = esim::new_frame<Frame>(
 				frame->getId(),
 				module,
 				frame->getAddress());
@@ -831,7 +866,7 @@ void System::EventNCStoreHandler(esim::Event *event,
 			frame->eviction = true;
 
 			// Call 'evict'
-			auto new_frame = misc::new_shared<Frame>(
+			auto new_frame = esim::new_frame<Frame>(
 					frame->getId(),
 					module,
 					0);
@@ -907,7 +942,7 @@ void System::EventNCStoreHandler(esim::Event *event,
 		{
 			// E state must tell the lower-level module to remove
 			// this module as an owner. Call 'message'.
-			auto new_frame = misc::new_shared<Frame>(
+			auto new_frame = esim::new_frame<Frame>(
 					frame->getId(),
 					module,
 					frame->tag);
@@ -927,7 +962,7 @@ void System::EventNCStoreHandler(esim::Event *event,
 			// because we've already evicted the block so that the
 			// lower-level cache will have the latest value before
 			// it becomes non-coherent. Call 'read-request'.
-			auto new_frame = misc::new_shared<Frame>(
+			auto new_frame = esim::new_frame<Frame>(
 					frame->getId(),
 					module,
 					frame->tag);
@@ -1020,8 +1055,8 @@ void System::EventNCStoreHandler(esim::Event *event,
 		module->incDataAccesses();
 
 		// Continue with 'store-finish' after access latency
-		esim_engine->Next(event_nc_store_finish,
-				module->getDataLatency());
+		module->AccessData(event_nc_store_finish, frame->tag, true,
+				frame->source_module);
 		return;
 	}
 
@@ -1059,6 +1094,216 @@ void System::EventNCStoreHandler(esim::Event *event,
 }
 
 
+void System::EventPrefetchHandler(esim::Event *event,
+		esim::Frame *esim_frame)
+{
+	// Get useful objects
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	Frame *frame = misc::cast<Frame *>(esim_frame);
+	Module *module = frame->getModule();
+	Cache *cache = module->getCache();
+	Directory *directory = module->getDirectory();
+
+	// Event "prefetch"
+	if (event == event_prefetch)
+	{
+		// Debug and trace
+		debug << misc::fmt("%lld A-%lld 0x%x %s prefetch\n",
+				esim_engine->getTime(),
+				frame->getId(),
+				frame->getAddress(),
+				module->getName().c_str());
+		trace << misc::fmt("mem.new_access "
+				"name=\"A-%lld\" "
+				"type=\"prefetch\" "
+				"state=\"%s:prefetch\" "
+				"addr=0x%x\n",
+				frame->getId(),
+				module->getName().c_str(),
+				frame->getAddress());
+
+		// Record access
+		module->StartAccess(frame, Module::AccessPrefetch);
+
+		// Continue
+		esim_engine->Next(event_prefetch_lock);
+		return;
+	}
+
+	// Event "prefetch_lock"
+	if (event == event_prefetch_lock)
+	{
+		// Debug and trace
+		debug << misc::fmt("  %lld A-%lld 0x%x %s prefetch_lock\n",
+				esim_engine->getTime(),
+				frame->getId(),
+				frame->getAddress(),
+				module->getName().c_str());
+		trace << misc::fmt("mem.access "
+				"name=\"A-%lld\" "
+				"state=\"%s:prefetch_lock\"\n",
+				frame->getId(),
+				module->getName().c_str());
+
+		// Prefetches never wait. If there is an older access to the
+		// same block, drop the prefetch.
+		Frame *older_frame = module->getInFlightAddress(
+				frame->getAddress(),
+				frame);
+		if (older_frame)
+		{
+			debug << misc::fmt("    A-%lld dropped, block in flight "
+					"in A-%lld\n",
+					frame->getId(),
+					older_frame->getId());
+			module->incDroppedPrefetches();
+			esim_engine->Next(event_prefetch_finish);
+			return;
+		}
+
+		// Call non-blocking "find_and_lock" event chain
+		auto new_frame = esim::new_frame<Frame>(
+				frame->getId(),
+				module,
+				frame->getAddress());
+		new_frame->request_direction = Frame::RequestDirectionUpDown;
+		new_frame->blocking = false;
+		new_frame->read = true;
+		new_frame->prefetch = true;
+		esim_engine->Call(event_find_and_lock,
+				new_frame,
+				event_prefetch_action);
+		return;
+	}
+
+	// Event "prefetch_action"
+	if (event == event_prefetch_action)
+	{
+		// Debug and trace
+		debug << misc::fmt("  %lld A-%lld 0x%x %s prefetch_action\n",
+				esim_engine->getTime(),
+				frame->getId(),
+				frame->getAddress(),
+				module->getName().c_str());
+		trace << misc::fmt("mem.access "
+				"name=\"A-%lld\" "
+				"state=\"%s:prefetch_action\"\n",
+				frame->getId(),
+				module->getName().c_str());
+
+		// Error locking. Prefetches are not retried.
+		if (frame->error)
+		{
+			debug << "    lock error, prefetch dropped\n";
+			module->incDroppedPrefetches();
+			esim_engine->Next(event_prefetch_finish);
+			return;
+		}
+
+		// Hit, the block was brought since the prefetch was issued
+		if (frame->state)
+		{
+			directory->UnlockEntry(frame->set,
+					frame->way,
+					frame->getId());
+			module->incDroppedPrefetches();
+			esim_engine->Next(event_prefetch_finish);
+			return;
+		}
+
+		// Miss
+		auto new_frame = esim::new_frame<Frame>(
+				frame->getId(),
+				module,
+				frame->tag);
+		new_frame->target_module = module->getLowModuleServingAddress(frame->tag);
+		new_frame->request_direction = Frame::RequestDirectionUpDown;
+		esim_engine->Call(event_read_request,
+				new_frame,
+				event_prefetch_miss);
+		return;
+	}
+
+	// Event "prefetch_miss"
+	if (event == event_prefetch_miss)
+	{
+		// Debug and trace
+		debug << misc::fmt("  %lld A-%lld 0x%x %s prefetch_miss\n",
+				esim_engine->getTime(),
+				frame->getId(),
+				frame->getAddress(),
+				module->getName().c_str());
+		trace << misc::fmt("mem.access "
+				"name=\"A-%lld\" "
+				"state=\"%s:prefetch_miss\"\n",
+				frame->getId(),
+				module->getName().c_str());
+
+		// Error on read request. Unlock block and drop the prefetch.
+		if (frame->error)
+		{
+			debug << "    read request error, prefetch dropped\n";
+			directory->UnlockEntry(frame->set,
+					frame->way,
+					frame->getId());
+			module->incDroppedPrefetches();
+			esim_engine->Next(event_prefetch_finish);
+			return;
+		}
+
+		// Set block state to E/S depending on return var 'shared', and
+		// mark it as prefetched.
+		cache->setBlock(frame->set,
+				frame->way,
+				frame->tag,
+				frame->shared ? Cache::BlockShared : Cache::BlockExclusive);
+		cache->getBlock(frame->set, frame->way)->setPrefetched(true);
+
+		// Unlock directory entry
+		directory->UnlockEntry(frame->set,
+				frame->way,
+				frame->getId());
+
+		// Statistics and prefetcher training
+		module->incPrefetches();
+		module->NotifyPrefetcherFill(frame->tag, true);
+
+		// Continue
+		esim_engine->Next(event_prefetch_finish);
+		return;
+	}
+
+	// Event "prefetch_finish"
+	if (event == event_prefetch_finish)
+	{
+		// Debug and trace
+		debug << misc::fmt("%lld A-%lld 0x%x %s prefetch_finish\n",
+				esim_engine->getTime(),
+				frame->getId(),
+				frame->getAddress(),
+				module->getName().c_str());
+		trace << misc::fmt("mem.access "
+				"name=\"A-%lld\" "
+				"state=\"%s:prefetch_finish\"\n",
+				frame->getId(),
+				module->getName().c_str());
+		trace << misc::fmt("mem.end_access "
+				"name=\"A-%lld\"\n",
+				frame->getId());
+
+		// Finish access
+		module->FinishAccess(frame);
+
+		// Return
+		esim_engine->Return();
+		return;
+	}
+
+	// Invalid event
+	throw misc::Panic("Invalid event");
+}
+
+
 void System::EventFindAndLockHandler(esim::Event *event,
 		esim::Frame *esim_frame)
 {
@@ -1088,6 +1333,7 @@ void System::EventFindAndLockHandler(esim::Event *event,
 
 		// Default return values
 		parent_frame->error = false;
+		parent_frame->prefetch_hit = false;
 
 		// If this access has already been assigned a way, keep using it
 		frame->way = parent_frame->way;
@@ -1117,9 +1363,12 @@ void System::EventFindAndLockHandler(esim::Event *event,
 				module->getName().c_str());
 
 		// Statistics
-		module->incAccesses();
-		if (frame->retry)
-			module->incRetryAccesses();
+		if (!frame->prefetch)
+		{
+			module->incAccesses();
+			if (frame->retry)
+				module->incRetryAccesses();
+		}
 
 		// Set parent frame flag expressing that port has already been 
 		// locked. This flag is checked by new writes to find out if 
@@ -1143,6 +1392,18 @@ void System::EventFindAndLockHandler(esim::Event *event,
 					frame->set,
 					frame->way,
 					Cache::BlockStateMap[frame->state]);
+
+			// First demand access to a prefetched block
+			Cache::Block *block = cache->getBlock(frame->set,
+					frame->way);
+			if (block->isPrefetched() && !frame->prefetch &&
+					frame->request_direction ==
+					Frame::RequestDirectionUpDown)
+			{
+				block->setPrefetched(false);
+				parent_frame->prefetch_hit = true;
+				module->incUsefulPrefetches();
+			}
 		}
 
 		// If a store access hits in the cache, we can be sure
@@ -1208,6 +1469,13 @@ void System::EventFindAndLockHandler(esim::Event *event,
 			if (frame->retry)
 				module->incRetryDirectoryEntryConflicts();
 
+			// A request from a higher-level module finding a
+			// prefetch of the same block in flight
+			Frame *older_frame = module->getInFlightAddress(
+					frame->getAddress());
+			if (older_frame && !frame->prefetch)
+				module->RecordLatePrefetch(older_frame);
+
 			// Done
 			return;
 		}
@@ -1258,6 +1526,15 @@ void System::EventFindAndLockHandler(esim::Event *event,
 					frame->state);
 			assert(frame->state || !directory->isBlockSharedOrOwned(
 					frame->set, frame->way));
+
+			// Replacing a prefetched block that was never used
+			Cache::Block *block = cache->getBlock(frame->set,
+					frame->way);
+			if (block->isPrefetched())
+			{
+				block->setPrefetched(false);
+				module->incUselessPrefetches();
+			}
 			
 			// Debug
 			debug << misc::fmt("    A-%lld 0x%x %s miss -> lru: "
@@ -1277,9 +1554,13 @@ void System::EventFindAndLockHandler(esim::Event *event,
 
 		// Entry is locked. Record the transient tag so that a 
 		// subsequent lookup detects that the block is being brought.
-		// Also, update LRU counters here.
+		// Also, update the replacement state here.
 		cache->setTransientTag(frame->set, frame->way, frame->tag);
-		cache->AccessBlock(frame->set, frame->way);
+		if (frame->hit)
+			cache->AccessBlock(frame->set, frame->way);
+		else
+			cache->InsertBlock(frame->set, frame->way,
+					parent_frame->pc);
 
 		// Access latency
 		module->incDirectoryAccesses();
@@ -1321,7 +1602,7 @@ void System::EventFindAndLockHandler(esim::Event *event,
 			module->incConflictInvalidations();
 
 			// Call 'evict'
-			auto new_frame = misc::new_shared<Frame>(
+			auto new_frame = esim::new_frame<Frame>(
 					frame->getId(),
 					module,
 					0);
@@ -1470,7 +1751,7 @@ void System::EventEvictHandler(esim::Event *event,
 		frame->target_module = module->getLowModuleServingAddress(frame->tag);
 
 		// Send write request to all sharers
-		auto new_frame = misc::new_shared<Frame>(
+		auto new_frame = esim::new_frame<Frame>(
 				frame->getId(),
 				module,
 				0);
@@ -1610,7 +1891,7 @@ void System::EventEvictHandler(esim::Event *event,
 		network->Receive(node, frame->message);
 
 		// Call find-and-lock
-		auto new_frame = misc::new_shared<Frame>(
+		auto new_frame = esim::new_frame<Frame>(
 				frame->getId(),
 				target_module,
 				frame->src_tag);
@@ -1696,7 +1977,7 @@ void System::EventEvictHandler(esim::Event *event,
 					(unsigned) module->getBlockSize())
 				continue;
 
-			Directory::Entry *directory_entry = directory->getEntry(
+			const Directory::Entry *directory_entry = directory->getEntry(
 					frame->set, frame->way, z);
 			directory->clearSharer(frame->set,
 					frame->way,
@@ -1718,9 +1999,15 @@ void System::EventEvictHandler(esim::Event *event,
 		// Stats
 		target_module->incDataAccesses();
 
-		// Continue with 'evict-reply', after data latency
-		esim_engine->Next(event_evict_reply,
-				target_module->getDataLatency());
+		// Continue with 'evict-reply' after the data access. Only
+		// evictions carrying data write the block, in DRAM for
+		// DRAM-backed modules. The rest only update the directory.
+		if (frame->reply == Frame::ReplyAckData)
+			target_module->AccessData(event_evict_reply, frame->tag,
+					true, frame->source_module);
+		else
+			esim_engine->Next(event_evict_reply,
+					target_module->getDataLatency());
 		return;
 	}
 
@@ -1802,7 +2089,7 @@ void System::EventEvictHandler(esim::Event *event,
 				continue;
 
 			// Set sharer and owner
-			Directory::Entry *entry = directory->getEntry(
+			const Directory::Entry *entry = directory->getEntry(
 					frame->set,
 					frame->way,
 					z);
@@ -1826,9 +2113,15 @@ void System::EventEvictHandler(esim::Event *event,
 		// Stats
 		target_module->incDataAccesses();
 		
-		// Continue with 'evict-reply' after latency
-		esim_engine->Next(event_evict_reply,
-				target_module->getDataLatency());
+		// Continue with 'evict-reply' after the data access. Only
+		// evictions carrying data write the block, in DRAM for
+		// DRAM-backed modules. The rest only update the directory.
+		if (frame->reply == Frame::ReplyAckData)
+			target_module->AccessData(event_evict_reply, frame->tag,
+					true, frame->source_module);
+		else
+			esim_engine->Next(event_evict_reply,
+					target_module->getDataLatency());
 		return;
 	}
 
@@ -2032,7 +2325,7 @@ void System::EventWriteRequestHandler(esim::Event *event,
 		network->Receive(node, frame->message);
 		
 		// Call 'find-and-lock'
-		auto new_frame = misc::new_shared<Frame>(
+		auto new_frame = esim::new_frame<Frame>(
 				frame->getId(),
 				target_module,
 				frame->getAddress());
@@ -2098,9 +2391,17 @@ void System::EventWriteRequestHandler(esim::Event *event,
 			return;
 		}
 
+		// Train the prefetcher of the target module with up-down
+		// requests
+		if (frame->request_direction == Frame::RequestDirectionUpDown)
+			target_module->NotifyPrefetcher(frame->pc,
+					frame->getAddress(),
+					frame->state,
+					frame->prefetch_hit);
+
 		// Invalidate the rest of higher-level sharers.
 		// Call 'invalidate' event chain.
-		auto new_frame = misc::new_shared<Frame>(
+		auto new_frame = esim::new_frame<Frame>(
 				frame->getId(),
 				target_module,
 				frame->getAddress());
@@ -2176,7 +2477,7 @@ void System::EventWriteRequestHandler(esim::Event *event,
 		case Cache::BlockInvalid:
 		case Cache::BlockNonCoherent:
 		{
-			auto new_frame = misc::new_shared<Frame>(
+			auto new_frame = esim::new_frame<Frame>(
 					frame->getId(),
 					target_module,
 					frame->tag);
@@ -2263,7 +2564,7 @@ void System::EventWriteRequestHandler(esim::Event *event,
 
 			// Set sharer and owner
 			int index = module->getLowNetworkNode()->getIndex();
-			Directory::Entry *entry = target_directory->getEntry(
+			const Directory::Entry *entry = target_directory->getEntry(
 					frame->set,
 					frame->way,
 					z);
@@ -2284,6 +2585,8 @@ void System::EventWriteRequestHandler(esim::Event *event,
 				frame->way,
 				frame->tag,
 				Cache::BlockExclusive);
+		if (!frame->state)
+			target_module->NotifyPrefetcherFill(frame->tag, false);
 
 		// If blocks were sent directly to the peer, the reply size 
 		// would have been decreased.  Based on the final size, we can
@@ -2304,8 +2607,8 @@ void System::EventWriteRequestHandler(esim::Event *event,
 		target_module->incDataAccesses();
 
 		// Continue with 'write-request-reply' after data latency
-		esim_engine->Next(event_write_request_reply,
-				target_module->getDataLatency());
+		target_module->AccessData(event_write_request_reply,
+				frame->tag, false, frame->source_module);
 		return;
 	}
 
@@ -2632,7 +2935,7 @@ void System::EventReadRequestHandler(esim::Event *event,
 		// only need to hit and not have ownership.  We would never 
 		// cross paths with a request coming down-up because we would
 		// hit before that.
-		auto new_frame = misc::new_shared<Frame>(
+		auto new_frame = esim::new_frame<Frame>(
 				frame->getId(),
 				target_module,
 				frame->getAddress());
@@ -2694,6 +2997,14 @@ void System::EventReadRequestHandler(esim::Event *event,
 			return;
 		}
 
+		// Train the prefetcher of the target module with up-down
+		// requests
+		if (frame->request_direction == Frame::RequestDirectionUpDown)
+			target_module->NotifyPrefetcher(frame->pc,
+					frame->getAddress(),
+					frame->state,
+					frame->prefetch_hit);
+
 		// Continue with 'read-request-updown' or 'read-request-downup'
 		esim_engine->Next(frame->request_direction == Frame::RequestDirectionUpDown ?
 				event_read_request_updown :
@@ -2741,7 +3052,7 @@ void System::EventReadRequestHandler(esim::Event *event,
 				assert(directory_entry_tag < frame->tag + (unsigned) target_module->getBlockSize());
 
 				// Get directory entry
-				Directory::Entry *directory_entry = directory->getEntry(
+				const Directory::Entry *directory_entry = directory->getEntry(
 						frame->set,
 						frame->way,
 						z);
@@ -2769,7 +3080,7 @@ void System::EventReadRequestHandler(esim::Event *event,
 				frame->pending++;
 
 				// Call 'read-request'
-				auto new_frame = misc::new_shared<Frame>(
+				auto new_frame = esim::new_frame<Frame>(
 						frame->getId(),
 						target_module,
 						directory_entry_tag);
@@ -2790,7 +3101,7 @@ void System::EventReadRequestHandler(esim::Event *event,
 			assert(!directory->isBlockSharedOrOwned(frame->set, frame->way));
 
 			// Call 'read-request'
-			auto new_frame = misc::new_shared<Frame>(
+			auto new_frame = esim::new_frame<Frame>(
 					frame->getId(),
 					target_module,
 					frame->tag);
@@ -2846,6 +3157,7 @@ void System::EventReadRequestHandler(esim::Event *event,
 				frame->way,
 				frame->tag,
 				frame->shared ? Cache::BlockShared : Cache::BlockExclusive);
+		target_module->NotifyPrefetcherFill(frame->tag, false);
 
 		// Continue with 'read-request-updown-finish'
 		esim_engine->Next(event_read_request_updown_finish);
@@ -2905,7 +3217,7 @@ void System::EventReadRequestHandler(esim::Event *event,
 			// the module.
 			for (int z = 0; z < directory->getNumSubBlocks(); z++)
 			{
-				Directory::Entry *entry = directory->getEntry(
+				const Directory::Entry *entry = directory->getEntry(
 						frame->set,
 						frame->way,
 						z);
@@ -2927,7 +3239,7 @@ void System::EventReadRequestHandler(esim::Event *event,
 					+ (unsigned) module->getBlockSize())
 				continue;
 			
-			Directory::Entry *entry = directory->getEntry(frame->set,
+			const Directory::Entry *entry = directory->getEntry(frame->set,
 					frame->way,
 					z);
 			directory->setSharer(frame->set,
@@ -2978,8 +3290,8 @@ void System::EventReadRequestHandler(esim::Event *event,
 		target_module->incDataAccesses();
 
 		// Continue with 'read-request-reply' after latency
-		esim_engine->Next(event_read_request_reply,
-				target_module->getDataLatency());
+		target_module->AccessData(event_read_request_reply,
+				frame->tag, false, frame->source_module);
 		return;
 	}
 
@@ -3012,7 +3324,7 @@ void System::EventReadRequestHandler(esim::Event *event,
 					z * (unsigned) target_module->getSubBlockSize();
 			assert(directory_entry_tag < frame->tag +
 					(unsigned) target_module->getBlockSize());
-			Directory::Entry *entry = target_directory->getEntry(
+			const Directory::Entry *entry = target_directory->getEntry(
 					frame->set,
 					frame->way,
 					z);
@@ -3035,7 +3347,7 @@ void System::EventReadRequestHandler(esim::Event *event,
 			frame->pending++;
 
 			// Call 'read-request'
-			auto new_frame = misc::new_shared<Frame>(
+			auto new_frame = esim::new_frame<Frame>(
 					frame->getId(),
 					target_module,
 					directory_entry_tag);
@@ -3333,7 +3645,7 @@ void System::EventInvalidateHandler(esim::Event *event,
 				continue;
 
 			// Get the directory entry
-			Directory::Entry *directory_entry = directory->getEntry(
+			const Directory::Entry *directory_entry = directory->getEntry(
 					frame->set, frame->way, z);
 
 			// Process all the high level modules connected to it
@@ -3374,7 +3686,7 @@ void System::EventInvalidateHandler(esim::Event *event,
 				frame->pending++;
 
 				// Send write request upwards if beginning of block
-				auto new_frame = misc::new_shared<Frame>(
+				auto new_frame = esim::new_frame<Frame>(
 						frame->getId(),
 						module,
 						directory_entry_tag);
@@ -3530,7 +3842,7 @@ void System::EventMessageHandler(esim::Event *event,
 		network->Receive(node, frame->message);
 
 		// Find and lock
-		auto new_frame = misc::new_shared<Frame>(
+		auto new_frame = esim::new_frame<Frame>(
 					frame->getId(),
 					target_module,
 					frame->getAddress());
@@ -3580,11 +3892,9 @@ void System::EventMessageHandler(esim::Event *event,
 						target_module->getNumSubBlocks())
 				{
 					// Clear the owner
-					Directory::Entry *dir_entry = 
-							target_directory->
-							getEntry(frame->set, 
-							frame->way, z);
-					dir_entry->setOwner(-1);
+					target_directory->setOwner(frame->set,
+							frame->way, z,
+							Directory::NoOwner);
 				}
 
 			}
@@ -3828,7 +4138,7 @@ void System::EventLocalLoadHandler(esim::Event *event,
 		}
 
 		// Call "find_and_lock" event chain
-		auto new_frame = misc::new_shared<Frame>(
+		auto new_frame = esim::new_frame<Frame>(
 				frame->getId(),
 				module,
 				frame->getAddress());
@@ -3973,7 +4283,7 @@ void System::EventLocalStoreHandler(esim::Event *event,
 		}
 
 		// Call 'find-and-lock'
-		auto new_frame = misc::new_shared<Frame>(
+		auto new_frame = esim::new_frame<Frame>(
 				frame->getId(),
 				module,
 				frame->getAddress());
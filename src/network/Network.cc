@@ -119,6 +119,9 @@ void Network::ParseConfiguration(misc::IniFile *config,
 				"negative.\n%s", config->getPath().c_str(),
 				name.c_str(), System::err_config_note));
 
+	// Parse the configuration file for a generated topology
+	ParseConfigurationForTopology(config);
+
 	// Parse the configure file for nodes
 	ParseConfigurationForNodes(config);
 
@@ -134,9 +137,19 @@ void Network::ParseConfiguration(misc::IniFile *config,
 	// Time to create the initial routing table
 	routing_table.Initialize();
 
+	// A generated topology sets the routes between its end nodes on top
+	// of the shortest paths. Manual routes can still override them.
+	if (topology)
+	{
+		routing_table.ShortestPaths();
+		topology->UpdateRoutes(&routing_table);
+		routing_table.UpdateManualRoutingCost();
+		ParseConfigurationForRoutes(config);
+	}
+
 	// Parse the routing elements, for manual routing.
-	if (!ParseConfigurationForRoutes(config))
-		routing_table.FloydWarshall();
+	else if (!ParseConfigurationForRoutes(config))
+		routing_table.ShortestPaths();
 
 	// If the network with current routing contains a cycle, warn
 	if (routing_table.hasCycle())
@@ -146,6 +159,43 @@ void Network::ParseConfiguration(misc::IniFile *config,
 }
 
 
+void Network::ParseConfigurationForTopology(misc::IniFile *ini_file)
+{
+	for (int i = 0; i < ini_file->getNumSections(); i++)
+	{
+		std::string section = ini_file->getSection(i);
+
+		// Tokenize section name
+		std::vector<std::string> tokens;
+		misc::StringTokenize(section, tokens, ".");
+
+		// Check section name
+		if (tokens.size() != 3)
+			continue;
+		if (strcasecmp(tokens[0].c_str(), "Network"))
+			continue;
+		if (strcasecmp(tokens[1].c_str(), name.c_str()))
+			continue;
+		if (strcasecmp(tokens[2].c_str(), "Topology"))
+			continue;
+
+		// Create switches, end nodes, and links
+		topology = misc::new_unique<Topology>(this, ini_file, section);
+		topology->Generate();
+	}
+}
+
+
+int Network::getMinEndNodeBufferSize() const
+{
+	if (packet_size != 0)
+		return ((System::getMessageSize() - 1) / packet_size + 1) *
+				packet_size;
+	else
+		return System::getMessageSize();
+}
+
+
 void Network::ParseConfigurationForNodes(misc::IniFile *config)
 {
 	for (int i = 0; i < config->getNumSections(); i++)
@@ -201,17 +251,7 @@ void Network::ParseConfigurationForNodes(misc::IniFile *config)
 		{
 			// End-node should be able to contain an entire msg
 			// or equivalent number of packets for that message.
-			int required_buffer_size = 0;
-
-			if (packet_size != 0)
-				required_buffer_size =
-						(((System::getMessageSize() - 1) 
-						/ packet_size + 1) *
-						packet_size);
-			else
-				required_buffer_size =
-						System::getMessageSize();
-
+			int required_buffer_size = getMinEndNodeBufferSize();
 			if (input_buffer_size < required_buffer_size ||
 					output_buffer_size < required_buffer_size)
 				throw Error(misc::fmt("%s: Buffer size on the " 
@@ -953,7 +993,7 @@ Message *Network::Send(EndNode *source_node,
 				packet->getId(), message->getId());
 		
 		// Create event frame
-		auto frame = misc::new_shared<Frame>(packet);
+		auto frame = esim::new_frame<Frame>(packet);
 
 		// The packet will be received automatically if the user didn't
 		// pass any receive event
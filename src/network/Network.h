@@ -33,6 +33,7 @@
 #include "Node.h"
 #include "RoutingTable.h"
 #include "System.h"
+#include "Topology.h"
 
 namespace net
 {
@@ -72,6 +73,13 @@ class Network
 	// Routing table
 	RoutingTable routing_table;
 
+	// Generated topology, if any
+	std::unique_ptr<Topology> topology;
+
+	// Parse the config file to generate the topology of the network, if
+	// given in a section '[ Network.<name>.Topology ]'
+	void ParseConfigurationForTopology(misc::IniFile *ini_file);
+
 	// Parse the config file to add all the nodes belongs to the network
 	void ParseConfigurationForNodes(misc::IniFile *ini_file);
 
@@ -172,6 +180,30 @@ public:
 	/// Get packet size
 	int getPacketSize() const { return packet_size; }
 
+	/// Get the default input buffer size
+	int getDefaultInputBufferSize() const
+	{
+		return default_input_buffer_size;
+	}
+
+	/// Get the default output buffer size
+	int getDefaultOutputBufferSize() const
+	{
+		return default_output_buffer_size;
+	}
+
+	/// Get the default bandwidth
+	int getDefaultBandwidth() const { return default_bandwidth; }
+
+	/// Return the minimum size of the buffers of an end node, which should
+	/// be able to contain an entire message, or all the packets of the
+	/// message if packets are used.
+	int getMinEndNodeBufferSize() const;
+
+	/// Return the topology generated from the configuration file, or
+	/// nullptr if the network did not use one.
+	Topology *getTopology() const { return topology.get(); }
+
 	/// Get the condition of the network, to see if it is
 	/// and ideal network with a fix latency or not.
 	///
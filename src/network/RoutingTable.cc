@@ -17,13 +17,17 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
 #include <climits>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <set>
+#include <unordered_set>
 
 #include <lib/cpp/Error.h>
 
+#include "EndNode.h"
 #include "Node.h"
 #include "Network.h"
 #include "RoutingTable.h"
@@ -52,20 +56,23 @@ void RoutingTable::Initialize()
 	dimension = network->getNumNodes();
 
 	// Initiate table with infinite costs
+	entries.reserve((size_t) dimension * dimension);
 	for (int i = 0; i < dimension; i++)
 	{
 		for (int j = 0; j < dimension; j++)
 		{
-			entries.emplace_back(misc::new_unique<Entry>(
-					i == j ? 0 : dimension, 
-					nullptr, nullptr));
+			entries.emplace_back(i == j ? 0 : dimension,
+					nullptr, nullptr);
 		}
 	}
 
-	// Set 1-hop connections
+	// Set 1-hop connections, and build the adjacency lists with the
+	// first output buffer that reaches each neighbor
+	adjacency_offsets.resize(dimension + 1);
 	for (int i = 0; i < dimension; i++)
 	{
 		Node *node = network->getNode(i);
+		adjacency_offsets[i] = adjacency_nodes.size();
 		for (int j = 0; j < node->getNumOutputBuffers(); j++)
 		{
 			Buffer *source_buffer = node->getOutputBuffer(j);
@@ -80,6 +87,13 @@ void RoutingTable::Initialize()
 				if (node != dst_node)
 				{
 					Entry* entry = Lookup(node, dst_node);
+					if (!entry->getNextNode())
+					{
+						adjacency_nodes.push_back(
+								dst_node->getIndex());
+						adjacency_buffers.push_back(
+								source_buffer);
+					}
 					entry->cost = 1;
 					entry->setNextNode(dst_node);
 					entry->setBuffer(source_buffer);
@@ -87,93 +101,99 @@ void RoutingTable::Initialize()
 			}
 		}
 	}
+	adjacency_offsets[dimension] = adjacency_nodes.size();
+
+	// No manual routes yet
+	dirty_destinations.assign(dimension, false);
 }
 
 
-void RoutingTable::FloydWarshall()
+void RoutingTable::ShortestPaths()
 {
-	// The entry->next_node values do not necessarily point
-	// to the immediate next hop after this.
-	for (int k = 0; k < dimension; k++)
+	// Queue of nodes to visit, distance from the source to each node, and
+	// position in the adjacency lists of the first hop to reach each node
+	std::vector<int> queue(dimension);
+	std::vector<int> distances(dimension);
+	std::vector<int> first_hops(dimension);
+
+	// Among all shortest paths to a node, the lowest possible index of
+	// the highest intermediate node, or -1 for the neighbors of the
+	// source. Routes with the same cost are broken as the Floyd-Warshall
+	// algorithm did: it considers intermediate nodes in increasing order
+	// of index and only replaces a route by a strictly shorter one, so
+	// it routes through this node, and takes the first hop of the route
+	// to it.
+	std::vector<int> intermediates(dimension);
+
+	// Breadth-first search from every source node
+	for (int source = 0; source < dimension; source++)
 	{
-		for (int i = 0; i < dimension; i++)
+		// Start with the source node only
+		std::fill(distances.begin(), distances.end(), -1);
+		distances[source] = 0;
+		int head = 0;
+		int tail = 0;
+		queue[tail++] = source;
+
+		// Visit nodes in order of distance. All nodes at a shorter
+		// distance have been visited when a node is taken from the
+		// queue, so its intermediate node is final at that point.
+		while (head < tail)
 		{
-			for (int j = 0; j < dimension; j++)
+			int node = queue[head++];
+			int intermediate = node == source ? -1 :
+					std::max(intermediates[node], node);
+			for (int edge = adjacency_offsets[node];
+					edge < adjacency_offsets[node + 1];
+					edge++)
 			{
-				Node *node_i = network->getNode(i);
-				Node *node_j = network->getNode(j);
-				Node *node_k = network->getNode(k);
-
-				Entry *entry_i_k = Lookup(node_i,node_k);
-				Entry *entry_k_j = Lookup(node_k,node_j);
-				Entry *entry_i_j = Lookup(node_i,node_j);
-
-				int temp_cost = entry_i_k->cost +
-						entry_k_j->cost;
-				if (entry_i_j->cost > temp_cost)
+				int neighbor = adjacency_nodes[edge];
+				if (distances[neighbor] < 0)
+				{
+					distances[neighbor] = distances[node] + 1;
+					intermediates[neighbor] = intermediate;
+					queue[tail++] = neighbor;
+					if (node == source)
+						first_hops[neighbor] = edge;
+				}
+				else if (distances[neighbor] ==
+						distances[node] + 1)
 				{
-					entry_i_j->cost = temp_cost;
-					entry_i_j->setNextNode(node_k);
+					intermediates[neighbor] = std::min(
+							intermediates[neighbor],
+							intermediate);
 				}
 			}
 		}
-	}
 
-	// Calculating the output buffer for the entry.
-	Node *next_node = nullptr;
-	Entry *entry = nullptr;
-	for (int i = 0; i < dimension; i++)
-	{
-		for (int j = 0; j < dimension; j++)
+		// Resolve first hops in order of distance, since the
+		// intermediate node of each node is always closer to the source
+		for (int i = 1; i < tail; i++)
 		{
+			int node = queue[i];
+			if (distances[node] > 1)
+				first_hops[node] = first_hops[intermediates[node]];
+		}
 
-			Node *node_i = network->getNode(i);
-			Node *node_j = network->getNode(j);
-
-			auto entry_i_j = Lookup(node_i, node_j);
-			next_node = entry_i_j->getNextNode();
-
-			if (!next_node)
+		// Fill in the row of the table for the source node. Entries of
+		// unreachable destinations keep an infinite cost.
+		Entry *row = &entries[(size_t) source * dimension];
+		for (int destination = 0; destination < dimension;
+				destination++)
+		{
+			Entry *entry = &row[destination];
+			if (destination == source || distances[destination] < 0)
 			{
-				entry_i_j->setBuffer(nullptr);
+				entry->setNextNode(nullptr);
+				entry->setBuffer(nullptr);
 				continue;
 			}
 
-			// Follow the buffers path
-			for (;;)
-			{
-				entry = Lookup(node_i, next_node);
-				if (entry->cost <= 1)
-					break;
-				next_node = entry->getNextNode();
-			}
-
-			// Get the output buffer based on the next node
-			for (int k = 0; k < node_i->getNumOutputBuffers(); k++)
-			{
-				Buffer *buffer = node_i->getOutputBuffer(k);
-				bool found = false;
-				Connection *connection = buffer->getConnection();
-				for (int m = 0; m < connection->
-						getNumDestinationBuffers(); 
-						m++)
-				{
-					Buffer *destination_buffer = 
-						connection->
-						getDestinationBuffer(m);
-					Node *receive_node = 
-							destination_buffer->
-							getNode();
-					if (next_node != receive_node)
-						continue;
-					entry_i_j->setNextNode(receive_node);
-					entry_i_j->setBuffer(buffer);
-					found = true;
-					break;
-				}
-				if (found)
-					break;
-			}
+			int edge = first_hops[destination];
+			entry->cost = distances[destination];
+			entry->setNextNode(network->getNode(
+					adjacency_nodes[edge]));
+			entry->setBuffer(adjacency_buffers[edge]);
 		}
 	}
 }
@@ -188,6 +208,25 @@ bool RoutingTable::hasCycle()
 	// the graph
 	std::unordered_map<Buffer *, misc::Vertex *> buffer_to_vertex;
 
+	// Find the output buffers that play a role in the routing table.
+	// Messages are only sent to end nodes, so the routes to switches are
+	// never followed and cannot cause a deadlock.
+	std::unordered_set<Buffer *> routing_buffers;
+	for (int source_id = 0; source_id < dimension; source_id++)
+	{
+		for (int destination_id = 0; destination_id < dimension;
+				destination_id++)
+		{
+			if (!dynamic_cast<EndNode *>(network->getNode(
+					destination_id)))
+				continue;
+			Buffer *buffer = entries[source_id * dimension +
+					destination_id].getBuffer();
+			if (buffer)
+				routing_buffers.insert(buffer);
+		}
+	}
+
 	// For every output buffer that plays a role in routing table
 	for (int node_id = 0; node_id < dimension; node_id++)
 	{
@@ -202,52 +241,30 @@ bool RoutingTable::hasCycle()
 			// Get the output buffer from the list in the node 
 			Buffer *output_buffer = node->getOutputBuffer(
 					buffer_id);
+			if (!routing_buffers.count(output_buffer))
+				continue;
 
-			// Find the buffer in the routing table
-			for (int destination_node_id = 0; 
-					destination_node_id < dimension;
-					destination_node_id++)
-			{
-				// Get the destination node
-				Node *destination_node = network->getNode(
-					destination_node_id);
-
-				// Look up the routing table
-				Entry *entry = Lookup(node, destination_node);
-
-				// Check if the current output buffer is the 
-				// path between the two nodes
-				if (output_buffer == entry->getBuffer())
-				{
-					// This means the buffer is involved 
-					// in the graph and might be part of 
-					// a deadlock scenario. So we create
-					// a vertex for it
-					graph->addVertex(misc::new_unique<
-							misc::Vertex>
-							(output_buffer->getName().
-							c_str()));
-
-					// Get the vertex which is the last
-					// vertex in the vertices list
-					misc::Vertex *vertex = graph->getVertex(
-							graph->getNumVertices() - 1);
-
-					// Map the vertex with the buffer for
-					// future easy reference
-					buffer_to_vertex.insert(std::make_pair(
-							output_buffer,
-							vertex));
-					
-					// We break from the for look and move
-					// on to the next buffer since we
-					// already find the buffer in the table
-					break;
-				}
-			}
+			// This means the buffer is involved in the graph and
+			// might be part of a deadlock scenario. So we create a
+			// vertex for it
+			graph->addVertex(misc::new_unique<misc::Vertex>(
+					output_buffer->getName().c_str()));
+
+			// Get the vertex which is the last vertex in the
+			// vertices list
+			misc::Vertex *vertex = graph->getVertex(
+					graph->getNumVertices() - 1);
+
+			// Map the vertex with the buffer for future easy
+			// reference
+			buffer_to_vertex.insert(std::make_pair(output_buffer,
+					vertex));
 		} 
 	}
 
+	// Edges already added to the graph
+	std::set<std::pair<misc::Vertex *, misc::Vertex *>> graph_edges;
+
 	// For every source node
 	for (int source_id = 0; source_id < dimension; source_id++)
 	{
@@ -262,8 +279,11 @@ bool RoutingTable::hasCycle()
 			Node *destination_node = network->getNode(
 					destination_id);
 
-			// If the source and destination are the same, continue
-			if (source_node == destination_node)
+			// If the source and destination are the same, or the
+			// destination is not an end node, continue
+			if (source_node == destination_node ||
+					!dynamic_cast<EndNode *>(
+					destination_node))
 				continue;
 
 			// Find the entry in the routing table
@@ -307,8 +327,10 @@ bool RoutingTable::hasCycle()
 							buffer_to_vertex.end());
 
 					// First see if the edge exists
-					if (!graph->findEdge(source_vertex_it->second,
-						destination_vertex_it->second))
+					if (graph_edges.insert(std::make_pair(
+							source_vertex_it->second,
+							destination_vertex_it->second))
+							.second)
 					{
 						// Add an edge to the graph based 
 						// on the source and the destination 
@@ -339,14 +361,24 @@ bool RoutingTable::hasCycle()
 
 
 RoutingTable::Entry *RoutingTable::Lookup(Node *source,
+		Node *destination)
+{
+	int i = source->getIndex();
+	int j = destination->getIndex();
+	assert((dimension > 0) && (i < dimension) && (j < dimension));
+
+	return &entries[(size_t) i * dimension + j];
+}
+
+
+const RoutingTable::Entry *RoutingTable::Lookup(Node *source,
 		Node *destination) const
 {
 	int i = source->getIndex();
 	int j = destination->getIndex();
 	assert((dimension > 0) && (i < dimension) && (j < dimension));
 
-	int location = i * dimension + j;
-	return entries.at(location).get();
+	return &entries[(size_t) i * dimension + j];
 }
 
 
@@ -370,7 +402,8 @@ void RoutingTable::Dump(std::ostream &os) const
 			unsigned int entry_text_size = 0;
 
 			// Get the entry of the table
-			Entry *entry = Lookup(node_i, network->getNode(j));
+			const Entry *entry = Lookup(node_i,
+					network->getNode(j));
 
 			// Get the string size of the members that
 			// will be printed, and add them up
@@ -457,7 +490,7 @@ void RoutingTable::Dump(std::ostream &os) const
 		for (int j = 0; j < dimension; j++)
 		{
 			Node *node_j = network->getNode(j);
-			Entry *entry = Lookup(node_i,node_j);
+			const Entry *entry = Lookup(node_i,node_j);
 
 			// First we have to create the string that will be
 			// printed for each element:
@@ -518,6 +551,9 @@ void RoutingTable::UpdateRoute(Node *source, Node *destination,
 	// Setting the next node
 	entry->setNextNode(next);
 
+	// The cost of the routes to the destination must be recomputed
+	dirty_destinations[destination->getIndex()] = true;
+
 	// Exit strategy from the nested loop
 	bool route_updated = false;
 
@@ -614,58 +650,61 @@ void RoutingTable::DumpRoutes(const std::string &path)
 	Dump(f);
 }
 
-void RoutingTable::UpdateManualRoutingCost()
+int RoutingTable::UpdateManualRoutingCost(int source,
+		int destination,
+		std::vector<char> &state)
 {
-	// For every entry in the 2D routing table
-	for (int i = 0; i < dimension; i++)
-	{
-		for(int j = 0; j < dimension; j++)
-		{
-			// Get the dimensions of the entry
-			Node *source = network->getNode(i);
-			Node *destination = network->getNode(j);
+	// Cost already computed
+	Entry *entry = &entries[(size_t) source * dimension + destination];
+	if (state[source] == 2)
+		return entry->cost;
 
-			// Lookup the entry
-			Entry *entry = Lookup(source, destination);
-
-			// Get the next node
-			Node *next = entry->getNextNode();
+	// Route-steps going back to a node in the path
+	if (state[source] == 1)
+		throw Error(misc::fmt("Network %s: route %s.to.%s: "
+				"routing loop\n",
+				network->getName().c_str(),
+				network->getNode(source)->getName().c_str(),
+				network->getNode(destination)->getName().c_str()));
+	state[source] = 1;
+
+	// The cost of the first step in the route is 1, since route-steps
+	// always lead to a neighbor. Add the cost of the rest of the path,
+	// unless the path is missing a step. No error is reported in that
+	// case since the route steps can overlap.
+	int next = entry->getNextNode()->getIndex();
+	int cost = 1;
+	if (next != destination &&
+			entries[(size_t) next * dimension + destination].
+			getNextNode())
+		cost += UpdateManualRoutingCost(next, destination, state);
+
+	// Done
+	entry->cost = cost;
+	state[source] = 2;
+	return cost;
+}
 
-			// If the entry has a next node we have to update
-			// the cost
-			if (next)
-			{
-				// The cost of the first step in the route
-				entry->cost = Lookup(source, next)->cost;
 
-				// Traverse through the path
-				for(;;)
-				{
-					// We reached end of the path
-					if (next == destination)
-						break;
-
-					// Get the next element in the path
-					Node *path_entry = Lookup(next, 
-							destination)->getNextNode();
-
-					// If there is a missing link just break
-					// No error is reported since the
-					// route steps can overlap
-					if (!path_entry)
-						break;
-
-					// Update the cost one step at a time
-					// The entry cost here should already
-					// been 1.
-					entry->cost += Lookup(next, path_entry)->cost;
-
-					// We set the update the next, to 
-					// become next in path
-					next = path_entry;
-				}
-			}
-		}
+void RoutingTable::UpdateManualRoutingCost()
+{
+	// Only the costs of routes to destinations with updated route-steps
+	// can change
+	std::vector<char> state(dimension);
+	for (int j = 0; j < dimension; j++)
+	{
+		// Skip destinations with no updated routes
+		if (!dirty_destinations[j])
+			continue;
+		dirty_destinations[j] = false;
+
+		// Update the costs of all entries with a next node, walking
+		// each path once
+		std::fill(state.begin(), state.end(), 0);
+		for (int i = 0; i < dimension; i++)
+			if (i != j && entries[(size_t) i * dimension + j].
+					getNextNode())
+				UpdateManualRoutingCost(i, j, state);
 	}
 }
 
@@ -20,8 +20,8 @@
 #ifndef NETWORK_ROUTINGTABLE_H
 #define NETWORK_ROUTINGTABLE_H
 
+#include <iostream>
 #include <vector>
-#include <memory>
 
 namespace net
 {
@@ -82,8 +82,30 @@ private:
 	// Dimension
 	int dimension = 0;
 
-	// Entries
-	std::vector<std::unique_ptr<Entry>> entries;
+	// Entries, stored as a flat matrix indexed by source node index
+	// times dimension plus destination node index
+	std::vector<Entry> entries;
+
+	// Adjacency lists of the network in compressed sparse row format.
+	// The neighbors of node i are found in positions adjacency_offsets[i]
+	// to adjacency_offsets[i + 1] - 1 of vectors adjacency_nodes (node
+	// index) and adjacency_buffers (first output buffer of node i
+	// reaching the neighbor).
+	std::vector<int> adjacency_offsets;
+	std::vector<int> adjacency_nodes;
+	std::vector<Buffer *> adjacency_buffers;
+
+	// Destinations whose manual routes changed since the last call to
+	// UpdateManualRoutingCost(), indexed by node index
+	std::vector<bool> dirty_destinations;
+
+	// Compute the cost of the manual route from a source to a destination
+	// whose route-steps are already set, memoizing the costs of all
+	// entries on the path. Vector 'state' is indexed by source node
+	// index, and marks entries in progress (1) and done (2).
+	int UpdateManualRoutingCost(int source,
+			int destination,
+			std::vector<char> &state);
 
 public:
 
@@ -98,11 +120,18 @@ public:
 	/// the table structures.
 	void Initialize();
 
-	/// Perform a Floyd-Warshall to find the best routes
-	void FloydWarshall();
+	/// Find the routes with the minimum number of hops between every pair
+	/// of nodes, running a breadth-first search from each source node
+	/// over the adjacency lists of the network. Among routes with the
+	/// same number of hops, the same one is chosen as with the
+	/// Floyd-Warshall algorithm.
+	void ShortestPaths();
 
 	/// Look up the entry from a certain node to a certain node
-	Entry *Lookup(Node *source, Node *destination) const;
+	Entry *Lookup(Node *source, Node *destination);
+
+	/// Look up the entry from a certain node to a certain node
+	const Entry *Lookup(Node *source, Node *destination) const;
 
 	/// Generating the route file
 	void DumpRoutes(const std::string &path);
@@ -110,7 +139,9 @@ public:
 	/// Dump Routing table information.
 	void Dump(std::ostream &os = std::cout) const;
 
-	/// Check if the routing table has cycle
+	/// Check if the routes to end nodes in the routing table form a cycle
+	/// of dependencies between output buffers, which could cause a
+	/// deadlock.
 	bool hasCycle();
 
 	/// Update a route manually. This function is used for adding route-steps.
@@ -138,7 +169,12 @@ public:
 			int virtual_channel);
 
 	/// Update the cost of the paths in the routing table based on 
-	/// all the routes that are created
+	/// all the routes that are created. Only the entries for destinations
+	/// with route-steps updated since the last call are recomputed.
+	///
+	/// \throw
+	///	An Error is thrown if the route-steps to a destination form a
+	///	loop.
 	void UpdateManualRoutingCost();
 
 };
@@ -71,6 +71,56 @@ const std::string System::help_message =
 		"      the network topology. The ideal option still requires a\n"
 		"      network to connect the end-nodes to each other\n"
 		"\n"
+		"Section '[ Network.<network>.Topology ]' can be used (Optional)\n"
+		"to generate a regular topology of switches, end nodes, and\n"
+		"bidirectional links when the network is loaded, together with its\n"
+		"routes between end nodes. Additional nodes, links, and routes can\n"
+		"still be given in the sections below. End nodes are named\n"
+		"'n<i>', numbered consecutively across the switches they are\n"
+		"attached to.\n"
+		"\n"
+		"  Type = {Mesh|Torus|FatTree|Dragonfly} (Required)\n"
+		"      Mesh and Torus. Switches 's<i>' are arranged in a grid with\n"
+		"          the first dimension varying fastest, and connected to\n"
+		"          their neighbors in each dimension. In a torus, the last\n"
+		"          switch of each row is also connected to the first.\n"
+		"          Packets use dimension-order routes, taking the\n"
+		"          shortest way around the rings of a torus.\n"
+		"      FatTree. A k-ary n-tree with n levels of k^(n-1) switches\n"
+		"          's<level>_<i>' and k^n end nodes, k per leaf switch.\n"
+		"          Packets go up to a nearest common ancestor, choosing\n"
+		"          the upper switch based on the destination, and down.\n"
+		"      Dragonfly. Groups of routers 's<group>_<i>' fully connected\n"
+		"          by local links, with one global link between each pair\n"
+		"          of groups. Packets use minimal routes of at most one\n"
+		"          local, one global, and one local hop.\n"
+		"  Dims = <size>x<size>[x<size>...] (Required for Mesh and Torus)\n"
+		"      Number of switches in each dimension, e.g., 16x16.\n"
+		"  Concentration = <num> (Default = 1)\n"
+		"      Number of end nodes attached to each switch of a mesh or\n"
+		"      torus, or to each router of a dragonfly.\n"
+		"  Arity = <k> (Required for FatTree)\n"
+		"      Number of children of each fat tree switch.\n"
+		"  Levels = <n> (Required for FatTree)\n"
+		"      Number of levels of switches of the fat tree.\n"
+		"  RoutersPerGroup = <num> (Required for Dragonfly)\n"
+		"      Number of routers in each dragonfly group.\n"
+		"  GlobalLinks = <num> (Required for Dragonfly)\n"
+		"      Number of global links of each dragonfly router.\n"
+		"  Groups = <num> (Default = RoutersPerGroup * GlobalLinks + 1)\n"
+		"      Number of dragonfly groups, at most the default value.\n"
+		"  InputBufferSize = <size> (Default = <network>.DefaultInputBufferSize)\n"
+		"      Size of the input buffers of nodes and links.\n"
+		"  OutputBufferSize = <size> (Default = <network>.DefaultOutputBufferSize)\n"
+		"      Size of the output buffers of nodes and links.\n"
+		"  Bandwidth = <bandwidth> (Default = <network>.DefaultBandwidth)\n"
+		"      Bandwidth of switches and links.\n"
+		"  VC = <virtual channels> (Default = 2 for Torus and Dragonfly,\n"
+		"      1 otherwise)\n"
+		"      Number of virtual channels of links between switches. With\n"
+		"      at least 2, the routes of tori and dragonflies change virtual\n"
+		"      channel along the way so that they are free of deadlock.\n"
+		"\n"
 		"Sections '[ Network.<network>.Node.<node> ]' are used to \n"
 		"define nodes in network '<network>'.\n"
 		"\n"
@@ -0,0 +1,574 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+
+#include "EndNode.h"
+#include "Network.h"
+#include "RoutingTable.h"
+#include "Switch.h"
+#include "System.h"
+#include "Topology.h"
+
+
+namespace net
+{
+
+misc::StringMap Topology::TypeMap =
+{
+	{ "Invalid", TypeInvalid },
+	{ "Mesh", TypeMesh },
+	{ "Torus", TypeTorus },
+	{ "FatTree", TypeFatTree },
+	{ "Dragonfly", TypeDragonfly }
+};
+
+
+Topology::Topology(Network *network,
+		misc::IniFile *ini_file,
+		const std::string &section) :
+		network(network)
+{
+	// Type of topology
+	type = (Type) ini_file->ReadEnum(section, "Type", TypeMap,
+			TypeInvalid);
+	ini_file->Enforce(section, "Type");
+	if (type == TypeInvalid)
+		throw Error(misc::fmt("%s: %s: Invalid topology type.\n%s",
+				ini_file->getPath().c_str(),
+				section.c_str(),
+				System::err_config_note));
+
+	// Number of switches and end nodes, used to check that the topology
+	// is not too large
+	long long num_switches = 0;
+	long long num_end_nodes = 0;
+
+	// Parameters of each type of topology
+	if (type == TypeMesh || type == TypeTorus)
+	{
+		// Dimensions
+		ini_file->Enforce(section, "Dims");
+		std::string dims = ini_file->ReadString(section, "Dims");
+		std::vector<std::string> tokens;
+		misc::StringTokenize(dims, tokens, "xX");
+		num_switches = 1;
+		for (const std::string &token : tokens)
+		{
+			misc::StringError error;
+			int size = misc::StringToInt(token, error);
+			if (error || size < 1)
+				throw Error(misc::fmt("%s: %s: Invalid value "
+						"'%s' for variable 'Dims'.\n%s",
+						ini_file->getPath().c_str(),
+						section.c_str(),
+						dims.c_str(),
+						System::err_config_note));
+			dimensions.push_back(size);
+			num_switches = std::min(num_switches * size,
+					(long long) INT_MAX);
+		}
+		if (dimensions.empty())
+			throw Error(misc::fmt("%s: %s: Invalid value '%s' for "
+					"variable 'Dims'.\n%s",
+					ini_file->getPath().c_str(),
+					section.c_str(),
+					dims.c_str(),
+					System::err_config_note));
+
+		// End nodes per switch
+		concentration = ini_file->ReadInt(section, "Concentration", 1);
+		num_end_nodes = num_switches * concentration;
+	}
+	else if (type == TypeFatTree)
+	{
+		// Shape of the tree
+		ini_file->Enforce(section, "Arity");
+		ini_file->Enforce(section, "Levels");
+		arity = ini_file->ReadInt(section, "Arity");
+		num_levels = ini_file->ReadInt(section, "Levels");
+		if (arity < 2 || num_levels < 1)
+			throw Error(misc::fmt("%s: %s: A fat tree needs an "
+					"arity of at least 2 and at least one "
+					"level.\n%s",
+					ini_file->getPath().c_str(),
+					section.c_str(),
+					System::err_config_note));
+
+		// Each level has arity^(levels - 1) switches, and each leaf
+		// switch has as many end nodes as its arity.
+		num_end_nodes = 1;
+		for (int i = 0; i < num_levels && num_end_nodes < INT_MAX; i++)
+			num_end_nodes *= arity;
+		num_switches = num_end_nodes / arity * num_levels;
+		concentration = arity;
+	}
+	else if (type == TypeDragonfly)
+	{
+		// Shape of the groups
+		ini_file->Enforce(section, "RoutersPerGroup");
+		ini_file->Enforce(section, "GlobalLinks");
+		num_routers_per_group = ini_file->ReadInt(section,
+				"RoutersPerGroup");
+		num_global_links = ini_file->ReadInt(section, "GlobalLinks");
+		if (num_routers_per_group < 1 || num_global_links < 1)
+			throw Error(misc::fmt("%s: %s: A dragonfly needs at "
+					"least one router per group and one "
+					"global link per router.\n%s",
+					ini_file->getPath().c_str(),
+					section.c_str(),
+					System::err_config_note));
+
+		// Groups, defaulting to the largest number of groups that can
+		// be connected with one global link between each pair
+		long long max_groups = (long long) num_routers_per_group *
+				num_global_links + 1;
+		num_groups = ini_file->ReadInt(section, "Groups",
+				std::min(max_groups, (long long) INT_MAX));
+		if (num_groups < 1 || num_groups > max_groups)
+			throw Error(misc::fmt("%s: %s: A dragonfly with %d "
+					"routers per group and %d global links "
+					"per router can have between 1 and %lld "
+					"groups.\n%s",
+					ini_file->getPath().c_str(),
+					section.c_str(),
+					num_routers_per_group,
+					num_global_links,
+					max_groups,
+					System::err_config_note));
+
+		// End nodes per router
+		concentration = ini_file->ReadInt(section, "Concentration", 1);
+		num_switches = (long long) num_groups * num_routers_per_group;
+		num_end_nodes = num_switches * concentration;
+	}
+
+	// Check sizes
+	if (concentration < 1)
+		throw Error(misc::fmt("%s: %s: Concentration must be at "
+				"least 1.\n%s",
+				ini_file->getPath().c_str(),
+				section.c_str(),
+				System::err_config_note));
+	if (num_switches + num_end_nodes >= INT_MAX)
+		throw Error(misc::fmt("%s: %s: Topology is too large.\n",
+				ini_file->getPath().c_str(),
+				section.c_str()));
+
+	// Buffers and bandwidth
+	input_buffer_size = ini_file->ReadInt(section, "InputBufferSize",
+			network->getDefaultInputBufferSize());
+	output_buffer_size = ini_file->ReadInt(section, "OutputBufferSize",
+			network->getDefaultOutputBufferSize());
+	bandwidth = ini_file->ReadInt(section, "Bandwidth",
+			network->getDefaultBandwidth());
+	if (input_buffer_size < 1 || output_buffer_size < 1 || bandwidth < 1)
+		throw Error(misc::fmt("%s: %s: Buffer sizes and bandwidth "
+				"cannot be zero/negative.\n%s",
+				ini_file->getPath().c_str(),
+				section.c_str(),
+				System::err_config_note));
+
+	// End nodes should be able to contain an entire message
+	int required_buffer_size = network->getMinEndNodeBufferSize();
+	if (input_buffer_size < required_buffer_size ||
+			output_buffer_size < required_buffer_size)
+		throw Error(misc::fmt("%s: %s: Buffer size on the end nodes "
+				"should be able to fit at least a whole "
+				"message, or all the packets of the message",
+				ini_file->getPath().c_str(),
+				section.c_str()));
+
+	// Virtual channels. Tori and dragonflies use two by default to keep
+	// their routes free of deadlock.
+	num_virtual_channels = ini_file->ReadInt(section, "VC",
+			type == TypeTorus || type == TypeDragonfly ? 2 : 1);
+	if (num_virtual_channels < 1)
+		throw Error(misc::fmt("%s: %s: Virtual channels cannot be "
+				"zero/negative.\n%s",
+				ini_file->getPath().c_str(),
+				section.c_str(),
+				System::err_config_note));
+}
+
+
+void Topology::addLink(Node *node_a, Node *node_b, int num_virtual_channels)
+{
+	network->addBidirectionalLink(node_a->getName() + "_" +
+			node_b->getName(),
+			node_a,
+			node_b,
+			bandwidth,
+			output_buffer_size,
+			input_buffer_size,
+			num_virtual_channels);
+}
+
+
+int Topology::getCoordinate(int switch_index, int dimension) const
+{
+	for (int i = 0; i < dimension; i++)
+		switch_index /= dimensions[i];
+	return switch_index % dimensions[dimension];
+}
+
+
+int Topology::getGlobalRouter(int group, int other_group) const
+{
+	// Global links of a group are numbered consecutively across its
+	// routers, and connect to the other groups in order
+	assert(group != other_group);
+	int link = other_group < group ? other_group : other_group - 1;
+	return link / num_global_links;
+}
+
+
+void Topology::GenerateMesh(bool torus)
+{
+	// Number of switches
+	int num_switches = 1;
+	for (int size : dimensions)
+		num_switches *= size;
+
+	// Switches and their end nodes
+	for (int i = 0; i < num_switches; i++)
+	{
+		switches.push_back(network->addSwitch(input_buffer_size,
+				output_buffer_size,
+				bandwidth,
+				misc::fmt("s%d", i)));
+		for (int j = 0; j < concentration; j++)
+		{
+			end_nodes.push_back(network->addEndNode(
+					input_buffer_size,
+					output_buffer_size,
+					misc::fmt("n%d", (int) end_nodes.size()),
+					nullptr));
+			addLink(end_nodes.back(), switches[i], 1);
+		}
+	}
+
+	// Links to the next switch in each dimension, wrapping around the
+	// last switch in tori
+	int stride = 1;
+	for (int dimension = 0; dimension < (int) dimensions.size();
+			dimension++)
+	{
+		int size = dimensions[dimension];
+		for (int i = 0; i < num_switches; i++)
+		{
+			int coordinate = getCoordinate(i, dimension);
+			if (coordinate < size - 1)
+				addLink(switches[i], switches[i + stride],
+						num_virtual_channels);
+			else if (torus && size > 2)
+				addLink(switches[i],
+						switches[i - coordinate * stride],
+						num_virtual_channels);
+		}
+		stride *= size;
+	}
+}
+
+
+void Topology::GenerateFatTree()
+{
+	// Switches, level by level starting at the leaves
+	int num_switches_per_level = 1;
+	for (int i = 0; i < num_levels - 1; i++)
+		num_switches_per_level *= arity;
+	for (int level = 0; level < num_levels; level++)
+		for (int i = 0; i < num_switches_per_level; i++)
+			switches.push_back(network->addSwitch(
+					input_buffer_size,
+					output_buffer_size,
+					bandwidth,
+					misc::fmt("s%d_%d", level, i)));
+
+	// End nodes, attached to the leaves
+	for (int i = 0; i < num_switches_per_level * arity; i++)
+	{
+		end_nodes.push_back(network->addEndNode(input_buffer_size,
+				output_buffer_size,
+				misc::fmt("n%d", i),
+				nullptr));
+		addLink(end_nodes.back(), switches[i / arity], 1);
+	}
+
+	// Switch i of a level connects to the switches of the next level whose
+	// index differs from i only in digit 'level', written in base 'arity'.
+	int stride = 1;
+	for (int level = 0; level < num_levels - 1; level++)
+	{
+		for (int i = 0; i < num_switches_per_level; i++)
+		{
+			int digit = i / stride % arity;
+			for (int j = 0; j < arity; j++)
+				addLink(switches[level * num_switches_per_level + i],
+						switches[(level + 1) *
+						num_switches_per_level +
+						i + (j - digit) * stride],
+						num_virtual_channels);
+		}
+		stride *= arity;
+	}
+}
+
+
+void Topology::GenerateDragonfly()
+{
+	// Routers and their end nodes
+	for (int group = 0; group < num_groups; group++)
+	{
+		for (int i = 0; i < num_routers_per_group; i++)
+		{
+			switches.push_back(network->addSwitch(
+					input_buffer_size,
+					output_buffer_size,
+					bandwidth,
+					misc::fmt("s%d_%d", group, i)));
+			for (int j = 0; j < concentration; j++)
+			{
+				end_nodes.push_back(network->addEndNode(
+						input_buffer_size,
+						output_buffer_size,
+						misc::fmt("n%d", (int)
+						end_nodes.size()),
+						nullptr));
+				addLink(end_nodes.back(), switches.back(), 1);
+			}
+		}
+	}
+
+	// Local links, connecting all routers of a group with each other
+	for (int group = 0; group < num_groups; group++)
+	{
+		int first = group * num_routers_per_group;
+		for (int i = 0; i < num_routers_per_group; i++)
+			for (int j = i + 1; j < num_routers_per_group; j++)
+				addLink(switches[first + i],
+						switches[first + j],
+						num_virtual_channels);
+	}
+
+	// Global links, one between each pair of groups
+	for (int group = 0; group < num_groups; group++)
+		for (int other = group + 1; other < num_groups; other++)
+			addLink(switches[group * num_routers_per_group +
+					getGlobalRouter(group, other)],
+					switches[other * num_routers_per_group +
+					getGlobalRouter(other, group)],
+					num_virtual_channels);
+}
+
+
+void Topology::Generate()
+{
+	switch (type)
+	{
+
+	case TypeMesh:
+
+		GenerateMesh(false);
+		break;
+
+	case TypeTorus:
+
+		GenerateMesh(true);
+		break;
+
+	case TypeFatTree:
+
+		GenerateFatTree();
+		break;
+
+	case TypeDragonfly:
+
+		GenerateDragonfly();
+		break;
+
+	default:
+
+		throw misc::Panic("Invalid topology type");
+	}
+}
+
+
+Node *Topology::getNextMesh(int switch_index, int end_node_index,
+		int &virtual_channel) const
+{
+	// Move along the first dimension where the coordinates of the current
+	// switch and the switch of the destination differ
+	int destination = end_node_index / concentration;
+	int stride = 1;
+	for (int dimension = 0; dimension < (int) dimensions.size();
+			dimension++)
+	{
+		int size = dimensions[dimension];
+		int coordinate = getCoordinate(switch_index, dimension);
+		int target = getCoordinate(destination, dimension);
+		if (coordinate != target)
+		{
+			// Direction, taking the shortest way around tori
+			bool forward = target > coordinate;
+			if (type == TypeTorus)
+			{
+				int distance = (target - coordinate + size) %
+						size;
+				forward = distance <= size - distance;
+
+				// Packets use virtual channel 1 until they
+				// cross the wraparound link of the ring, and
+				// virtual channel 0 after that.
+				if (num_virtual_channels > 1)
+					virtual_channel = forward ==
+							(coordinate > target);
+			}
+
+			// Next switch
+			int next = forward ? (coordinate + 1) % size :
+					(coordinate + size - 1) % size;
+			return switches[switch_index + (next - coordinate) *
+					stride];
+		}
+		stride *= size;
+	}
+
+	// Destination attached to this switch
+	return end_nodes[end_node_index];
+}
+
+
+Node *Topology::getNextFatTree(int switch_index, int end_node_index,
+		int &virtual_channel) const
+{
+	int num_switches_per_level = switches.size() / num_levels;
+	int level = switch_index / num_switches_per_level;
+	int index = switch_index % num_switches_per_level;
+	int leaf = end_node_index / arity;
+
+	// A switch is an ancestor of the leaf if their indices only differ in
+	// the digits below 'level'
+	int stride = 1;
+	for (int i = 0; i < level; i++)
+		stride *= arity;
+	if (index / stride == leaf / stride)
+	{
+		// Destination attached to this switch
+		if (level == 0)
+			return end_nodes[end_node_index];
+
+		// Go down to the child that is an ancestor of the leaf
+		stride /= arity;
+		int digit = index / stride % arity;
+		int child = index + (leaf / stride % arity - digit) * stride;
+		return switches[(level - 1) * num_switches_per_level + child];
+	}
+
+	// Go up, choosing the parent from the digits of the destination to
+	// spread different destinations across the upper levels
+	int digit = index / stride % arity;
+	int parent = index + (end_node_index / stride % arity - digit) * stride;
+	return switches[(level + 1) * num_switches_per_level + parent];
+}
+
+
+Node *Topology::getNextDragonfly(int switch_index, int end_node_index,
+		int &virtual_channel) const
+{
+	int group = switch_index / num_routers_per_group;
+	int destination = end_node_index / concentration;
+	int destination_group = destination / num_routers_per_group;
+
+	// Within the group of the destination, go straight to its router.
+	// This last local hop uses virtual channel 1, so that it never waits
+	// for a local hop in the source group.
+	if (group == destination_group)
+	{
+		if (switch_index == destination)
+			return end_nodes[end_node_index];
+		if (num_virtual_channels > 1)
+			virtual_channel = 1;
+		return switches[destination];
+	}
+
+	// Go to the router with the global link to the destination group, and
+	// take the global link
+	int router = group * num_routers_per_group +
+			getGlobalRouter(group, destination_group);
+	if (switch_index != router)
+		return switches[router];
+	return switches[destination_group * num_routers_per_group +
+			getGlobalRouter(destination_group, group)];
+}
+
+
+void Topology::UpdateRoutes(RoutingTable *routing_table) const
+{
+	for (int i = 0; i < (int) end_nodes.size(); i++)
+	{
+		EndNode *destination = end_nodes[i];
+
+		// End nodes send everything to their switch
+		for (int j = 0; j < (int) end_nodes.size(); j++)
+			if (j != i)
+				routing_table->UpdateRoute(end_nodes[j],
+						destination,
+						switches[j / concentration],
+						0);
+
+		// Switches
+		for (int j = 0; j < (int) switches.size(); j++)
+		{
+			int virtual_channel = 0;
+			Node *next = nullptr;
+			switch (type)
+			{
+
+			case TypeMesh:
+			case TypeTorus:
+
+				next = getNextMesh(j, i, virtual_channel);
+				break;
+
+			case TypeFatTree:
+
+				next = getNextFatTree(j, i, virtual_channel);
+				break;
+
+			case TypeDragonfly:
+
+				next = getNextDragonfly(j, i, virtual_channel);
+				break;
+
+			default:
+
+				throw misc::Panic("Invalid topology type");
+			}
+			routing_table->UpdateRoute(switches[j], destination,
+					next, virtual_channel);
+		}
+	}
+}
+
+
+}  // namespace net
+
@@ -0,0 +1,178 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NETWORK_TOPOLOGY_H
+#define NETWORK_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/String.h>
+
+
+namespace net
+{
+
+class EndNode;
+class Network;
+class Node;
+class RoutingTable;
+class Switch;
+
+/// Regular topology generated from the parameters given in section
+/// '[ Network.<name>.Topology ]' of the network configuration file. The
+/// topology expands into switches, end nodes, and bidirectional links when
+/// the network is loaded, and fills the routing table with the routes
+/// between end nodes that are natural for it.
+class Topology
+{
+public:
+
+	/// Topology types
+	enum Type
+	{
+		TypeInvalid = 0,
+		TypeMesh,
+		TypeTorus,
+		TypeFatTree,
+		TypeDragonfly
+	};
+
+	/// String map for values of type Type
+	static misc::StringMap TypeMap;
+
+private:
+
+	// Network that the topology belongs to
+	Network *network;
+
+	// Type of topology
+	Type type = TypeInvalid;
+
+	// Size of each dimension of a mesh or torus
+	std::vector<int> dimensions;
+
+	// Number of end nodes attached to each switch of a mesh, torus, or
+	// dragonfly
+	int concentration = 1;
+
+	// Number of children of each switch of a fat tree
+	int arity = 0;
+
+	// Number of switch levels of a fat tree
+	int num_levels = 0;
+
+	// Number of groups of a dragonfly
+	int num_groups = 0;
+
+	// Number of routers in each group of a dragonfly
+	int num_routers_per_group = 0;
+
+	// Number of global links of each router of a dragonfly
+	int num_global_links = 0;
+
+	// Buffer sizes of nodes and links
+	int input_buffer_size = 0;
+	int output_buffer_size = 0;
+
+	// Bandwidth of switches and links
+	int bandwidth = 0;
+
+	// Number of virtual channels of links between switches
+	int num_virtual_channels = 1;
+
+	// Switches, in the order explained in the help message
+	std::vector<Switch *> switches;
+
+	// End nodes, in the order explained in the help message
+	std::vector<EndNode *> end_nodes;
+
+	// Connect two nodes with a bidirectional link
+	void addLink(Node *node_a, Node *node_b, int num_virtual_channels);
+
+	// Create the nodes and links of each type of topology
+	void GenerateMesh(bool torus);
+	void GenerateFatTree();
+	void GenerateDragonfly();
+
+	// Return the coordinate of a switch of a mesh or torus in the given
+	// dimension
+	int getCoordinate(int switch_index, int dimension) const;
+
+	// Return the index of the dragonfly router in a group that holds the
+	// global link to another group
+	int getGlobalRouter(int group, int other_group) const;
+
+	// Compute the next hop and virtual channel of the route from a switch
+	// to an end node for each type of topology
+	Node *getNextMesh(int switch_index, int end_node_index,
+			int &virtual_channel) const;
+	Node *getNextFatTree(int switch_index, int end_node_index,
+			int &virtual_channel) const;
+	Node *getNextDragonfly(int switch_index, int end_node_index,
+			int &virtual_channel) const;
+
+public:
+
+	/// Constructor, reading the topology parameters.
+	///
+	/// \param network
+	///	Network where the topology is generated
+	///
+	/// \param ini_file
+	///	Network configuration file
+	///
+	/// \param section
+	///	Section of the configuration file describing the topology
+	///
+	/// \throw
+	///	A net::Error is thrown if any parameter is invalid.
+	Topology(Network *network,
+			misc::IniFile *ini_file,
+			const std::string &section);
+
+	/// Create the switches, end nodes, and links of the topology in the
+	/// network.
+	void Generate();
+
+	/// Set the routes between every pair of end nodes of the topology in
+	/// the routing table. Meshes and tori use dimension-order routing,
+	/// fat trees route up to a nearest common ancestor and back down,
+	/// and dragonflies use minimal local-global-local routes. When links
+	/// between switches have at least two virtual channels, tori and
+	/// dragonflies switch virtual channel so that the routes are free of
+	/// deadlock. Routes to switches are not modified.
+	void UpdateRoutes(RoutingTable *routing_table) const;
+
+	/// Return the type of topology
+	Type getType() const { return type; }
+
+	/// Return the number of switches generated
+	int getNumSwitches() const { return switches.size(); }
+
+	/// Return the number of end nodes generated
+	int getNumEndNodes() const { return end_nodes.size(); }
+};
+
+
+}  // namespace net
+
+#endif
+
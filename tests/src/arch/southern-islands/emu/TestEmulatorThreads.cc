@@ -0,0 +1,171 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <arch/common/Arch.h>
+
+#include <arch/southern-islands/emulator/Emulator.h>
+#include <arch/southern-islands/emulator/NDRange.h>
+#include <memory/Memory.h>
+
+
+namespace SI
+{
+
+// Number of work-groups of the ND-range
+static const int num_work_groups = 40;
+
+// Program 'v_add_i32 v2, vcc, v0, v1; s_endpgm'. Instructions are given as
+// raw words, since the instruction formats include an extra word for the
+// literal constant. The decoder reads that word past the last instruction too.
+static const unsigned add_program[] = {
+	0x4a040300,  // v_add_i32 v2, vcc, v0, v1
+	0xbf810000,  // s_endpgm
+	0
+};
+
+// Address of the array written by all work-groups in 'shared_program'
+static const unsigned shared_array_address = 0x1000;
+
+// Address of the counter incremented by all work-items in 'shared_program'
+static const unsigned shared_counter_address = 0x2000;
+
+// Program where every work-item stores its index in the wavefront into entry
+// 'id_in_wavefront' of the array at 'shared_array_address', and atomically
+// adds 1 to the counter at 'shared_counter_address'. All work-groups write
+// the same array entries and the same counter.
+static const unsigned shared_program[] = {
+	0xbe8403ff, shared_array_address,  // s_mov_b32 s4, 0x1000
+	0xbe8503ff, 4 << 16,  // s_mov_b32 s5, stride 4
+	0xbe860380,  // s_mov_b32 s6, 0
+	0xbe870380,  // s_mov_b32 s7, 0
+	0xbe8803ff, shared_counter_address,  // s_mov_b32 s8, 0x2000
+	0xbe890380,  // s_mov_b32 s9, stride 0
+	0xbe8a0380,  // s_mov_b32 s10, 0
+	0xbe8b0380,  // s_mov_b32 s11, 0
+	0xbe8c0380,  // s_mov_b32 s12, 0
+	0x360600bf,  // v_and_b32 v3, 63, v0
+	0x7e080281,  // v_mov_b32 v4, 1
+	0xe0700000, 0x0c010300,  // buffer_store_dword v3, s[4:7], s12
+	0xe0c80000, 0x0c020400,  // buffer_atomic_add v4, s[8:11], s12
+	0xbf810000,  // s_endpgm
+	0
+};
+
+// Create an ND-range in the emulator with 'num_work_groups' work-groups of
+// two wavefronts each, running the given program. All work-groups are waiting
+// to be scheduled.
+static NDRange *newNDRange(Emulator *emulator, const unsigned *program,
+		unsigned size)
+{
+	NDRange *ndrange = emulator->addNDRange();
+	unsigned global_size[1] = { num_work_groups * 128 };
+	unsigned local_size[1] = { 128 };
+	ndrange->SetupSize(global_size, local_size, 1);
+	ndrange->SetupInstructionMemory((const char *) program, size, 0);
+	for (int id = 0; id < num_work_groups; id++)
+		ndrange->AddWorkgroupIdToWaitingList(id);
+	return ndrange;
+}
+
+// Run the emulator with the given number of host threads until the
+// ND-range has no more work-groups, and return the number of iterations of
+// the functional emulation loop.
+static int RunNDRange(int num_threads, long long &num_instructions)
+{
+	Emulator::Destroy();
+	comm::ArchPool::Destroy();
+	Emulator::setNumThreads(num_threads);
+	Emulator *emulator = Emulator::getInstance();
+	NDRange *ndrange = newNDRange(emulator, add_program,
+			sizeof add_program);
+	int num_iterations = 0;
+	while (!ndrange->isWaitingWorkGroupsEmpty())
+	{
+		EXPECT_TRUE(emulator->Run());
+		EXPECT_TRUE(ndrange->isRunningWorkGroupsEmpty());
+		num_iterations++;
+	}
+	num_instructions = emulator->getNumInstructions();
+	Emulator::Destroy();
+	comm::ArchPool::Destroy();
+	Emulator::setNumThreads(1);
+	return num_iterations;
+}
+
+// Run 'shared_program' with the given number of host threads until the
+// ND-range has no more work-groups. Return the content of the shared array
+// in 'array', and the final value of the shared counter.
+static unsigned RunSharedNDRange(int num_threads, unsigned (&array)[64])
+{
+	Emulator::Destroy();
+	comm::ArchPool::Destroy();
+	Emulator::setNumThreads(num_threads);
+	Emulator *emulator = Emulator::getInstance();
+	mem::Memory *global_memory = emulator->getGlobalMemory();
+	global_memory->Map(shared_array_address, sizeof array,
+			mem::Memory::AccessRead | mem::Memory::AccessWrite);
+	global_memory->Map(shared_counter_address, 4,
+			mem::Memory::AccessRead | mem::Memory::AccessWrite);
+	NDRange *ndrange = newNDRange(emulator, shared_program,
+			sizeof shared_program);
+	while (!ndrange->isWaitingWorkGroupsEmpty())
+		EXPECT_TRUE(emulator->Run());
+	unsigned counter;
+	global_memory->Read(shared_array_address, sizeof array,
+			(char *) array);
+	global_memory->Read(shared_counter_address, 4, (char *) &counter);
+	Emulator::Destroy();
+	comm::ArchPool::Destroy();
+	Emulator::setNumThreads(1);
+	return counter;
+}
+
+TEST(TestEmulatorThreads, work_groups)
+{
+	// A single host thread runs one work-group per iteration
+	long long num_instructions;
+	EXPECT_EQ(num_work_groups, RunNDRange(1, num_instructions));
+	EXPECT_EQ(num_work_groups * 2 * 2, num_instructions);
+
+	// Several host threads run a batch of work-groups per iteration, and
+	// all instructions are counted
+	int num_iterations = RunNDRange(4, num_instructions);
+	EXPECT_GT(num_iterations, 1);
+	EXPECT_LT(num_iterations, num_work_groups);
+	EXPECT_EQ(num_work_groups * 2 * 2, num_instructions);
+}
+
+TEST(TestEmulatorThreads, shared_global_memory)
+{
+	// All work-items increment the same counter atomically, and all
+	// work-groups overwrite the same array entries. The results do not
+	// depend on the number of host threads.
+	for (int num_threads : { 1, 2, 4, 8 })
+	{
+		unsigned array[64];
+		unsigned counter = RunSharedNDRange(num_threads, array);
+		EXPECT_EQ((unsigned) num_work_groups * 128, counter);
+		for (unsigned i = 0; i < 64; i++)
+			EXPECT_EQ(i, array[i]);
+	}
+}
+
+}  // namespace SI
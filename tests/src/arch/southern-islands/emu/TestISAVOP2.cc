@@ -126,6 +126,71 @@ TEST(TestISAVOP2, V_ADD_I32)
 }
 
 
+
+// This test checks the execution of V_ADD_I32 for all work-items of a
+// wavefront at once, with some work-items inactive.
+TEST(TestISAVOP2, V_ADD_I32_wavefront)
+{
+	// Create a work-group with a single wavefront
+	NDRange ndrange;
+	unsigned global_size[1] = {64};
+	unsigned local_size[1] = {64};
+	ndrange.SetupSize(global_size, local_size, 1);
+
+	// Program with instruction - v_add_i32 v2, vcc, v0, v1
+	Instruction::BytesVOP2 inst_bytes = 
+	{
+		// src0 - v0
+		256,
+
+		// vsrc1 - v1
+		1,
+
+		// vdst - v2
+		2,
+
+		// op - v_add_i32 has opcode = 37                    
+		37,
+
+		// enc - 0
+		0,
+
+		// lit_cnst - 0
+		0
+	};
+	ndrange.SetupInstructionMemory((char *) &inst_bytes,
+			sizeof inst_bytes, 0);
+	WorkGroup work_group(&ndrange, 0);
+	Wavefront *wavefront = work_group.getWavefrontsBegin()->get();
+
+	// Set values in registers - v0 = i and v1 = 1 for the first 32
+	// work-items, and v0 = 0x80000000 + i and v1 = 0xffffffff, producing
+	// a carry, for the rest. Only even work-items are active.
+	for (int i = 0; i < Wavefront::Size; i++)
+	{
+		wavefront->setVregUint(0, i, i < 32 ? i : 0x80000000 + i);
+		wavefront->setVregUint(1, i, i < 32 ? 1 : 0xffffffff);
+		wavefront->setVregUint(2, i, 7);
+	}
+	wavefront->setSregUint(Instruction::RegisterExec, 0x55555555);
+	wavefront->setSregUint(Instruction::RegisterExec + 1, 0x55555555);
+	wavefront->setSregUint(Instruction::RegisterVcc, 0xaaaaaaaa);
+	wavefront->setSregUint(Instruction::RegisterVcc + 1, 0);
+
+	// Execute instruction
+	wavefront->Execute();
+
+	// Read results - v2 should only change in active work-items, and only
+	// the bits of vcc for active work-items should be updated.
+	for (int i = 0; i < Wavefront::Size; i++)
+		EXPECT_EQ(i % 2 ? 7 : i < 32 ? i + 1 : 0x7fffffffu + i,
+				wavefront->getVregUint(2, i));
+	EXPECT_EQ(0xaaaaaaaau, wavefront->getSregUint(
+			Instruction::RegisterVcc));
+	EXPECT_EQ(0x55555555u, wavefront->getSregUint(
+			Instruction::RegisterVcc + 1));
+}
+
 }
 
 
@@ -0,0 +1,372 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <arch/southern-islands/emulator/NDRange.h>
+#include <arch/southern-islands/emulator/Wavefront.h>
+#include <arch/southern-islands/emulator/WorkGroup.h>
+#include <arch/southern-islands/timing/ComputeUnit.h>
+#include <arch/southern-islands/timing/Gpu.h>
+#include <arch/southern-islands/timing/Timing.h>
+#include <arch/southern-islands/timing/Uop.h>
+#include <arch/southern-islands/timing/WavefrontPool.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/esim/Engine.h>
+#include <memory/Mmu.h>
+#include <memory/Module.h>
+#include <memory/System.h>
+#include <network/System.h>
+
+namespace SI
+{
+
+// One compute unit whose vector cache has 64-byte blocks and 2 MSHR
+// entries, backed by a main memory module.
+const std::string si_config_0 =
+		"[ Device ]\n"
+		"Frequency = 1000\n"
+		"NumComputeUnits = 1\n";
+
+const std::string mem_config_0 =
+		"[CacheGeometry geo-l1]\n"
+		"Sets = 16\n"
+		"Assoc = 2\n"
+		"BlockSize = 64\n"
+		"Latency = 2\n"
+		"MSHR = 2\n"
+		"Ports = 2\n"
+		"\n"
+		"[Module mod-l1]\n"
+		"Type = Cache\n"
+		"Geometry = geo-l1\n"
+		"LowNetwork = l1-mm\n"
+		"LowModules = mod-mm\n"
+		"\n"
+		"[Module mod-mm]\n"
+		"Type = MainMemory\n"
+		"BlockSize = 64\n"
+		"Latency = 20\n"
+		"HighNetwork = l1-mm\n"
+		"\n"
+		"[Entry si-cu-0]\n"
+		"Arch = SouthernIslands\n"
+		"ComputeUnit = 0\n"
+		"Module = mod-l1\n"
+		"\n"
+		"[Network l1-mm]\n"
+		"DefaultInputBufferSize = 1024\n"
+		"DefaultOutputBufferSize = 1024\n"
+		"DefaultBandwidth = 64";
+
+// Base virtual address of the accesses, aligned to a page
+const unsigned base_address = 0x20000;
+
+static void Cleanup()
+{
+	esim::Engine::Destroy();
+	net::System::Destroy();
+	mem::System::Destroy();
+	Timing::Destroy();
+	comm::ArchPool::Destroy();
+}
+
+
+// Timing simulator with one compute unit connected to the memory hierarchy,
+// and one wavefront ready to create vector memory uops.
+class Environment
+{
+	NDRange ndrange;
+
+	std::unique_ptr<WorkGroup> work_group;
+
+	std::unique_ptr<WavefrontPool> wavefront_pool;
+
+	std::unique_ptr<WavefrontPoolEntry> wavefront_pool_entry;
+
+public:
+
+	Gpu *gpu;
+
+	ComputeUnit *compute_unit;
+
+	VectorMemoryUnit *vector_memory_unit;
+
+	Wavefront *wavefront;
+
+	Environment()
+	{
+		// Set up timing simulator and memory system
+		misc::IniFile ini_file_si;
+		misc::IniFile ini_file_mem;
+		ini_file_si.LoadFromString(si_config_0);
+		ini_file_mem.LoadFromString(mem_config_0);
+		Timing::ParseConfiguration(&ini_file_si);
+		Timing *timing = Timing::getInstance();
+		mem::System::getInstance()->ReadConfiguration(&ini_file_mem);
+		gpu = timing->getGpu();
+		compute_unit = gpu->getComputeUnit(0);
+		vector_memory_unit = compute_unit->getVectorMemoryUnit();
+
+		// Translate one page of another address space first, so that
+		// physical and virtual addresses of the test differ.
+		mem::Mmu *mmu = gpu->getMmu();
+		mmu->TranslateVirtualAddress(mmu->newSpace("other"),
+				base_address);
+
+		// One work-group with one full wavefront
+		unsigned global_size[1] = { WorkGroup::WavefrontSize };
+		unsigned local_size[1] = { WorkGroup::WavefrontSize };
+		ndrange.SetupSize(global_size, local_size, 1);
+		ndrange.address_space = mmu->newSpace("test");
+		work_group = misc::new_unique<WorkGroup>(&ndrange, 0);
+		wavefront = work_group->getWavefrontsBegin()->get();
+		setActiveMask(0xffffffff, 0xffffffff);
+
+		// Wavefront pool entry holding the uops
+		wavefront_pool = misc::new_unique<WavefrontPool>(0,
+				compute_unit);
+		wavefront_pool_entry = misc::new_unique<WavefrontPoolEntry>(0,
+				wavefront_pool.get());
+	}
+
+	// Set the active work-items of the wavefront
+	void setActiveMask(unsigned low, unsigned high)
+	{
+		wavefront->setSregUint(Instruction::RegisterExec, low);
+		wavefront->setSregUint(Instruction::RegisterExec + 1, high);
+	}
+
+	// Create a uop where work-item i accesses 'size' bytes at
+	// 'addresses[i]'
+	std::unique_ptr<Uop> newUop(const std::vector<unsigned> &addresses,
+			unsigned size = 4)
+	{
+		auto uop = misc::new_unique<Uop>(wavefront,
+				wavefront_pool_entry.get(), 0,
+				work_group.get(), 0);
+		uop->vector_memory_read = true;
+		for (unsigned i = 0; i < addresses.size(); i++)
+		{
+			uop->work_item_info_list[i].global_memory_access_address =
+					addresses[i];
+			uop->work_item_info_list[i].global_memory_access_size =
+					size;
+		}
+		return uop;
+	}
+
+	// Return the physical address of a virtual address of the test
+	unsigned Translate(unsigned address)
+	{
+		return gpu->getMmu()->TranslateVirtualAddress(
+				ndrange.address_space, address);
+	}
+};
+
+
+// Consecutive 4-byte accesses of all work-items cover 4 blocks of 64 bytes
+TEST(TestVectorMemoryUnit, coalesce_unit_stride)
+{
+	try
+	{
+		// Cleanup singleton instances
+		Cleanup();
+
+		// Coalesce
+		Environment env;
+		std::vector<unsigned> addresses;
+		for (unsigned i = 0; i < WorkGroup::WavefrontSize; i++)
+			addresses.push_back(base_address + i * 4);
+		auto uop = env.newUop(addresses);
+		env.vector_memory_unit->Coalesce(uop.get());
+
+		// Blocks are translated, in order
+		EXPECT_TRUE(uop->vector_memory_coalesced);
+		ASSERT_EQ(4u, uop->vector_memory_blocks.size());
+		EXPECT_NE(base_address, env.Translate(base_address));
+		for (unsigned i = 0; i < 4; i++)
+			EXPECT_EQ(env.Translate(base_address + i * 64),
+					uop->vector_memory_blocks[i]);
+
+		// Statistics
+		EXPECT_EQ(WorkGroup::WavefrontSize, env.compute_unit->
+				num_vector_memory_work_item_accesses);
+		EXPECT_EQ(4, env.compute_unit->num_vector_memory_transactions);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+// Accesses of all active work-items within one block produce a single
+// transaction, while inactive work-items are ignored.
+TEST(TestVectorMemoryUnit, coalesce_same_block)
+{
+	try
+	{
+		// Cleanup singleton instances
+		Cleanup();
+
+		// Active work-items access the same block, inactive
+		// work-items access other blocks.
+		Environment env;
+		env.setActiveMask(0xffffffff, 0);
+		std::vector<unsigned> addresses;
+		for (unsigned i = 0; i < WorkGroup::WavefrontSize; i++)
+			addresses.push_back(i < 32 ?
+					base_address + 128 + (i % 16) * 4 :
+					base_address + i * 64);
+		auto uop = env.newUop(addresses);
+		env.vector_memory_unit->Coalesce(uop.get());
+
+		// One transaction
+		ASSERT_EQ(1u, uop->vector_memory_blocks.size());
+		EXPECT_EQ(env.Translate(base_address + 128),
+				uop->vector_memory_blocks[0]);
+		EXPECT_EQ(32, env.compute_unit->
+				num_vector_memory_work_item_accesses);
+		EXPECT_EQ(1, env.compute_unit->num_vector_memory_transactions);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+// Work-items accessing different blocks in reverse order produce one
+// transaction each, sorted by address. An unaligned access crossing a block
+// boundary produces a transaction for each block.
+TEST(TestVectorMemoryUnit, coalesce_scattered)
+{
+	try
+	{
+		// Cleanup singleton instances
+		Cleanup();
+
+		// Work-item i accesses block 63 - i, with a stride of 2
+		// blocks. Work-item 0 crosses into the next block.
+		Environment env;
+		std::vector<unsigned> addresses;
+		for (unsigned i = 0; i < WorkGroup::WavefrontSize; i++)
+			addresses.push_back(base_address +
+					(WorkGroup::WavefrontSize - 1 - i) * 128);
+		addresses[0] += 60;
+		auto uop = env.newUop(addresses, 8);
+		env.vector_memory_unit->Coalesce(uop.get());
+
+		// One block per work-item, plus the crossed block
+		ASSERT_EQ(WorkGroup::WavefrontSize + 1,
+				uop->vector_memory_blocks.size());
+		for (unsigned i = 0; i < WorkGroup::WavefrontSize; i++)
+			EXPECT_EQ(env.Translate(base_address + i * 128),
+					uop->vector_memory_blocks[i]);
+		EXPECT_EQ(env.Translate(base_address +
+				WorkGroup::WavefrontSize * 128 - 64),
+				uop->vector_memory_blocks.back());
+		EXPECT_EQ(WorkGroup::WavefrontSize + 1, env.compute_unit->
+				num_vector_memory_transactions);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+// A uop whose blocks were partially submitted resumes at the first block
+// not submitted yet, once the vector cache has room for new accesses.
+TEST(TestVectorMemoryUnit, access_blocks_retry)
+{
+	try
+	{
+		// Cleanup singleton instances
+		Cleanup();
+
+		// Two accesses fill the MSHR of the vector cache
+		Environment env;
+		mem::Module *vector_cache = env.compute_unit->vector_cache;
+		esim::Engine *esim_engine = esim::Engine::getInstance();
+		std::vector<unsigned> addresses_0 = { base_address + 0x800,
+				base_address + 0x840 };
+		env.setActiveMask(0x3, 0);
+		auto uop_0 = env.newUop(addresses_0);
+		env.vector_memory_unit->Coalesce(uop_0.get());
+		EXPECT_TRUE(env.vector_memory_unit->AccessBlocks(uop_0.get(),
+				mem::Module::AccessLoad));
+		EXPECT_EQ(2, uop_0->num_vector_memory_accessed_blocks);
+		esim_engine->ProcessEvents();
+		EXPECT_FALSE(vector_cache->canAccess(0));
+
+		// Unit-stride uop with 4 blocks, whose first 2 blocks were
+		// submitted in an earlier cycle. No block is submitted while
+		// the MSHR is full.
+		std::vector<unsigned> addresses_1;
+		for (unsigned i = 0; i < WorkGroup::WavefrontSize; i++)
+			addresses_1.push_back(base_address + i * 4);
+		env.setActiveMask(0xffffffff, 0xffffffff);
+		auto uop_1 = env.newUop(addresses_1);
+		env.vector_memory_unit->Coalesce(uop_1.get());
+		ASSERT_EQ(4u, uop_1->vector_memory_blocks.size());
+		uop_1->num_vector_memory_accessed_blocks = 2;
+		EXPECT_FALSE(env.vector_memory_unit->AccessBlocks(uop_1.get(),
+				mem::Module::AccessLoad));
+		EXPECT_EQ(2, uop_1->num_vector_memory_accessed_blocks);
+		EXPECT_EQ(0, uop_1->global_memory_witness);
+
+		// Wait for the first uop to complete
+		for (int i = 0; i < 1000 && uop_0->global_memory_witness; i++)
+			esim_engine->ProcessEvents();
+		ASSERT_EQ(0, uop_0->global_memory_witness);
+
+		// The remaining physical blocks are submitted
+		EXPECT_TRUE(env.vector_memory_unit->AccessBlocks(uop_1.get(),
+				mem::Module::AccessLoad));
+		EXPECT_EQ(4, uop_1->num_vector_memory_accessed_blocks);
+		EXPECT_EQ(-2, uop_1->global_memory_witness);
+		esim_engine->ProcessEvents();
+		EXPECT_FALSE(vector_cache->isInFlightAddress(
+				uop_1->vector_memory_blocks[0]));
+		EXPECT_FALSE(vector_cache->isInFlightAddress(
+				uop_1->vector_memory_blocks[1]));
+		EXPECT_TRUE(vector_cache->isInFlightAddress(
+				env.Translate(base_address + 128)));
+		EXPECT_TRUE(vector_cache->isInFlightAddress(
+				env.Translate(base_address + 192)));
+
+		// Both blocks complete
+		for (int i = 0; i < 1000 && uop_1->global_memory_witness; i++)
+			esim_engine->ProcessEvents();
+		EXPECT_EQ(0, uop_1->global_memory_witness);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+}  // namespace SI
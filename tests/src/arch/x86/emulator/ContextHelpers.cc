@@ -0,0 +1,54 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <arch/common/Arch.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <lib/esim/Engine.h>
+#include <memory/Memory.h>
+
+#include "ContextHelpers.h"
+
+
+namespace x86
+{
+
+
+void Cleanup()
+{
+	Emulator::Destroy();
+	esim::Engine::Destroy();
+	comm::ArchPool::Destroy();
+}
+
+
+Context *newContext(const unsigned char *code, unsigned size)
+{
+	Context *context = Emulator::getInstance()->newContext();
+	context->Initialize();
+	mem::Memory *memory = context->getMemory();
+	memory->Map(code_address, mem::Memory::PageSize,
+			mem::Memory::AccessRead |
+			mem::Memory::AccessWrite |
+			mem::Memory::AccessExec);
+	memory->Write(code_address, size, (const char *) code);
+	context->getRegs().setEip(code_address);
+	return context;
+}
+
+}
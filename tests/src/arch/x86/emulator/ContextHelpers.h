@@ -0,0 +1,47 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_EMULATOR_CONTEXT_HELPERS_H
+#define ARCH_X86_EMULATOR_CONTEXT_HELPERS_H
+
+#include <arch/x86/emulator/Context.h>
+
+
+namespace x86
+{
+
+/// Page mapped by newContext() in the contexts it creates
+const unsigned code_address = 0x10000;
+
+/// Destroy all singletons related with x86 emulation, including:
+///
+/// - Emulator singleton
+/// - Event-driven simulation engine singleton
+/// - ArchPool singleton
+///
+void Cleanup();
+
+/// Create a context with one readable, writable, and executable page at
+/// 'code_address'. The first \a size bytes of the page are set to \a code,
+/// and the instruction pointer of the context points to them.
+Context *newContext(const unsigned char *code = nullptr, unsigned size = 0);
+
+}
+
+#endif // ARCH_X86_EMULATOR_CONTEXT_HELPERS_H
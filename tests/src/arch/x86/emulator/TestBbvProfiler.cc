@@ -0,0 +1,103 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+#include <arch/x86/emulator/BbvProfiler.h>
+#include <arch/x86/emulator/Emulator.h>
+
+namespace x86
+{
+
+// Return the content of a file
+static std::string readFile(const std::string &path)
+{
+	std::ifstream f(path);
+	std::stringstream stream;
+	stream << f.rdbuf();
+	return stream.str();
+}
+
+TEST(TestX86BbvProfiler, interval_output)
+{
+	char temp_path[] = "/tmp/m2s.XXXXXX";
+	int fd = mkstemp(temp_path);
+	ASSERT_GE(fd, 0);
+	close(fd);
+	{
+		BbvProfiler profiler(temp_path, 10);
+
+		// The first interval ends after exactly 10 instructions, in
+		// the middle of the third block, with blocks numbered in order
+		// of first execution
+		profiler.AddBlock(0x8048000, 4);
+		profiler.AddBlock(0x8048100, 3);
+		EXPECT_EQ(0, profiler.getNumIntervals());
+		profiler.AddBlock(0x8048000, 4);
+		EXPECT_EQ(1, profiler.getNumIntervals());
+
+		// The second interval starts with the rest of the split block,
+		// and blocks are dumped in order of identifier
+		profiler.AddBlock(0x8048200, 2);
+		profiler.AddBlock(0x8048100, 3);
+		profiler.AddBlock(0x8048000, 5);
+		EXPECT_EQ(2, profiler.getNumIntervals());
+		EXPECT_EQ(3, profiler.getNumBlocks());
+
+		// The last interval is incomplete, and it is dumped when the
+		// profiler is destroyed
+		profiler.AddBlock(0x8048300, 1);
+		EXPECT_EQ(2, profiler.getNumIntervals());
+		EXPECT_EQ(4, profiler.getNumBlocks());
+	}
+	EXPECT_EQ("T:1:7 :2:3 \n"
+			"T:1:5 :2:3 :3:2 \n"
+			"T:1:1 :4:1 \n",
+			readFile(temp_path));
+
+	// A block longer than an interval is split across several intervals
+	{
+		BbvProfiler profiler(temp_path, 10);
+		profiler.AddBlock(0x8048000, 25);
+		EXPECT_EQ(2, profiler.getNumIntervals());
+	}
+	EXPECT_EQ("T:1:10 \n"
+			"T:1:10 \n"
+			"T:1:5 \n",
+			readFile(temp_path));
+
+	// Nothing is dumped without instructions in the last interval
+	{
+		BbvProfiler profiler(temp_path, 10);
+		profiler.AddBlock(0x8048000, 10);
+		EXPECT_EQ(1, profiler.getNumIntervals());
+	}
+	EXPECT_EQ("T:1:10 \n", readFile(temp_path));
+	unlink(temp_path);
+
+	// The output file must be writable
+	EXPECT_THROW(BbvProfiler("/nonexistent/m2s.bbv", 10), Error);
+}
+
+}  // namespace x86
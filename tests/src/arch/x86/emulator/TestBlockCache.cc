@@ -0,0 +1,131 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <arch/x86/emulator/BlockCache.h>
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/DecodeCache.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <memory/Memory.h>
+
+#include "ContextHelpers.h"
+
+namespace x86
+{
+
+// Loop with three instructions 'mov eax, 1', 'mov ebx, 2', 'mov ecx, 3',
+// followed by a jump back to the first one.
+static const unsigned char loop_code[] = {
+	0xb8, 0x01, 0x00, 0x00, 0x00,
+	0xbb, 0x02, 0x00, 0x00, 0x00,
+	0xb9, 0x03, 0x00, 0x00, 0x00,
+	0xeb, 0xef
+};
+
+TEST(TestX86BlockCache, block_formation)
+{
+	Cleanup();
+	Context *context = newContext(loop_code, sizeof loop_code);
+	Regs &regs = context->getRegs();
+
+	// The whole loop runs as one superblock, ending at the jump
+	EXPECT_EQ(4, context->ExecuteBlock(100));
+	EXPECT_EQ(1u, regs.getEax());
+	EXPECT_EQ(2u, regs.getEbx());
+	EXPECT_EQ(3u, regs.getEcx());
+	EXPECT_EQ(code_address, regs.getEip());
+
+	// Superblock is in the cache
+	mem::Memory *memory = context->getMemory();
+	BlockCache::Block *block = context->getBlockCache()->Lookup(
+			code_address, memory->getPage(code_address));
+	ASSERT_TRUE(block != nullptr);
+	ASSERT_EQ(4u, block->insts.size());
+	EXPECT_EQ(code_address + 15, block->insts[3].inst.getEip());
+
+	// The instruction limit stops it in the middle
+	regs.setEax(0);
+	regs.setEbx(0);
+	EXPECT_EQ(2, context->ExecuteBlock(2));
+	EXPECT_EQ(1u, regs.getEax());
+	EXPECT_EQ(2u, regs.getEbx());
+	EXPECT_EQ(code_address + 10, regs.getEip());
+
+	// A superblock starting in the middle of the loop is built
+	// separately
+	EXPECT_EQ(2, context->ExecuteBlock(100));
+	EXPECT_EQ(code_address, regs.getEip());
+	block = context->getBlockCache()->Lookup(code_address + 10,
+			memory->getPage(code_address));
+	ASSERT_TRUE(block != nullptr);
+	EXPECT_EQ(2u, block->insts.size());
+}
+
+TEST(TestX86BlockCache, write_to_code_page)
+{
+	Cleanup();
+	Context *context = newContext(loop_code, sizeof loop_code);
+	mem::Memory *memory = context->getMemory();
+	BlockCache *cache = context->getBlockCache();
+	EXPECT_EQ(4, context->ExecuteBlock(100));
+
+	// Overwriting the immediate value of 'mov ebx' invalidates the
+	// superblock
+	unsigned value = 7;
+	memory->Write(code_address + 6, 4, (const char *) &value);
+	EXPECT_TRUE(cache->Lookup(code_address,
+			memory->getPage(code_address)) == nullptr);
+
+	// The new instruction is executed
+	EXPECT_EQ(4, context->ExecuteBlock(100));
+	EXPECT_EQ(7u, context->getRegs().getEbx());
+	EXPECT_TRUE(cache->Lookup(code_address,
+			memory->getPage(code_address)) != nullptr);
+}
+
+TEST(TestX86BlockCache, clone)
+{
+	Cleanup();
+	Context *parent = newContext(loop_code, sizeof loop_code);
+	EXPECT_EQ(4, parent->ExecuteBlock(100));
+	DecodeCache *decode_cache = parent->getDecodeCache();
+	int num_misses = decode_cache->getNumMisses();
+
+	// Child shares the caches of the parent
+	Context *child = Emulator::getInstance()->newContext();
+	child->Clone(parent);
+	EXPECT_EQ(parent->getBlockCache(), child->getBlockCache());
+	EXPECT_EQ(decode_cache, child->getDecodeCache());
+
+	// Child runs the superblock built by the parent without decoding
+	// any instruction again
+	child->getRegs().setEax(0);
+	EXPECT_EQ(4, child->ExecuteBlock(100));
+	EXPECT_EQ(1u, child->getRegs().getEax());
+	EXPECT_EQ(num_misses, decode_cache->getNumMisses());
+
+	// A write by the child invalidates the superblock for the parent
+	unsigned value = 5;
+	child->getMemory()->Write(code_address + 1, 4, (const char *) &value);
+	EXPECT_EQ(4, parent->ExecuteBlock(100));
+	EXPECT_EQ(5u, parent->getRegs().getEax());
+}
+
+}  // namespace x86
@@ -0,0 +1,184 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/DecodeCache.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <memory/Memory.h>
+
+#include "ContextHelpers.h"
+
+namespace x86
+{
+
+// Page holding the code issuing system calls
+static const unsigned syscall_address = 0x20000;
+
+// Write instruction 'mov eax, value' at the given address
+static void WriteMovEax(mem::Memory *memory, unsigned address, unsigned value)
+{
+	unsigned char code[] = {
+		0xb8,
+		(unsigned char) value,
+		(unsigned char) (value >> 8),
+		(unsigned char) (value >> 16),
+		(unsigned char) (value >> 24)
+	};
+	memory->Write(address, sizeof code, (const char *) code);
+}
+
+// Emulate the instruction at the given address
+static void ExecuteAt(Context *context, unsigned address)
+{
+	context->getRegs().setEip(address);
+	context->Execute();
+}
+
+// Emulate system call 'code' with arguments 'ebx', 'ecx', and 'edx' with an
+// 'int 0x80' instruction placed in its own page.
+static void Syscall(Context *context, unsigned code, unsigned ebx,
+		unsigned ecx, unsigned edx)
+{
+	mem::Memory *memory = context->getMemory();
+	memory->Map(syscall_address, mem::Memory::PageSize,
+			mem::Memory::AccessRead |
+			mem::Memory::AccessWrite |
+			mem::Memory::AccessExec);
+	unsigned char int_80[] = { 0xcd, 0x80 };
+	memory->Write(syscall_address, sizeof int_80, (const char *) int_80);
+	Regs &regs = context->getRegs();
+	regs.setEax(code);
+	regs.setEbx(ebx);
+	regs.setEcx(ecx);
+	regs.setEdx(edx);
+	ExecuteAt(context, syscall_address);
+	EXPECT_EQ(0u, regs.getEax());
+}
+
+TEST(TestX86DecodeCache, hit)
+{
+	Cleanup();
+	Context *context = newContext();
+	DecodeCache *cache = context->getDecodeCache();
+	WriteMovEax(context->getMemory(), code_address, 1);
+
+	// First execution decodes the instruction
+	ExecuteAt(context, code_address);
+	EXPECT_EQ(1u, context->getRegs().getEax());
+	EXPECT_EQ(code_address + 5, context->getRegs().getEip());
+	EXPECT_EQ(0, cache->getNumHits());
+	EXPECT_EQ(1, cache->getNumMisses());
+
+	// Second execution finds it in the cache
+	context->getRegs().setEax(0);
+	ExecuteAt(context, code_address);
+	EXPECT_EQ(1u, context->getRegs().getEax());
+	EXPECT_EQ(code_address + 5, context->getRegs().getEip());
+	EXPECT_EQ(1, cache->getNumHits());
+	EXPECT_EQ(1, cache->getNumMisses());
+}
+
+TEST(TestX86DecodeCache, write_to_code_page)
+{
+	Cleanup();
+	Context *context = newContext();
+	mem::Memory *memory = context->getMemory();
+	DecodeCache *cache = context->getDecodeCache();
+	WriteMovEax(memory, code_address, 1);
+	ExecuteAt(context, code_address);
+
+	// Writing data into a page without execution permission keeps the
+	// cached instruction
+	const unsigned data_address = 0x30000;
+	memory->Map(data_address, mem::Memory::PageSize,
+			mem::Memory::AccessRead | mem::Memory::AccessWrite);
+	WriteMovEax(memory, data_address, 2);
+	ExecuteAt(context, code_address);
+	EXPECT_EQ(1u, context->getRegs().getEax());
+	EXPECT_EQ(1, cache->getNumHits());
+
+	// Overwriting the code runs the new instruction
+	WriteMovEax(memory, code_address, 3);
+	ExecuteAt(context, code_address);
+	EXPECT_EQ(3u, context->getRegs().getEax());
+	EXPECT_EQ(1, cache->getNumHits());
+	EXPECT_EQ(2, cache->getNumMisses());
+
+	// Writing anywhere else in the code page also invalidates it
+	WriteMovEax(memory, code_address + 0x100, 4);
+	ExecuteAt(context, code_address);
+	EXPECT_EQ(3u, context->getRegs().getEax());
+	EXPECT_EQ(3, cache->getNumMisses());
+}
+
+TEST(TestX86DecodeCache, mprotect)
+{
+	Cleanup();
+	Context *context = newContext();
+	DecodeCache *cache = context->getDecodeCache();
+	WriteMovEax(context->getMemory(), code_address, 1);
+	ExecuteAt(context, code_address);
+	EXPECT_EQ(1, cache->getNumMisses());
+
+	// Make the code page read-only and executable
+	Syscall(context, 125, code_address, mem::Memory::PageSize, 0x5);
+	int num_misses = cache->getNumMisses();
+
+	// Instruction is decoded again
+	ExecuteAt(context, code_address);
+	EXPECT_EQ(1u, context->getRegs().getEax());
+	EXPECT_EQ(num_misses + 1, cache->getNumMisses());
+
+	// Removing execution permission reports the violation instead of
+	// running the cached instruction
+	Syscall(context, 125, code_address, mem::Memory::PageSize, 0x1);
+	EXPECT_THROW(ExecuteAt(context, code_address), mem::Memory::Error);
+}
+
+TEST(TestX86DecodeCache, munmap)
+{
+	Cleanup();
+	Context *context = newContext();
+	mem::Memory *memory = context->getMemory();
+	DecodeCache *cache = context->getDecodeCache();
+	WriteMovEax(memory, code_address, 1);
+	ExecuteAt(context, code_address);
+	ASSERT_TRUE(cache->Lookup(code_address,
+			memory->getPage(code_address)) != nullptr);
+
+	// Unmapping the page drops the cached instruction, even if a new
+	// page is mapped at the same address
+	Syscall(context, 91, code_address, mem::Memory::PageSize, 0);
+	EXPECT_TRUE(memory->getPage(code_address) == nullptr);
+	memory->Map(code_address, mem::Memory::PageSize,
+			mem::Memory::AccessRead |
+			mem::Memory::AccessWrite |
+			mem::Memory::AccessExec);
+	EXPECT_TRUE(cache->Lookup(code_address,
+			memory->getPage(code_address)) == nullptr);
+
+	// New content is executed
+	WriteMovEax(memory, code_address, 2);
+	ExecuteAt(context, code_address);
+	EXPECT_EQ(2u, context->getRegs().getEax());
+}
+
+}  // namespace x86
@@ -0,0 +1,173 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <lib/cpp/Error.h>
+#include <lib/esim/Engine.h>
+#include <memory/Memory.h>
+
+#include "ContextHelpers.h"
+
+namespace x86
+{
+
+// Number of iterations of the loop in the code
+static const int num_iterations = 1000;
+
+// Number of instructions executed by the code, which runs the loop, calls
+// 'getpid' (which runs on the host threads), and calls 'exit' with its
+// result (which runs on the main thread).
+static const int num_code_instructions = 2 * num_iterations + 6;
+
+// Code running 'dec ecx; jnz' in a loop, followed by the system calls
+static const unsigned char code[] = {
+	0xb9, num_iterations & 0xff, num_iterations >> 8, 0x00, 0x00,
+						// mov ecx, num_iterations
+	0x49,					// dec ecx
+	0x75, 0xfd,				// jnz -3
+	0xb8, 0x14, 0x00, 0x00, 0x00,		// mov eax, 20 (getpid)
+	0xcd, 0x80,				// int 0x80
+	0x89, 0xc3,				// mov ebx, eax
+	0xb8, 0x01, 0x00, 0x00, 0x00,		// mov eax, 1 (exit)
+	0xcd, 0x80				// int 0x80
+};
+
+// Run the functional emulation loop until all contexts finish, with the
+// given number of iterations at most
+static void runEmulator(int max_iterations)
+{
+	Emulator *emulator = Emulator::getInstance();
+	for (int i = 0; i < max_iterations && emulator->Run(); i++)
+		;
+}
+
+TEST(TestX86EmulatorThreads, independent_contexts)
+{
+	try
+	{
+		long long num_instructions[2];
+		int num_threads[2] = { 1, 4 };
+		for (int run = 0; run < 2; run++)
+		{
+			// Contexts with separate memory images run on different
+			// host threads
+			Cleanup();
+			Emulator::setNumThreads(num_threads[run]);
+			Emulator::setQuantum(100);
+			Emulator *emulator = Emulator::getInstance();
+			for (int i = 0; i < 4; i++)
+				newContext(code, sizeof code);
+
+			// All contexts finish, and only the instructions that
+			// were executed are counted
+			runEmulator(1000);
+			EXPECT_EQ(0, emulator->getNumContexts());
+			num_instructions[run] = emulator->getNumInstructions();
+			EXPECT_EQ(4 * num_code_instructions,
+					num_instructions[run]);
+		}
+		EXPECT_EQ(num_instructions[0], num_instructions[1]);
+
+		// Restore default number of threads
+		Cleanup();
+		Emulator::setNumThreads(1);
+		Emulator::setQuantum(1);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestX86EmulatorThreads, shared_memory_group)
+{
+	try
+	{
+		// Two contexts sharing a memory image run one after another on
+		// the same host thread, next to two independent contexts
+		Cleanup();
+		Emulator::setNumThreads(4);
+		Emulator::setQuantum(100);
+		Emulator *emulator = Emulator::getInstance();
+		Context *parent = newContext(code, sizeof code);
+		Context *child = emulator->newContext();
+		child->Clone(parent);
+		EXPECT_EQ(parent->getMemory(), child->getMemory());
+		newContext(code, sizeof code);
+		newContext(code, sizeof code);
+
+		// All contexts finish, executing the code once each
+		runEmulator(1000);
+		EXPECT_EQ(0, emulator->getNumContexts());
+		EXPECT_EQ(4 * num_code_instructions,
+				emulator->getNumInstructions());
+
+		// Restore default number of threads
+		Cleanup();
+		Emulator::setNumThreads(1);
+		Emulator::setQuantum(1);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestX86EmulatorThreads, stop_instruction)
+{
+	try
+	{
+		// Contexts run on host threads with a large quantum, but the
+		// emulator stops exactly at the requested instruction
+		Cleanup();
+		Emulator::setNumThreads(4);
+		Emulator::setQuantum(100);
+		Emulator *emulator = Emulator::getInstance();
+		for (int i = 0; i < 4; i++)
+			newContext(code, sizeof code);
+		emulator->setStopInstruction(777);
+		runEmulator(1000);
+		EXPECT_EQ(777, emulator->getNumInstructions());
+		EXPECT_EQ(4, emulator->getNumContexts());
+
+		// Clearing the stop point lets all contexts finish
+		emulator->setStopInstruction(0);
+		runEmulator(1000);
+		EXPECT_EQ(0, emulator->getNumContexts());
+		EXPECT_EQ(4 * num_code_instructions,
+				emulator->getNumInstructions());
+
+		// Restore default number of threads
+		Cleanup();
+		Emulator::setNumThreads(1);
+		Emulator::setQuantum(1);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+}  // namespace x86
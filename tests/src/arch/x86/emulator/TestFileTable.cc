@@ -0,0 +1,80 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <sstream>
+#include <unistd.h>
+
+#include <arch/common/FileTable.h>
+
+namespace x86
+{
+
+TEST(TestX86FileTable, virtual_file_checkpoint)
+{
+	// Create a virtual file the same way the emulator does for files such
+	// as /proc/cpuinfo
+	char temp_path[] = "/tmp/m2s.XXXXXX";
+	int fd = mkstemp(temp_path);
+	ASSERT_GE(fd, 0);
+	const std::string content = "processor : 0\n";
+	ASSERT_EQ((ssize_t) content.size(),
+			write(fd, content.data(), content.size()));
+	close(fd);
+	int host_index = open(temp_path, O_RDONLY);
+	ASSERT_GE(host_index, 0);
+	comm::FileTable file_table;
+	comm::FileDescriptor *desc = file_table.newFileDescriptor(
+			comm::FileDescriptor::TypeVirtual, host_index,
+			temp_path, O_RDONLY);
+	int guest_index = desc->getGuestIndex();
+
+	// Read part of the file
+	char buffer[64];
+	ASSERT_EQ(10, read(host_index, buffer, 10));
+
+	// Save checkpoint and close the file, which deletes it
+	std::stringstream stream;
+	file_table.SaveCheckpoint(stream);
+	file_table.freeFileDescriptor(guest_index);
+	close(host_index);
+	EXPECT_NE(0, access(temp_path, F_OK));
+
+	// Restore checkpoint. The file is read from the saved position.
+	comm::FileTable restored_file_table;
+	restored_file_table.LoadCheckpoint(stream);
+	desc = restored_file_table.getFileDescriptor(guest_index);
+	ASSERT_TRUE(desc != nullptr);
+	EXPECT_EQ(comm::FileDescriptor::TypeVirtual, desc->getType());
+	ssize_t size = read(desc->getHostIndex(), buffer, sizeof buffer);
+	ASSERT_EQ((ssize_t) content.size() - 10, size);
+	EXPECT_EQ(content.substr(10), std::string(buffer, size));
+
+	// Closing the restored file deletes its new temporary file
+	std::string path = desc->getPath();
+	EXPECT_EQ(0, access(path.c_str(), F_OK));
+	close(desc->getHostIndex());
+	restored_file_table.freeFileDescriptor(guest_index);
+	EXPECT_NE(0, access(path.c_str(), F_OK));
+}
+
+}  // namespace x86
@@ -19,6 +19,7 @@
 
 #include "gtest/gtest.h"
 
+#include <utility>
 #include <vector>
 
 #include <lib/cpp/IniFile.h>
@@ -593,8 +594,266 @@ TEST(TestBranchPredictor, test_combined_branch_predictor_1)
 }
 
 
+// Run a conditional branch through the given number of repetitions of a
+// periodic pattern of outcomes, looking up and updating the predictor for
+// each instance, and return the number of correct predictions in the last
+// repetition.
+static int RunBranchPattern(BranchPredictor &branch_predictor,
+		const std::vector<bool> &pattern,
+		int num_repetitions)
+{
+	ObjectPool *object_pool = ObjectPool::getInstance();
+	unsigned int branch_addr = 0x8048100;
+	unsigned int branch_inst_size = 2;
+	unsigned int branch_target_distance = 16;
+	int num_correct = 0;
+	for (int i = 0; i < num_repetitions; i++)
+	{
+		num_correct = 0;
+		for (bool taken : pattern)
+		{
+			auto uinst = misc::new_shared<Uinst>(Uinst::OpcodeBranch);
+			auto uop = misc::new_unique<Uop>(
+					object_pool->getThread(),
+					object_pool->getContext(),
+					uinst);
+			uop->eip = branch_addr;
+			uop->mop_size = branch_inst_size;
+			uop->neip = taken ? branch_addr + branch_target_distance :
+					branch_addr + branch_inst_size;
+			BranchPredictor::Prediction prediction =
+					branch_predictor.Lookup(uop.get());
+			if ((prediction == BranchPredictor::PredictionTaken) == taken)
+				num_correct++;
+			branch_predictor.Update(uop.get());
+		}
+	}
+	return num_correct;
+}
+
+
+TEST(TestBranchPredictor, test_tage_branch_predictor)
+{
+	// Setup configuration file for branch predictor
+	std::string config =
+			"[ BranchPredictor ]\n"
+			"Kind = TAGE\n"
+			"TAGE.NumTables = 4\n"
+			"TAGE.TableSize = 256\n"
+			"TAGE.MaxHistory = 40";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	Timing::ParseConfiguration(&ini_file);
+	BranchPredictor::ParseConfiguration(&ini_file);
+	EXPECT_EQ(BranchPredictor::KindTage, BranchPredictor::getKind());
+	EXPECT_EQ(4, TagePredictor::getNumTables());
+	EXPECT_EQ(256, TagePredictor::getTableSize());
+	EXPECT_EQ(40, TagePredictor::getMaxHistory());
+
+	// A pattern with a period of 7 branches cannot be learned by a bimodal
+	// predictor, but is predicted perfectly using the global history.
+	std::vector<bool> pattern = { true, true, false, true, false, false, true };
+	BranchPredictor branch_predictor;
+	EXPECT_EQ(7, RunBranchPattern(branch_predictor, pattern, 200));
+
+	// A loop with a long constant trip count is captured by the loop
+	// predictor, including its exit.
+	std::vector<bool> loop(60, true);
+	loop.back() = false;
+	BranchPredictor loop_predictor;
+	EXPECT_EQ(60, RunBranchPattern(loop_predictor, loop, 20));
+}
+
+
+TEST(TestBranchPredictor, test_perceptron_branch_predictor)
+{
+	// Setup configuration file for branch predictor
+	std::string config =
+			"[ BranchPredictor ]\n"
+			"Kind = Perceptron\n"
+			"Perceptron.NumTables = 6\n"
+			"Perceptron.TableSize = 512\n"
+			"Perceptron.MaxHistory = 32";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	Timing::ParseConfiguration(&ini_file);
+	BranchPredictor::ParseConfiguration(&ini_file);
+	EXPECT_EQ(BranchPredictor::KindPerceptron, BranchPredictor::getKind());
+	EXPECT_EQ(6, PerceptronPredictor::getNumTables());
+	EXPECT_EQ(512, PerceptronPredictor::getTableSize());
+	EXPECT_EQ(32, PerceptronPredictor::getMaxHistory());
+
+	// Periodic pattern learned from the global history
+	std::vector<bool> pattern = { true, true, false, true, false, false, true };
+	BranchPredictor branch_predictor;
+	EXPECT_EQ(7, RunBranchPattern(branch_predictor, pattern, 200));
 }
 
 
+TEST(TestBranchPredictor, test_indirect_target_predictor)
+{
+	// Setup configuration file for branch predictor
+	std::string config =
+			"[ BranchPredictor ]\n"
+			"Kind = TAGE\n"
+			"ITTAGE = t";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	Timing::ParseConfiguration(&ini_file);
+	BranchPredictor::ParseConfiguration(&ini_file);
+	EXPECT_TRUE(IndirectPredictor::isPresent());
+
+	// An indirect jump cycling through 4 targets always misses in the BTB,
+	// which only remembers the last target, but the sequence of targets
+	// is learned by the indirect target predictor.
+	BranchPredictor branch_predictor;
+	ObjectPool *object_pool = ObjectPool::getInstance();
+	const unsigned int targets[4] = { 0x8049000, 0x8049100, 0x8049180, 0x8049204 };
+	int num_correct = 0;
+	for (int i = 0; i < 4000; i++)
+	{
+		auto uinst = misc::new_shared<Uinst>(Uinst::OpcodeJump);
+		uinst->setIDep(0, Uinst::DepEax);
+		auto uop = misc::new_unique<Uop>(
+				object_pool->getThread(),
+				object_pool->getContext(),
+				uinst);
+		uop->eip = 0x8048200;
+		uop->mop_size = 2;
+		uop->neip = targets[i % 4];
+		unsigned int target = branch_predictor.LookupBtb(uop.get());
+		branch_predictor.Lookup(uop.get());
+		if (i >= 3600 && target == uop->neip)
+			num_correct++;
+		branch_predictor.Update(uop.get());
+		branch_predictor.UpdateBtb(uop.get());
+	}
+	EXPECT_EQ(400, num_correct);
+}
 
 
+TEST(TestBranchPredictor, test_indirect_target_btb_miss)
+{
+	// Setup configuration file for branch predictor, with a BTB of one
+	// entry
+	std::string config =
+			"[ BranchPredictor ]\n"
+			"Kind = TAGE\n"
+			"ITTAGE = t\n"
+			"BTB.Sets = 1\n"
+			"BTB.Assoc = 1";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	Timing::ParseConfiguration(&ini_file);
+	BranchPredictor::ParseConfiguration(&ini_file);
+	EXPECT_TRUE(IndirectPredictor::isPresent());
+
+	// An indirect jump alternates with a direct jump that evicts it from
+	// the BTB, so it always misses in the BTB. Its target is still
+	// provided by the indirect target predictor once it is confident.
+	BranchPredictor branch_predictor;
+	ObjectPool *object_pool = ObjectPool::getInstance();
+	int num_correct = 0;
+	for (int i = 0; i < 2000; i++)
+	{
+		bool indirect = i % 2 == 0;
+		auto uinst = misc::new_shared<Uinst>(Uinst::OpcodeJump);
+		if (indirect)
+			uinst->setIDep(0, Uinst::DepEax);
+		auto uop = misc::new_unique<Uop>(
+				object_pool->getThread(),
+				object_pool->getContext(),
+				uinst);
+		uop->eip = indirect ? 0x8048200 : 0x8049000;
+		uop->mop_size = 2;
+		uop->neip = indirect ? 0x8049000 : 0x8048200;
+		unsigned int target = branch_predictor.LookupBtb(uop.get());
+		branch_predictor.Lookup(uop.get());
+		if (indirect && i >= 1800 && target == uop->neip)
+			num_correct++;
+		branch_predictor.Update(uop.get());
+		branch_predictor.UpdateBtb(uop.get());
+	}
+	EXPECT_EQ(100, num_correct);
+}
+
+
+// Run a conditional branch taken, not taken, and taken again through the BTB
+// of a predictor of the given kind, with or without keeping the taken target
+// of not-taken branches. Return the BTB targets found on the second and third
+// lookups.
+static std::pair<unsigned, unsigned> RunBtbNotTakenTest(const std::string &kind,
+		bool keep_taken_target)
+{
+	// Setup configuration file for branch predictor
+	std::string config =
+			"[ BranchPredictor ]\n"
+			"Kind = " + kind + "\n"
+			"BTB.KeepTakenTarget = " +
+			(keep_taken_target ? "t" : "f");
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	Timing::ParseConfiguration(&ini_file);
+	BranchPredictor::ParseConfiguration(&ini_file);
+
+	// Run the branch
+	BranchPredictor branch_predictor;
+	ObjectPool *object_pool = ObjectPool::getInstance();
+	unsigned int targets[3];
+	for (int i = 0; i < 3; i++)
+	{
+		auto uinst = misc::new_shared<Uinst>(Uinst::OpcodeBranch);
+		auto uop = misc::new_unique<Uop>(
+				object_pool->getThread(),
+				object_pool->getContext(),
+				uinst);
+		uop->eip = 0x8048200;
+		uop->mop_size = 2;
+		uop->target_neip = 0x8049000;
+		uop->neip = i == 1 ? uop->eip + uop->mop_size : 0x8049000;
+		targets[i] = branch_predictor.LookupBtb(uop.get());
+		branch_predictor.UpdateBtb(uop.get());
+	}
+	return std::make_pair(targets[1], targets[2]);
+}
+
+
+TEST(TestBranchPredictor, test_btb_not_taken_target)
+{
+	// The BTB keeps the taken target of a conditional branch that was not
+	// taken, for the next time it is predicted taken, with any predictor
+	for (const std::string kind : { "TwoLevel", "TAGE", "Perceptron" })
+	{
+		std::pair<unsigned, unsigned> targets =
+				RunBtbNotTakenTest(kind, true);
+		EXPECT_EQ(0x8049000u, targets.first);
+		EXPECT_EQ(0x8049000u, targets.second);
+	}
+}
+
+
+TEST(TestBranchPredictor, test_btb_not_taken_fall_through)
+{
+	// By default, the BTB records the fall-through address of a branch
+	// that was not taken, with any predictor
+	for (const std::string kind : { "TwoLevel", "TAGE", "Perceptron" })
+	{
+		std::pair<unsigned, unsigned> targets =
+				RunBtbNotTakenTest(kind, false);
+		EXPECT_EQ(0x8049000u, targets.first);
+		EXPECT_EQ(0x8048202u, targets.second);
+	}
+}
+
+
+}
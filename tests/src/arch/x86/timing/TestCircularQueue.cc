@@ -0,0 +1,156 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include <arch/x86/emulator/Uinst.h>
+#include <arch/x86/timing/CircularQueue.h>
+#include <arch/x86/timing/Core.h>
+#include <arch/x86/timing/Thread.h>
+#include <arch/x86/timing/Uop.h>
+
+#include "ObjectPool.h"
+
+namespace x86
+{
+
+// Create a uop from the pool of the core
+static std::shared_ptr<Uop> CreateUop(ObjectPool *object_pool)
+{
+	auto uinst = misc::new_shared<Uinst>(Uinst::OpcodeAdd);
+	return std::allocate_shared<Uop>(
+			UopAllocator<Uop>(object_pool->getCore()->getUopPool()),
+			object_pool->getThread(),
+			object_pool->getContext(),
+			uinst);
+}
+
+
+// Return the identifiers of the uops in the queue, from head to tail
+static std::vector<long long> getIds(const CircularQueue &queue)
+{
+	std::vector<long long> ids;
+	for (auto &uop : queue)
+		ids.push_back(uop->getId());
+	return ids;
+}
+
+
+TEST(TestCircularQueue, insert_and_extract)
+{
+	// Setup the timing simulator related object pool
+	ObjectPool *object_pool = ObjectPool::getInstance();
+
+	// Create uops
+	std::vector<std::shared_ptr<Uop>> uops;
+	for (int i = 0; i < 6; i++)
+		uops.push_back(CreateUop(object_pool));
+
+	// Queue with 4 slots. Inserting and extracting wraps around the buffer.
+	CircularQueue queue(2, &Uop::uop_queue_index);
+	for (int i = 0; i < 6; i++)
+	{
+		queue.push_back(uops[i]);
+		EXPECT_EQ(1, queue.size());
+		EXPECT_EQ(uops[i], queue.front());
+		EXPECT_EQ(uops[i], queue.back());
+		queue.erase(queue.front().get());
+		EXPECT_TRUE(queue.empty());
+		EXPECT_EQ(-1, uops[i]->uop_queue_index);
+	}
+
+	// Extract from the tail
+	for (int i = 0; i < 3; i++)
+		queue.push_back(uops[i]);
+	queue.erase(queue.back().get());
+	EXPECT_EQ(2, queue.size());
+	EXPECT_EQ(uops[0], queue.front());
+	EXPECT_EQ(uops[1], queue.back());
+}
+
+
+TEST(TestCircularQueue, extract_out_of_order)
+{
+	// Setup the timing simulator related object pool
+	ObjectPool *object_pool = ObjectPool::getInstance();
+
+	// Create uops
+	std::vector<std::shared_ptr<Uop>> uops;
+	for (int i = 0; i < 12; i++)
+		uops.push_back(CreateUop(object_pool));
+
+	// Fill queue with 8 slots
+	CircularQueue queue(4, &Uop::instruction_queue_index);
+	for (int i = 0; i < 8; i++)
+		queue.push_back(uops[i]);
+
+	// Remove every other uop while traversing the queue
+	auto it = queue.begin();
+	auto e = queue.end();
+	int index = 0;
+	while (it != e)
+	{
+		Uop *uop = it->get();
+		++it;
+		if (index % 2)
+			queue.erase(uop);
+		index++;
+	}
+	EXPECT_EQ(4, queue.size());
+	EXPECT_EQ(std::vector<long long>({
+			uops[0]->getId(),
+			uops[2]->getId(),
+			uops[4]->getId(),
+			uops[6]->getId() }), getIds(queue));
+
+	// Fill the last slot. The next insertion finds the buffer full of
+	// holes and compacts it.
+	queue.push_back(uops[8]);
+	queue.push_back(uops[9]);
+	EXPECT_EQ(6, queue.size());
+	EXPECT_EQ(uops[9], queue.back());
+
+	// More insertions than slots make the buffer grow
+	for (int i = 10; i < 12; i++)
+		queue.push_back(uops[i]);
+	for (int i = 1; i < 8; i += 2)
+		queue.push_back(uops[i]);
+	EXPECT_EQ(12, queue.size());
+
+	// Slot indices are still valid after relocation
+	queue.erase(uops[10].get());
+	queue.erase(uops[0].get());
+	queue.erase(uops[7].get());
+	EXPECT_EQ(std::vector<long long>({
+			uops[2]->getId(),
+			uops[4]->getId(),
+			uops[6]->getId(),
+			uops[8]->getId(),
+			uops[9]->getId(),
+			uops[11]->getId(),
+			uops[1]->getId(),
+			uops[3]->getId(),
+			uops[5]->getId() }), getIds(queue));
+	EXPECT_EQ(uops[2], queue.front());
+	EXPECT_EQ(uops[5], queue.back());
+}
+
+}
@@ -349,9 +349,11 @@ TEST(TestX86TimingFetchStage, fetch_same_block)
 	// Cleanup the environment
 	Cleanup();
 
-	// CPU configuration file
+	// CPU configuration file. Idle cycles are not skipped, since the fetch
+	// queue is checked in every cycle.
 	std::string config_string =
 			"[ General ]\n"
+			"SkipIdleCycles = f\n"
 			"[ TraceCache ]\n"
 			"Present = f";
 	misc::IniFile config_ini;
@@ -1050,6 +1050,88 @@ TEST(TestRegisterFile, commit_uop_0)
 }
 
 
+
+
+
+//
+// TrackUop() Tests
+//
+
+
+// Test TrackUop(): a producer writes two registers that a consumer reads.
+// The consumer waits on both of them and becomes ready when the producer
+// writes back. A second consumer stops waiting with UntrackUop() and is not
+// woken up. A third consumer reading a register that is not pending is
+// ready right away.
+TEST(TestRegisterFile, track_uop_0)
+{
+	// Cleanup singleton instances
+	ObjectPool::Destroy();
+
+	// Get object pool instance
+	ObjectPool *object_pool = ObjectPool::getInstance();
+
+	// Create uinsts
+	auto uinst_0 = misc::new_shared<Uinst>(Uinst::OpcodeAdd);
+	auto uinst_1 = misc::new_shared<Uinst>(Uinst::OpcodeAdd);
+	auto uinst_2 = misc::new_shared<Uinst>(Uinst::OpcodeAdd);
+	auto uinst_3 = misc::new_shared<Uinst>(Uinst::OpcodeAdd);
+
+	// Set dependencies
+	uinst_0->setODep(0, Uinst::DepEax);
+	uinst_0->setODep(1, Uinst::DepEbx);
+	uinst_1->setIDep(0, Uinst::DepEax);
+	uinst_1->setIDep(1, Uinst::DepEbx);
+	uinst_1->setODep(0, Uinst::DepEdx);
+	uinst_2->setIDep(0, Uinst::DepEbx);
+	uinst_3->setIDep(0, Uinst::DepEcx);
+
+	// Create uops
+	auto uop_0 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_0);
+	auto uop_1 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_1);
+	auto uop_2 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_2);
+	auto uop_3 = misc::new_unique<Uop>(object_pool->getThread(),
+			object_pool->getContext(),
+			uinst_3);
+
+	// Get register file
+	auto register_file = object_pool->getThread()->getRegisterFile();
+
+	// Rename uops
+	register_file->Rename(uop_0.get());
+	register_file->Rename(uop_1.get());
+	register_file->Rename(uop_2.get());
+	register_file->Rename(uop_3.get());
+
+	// Consumers of the producer's outputs wait
+	EXPECT_FALSE(register_file->TrackUop(uop_1.get()));
+	EXPECT_EQ(2, uop_1->num_pending_inputs);
+	EXPECT_FALSE(register_file->TrackUop(uop_2.get()));
+	EXPECT_EQ(1, uop_2->num_pending_inputs);
+
+	// Consumer of a register that is not pending is ready
+	EXPECT_TRUE(register_file->TrackUop(uop_3.get()));
+	EXPECT_TRUE(uop_3->ready);
+
+	// Second consumer stops waiting
+	register_file->UntrackUop(uop_2.get());
+	EXPECT_EQ(0, uop_2->num_pending_inputs);
+
+	// Producer writes back
+	register_file->WriteUop(uop_0.get());
+	EXPECT_TRUE(uop_1->ready);
+	EXPECT_EQ(0, uop_1->num_pending_inputs);
+	EXPECT_FALSE(uop_2->ready);
+	EXPECT_TRUE(register_file->isUopReady(uop_2.get()));
+}
+
+
 } // Namespace x86
 
 
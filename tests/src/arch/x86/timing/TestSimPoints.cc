@@ -0,0 +1,170 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <unistd.h>
+
+#include <arch/x86/timing/SimPoints.h>
+#include <arch/x86/timing/Timing.h>
+
+namespace x86
+{
+
+// Temporary file with the given content, deleted when destroyed
+class TempFile
+{
+	char path[20] = "/tmp/m2s.XXXXXX";
+
+public:
+
+	TempFile(const std::string &content)
+	{
+		int fd = mkstemp(path);
+		EXPECT_GE(fd, 0);
+		EXPECT_EQ((ssize_t) content.size(),
+				write(fd, content.data(), content.size()));
+		close(fd);
+	}
+
+	~TempFile() { unlink(path); }
+
+	const char *getPath() const { return path; }
+};
+
+TEST(TestSimPoints, parse_files)
+{
+	try
+	{
+		// Simulation points are sorted by interval, and get the
+		// weights of their clusters. Empty lines are skipped.
+		TempFile simpoints_file("12 0\n\n3 1\n  7 2  \n");
+		TempFile weights_file("0.5 0\n0.3 1\n\n0.2 2\n");
+		SimPoints simpoints(nullptr, simpoints_file.getPath(),
+				weights_file.getPath(), 100, 0);
+		ASSERT_EQ(3, simpoints.getNumSimPoints());
+		EXPECT_EQ(3, simpoints.getSimPoint(0).interval);
+		EXPECT_EQ(1, simpoints.getSimPoint(0).cluster);
+		EXPECT_DOUBLE_EQ(0.3, simpoints.getSimPoint(0).weight);
+		EXPECT_EQ(7, simpoints.getSimPoint(1).interval);
+		EXPECT_EQ(2, simpoints.getSimPoint(1).cluster);
+		EXPECT_DOUBLE_EQ(0.2, simpoints.getSimPoint(1).weight);
+		EXPECT_EQ(12, simpoints.getSimPoint(2).interval);
+		EXPECT_EQ(0, simpoints.getSimPoint(2).cluster);
+		EXPECT_DOUBLE_EQ(0.5, simpoints.getSimPoint(2).weight);
+		EXPECT_FALSE(simpoints.getSimPoint(0).measured);
+		EXPECT_EQ(0.0, simpoints.getCpi());
+
+		// Without weights, all simulation points weigh the same
+		SimPoints unweighted(nullptr, simpoints_file.getPath(), "",
+				100, 0);
+		for (int i = 0; i < unweighted.getNumSimPoints(); i++)
+			EXPECT_DOUBLE_EQ(1.0 / 3,
+					unweighted.getSimPoint(i).weight);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestSimPoints, malformed_files)
+{
+	// Invalid simulation point files
+	const char *invalid_simpoints[] = {
+		"",
+		"\n\n",
+		"3\n",
+		"3 1 4\n",
+		"-1 0\n",
+		"three 1\n",
+		"3 1\n5 0\n3 2\n"
+	};
+	for (const char *content : invalid_simpoints)
+	{
+		TempFile simpoints_file(content);
+		EXPECT_THROW(SimPoints(nullptr, simpoints_file.getPath(), "",
+				100, 0), Timing::Error) << content;
+	}
+	EXPECT_THROW(SimPoints(nullptr, "/nonexistent/m2s.simpoints", "",
+			100, 0), Timing::Error);
+
+	// Invalid weight files, or weights missing for a cluster
+	TempFile simpoints_file("3 0\n5 1\n");
+	const char *invalid_weights[] = {
+		"0.5\n",
+		"0.5 0 1\n",
+		"-0.5 0\n0.5 1\n",
+		"0.5 0\n"
+	};
+	for (const char *content : invalid_weights)
+	{
+		TempFile weights_file(content);
+		EXPECT_THROW(SimPoints(nullptr, simpoints_file.getPath(),
+				weights_file.getPath(), 100, 0),
+				Timing::Error) << content;
+	}
+	EXPECT_THROW(SimPoints(nullptr, simpoints_file.getPath(),
+			"/nonexistent/m2s.weights", 100, 0), Timing::Error);
+}
+
+TEST(TestSimPoints, positions)
+{
+	try
+	{
+		// Intervals of 100 instructions, with a warmup of 150
+		// instructions that cannot start before the program does
+		TempFile simpoints_file("0 0\n2 1\n10 2\n");
+		SimPoints simpoints(nullptr, simpoints_file.getPath(), "",
+				100, 150);
+		EXPECT_EQ(0, simpoints.getStartPosition(0));
+		EXPECT_EQ(0, simpoints.getWarmupPosition(0));
+		EXPECT_EQ(200, simpoints.getStartPosition(1));
+		EXPECT_EQ(50, simpoints.getWarmupPosition(1));
+		EXPECT_EQ(1000, simpoints.getStartPosition(2));
+		EXPECT_EQ(850, simpoints.getWarmupPosition(2));
+
+		// The warmup of the second point starts before the first one
+		// ends, so the detailed simulation goes on without
+		// fast-forwarding. The third point is fast-forwarded from the
+		// end of the second one.
+		EXPECT_LT(simpoints.getWarmupPosition(1),
+				simpoints.getStartPosition(0) + 100);
+		EXPECT_EQ(550, simpoints.getWarmupPosition(2) -
+				(simpoints.getStartPosition(1) + 100));
+
+		// Without warmup, fast-forwarding reaches the start of each
+		// interval
+		SimPoints no_warmup(nullptr, simpoints_file.getPath(), "",
+				100, 0);
+		for (int i = 0; i < no_warmup.getNumSimPoints(); i++)
+			EXPECT_EQ(no_warmup.getStartPosition(i),
+					no_warmup.getWarmupPosition(i));
+		EXPECT_EQ(0, no_warmup.getNumFastForwardInstructions());
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+}  // namespace x86
@@ -24,8 +24,11 @@
 #include <dram/Address.h>
 #include <dram/Bank.h>
 #include <dram/Channel.h>
+#include <dram/Command.h>
 #include <dram/Controller.h>
 #include <dram/Rank.h>
+#include <dram/Request.h>
+#include <dram/Scheduler.h>
 #include <dram/System.h>
 #include <gtest/gtest.h>
 #include <lib/cpp/IniFile.h>
@@ -806,4 +809,174 @@ TEST(TestSystemEvents, section_test_address_out_of_bounds)
 	EXPECT_REGEX_MATCH(misc::fmt("Invalid Address").c_str(),
 			message.c_str());
 }
+
+// Submit a read to row 0, a read to row 1, and a read to row 0 of bank 0, and
+// run until the bank is idle. Return the controller.
+static Controller *RunRowHitTest(const std::string &policy)
+{
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(default_config +
+			"SchedulingPolicy = " + policy + "\n");
+
+	// Set up dram instance
+	System *dram_system = System::getInstance();
+	dram_system->ParseConfiguration(&ini_file);
+
+	// Submit the requests
+	dram_system->Read(0);
+	dram_system->Read(1 << 10);
+	dram_system->Read(1);
+
+	// Get relevent bank
+	Controller *controller = dram_system->getController(0);
+	Bank *bank = controller->getChannel(0)->getRank(0)->getBank(0);
+
+	// Process events until all requests are served
+	esim::Engine *engine = esim::Engine::getInstance();
+	for (int i = 0; i < 1000; i++)
+		engine->ProcessEvents();
+	EXPECT_EQ(0, bank->getNumRequestsInQueue());
+	EXPECT_EQ(0, bank->getNumCommandsInQueue());
+	return controller;
+}
+
+TEST(TestSystemEvents, section_oldest_first_row_conflicts)
+{
+	// cleanup singleton instance
+	Cleanup();
+
+	// Requests are served in order, closing row 0 in between
+	try
+	{
+		Controller *controller = RunRowHitTest("OldestFirst");
+		EXPECT_EQ(0, controller->getNumRowHits());
+		EXPECT_EQ(1, controller->getNumRowMisses());
+		EXPECT_EQ(2, controller->getNumRowConflicts());
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestSystemEvents, section_fr_fcfs_row_hit_first)
+{
+	// cleanup singleton instance
+	Cleanup();
+
+	// The second read to row 0 is served before the read to row 1
+	try
+	{
+		Controller *controller = RunRowHitTest("FrFcfs");
+		EXPECT_EQ(1, controller->getNumRowHits());
+		EXPECT_EQ(1, controller->getNumRowMisses());
+		EXPECT_EQ(1, controller->getNumRowConflicts());
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestSystemEvents, section_fr_fcfs_cap_zero)
+{
+	// cleanup singleton instance
+	Cleanup();
+
+	// With a cap of zero, no row hit can bypass an older request
+	try
+	{
+		Controller *controller = RunRowHitTest("FrFcfsCap\n"
+				"StarvationCap = 0");
+		EXPECT_EQ(0, controller->getNumRowHits());
+		EXPECT_EQ(2, controller->getNumRowConflicts());
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestSystemEvents, section_bliss_blacklist)
+{
+	// cleanup singleton instance
+	Cleanup();
+
+	// A source is blacklisted when it is served more than the threshold
+	// of consecutive requests, and the blacklist is cleared periodically.
+	try
+	{
+		// Set up INI file
+		misc::IniFile ini_file;
+		ini_file.LoadFromString(default_config +
+				"SchedulingPolicy = Bliss\n"
+				"BlacklistThreshold = 2\n"
+				"BlacklistClearingInterval = 100\n");
+
+		// Set up dram instance
+		System *dram_system = System::getInstance();
+		dram_system->ParseConfiguration(&ini_file);
+
+		// Get the scheduler
+		Controller *controller = dram_system->getController(0);
+		int source = controller->AddSource("source");
+		int other_source = controller->AddSource("other_source");
+		Channel *channel = controller->getChannel(0);
+		Bank *bank = channel->getRank(0)->getBank(0);
+		Bliss *bliss = dynamic_cast<Bliss *>(channel->getScheduler());
+		ASSERT_TRUE(bliss != nullptr);
+
+		// Run a command of the given type for a request of the source
+		auto serve = [&](int source, CommandType type)
+		{
+			auto request = std::make_shared<Request>();
+			request->setSource(source);
+			Command command(request, type, 0, bank);
+			bliss->CommandRun(&command);
+		};
+
+		// Up to the threshold, the source is not blacklisted
+		serve(source, CommandRead);
+		serve(source, CommandRead);
+		EXPECT_FALSE(bliss->isBlacklisted(source));
+
+		// Commands that do not serve requests are not counted
+		serve(source, CommandActivate);
+		serve(source, CommandPrecharge);
+		EXPECT_FALSE(bliss->isBlacklisted(source));
+
+		// One more request blacklists the source
+		serve(source, CommandWrite);
+		EXPECT_TRUE(bliss->isBlacklisted(source));
+		EXPECT_FALSE(bliss->isBlacklisted(other_source));
+
+		// A different source restarts the count
+		serve(other_source, CommandRead);
+		serve(other_source, CommandRead);
+		EXPECT_FALSE(bliss->isBlacklisted(other_source));
+
+		// The blacklist is not cleared before the interval
+		esim::Engine *engine = esim::Engine::getInstance();
+		while (System::frequency_domain->getCycle() < 99)
+			engine->ProcessEvents();
+		bliss->FindNext();
+		EXPECT_TRUE(bliss->isBlacklisted(source));
+
+		// The blacklist is cleared after the interval
+		while (System::frequency_domain->getCycle() < 100)
+			engine->ProcessEvents();
+		bliss->FindNext();
+		EXPECT_FALSE(bliss->isBlacklisted(source));
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
 }
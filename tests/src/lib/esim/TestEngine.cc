@@ -165,6 +165,53 @@ TEST(TestEngine, test_event_frame)
 	}
 }
 
+// Tests the ability to schedule an event in a pooled event frame
+TEST(TestEngine, test_event_frame_pooled)
+{
+	try
+	{
+		// Cleanup pointers to singleton instances
+		Cleanup();
+
+		// Set frame
+		auto frame = new_frame<DummyFrame_1>();
+
+		// Set up esim engine
+		Engine *engine = Engine::getInstance();
+
+		// Set up frequency domain
+		FrequencyDomain *domain = engine->RegisterFrequencyDomain(
+				"Test frequency domain", 2e3);
+
+		// Register event
+		Event *event = engine->RegisterEvent(
+				"test event", testHandler_1, domain);
+
+		// Schedule next event for 0 cycles from now
+		engine->Call(event, frame, nullptr, 0, 0);
+
+		// Run simulation for 1 cycle
+		engine->ProcessEvents();
+
+		// Check that handler was executed
+		EXPECT_EQ(1, frame->counter);
+
+		// Schedule the same frame for 2 cycles from now, and run
+		// simulation for 3 cycles
+		engine->Call(event, frame, nullptr, 2, 0);
+		for (int i = 0; i < 3; i++)
+			engine->ProcessEvents();
+
+		// Check that handler was executed again on the same frame
+		EXPECT_EQ(2, frame->counter);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
 
 
 
@@ -516,9 +563,272 @@ TEST(TestEngine, test_event_queue_priority)
 	}
 }
 
+
+
+
+//
+// Test 5
+//
+
+// Frame that reschedules itself a number of times
+class DummyFrame_5 : public Frame
+{
+public:
+	int id;
+	int remaining;
+
+	DummyFrame_5(int id, int remaining) : id(id), remaining(remaining) { }
+};
+
+// Sequence of (time, frame) pairs for executed events
+std::vector<std::pair<long long, int>> trace_5;
+
+// Pseudo-random number generator giving the same sequence in every run
+unsigned random_5;
+
+int getRandom_5(int max)
+{
+	random_5 = random_5 * 1103515245 + 12345;
+	return (random_5 >> 16) % max;
+}
+
+void testHandler_5(Event *event, Frame *frame)
+{
+	// Record execution
+	Engine *engine = Engine::getInstance();
+	DummyFrame_5 *data = dynamic_cast<DummyFrame_5 *>(frame);
+	trace_5.emplace_back(engine->getTime(), data->id);
+
+	// Reschedule, mostly within a few cycles, sometimes far ahead
+	if (data->remaining-- > 0)
+	{
+		int after = getRandom_5(4) ? getRandom_5(8) :
+				getRandom_5(3000);
+		engine->Next(event, after);
+	}
+}
+
+// Run events in two frequency domains and return the trace of executed
+// events.
+std::vector<std::pair<long long, int>> runSchedule_5(
+		Engine::SchedulerKind kind)
+{
+	// Set up esim engine
+	Cleanup();
+	Engine::setSchedulerKind(kind);
+	Engine *engine = Engine::getInstance();
+	FrequencyDomain *fast_domain = engine->RegisterFrequencyDomain(
+			"fast domain", 1000);
+	FrequencyDomain *slow_domain = engine->RegisterFrequencyDomain(
+			"slow domain", 600);
+	Event *fast_event = engine->RegisterEvent("fast event",
+			testHandler_5, fast_domain);
+	Event *slow_event = engine->RegisterEvent("slow event",
+			testHandler_5, slow_domain);
+
+	// Schedule events
+	trace_5.clear();
+	random_5 = 1;
+	for (int i = 0; i < 200; i++)
+		engine->Call(i % 2 ? fast_event : slow_event,
+				misc::new_shared<DummyFrame_5>(i, 20),
+				nullptr, getRandom_5(10));
+
+	// Run simulation
+	for (int i = 0; i < 10000; i++)
+		engine->ProcessEvents();
+	engine->ProcessAllEvents();
+
+	// Restore default scheduler
+	Engine::setSchedulerKind(Engine::SchedulerHeap);
+	return trace_5;
+}
+
+// Tests that the calendar queue runs events in the same order as the heap
+TEST(TestEngine, test_calendar_queue)
+{
+	try
+	{
+		std::vector<std::pair<long long, int>> heap_trace =
+				runSchedule_5(Engine::SchedulerHeap);
+		std::vector<std::pair<long long, int>> calendar_trace =
+				runSchedule_5(Engine::SchedulerCalendar);
+		EXPECT_EQ(200u * 21, heap_trace.size());
+		EXPECT_TRUE(heap_trace == calendar_trace);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+
+
+//
+// Test 6
+//
+
+// Frame recording its destruction
+class DummyFrame_6 : public Frame
+{
+public:
+	bool *destroyed;
+
+	DummyFrame_6(bool *destroyed) : destroyed(destroyed) { }
+
+	~DummyFrame_6() { *destroyed = true; }
+};
+
+void testHandler_6(Event *event, Frame *frame)
+{
+}
+
+// Tests that frames are freed when the last reference disappears, and that
+// their memory is reused.
+TEST(TestEngine, test_frame_pointer)
+{
+	try
+	{
+		// Set up esim engine
+		Cleanup();
+		Engine *engine = Engine::getInstance();
+		FrequencyDomain *domain = engine->RegisterFrequencyDomain(
+				"frequency domain", 1000);
+		Event *event = engine->RegisterEvent("event", testHandler_6,
+				domain);
+
+		// Frame referenced by the engine and by a local pointer
+		bool destroyed = false;
+		auto frame = new_frame<DummyFrame_6>(&destroyed);
+		FramePointer<Frame> base_frame = frame;
+		engine->Call(event, std::move(frame), nullptr, 1);
+		EXPECT_TRUE(frame == nullptr);
+		engine->ProcessEvents();
+		engine->ProcessEvents();
+		EXPECT_FALSE(destroyed);
+
+		// Release the last reference
+		Frame *address = base_frame.get();
+		base_frame = nullptr;
+		EXPECT_TRUE(destroyed);
+
+		// The next frame of the same size takes the same memory
+		destroyed = false;
+		frame = new_frame<DummyFrame_6>(&destroyed);
+		EXPECT_EQ(address, frame.get());
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+
+
+// Tests that frames created with misc::new_shared() can still be passed to
+// the engine, and stay alive while referenced by either kind of pointer.
+TEST(TestEngine, test_frame_pointer_shared_ptr)
+{
+	try
+	{
+		// Set up esim engine
+		Cleanup();
+		Engine *engine = Engine::getInstance();
+		FrequencyDomain *domain = engine->RegisterFrequencyDomain(
+				"frequency domain", 1000);
+		Event *event = engine->RegisterEvent("event", testHandler_6,
+				domain);
+
+		// Frame owned by a shared pointer, outliving the engine's
+		// references to it
+		bool destroyed = false;
+		auto frame = misc::new_shared<DummyFrame_6>(&destroyed);
+		engine->Call(event, frame, nullptr, 1);
+		engine->ProcessEvents();
+		engine->ProcessEvents();
+		engine->Schedule(event, frame, 1);
+		engine->ProcessEvents();
+		engine->ProcessEvents();
+		EXPECT_FALSE(destroyed);
+		EXPECT_EQ(1, frame.use_count());
+		frame = nullptr;
+		EXPECT_TRUE(destroyed);
+
+		// Frame pointer outliving the shared pointer
+		destroyed = false;
+		frame = misc::new_shared<DummyFrame_6>(&destroyed);
+		FramePointer<Frame> frame_pointer = frame;
+		frame = nullptr;
+		EXPECT_FALSE(destroyed);
+		frame_pointer = nullptr;
+		EXPECT_TRUE(destroyed);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
 }
 
 
 
 
+//
+// Test 7
+//
+
+// Times at which the handler was invoked
+std::vector<long long> times_7;
+
+void testHandler_7(Event *event, Frame *frame)
+{
+	times_7.push_back(Engine::getInstance()->getTime());
+}
+
+// Tests skipping simulation time until the next pending event
+TEST(TestEngine, test_skip_to)
+{
+	try
+	{
+		// Set up esim engine
+		Cleanup();
+		times_7.clear();
+		Engine *engine = Engine::getInstance();
+		FrequencyDomain *domain = engine->RegisterFrequencyDomain(
+				"frequency domain", 1000);
+		Event *event = engine->RegisterEvent("event", testHandler_7,
+				domain);
+		EXPECT_EQ(-1, engine->getNextEventTime());
+
+		// Events in cycles 5 and 20
+		engine->Schedule(event, new_frame<Frame>(), 20);
+		engine->Schedule(event, new_frame<Frame>(), 5);
+		EXPECT_EQ(5000, engine->getNextEventTime());
+
+		// Time cannot skip over a pending event
+		engine->SkipTo(3000);
+		EXPECT_EQ(3000, engine->getTime());
+		EXPECT_THROW(engine->SkipTo(8000), misc::Panic);
+		for (int i = 0; i < 3; i++)
+			engine->ProcessEvents();
+		EXPECT_EQ(std::vector<long long>({ 5000 }), times_7);
+
+		// Skip to the next event
+		EXPECT_EQ(20000, engine->getNextEventTime());
+		engine->SkipTo(20000);
+		engine->ProcessEvents();
+		EXPECT_EQ(std::vector<long long>({ 5000, 20000 }), times_7);
+		EXPECT_EQ(-1, engine->getNextEventTime());
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
 
+}
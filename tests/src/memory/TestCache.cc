@@ -0,0 +1,174 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <memory/Cache.h>
+
+namespace mem
+{
+
+TEST(TestCache, find_block)
+{
+	Cache cache("cache", 4, 64, 64, Cache::ReplacementLRU, Cache::WriteBack);
+
+	// Blocks with the same tag in both groups of ways compared together
+	cache.setBlock(1, 5, 0x1040, Cache::BlockShared);
+	cache.setBlock(1, 40, 0x2040, Cache::BlockModified);
+	cache.setBlock(1, 41, 0x3040, Cache::BlockInvalid);
+	cache.setTransientTag(1, 41, 0x2040);
+
+	// Hits
+	unsigned set_id;
+	unsigned way_id;
+	Cache::BlockState state;
+	EXPECT_TRUE(cache.FindBlock(0x1040, set_id, way_id, state));
+	EXPECT_EQ(set_id, 1u);
+	EXPECT_EQ(way_id, 5u);
+	EXPECT_EQ(state, Cache::BlockShared);
+	EXPECT_TRUE(cache.FindBlock(0x2050, set_id, way_id, state));
+	EXPECT_EQ(way_id, 40u);
+	EXPECT_EQ(state, Cache::BlockModified);
+
+	// Tags of invalid blocks do not hit
+	EXPECT_FALSE(cache.FindBlock(0x3040, set_id, way_id, state));
+
+	// Masks are relative to the first way compared
+	unsigned transient_mask;
+	EXPECT_EQ(cache.MatchTags(1, 0, 0x2040, transient_mask), 0u);
+	EXPECT_EQ(transient_mask, 0u);
+	EXPECT_EQ(cache.MatchTags(1, 32, 0x2040, transient_mask), 1u << 8);
+	EXPECT_EQ(transient_mask, 1u << 9);
+	EXPECT_EQ(cache.MatchTags(1, 32, 0x3040, transient_mask), 0u);
+}
+
+
+TEST(TestCache, replacement_lru)
+{
+	Cache cache("cache", 1, 4, 64, Cache::ReplacementLRU, Cache::WriteBack);
+
+	// Blocks start in way order, and a replaced block becomes the most
+	// recently used.
+	EXPECT_EQ(cache.ReplaceBlock(0), 3u);
+	EXPECT_EQ(cache.getBlockAge(0, 3), 0u);
+
+	// Order is now 1, 3, 0, 2
+	cache.AccessBlock(0, 1);
+	EXPECT_EQ(cache.getBlockAge(0, 1), 0u);
+	EXPECT_EQ(cache.getBlockAge(0, 2), 3u);
+	EXPECT_EQ(cache.ReplaceBlock(0), 2u);
+	EXPECT_EQ(cache.ReplaceBlock(0), 0u);
+}
+
+
+TEST(TestCache, replacement_plru)
+{
+	Cache cache("cache", 1, 4, 64, Cache::ReplacementPLRU, Cache::WriteBack);
+
+	// Consecutive replacements visit all ways
+	EXPECT_EQ(cache.ReplaceBlock(0), 0u);
+	EXPECT_EQ(cache.ReplaceBlock(0), 2u);
+	EXPECT_EQ(cache.ReplaceBlock(0), 1u);
+	EXPECT_EQ(cache.ReplaceBlock(0), 3u);
+
+	// An access protects the block and its sibling subtree is replaced
+	cache.AccessBlock(0, 0);
+	EXPECT_EQ(cache.ReplaceBlock(0), 2u);
+	cache.AccessBlock(0, 3);
+	EXPECT_EQ(cache.ReplaceBlock(0), 1u);
+}
+
+
+TEST(TestCache, replacement_srrip)
+{
+	Cache cache("cache", 1, 4, 64, Cache::ReplacementSRRIP, Cache::WriteBack);
+
+	// Fill the set. Blocks are inserted with a long re-reference interval.
+	for (unsigned way_id = 0; way_id < 4; way_id++)
+	{
+		EXPECT_EQ(cache.ReplaceBlock(0), way_id);
+		cache.InsertBlock(0, way_id);
+		EXPECT_EQ(cache.getBlockAge(0, way_id),
+				(unsigned) Cache::max_rrpv - 1);
+	}
+
+	// A hit promotes the block, and the set ages until a victim is found
+	cache.AccessBlock(0, 2);
+	EXPECT_EQ(cache.getBlockAge(0, 2), 0u);
+	EXPECT_EQ(cache.ReplaceBlock(0), 0u);
+	EXPECT_EQ(cache.getBlockAge(0, 2), 1u);
+	EXPECT_EQ(cache.getBlockAge(0, 1), (unsigned) Cache::max_rrpv);
+}
+
+
+TEST(TestCache, replacement_drrip)
+{
+	Cache cache("cache", 128, 4, 64, Cache::ReplacementDRRIP,
+			Cache::WriteBack);
+	EXPECT_FALSE(cache.isBRRIPSelected());
+
+	// Misses in an SRRIP leader set select BRRIP for the followers
+	cache.InsertBlock(0, 0);
+	EXPECT_TRUE(cache.isBRRIPSelected());
+	cache.InsertBlock(0, 1);
+
+	// Misses in a BRRIP leader set select SRRIP back
+	cache.InsertBlock(1, 0);
+	cache.InsertBlock(1, 1);
+	EXPECT_FALSE(cache.isBRRIPSelected());
+
+	// Most blocks in follower sets are inserted with a distant prediction
+	// under BRRIP.
+	cache.InsertBlock(0, 2);
+	cache.InsertBlock(0, 3);
+	ASSERT_TRUE(cache.isBRRIPSelected());
+	cache.InsertBlock(2, 0);
+	EXPECT_EQ(cache.getBlockAge(2, 0), (unsigned) Cache::max_rrpv);
+}
+
+
+TEST(TestCache, replacement_ship)
+{
+	Cache cache("cache", 1, 2, 64, Cache::ReplacementSHiP, Cache::WriteBack);
+
+	// Fill the set from two instructions
+	EXPECT_EQ(cache.ReplaceBlock(0), 0u);
+	cache.InsertBlock(0, 0, 0x100);
+	cache.setBlock(0, 0, 0x0, Cache::BlockExclusive);
+	EXPECT_EQ(cache.ReplaceBlock(0), 1u);
+	cache.InsertBlock(0, 1, 0x200);
+	cache.setBlock(0, 1, 0x40, Cache::BlockExclusive);
+
+	// Evicting the block of the first instruction without reuse makes
+	// its next insertions distant.
+	EXPECT_EQ(cache.ReplaceBlock(0), 0u);
+	cache.InsertBlock(0, 0, 0x100);
+	cache.setBlock(0, 0, 0x80, Cache::BlockExclusive);
+	EXPECT_EQ(cache.getBlockAge(0, 0), (unsigned) Cache::max_rrpv);
+
+	// Reusing the block trains the counter back
+	cache.AccessBlock(0, 0);
+	EXPECT_EQ(cache.getBlockAge(0, 0), 0u);
+	EXPECT_EQ(cache.ReplaceBlock(0), 1u);
+	cache.InsertBlock(0, 1, 0x100);
+	EXPECT_EQ(cache.getBlockAge(0, 1), (unsigned) Cache::max_rrpv - 1);
+}
+
+
+}  // namespace mem
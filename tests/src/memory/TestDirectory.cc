@@ -0,0 +1,68 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <memory/Directory.h>
+
+namespace mem
+{
+
+// Directory sets are only allocated when modified or locked, and sets that
+// were never allocated read as empty.
+TEST(TestDirectory, sparse_sets)
+{
+	Directory directory("dir", 1 << 20, 16, 1, 64);
+	EXPECT_EQ(directory.getNumAllocatedSets(), 0);
+
+	// Reads do not allocate sets
+	EXPECT_EQ(directory.getEntry(1000, 3, 0)->getOwner(),
+			Directory::NoOwner);
+	EXPECT_EQ(directory.getEntry(1000, 3, 0)->getNumSharers(), 0);
+	EXPECT_FALSE(directory.isSharer(1000, 3, 0, 63));
+	EXPECT_FALSE(directory.isBlockSharedOrOwned(1000, 3));
+	EXPECT_FALSE(directory.isEntryLocked(1000, 3));
+	directory.clearSharer(1000, 3, 0, 63);
+	directory.clearAllSharers(1000, 3, 0);
+	EXPECT_EQ(directory.getNumAllocatedSets(), 0);
+
+	// Sharers and owners
+	directory.setSharer(1000, 3, 0, 63);
+	directory.setSharer(1000, 3, 0, 2);
+	directory.setOwner(1000, 15, 0, 5);
+	EXPECT_EQ(directory.getNumAllocatedSets(), 1);
+	EXPECT_TRUE(directory.isSharer(1000, 3, 0, 63));
+	EXPECT_FALSE(directory.isSharer(1000, 4, 0, 63));
+	EXPECT_EQ(directory.getEntry(1000, 3, 0)->getNumSharers(), 2);
+	EXPECT_EQ(directory.getEntry(1000, 15, 0)->getOwner(), 5);
+	directory.clearSharer(1000, 3, 0, 63);
+	EXPECT_EQ(directory.getEntry(1000, 3, 0)->getNumSharers(), 1);
+	directory.clearAllSharers(1000, 3, 0);
+	EXPECT_FALSE(directory.isSharer(1000, 3, 0, 2));
+
+	// Locks
+	EXPECT_TRUE(directory.LockEntry((1 << 20) - 1, 0, nullptr, 7));
+	EXPECT_EQ(directory.getNumAllocatedSets(), 2);
+	EXPECT_EQ(directory.getEntryAccessId((1 << 20) - 1, 0), 7);
+	directory.UnlockEntry((1 << 20) - 1, 0, 7);
+	EXPECT_FALSE(directory.isEntryLocked((1 << 20) - 1, 0));
+}
+
+
+}  // namespace mem
@@ -0,0 +1,168 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <memory/Memory.h>
+
+namespace mem
+{
+
+TEST(TestMemory, map_and_unmap)
+{
+	Memory memory;
+
+	// Map pages across a page table boundary, and near both ends of the
+	// address space
+	memory.Map(0x3ff000, 2 * Memory::PageSize,
+			Memory::AccessRead | Memory::AccessWrite);
+	memory.Map(0, Memory::PageSize, Memory::AccessRead);
+	memory.Map(0xffffe000, Memory::PageSize, Memory::AccessRead);
+	EXPECT_EQ(4u, memory.getNumPages());
+	ASSERT_TRUE(memory.getPage(0x3ff123) != nullptr);
+	EXPECT_EQ(0x3ff000u, memory.getPage(0x3ff123)->getTag());
+	ASSERT_TRUE(memory.getPage(0x400fff) != nullptr);
+	EXPECT_EQ(0x400000u, memory.getPage(0x400fff)->getTag());
+	EXPECT_TRUE(memory.getPage(0x401000) == nullptr);
+	ASSERT_TRUE(memory.getPage(0xffffeff0) != nullptr);
+	EXPECT_EQ(0xffffe000u, memory.getPage(0xffffeff0)->getTag());
+
+	// Unmapped pages must not be returned, even if they were recently
+	// accessed.
+	memory.Unmap(0x3ff000, Memory::PageSize);
+	EXPECT_EQ(3u, memory.getNumPages());
+	EXPECT_TRUE(memory.getPage(0x3ff000) == nullptr);
+	EXPECT_TRUE(memory.getPage(0x400000) != nullptr);
+
+	// Pages 256 pages apart, mapping into the same TLB entry
+	unsigned alias = 0x3ff000 + 256 * Memory::PageSize;
+	memory.Map(alias, Memory::PageSize, Memory::AccessRead);
+	EXPECT_EQ(alias, memory.getPage(alias)->getTag());
+	memory.Map(0x3ff000, Memory::PageSize, Memory::AccessRead);
+	EXPECT_EQ(0x3ff000u, memory.getPage(0x3ff000)->getTag());
+	EXPECT_EQ(alias, memory.getPage(alias)->getTag());
+
+	// Clear
+	memory.Clear();
+	EXPECT_EQ(0u, memory.getNumPages());
+	EXPECT_TRUE(memory.getPage(0) == nullptr);
+	EXPECT_TRUE(memory.getPage(0x400000) == nullptr);
+}
+
+TEST(TestMemory, next_page)
+{
+	Memory memory;
+	memory.Map(0x1000, Memory::PageSize, Memory::AccessRead);
+	memory.Map(0x12345000, Memory::PageSize, Memory::AccessRead);
+	memory.Map(0xffffe000, Memory::PageSize, Memory::AccessRead);
+
+	// Pages are found in increasing order, skipping empty page tables
+	Memory::Page *page = memory.getNextPage(0);
+	ASSERT_TRUE(page != nullptr);
+	EXPECT_EQ(0x1000u, page->getTag());
+	page = memory.getNextPage(page->getTag());
+	ASSERT_TRUE(page != nullptr);
+	EXPECT_EQ(0x12345000u, page->getTag());
+	page = memory.getNextPage(page->getTag());
+	ASSERT_TRUE(page != nullptr);
+	EXPECT_EQ(0xffffe000u, page->getTag());
+	EXPECT_TRUE(memory.getNextPage(page->getTag()) == nullptr);
+}
+
+TEST(TestMemory, access)
+{
+	Memory memory;
+	memory.Map(0x2000, 2 * Memory::PageSize,
+			Memory::AccessRead | Memory::AccessWrite);
+
+	// Access crossing a page boundary
+	unsigned value = 0x12345678;
+	unsigned result = 0;
+	memory.Write(0x2ffe, 4, (char *) &value);
+	memory.Read(0x2ffe, 4, (char *) &result);
+	EXPECT_EQ(value, result);
+
+	// Permissions are checked in safe mode
+	EXPECT_THROW(memory.Write(0x5000, 4, (char *) &value), Memory::Error);
+	memory.Protect(0x2000, Memory::PageSize, Memory::AccessRead);
+	EXPECT_THROW(memory.Write(0x2000, 4, (char *) &value), Memory::Error);
+
+	// In unsafe mode, writes allocate pages
+	memory.setSafe(false);
+	memory.Write(0x10000000, 4, (char *) &value);
+	memory.Read(0x10000000, 4, (char *) &result);
+	EXPECT_EQ(value, result);
+	EXPECT_EQ(3u, memory.getNumPages());
+
+	// Copies of the memory keep all pages
+	Memory copy(memory);
+	EXPECT_EQ(3u, copy.getNumPages());
+	result = 0;
+	copy.Read(0x2ffe, 4, (char *) &result);
+	EXPECT_EQ(value, result);
+}
+
+TEST(TestMemory, map_shared)
+{
+	// Host memory for two pages
+	std::shared_ptr<char> host(new char[2 * Memory::PageSize],
+			std::default_delete<char[]>());
+	for (unsigned i = 0; i < 2 * Memory::PageSize; i++)
+		host.get()[i] = i % 251;
+
+	// Map pages backed by host memory
+	Memory memory;
+	memory.MapShared(0x8000, 2 * Memory::PageSize,
+			Memory::AccessRead | Memory::AccessWrite |
+			Memory::AccessExec, host);
+	Memory::Page *page = memory.getPage(0x9000);
+	ASSERT_TRUE(page != nullptr);
+	long long version = page->getVersion();
+
+	// Reads and instruction fetches do not allocate page data
+	char c;
+	memory.Read(0x9001, 1, &c);
+	EXPECT_EQ((char) ((Memory::PageSize + 1) % 251), c);
+	char *buffer = memory.getBuffer(0x9002, 1, Memory::AccessExec);
+	EXPECT_EQ((char) ((Memory::PageSize + 2) % 251), *buffer);
+	buffer = memory.getBuffer(0x9003, 1, Memory::AccessRead);
+	EXPECT_EQ((char) ((Memory::PageSize + 3) % 251), *buffer);
+	EXPECT_TRUE(page->getData() == nullptr);
+
+	// Copies of the memory share the host memory
+	Memory copy(memory);
+	EXPECT_TRUE(copy.getPage(0x9000)->getData() == nullptr);
+
+	// Writes allocate a private copy of the page, leaving the host memory
+	// and other pages untouched.
+	c = 0;
+	memory.Write(0x9001, 1, &c);
+	EXPECT_TRUE(page->getData() != nullptr);
+	EXPECT_EQ((char) ((Memory::PageSize + 2) % 251), page->getData()[2]);
+	EXPECT_EQ((char) ((Memory::PageSize + 1) % 251),
+			host.get()[Memory::PageSize + 1]);
+	EXPECT_TRUE(memory.getPage(0x8000)->getData() == nullptr);
+	copy.Read(0x9001, 1, &c);
+	EXPECT_EQ((char) ((Memory::PageSize + 1) % 251), c);
+
+	// Writing executable pages assigns a new version
+	EXPECT_NE(version, page->getVersion());
+}
+
+}
@@ -21,6 +21,8 @@
 
 #include <arch/x86/timing/Timing.h>
 #include <arch/common/Arch.h>
+#include <dram/Controller.h>
+#include <dram/System.h>
 #include <lib/cpp/IniFile.h>
 #include <lib/cpp/Error.h>
 #include <lib/esim/Engine.h>
@@ -85,6 +87,48 @@ const std::string mem_config_1 =
                 "DefaultBandwidth = 256"; 
 
 
+const std::string mem_config_dram =
+		"[CacheGeometry geo-l1]\n"
+		"Sets = 128\n"
+		"Assoc = 2\n"
+		"BlockSize = 256\n"
+		"Latency = 5\n"
+		"Ports = 2\n"
+		"\n"
+		"[Module mod-l1-0]\n"
+		"Type = Cache\n"
+		"Geometry = geo-l1\n"
+		"LowNetwork = l1-mm\n"
+		"LowModules = mod-mm\n"
+		"\n"
+		"[Module mod-mm]\n"
+		"Type = MainMemory\n"
+		"BlockSize = 256\n"
+		"Latency = 200\n"
+		"HighNetwork = l1-mm\n"
+		"DramController = Two\n"
+		"\n"
+		"[Entry core-0]\n"
+		"Arch = x86\n"
+		"Core = 0\n"
+		"Thread = 0\n"
+		"DataModule = mod-l1-0\n"
+		"InstModule = mod-l1-0\n"
+		"\n"
+		"[Network l1-mm]\n"
+		"DefaultInputBufferSize = 1024\n"
+		"DefaultOutputBufferSize = 1024\n"
+		"DefaultBandwidth = 256";
+
+const std::string dram_config_0 =
+		"[ General ]\n"
+		"Frequency = 1000\n"
+		"\n"
+		"[ MemoryController One ]\n"
+		"\n"
+		"[ MemoryController Two ]\n";
+
+
 const std::string x86_config_0 =
 		"[ General ]\n"
 		"Cores = 1\n"
@@ -98,6 +142,8 @@ static void Cleanup()
 
 	System::Destroy();
 
+	dram::System::Destroy();
+
 	x86::Timing::Destroy();
 
 	comm::ArchPool::Destroy();
@@ -419,5 +465,133 @@ TEST(TestModule, can_access_2)
 }
 
 
+// This test checks that the accesses to a main memory module backed by a
+// DRAM controller complete through that controller. The addresses are
+// decoded relative to the controller, even if they fall beyond its capacity,
+// and the requests are tagged with the L1 module that originated them.
+TEST(TestModule, dram_round_trip)
+{
+	try
+	{
+		// Cleanup singleton instances
+		Cleanup();
+
+		// Load configuration files
+		misc::IniFile ini_file_mem;
+		misc::IniFile ini_file_x86;
+		misc::IniFile ini_file_dram;
+		ini_file_mem.LoadFromString(mem_config_dram);
+		ini_file_x86.LoadFromString(x86_config_0);
+		ini_file_dram.LoadFromString(dram_config_0);
+
+		// Set up x86 timing simulator
+		x86::Timing::ParseConfiguration(&ini_file_x86);
+		x86::Timing::getInstance();
+
+		// Set up DRAM and memory system
+		dram::System *dram_system = dram::System::getInstance();
+		dram_system->ParseConfiguration(&ini_file_dram);
+		System *memory_system = System::getInstance();
+		memory_system->ReadConfiguration(&ini_file_mem);
+		Module *module_l1_0 = memory_system->getModule("mod-l1-0");
+		ASSERT_NE(module_l1_0, nullptr);
+		dram::Controller *controller_one =
+				dram_system->getController("One");
+		dram::Controller *controller_two =
+				dram_system->getController("Two");
+
+		// Three stores to the same set, the last one evicting the
+		// dirty block of the first one.
+		esim::Engine *esim_engine = esim::Engine::getInstance();
+		for (unsigned i = 0; i < 3; i++)
+		{
+			int witness = -1;
+			module_l1_0->Access(Module::AccessStore,
+					0xfff00000 + i * 0x8000, &witness);
+			while (witness < 0)
+				esim_engine->ProcessEvents();
+		}
+
+		// Wait for the write-back of the evicted block
+		for (int i = 0; i < 10000 &&
+				controller_two->getNumCompletedRequests() < 4; i++)
+			esim_engine->ProcessEvents();
+
+		// All requests went through the controller of the module
+		EXPECT_EQ(0, controller_one->getNumReads() +
+				controller_one->getNumWrites());
+		EXPECT_EQ(3, controller_two->getNumReads());
+		EXPECT_EQ(1, controller_two->getNumWrites());
+		EXPECT_EQ(4, controller_two->getNumCompletedRequests());
+		EXPECT_EQ(4, controller_two->getNumRequests(
+				controller_two->getSourceId("mod-l1-0")));
+		EXPECT_EQ(0, controller_two->getNumRequests(
+				controller_two->getSourceId("mod-mm")));
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+// This test checks that evicting a clean block from a cache backed by a
+// DRAM main memory sends no request to the DRAM controller, since no data
+// is written back.
+TEST(TestModule, dram_clean_eviction)
+{
+	try
+	{
+		// Cleanup singleton instances
+		Cleanup();
+
+		// Load configuration files
+		misc::IniFile ini_file_mem;
+		misc::IniFile ini_file_x86;
+		misc::IniFile ini_file_dram;
+		ini_file_mem.LoadFromString(mem_config_dram);
+		ini_file_x86.LoadFromString(x86_config_0);
+		ini_file_dram.LoadFromString(dram_config_0);
+
+		// Set up x86 timing simulator
+		x86::Timing::ParseConfiguration(&ini_file_x86);
+		x86::Timing::getInstance();
+
+		// Set up DRAM and memory system
+		dram::System *dram_system = dram::System::getInstance();
+		dram_system->ParseConfiguration(&ini_file_dram);
+		System *memory_system = System::getInstance();
+		memory_system->ReadConfiguration(&ini_file_mem);
+		Module *module_l1_0 = memory_system->getModule("mod-l1-0");
+		ASSERT_NE(module_l1_0, nullptr);
+		dram::Controller *controller = dram_system->getController("Two");
+
+		// Three loads to the same set, the last one evicting the clean
+		// block of the first one
+		esim::Engine *esim_engine = esim::Engine::getInstance();
+		for (unsigned i = 0; i < 3; i++)
+		{
+			int witness = -1;
+			module_l1_0->Access(Module::AccessLoad,
+					0xfff00000 + i * 0x8000, &witness);
+			while (witness < 0)
+				esim_engine->ProcessEvents();
+		}
+		esim_engine->ProcessAllEvents();
+
+		// Only the three loads reached the controller
+		EXPECT_EQ(3, controller->getNumReads());
+		EXPECT_EQ(0, controller->getNumWrites());
+		EXPECT_EQ(3, controller->getNumCompletedRequests());
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
 } // Namespace mem
 
@@ -0,0 +1,274 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <arch/x86/timing/Timing.h>
+#include <arch/common/Arch.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/Error.h>
+#include <lib/esim/Engine.h>
+#include <memory/Prefetcher.h>
+#include <memory/System.h>
+#include <memory/Module.h>
+#include <network/System.h>
+
+namespace mem
+{
+
+const std::string prefetch_mem_config =
+		"[CacheGeometry geo-l1]\n"
+		"Sets = 16\n"
+		"Assoc = 2\n"
+		"BlockSize = 64\n"
+		"Latency = 2\n"
+		"MSHR = 8\n"
+		"Ports = 2\n"
+		"\n"
+		"[Module mod-l1-0]\n"
+		"Type = Cache\n"
+		"Geometry = geo-l1\n"
+		"LowNetwork = l1-mm\n"
+		"LowModules = mod-mm\n"
+		"Prefetcher = Stream\n"
+		"PrefetchDegree = 2\n"
+		"\n"
+		"[Module mod-mm]\n"
+		"Type = MainMemory\n"
+		"BlockSize = 64\n"
+		"Latency = 100\n"
+		"HighNetwork = l1-mm\n"
+		"\n"
+		"[Entry core-0]\n"
+		"Arch = x86\n"
+		"Core = 0\n"
+		"Thread = 0\n"
+		"DataModule = mod-l1-0\n"
+		"InstModule = mod-l1-0\n"
+		"\n"
+		"[Network l1-mm]\n"
+		"DefaultInputBufferSize = 1024\n"
+		"DefaultOutputBufferSize = 1024\n"
+		"DefaultBandwidth = 256";
+
+const std::string prefetch_x86_config =
+		"[ General ]\n"
+		"Cores = 1\n"
+		"Threads = 1\n";
+
+static void Cleanup()
+{
+	esim::Engine::Destroy();
+
+	net::System::Destroy();
+
+	System::Destroy();
+
+	x86::Timing::Destroy();
+
+	comm::ArchPool::Destroy();
+}
+
+
+TEST(TestPrefetcher, create)
+{
+	EXPECT_EQ(Prefetcher::Create(Prefetcher::TypeNone, 64, 2, 16, 64),
+			nullptr);
+	auto prefetcher = Prefetcher::Create(Prefetcher::TypeStride,
+			64, 2, 16, 64);
+	ASSERT_NE(prefetcher, nullptr);
+	EXPECT_EQ(prefetcher->getType(), Prefetcher::TypeStride);
+	EXPECT_EQ(prefetcher->getDegree(), 2);
+	EXPECT_EQ(prefetcher->getDistance(), 16);
+	EXPECT_EQ(prefetcher->getTableSize(), 64);
+}
+
+
+// A constant stride is prefetched after it is confirmed twice. Strides
+// shorter than a block advance one block per prefetch.
+TEST(TestPrefetcher, stride)
+{
+	StridePrefetcher prefetcher(64, 2, 16, 64);
+	std::vector<unsigned> addresses;
+
+	// Training
+	for (int i = 0; i < 3; i++)
+	{
+		prefetcher.Access(0x400, 0x1000 + i * 128, false, false,
+				addresses);
+		EXPECT_TRUE(addresses.empty());
+	}
+
+	// Stride confirmed
+	prefetcher.Access(0x400, 0x1180, false, false, addresses);
+	EXPECT_EQ(addresses, std::vector<unsigned>({ 0x1200, 0x1280 }));
+
+	// Short stride of another instruction
+	addresses.clear();
+	for (int i = 0; i < 4; i++)
+		prefetcher.Access(0x500, 0x2000 + i * 4, true, false,
+				addresses);
+	EXPECT_EQ(addresses, std::vector<unsigned>({ 0x204c, 0x208c }));
+}
+
+
+TEST(TestPrefetcher, stream)
+{
+	StreamPrefetcher prefetcher(64, 2, 16, 4);
+	std::vector<unsigned> addresses;
+
+	// Ascending stream confirmed on the third miss
+	prefetcher.Access(0, 10 << 6, false, false, addresses);
+	prefetcher.Access(0, 11 << 6, false, false, addresses);
+	EXPECT_TRUE(addresses.empty());
+	prefetcher.Access(0, 12 << 6, false, false, addresses);
+	EXPECT_EQ(addresses, std::vector<unsigned>({ 13 << 6, 14 << 6 }));
+
+	// Regular hits do not train the stream, hits on prefetched blocks do
+	addresses.clear();
+	prefetcher.Access(0, 13 << 6, true, false, addresses);
+	EXPECT_TRUE(addresses.empty());
+	prefetcher.Access(0, 13 << 6, true, true, addresses);
+	EXPECT_EQ(addresses, std::vector<unsigned>({ 15 << 6, 16 << 6 }));
+
+	// Descending stream far from the first one
+	addresses.clear();
+	prefetcher.Access(0, 100 << 6, false, false, addresses);
+	prefetcher.Access(0, 99 << 6, false, false, addresses);
+	prefetcher.Access(0, 98 << 6, false, false, addresses);
+	EXPECT_EQ(addresses, std::vector<unsigned>({ 97 << 6, 96 << 6 }));
+}
+
+
+// Sequential misses whose fills arrive 5 accesses later. The best-offset
+// prefetcher should learn offset 5, the smallest timely offset.
+TEST(TestPrefetcher, best_offset)
+{
+	BestOffsetPrefetcher prefetcher(64, 1, 16, 64);
+	std::vector<unsigned> addresses;
+	unsigned block;
+	for (block = 0; block < 10000 && !prefetcher.getOffset(); block++)
+	{
+		prefetcher.Access(0, block << 6, false, false, addresses);
+		if (block >= 4)
+			prefetcher.Fill((block - 4) << 6, false);
+	}
+	EXPECT_EQ(prefetcher.getOffset(), 5);
+	ASSERT_FALSE(addresses.empty());
+	EXPECT_EQ(addresses.back(), (block - 1 + 5) << 6);
+}
+
+
+// Sequential loads to a cache with a stream prefetcher bring the next blocks
+// ahead of time, and later loads hit on them.
+TEST(TestPrefetcher, module_stream)
+{
+	try
+	{
+		// Cleanup singleton instances
+		Cleanup();
+
+		// Load configuration files
+		misc::IniFile ini_file_mem;
+		misc::IniFile ini_file_x86;
+		ini_file_mem.LoadFromString(prefetch_mem_config);
+		ini_file_x86.LoadFromString(prefetch_x86_config);
+
+		// Set up x86 timing simulator
+		x86::Timing::ParseConfiguration(&ini_file_x86);
+		x86::Timing::getInstance();
+
+		// Set up memory system
+		System *memory_system = System::getInstance();
+		memory_system->ReadConfiguration(&ini_file_mem);
+		Module *module_l1 = memory_system->getModule("mod-l1-0");
+		ASSERT_NE(module_l1, nullptr);
+		ASSERT_NE(module_l1->getPrefetcher(), nullptr);
+
+		// Three sequential misses confirm the stream
+		esim::Engine *esim_engine = esim::Engine::getInstance();
+		for (unsigned address = 0; address < 0xc0; address += 0x40)
+		{
+			int witness = -1;
+			module_l1->Access(Module::AccessLoad, address, &witness);
+			while (witness < 0)
+				esim_engine->ProcessEvents();
+		}
+
+		// Wait for the prefetches
+		while (module_l1->isInFlightAddress(0xc0) ||
+				module_l1->isInFlightAddress(0x100))
+			esim_engine->ProcessEvents();
+		EXPECT_EQ(module_l1->getNumPrefetches(), 2);
+		int set, way, tag;
+		Cache::BlockState state;
+		ASSERT_TRUE(module_l1->FindBlock(0xc0, set, way, tag, state));
+		EXPECT_TRUE(module_l1->getCache()->getBlock(set, way)
+				->isPrefetched());
+		EXPECT_TRUE(module_l1->FindBlock(0x100, set, way, tag, state));
+
+		// A load on a prefetched block is a useful prefetch
+		int witness = -1;
+		module_l1->Access(Module::AccessLoad, 0xc0, &witness);
+		while (witness < 0)
+			esim_engine->ProcessEvents();
+		EXPECT_EQ(module_l1->getNumUsefulPrefetches(), 1);
+		ASSERT_TRUE(module_l1->FindBlock(0xc0, set, way, tag, state));
+		EXPECT_FALSE(module_l1->getCache()->getBlock(set, way)
+				->isPrefetched());
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+TEST(TestPrefetcher, config_invalid_prefetcher)
+{
+	// Cleanup singleton instances
+	Cleanup();
+
+	// Invalid prefetcher type
+	std::string config = prefetch_mem_config;
+	config.replace(config.find("Prefetcher = Stream"),
+			std::string("Prefetcher = Stream").size(),
+			"Prefetcher = Markov");
+	misc::IniFile ini_file_mem;
+	misc::IniFile ini_file_x86;
+	ini_file_mem.LoadFromString(config);
+	ini_file_x86.LoadFromString(prefetch_x86_config);
+	x86::Timing::ParseConfiguration(&ini_file_x86);
+	x86::Timing::getInstance();
+	std::string message;
+	try
+	{
+		System *memory_system = System::getInstance();
+		memory_system->ReadConfiguration(&ini_file_mem);
+	}
+	catch (misc::Error &e)
+	{
+		message = e.getMessage();
+	}
+	EXPECT_NE(message.find("Invalid prefetcher"), std::string::npos);
+}
+
+
+}  // namespace mem
@@ -22,6 +22,9 @@
 #include <string>
 #include <regex>
 #include <exception>
+#include <vector>
+#include <network/Buffer.h>
+#include <network/Connection.h>
 #include <network/EndNode.h>
 #include <network/RoutingTable.h>
 #include <network/System.h>
@@ -1942,6 +1945,66 @@ TEST(TestSystemConfiguration, routes_no_possible_route)
 					message.c_str());
 }
 
+TEST(TestSystemConfiguration, routes_loop)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// Setup configuration file
+	std::string config =
+			"[ Network.test ]\n"
+			"DefaultInputBufferSize = 4\n"
+			"DefaultOutputBufferSize = 4\n"
+			"DefaultBandwidth = 1\n"
+			"DefaultPacketSize = 0\n"
+			"[Network.test.Node.N0]\n"
+			"Type = EndNode\n"
+			"[Network.test.Node.N1]\n"
+			"Type = EndNode\n"
+			"[Network.test.Node.S0]\n"
+			"Type = Switch\n"
+			"[Network.test.Node.S1]\n"
+			"Type = Switch\n"
+			"[Network.test.Link.N0-S0]\n"
+			"Type = Unidirectional\n"
+			"Source = N0\n"
+			"Dest = S0\n"
+			"[Network.test.Link.S0-S1]\n"
+			"Type = Bidirectional\n"
+			"Source = S0\n"
+			"Dest = S1\n"
+			"[Network.test.Link.S1-N1]\n"
+			"Type = Unidirectional\n"
+			"Source = S1\n"
+			"Dest = N1\n"
+			"[Network.test.Routes]\n"
+			"N0.to.N1 = S0\n"
+			"S0.to.N1 = S1\n"
+			"S1.to.N1 = S0";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Set up network instance
+	System *system = System::getInstance();
+	EXPECT_TRUE(system != nullptr);
+
+	// Test body
+	std::string message;
+	try
+	{
+		system->ParseConfiguration(&ini_file);
+	}
+	catch (misc::Error &error)
+	{
+		message = error.getMessage();
+	}
+	EXPECT_REGEX_MATCH("Network test: route S0.to.N1: "
+					"routing loop\n",
+					message.c_str());
+}
+
 TEST(TestSystemConfiguration, routes_wrong_virtual_channel)
 {
 	// Cleanup singleton instance
@@ -2463,4 +2526,424 @@ TEST(TestSystemConfiguration, thorough_manual_routing)
 	}
 }
 
+
+TEST(TestSystemConfiguration, topology_invalid_dims)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// Setup configuration file
+	std::string config =
+			"[ Network.test ]\n"
+			"DefaultInputBufferSize = 4\n"
+			"DefaultOutputBufferSize = 4\n"
+			"DefaultBandwidth = 1\n"
+			"[ Network.test.Topology ]\n"
+			"Type = Mesh\n"
+			"Dims = 4x0";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Set up network instance
+	System *system = System::getInstance();
+	EXPECT_TRUE(system != nullptr);
+
+	// Test body
+	std::string message;
+	try
+	{
+		system->ParseConfiguration(&ini_file);
+	}
+	catch (misc::Error &error)
+	{
+		message = error.getMessage();
+	}
+	EXPECT_REGEX_MATCH(misc::fmt("%s: Network.test.Topology: Invalid "
+			"value '4x0' for variable 'Dims'.\n.*",
+			ini_file.getPath().c_str()).c_str(),
+			message.c_str());
+}
+
+TEST(TestSystemConfiguration, topology_mesh_dimension_order)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// Setup configuration file
+	std::string config =
+			"[ Network.test ]\n"
+			"DefaultInputBufferSize = 4\n"
+			"DefaultOutputBufferSize = 4\n"
+			"DefaultBandwidth = 1\n"
+			"[ Network.test.Topology ]\n"
+			"Type = Mesh\n"
+			"Dims = 3x3\n"
+			"Concentration = 2";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Set up network instance
+	System *system = System::getInstance();
+	EXPECT_TRUE(system != nullptr);
+
+	// Test body
+	try
+	{
+		system->ParseConfiguration(&ini_file);
+		Network *network = system->getNetworkByName("test");
+		EXPECT_EQ(network->getNumNodes(), 27);
+		EXPECT_EQ(network->getNumEndNodes(), 18);
+		RoutingTable *table = network->getRoutingTable();
+		EXPECT_FALSE(table->hasCycle());
+
+		// Route from the corner at (0, 0) to the opposite corner at
+		// (2, 2) goes along X first
+		Node *n0 = network->getNodeByName("n0");
+		Node *n17 = network->getNodeByName("n17");
+		Node *s0 = network->getNodeByName("s0");
+		Node *s1 = network->getNodeByName("s1");
+		Node *s2 = network->getNodeByName("s2");
+		Node *s5 = network->getNodeByName("s5");
+		Node *s8 = network->getNodeByName("s8");
+		RoutingTable::Entry *entry = table->Lookup(n0, n17);
+		EXPECT_EQ(entry->cost, 6);
+		EXPECT_EQ(entry->getNextNode(), s0);
+		EXPECT_EQ(table->Lookup(s0, n17)->getNextNode(), s1);
+		EXPECT_EQ(table->Lookup(s1, n17)->getNextNode(), s2);
+		EXPECT_EQ(table->Lookup(s2, n17)->getNextNode(), s5);
+		EXPECT_EQ(table->Lookup(s5, n17)->getNextNode(), s8);
+		EXPECT_EQ(table->Lookup(s8, n17)->getNextNode(), n17);
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestSystemConfiguration, topology_torus_no_cycle)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// Setup configuration file
+	std::string config =
+			"[ Network.test ]\n"
+			"DefaultInputBufferSize = 4\n"
+			"DefaultOutputBufferSize = 4\n"
+			"DefaultBandwidth = 1\n"
+			"[ Network.test.Topology ]\n"
+			"Type = Torus\n"
+			"Dims = 5x4";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Set up network instance
+	System *system = System::getInstance();
+	EXPECT_TRUE(system != nullptr);
+
+	// Test body
+	try
+	{
+		system->ParseConfiguration(&ini_file);
+		Network *network = system->getNetworkByName("test");
+		RoutingTable *table = network->getRoutingTable();
+		EXPECT_FALSE(table->hasCycle());
+
+		// Route from (4, 0) to (0, 0) takes the wraparound link
+		Node *n0 = network->getNodeByName("n0");
+		Node *s0 = network->getNodeByName("s0");
+		Node *s4 = network->getNodeByName("s4");
+		RoutingTable::Entry *entry = table->Lookup(s4, n0);
+		EXPECT_EQ(entry->cost, 2);
+		EXPECT_EQ(entry->getNextNode(), s0);
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestSystemConfiguration, topology_fat_tree_and_dragonfly)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// Setup configuration file
+	std::string config =
+			"[ Network.tree ]\n"
+			"DefaultInputBufferSize = 4\n"
+			"DefaultOutputBufferSize = 4\n"
+			"DefaultBandwidth = 1\n"
+			"[ Network.tree.Topology ]\n"
+			"Type = FatTree\n"
+			"Arity = 2\n"
+			"Levels = 3\n"
+			"[ Network.dragonfly ]\n"
+			"DefaultInputBufferSize = 4\n"
+			"DefaultOutputBufferSize = 4\n"
+			"DefaultBandwidth = 1\n"
+			"[ Network.dragonfly.Topology ]\n"
+			"Type = Dragonfly\n"
+			"RoutersPerGroup = 4\n"
+			"GlobalLinks = 2\n"
+			"Concentration = 2";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Set up network instance
+	System *system = System::getInstance();
+	EXPECT_TRUE(system != nullptr);
+
+	// Test body
+	try
+	{
+		system->ParseConfiguration(&ini_file);
+
+		// Fat tree with 3 levels of 4 switches and 8 end nodes
+		Network *network = system->getNetworkByName("tree");
+		EXPECT_EQ(network->getNumNodes(), 20);
+		EXPECT_EQ(network->getNumEndNodes(), 8);
+		RoutingTable *table = network->getRoutingTable();
+		EXPECT_FALSE(table->hasCycle());
+		Node *n0 = network->getNodeByName("n0");
+		Node *n7 = network->getNodeByName("n7");
+		EXPECT_EQ(table->Lookup(n0, n7)->cost, 6);
+		EXPECT_EQ(table->Lookup(n0, network->getNodeByName("n1"))->cost,
+				2);
+
+		// Dragonfly with 9 groups of 4 routers, at most 3 hops between
+		// routers on the way between any two end nodes
+		network = system->getNetworkByName("dragonfly");
+		EXPECT_EQ(network->getNumNodes(), 108);
+		EXPECT_EQ(network->getNumEndNodes(), 72);
+		table = network->getRoutingTable();
+		EXPECT_FALSE(table->hasCycle());
+		for (int i = 0; i < network->getNumNodes(); i++)
+		{
+			Node *source = network->getNode(i);
+			for (int j = 0; j < network->getNumNodes(); j++)
+			{
+				Node *destination = network->getNode(j);
+				if (source == destination ||
+						!dynamic_cast<EndNode *>(source) ||
+						!dynamic_cast<EndNode *>(destination))
+					continue;
+				EXPECT_LE(table->Lookup(source, destination)->cost,
+						5);
+			}
+		}
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+// Return the configuration of a link between two nodes of network 'test'
+static std::string LinkConfig(const std::string &source,
+		const std::string &destination,
+		bool bidirectional = true)
+{
+	return misc::fmt("[ Network.test.Link.%s-%s ]\n"
+			"Type = %s\n"
+			"Source = %s\n"
+			"Dest = %s\n",
+			source.c_str(), destination.c_str(),
+			bidirectional ? "Bidirectional" : "Unidirectional",
+			source.c_str(), destination.c_str());
+}
+
+// Parse network 'test' from its nodes and links, and check that the
+// routing table chooses the same routes as the Floyd-Warshall algorithm,
+// computed here as a reference.
+static void ExpectFloydWarshallRoutes(const std::string &nodes_and_links)
+{
+	// Set up network
+	Cleanup();
+	std::string config =
+			"[ Network.test ]\n"
+			"DefaultInputBufferSize = 4\n"
+			"DefaultOutputBufferSize = 4\n"
+			"DefaultBandwidth = 1\n" +
+			nodes_and_links;
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	System *system = System::getInstance();
+	system->ParseConfiguration(&ini_file);
+	Network *network = system->getNetworkByName("test");
+	RoutingTable *table = network->getRoutingTable();
+
+	// One-hop routes
+	int dimension = network->getNumNodes();
+	std::vector<int> costs(dimension * dimension, dimension);
+	std::vector<int> next_nodes(dimension * dimension, -1);
+	for (int i = 0; i < dimension; i++)
+	{
+		Node *node = network->getNode(i);
+		costs[i * dimension + i] = 0;
+		for (int j = 0; j < node->getNumOutputBuffers(); j++)
+		{
+			Connection *connection = node->getOutputBuffer(j)->
+					getConnection();
+			for (int k = 0; k < connection->
+					getNumDestinationBuffers(); k++)
+			{
+				Node *neighbor = connection->
+						getDestinationBuffer(k)->getNode();
+				if (neighbor == node)
+					continue;
+				costs[i * dimension + neighbor->getIndex()] = 1;
+				next_nodes[i * dimension + neighbor->getIndex()] =
+						neighbor->getIndex();
+			}
+		}
+	}
+
+	// Floyd-Warshall, recording the intermediate node of each route
+	for (int k = 0; k < dimension; k++)
+		for (int i = 0; i < dimension; i++)
+			for (int j = 0; j < dimension; j++)
+				if (costs[i * dimension + j] >
+						costs[i * dimension + k] +
+						costs[k * dimension + j])
+				{
+					costs[i * dimension + j] =
+							costs[i * dimension + k] +
+							costs[k * dimension + j];
+					next_nodes[i * dimension + j] = k;
+				}
+
+	// Compare the first hop of every route, following intermediate nodes
+	// until a neighbor of the source is found
+	int num_mismatches = 0;
+	for (int i = 0; i < dimension; i++)
+	{
+		for (int j = 0; j < dimension; j++)
+		{
+			RoutingTable::Entry *entry = table->Lookup(
+					network->getNode(i), network->getNode(j));
+			int next_node = next_nodes[i * dimension + j];
+			if (next_node < 0)
+			{
+				num_mismatches += entry->getNextNode() != nullptr;
+				continue;
+			}
+			while (costs[i * dimension + next_node] > 1)
+				next_node = next_nodes[i * dimension + next_node];
+			if (entry->cost != costs[i * dimension + j] ||
+					entry->getNextNode() !=
+					network->getNode(next_node))
+				num_mismatches++;
+		}
+	}
+	EXPECT_EQ(0, num_mismatches);
+}
+
+TEST(TestSystemConfiguration, shortest_paths_ring)
+{
+	// Ring of 8 switches, with one end node each. Routes to the opposite
+	// switch have the same cost in both directions.
+	std::string config;
+	for (int i = 0; i < 8; i++)
+		config += misc::fmt("[ Network.test.Node.n%d ]\n"
+				"Type = EndNode\n"
+				"[ Network.test.Node.s%d ]\n"
+				"Type = Switch\n", i, i);
+	for (int i = 0; i < 8; i++)
+		config += LinkConfig(misc::fmt("n%d", i), misc::fmt("s%d", i)) +
+				LinkConfig(misc::fmt("s%d", i),
+				misc::fmt("s%d", (i + 1) % 8));
+
+	try
+	{
+		ExpectFloydWarshallRoutes(config);
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestSystemConfiguration, shortest_paths_torus)
+{
+	// Torus of 4x4 switches, declared after their end nodes
+	std::string config;
+	for (int i = 0; i < 16; i++)
+		config += misc::fmt("[ Network.test.Node.n%d ]\n"
+				"Type = EndNode\n", i);
+	for (int i = 0; i < 16; i++)
+		config += misc::fmt("[ Network.test.Node.s%d ]\n"
+				"Type = Switch\n", i);
+	for (int i = 0; i < 16; i++)
+	{
+		int x = i % 4;
+		int y = i / 4;
+		config += LinkConfig(misc::fmt("n%d", i), misc::fmt("s%d", i)) +
+				LinkConfig(misc::fmt("s%d", i), misc::fmt("s%d",
+				y * 4 + (x + 1) % 4)) +
+				LinkConfig(misc::fmt("s%d", i), misc::fmt("s%d",
+				(y + 1) % 4 * 4 + x));
+	}
+
+	try
+	{
+		ExpectFloydWarshallRoutes(config);
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestSystemConfiguration, shortest_paths_irregular)
+{
+	// Switches declared out of order, connected with bidirectional and
+	// unidirectional links, and with some nodes unreachable from others
+	std::string config;
+	const int switches[] = { 5, 2, 8, 0, 7, 3, 9, 1, 6, 4 };
+	for (int i : switches)
+		config += misc::fmt("[ Network.test.Node.s%d ]\n"
+				"Type = Switch\n", i);
+	for (int i = 0; i < 6; i++)
+		config += misc::fmt("[ Network.test.Node.n%d ]\n"
+				"Type = EndNode\n", i);
+	const int links[][3] = {
+		{ 0, 1, 1 }, { 0, 2, 1 }, { 1, 3, 1 }, { 2, 3, 1 },
+		{ 3, 4, 1 }, { 2, 5, 0 }, { 5, 4, 0 }, { 4, 6, 1 },
+		{ 5, 6, 1 }, { 6, 7, 1 }, { 1, 7, 0 }, { 7, 8, 1 },
+		{ 8, 0, 0 }, { 3, 8, 1 }, { 9, 5, 0 }
+	};
+	for (auto &link : links)
+		config += LinkConfig(misc::fmt("s%d", link[0]),
+				misc::fmt("s%d", link[1]), link[2]);
+	const int end_nodes[] = { 0, 3, 4, 6, 8, 9 };
+	for (int i = 0; i < 6; i++)
+		config += LinkConfig(misc::fmt("n%d", i),
+				misc::fmt("s%d", end_nodes[i]));
+
+	try
+	{
+		ExpectFloydWarshallRoutes(config);
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
 }